@@ -116,6 +116,10 @@
     (zero) byte are rejected with SI_FAIL. Streams larger than SI_MAX_FILE_SIZE
     are rejected with SI_FILE.
 
+    Data that arrives in pieces, such as from a pipe or socket, can be loaded
+    without collecting it first by using BeginLoad(), Feed() and EndLoad().
+    LoadData(std::istream&) is implemented this way.
+
     @section multiline MULTI-LINE VALUES
 
     Values that span multiple lines are created using the following format.
@@ -184,7 +188,23 @@
       SI_STRLESS class, or by sorting the strings external to this library.
     - Usage of the <mbstring.h> header on Windows can be disabled by defining
       SI_NO_MBCS. This is defined automatically on Windows CE platforms.
-    - Not thread-safe so manage your own locking
+    - Not thread-safe so manage your own locking. With SI_SUPPORT_THREADS
+      defined, CSimpleIniShared publishes loaded objects to many reading
+      threads without locking the readers.
+    - Define SI_SUPPORT_WATCH on Linux to enable CSimpleIniWatcher, which
+      reloads a file into a CSimpleIniShared object when it is written and
+      reports the keys that changed.
+    - Define SI_SUPPORT_MMAP to enable LoadFileMapped(), which parses a
+      copy-on-write mapping of the file in place instead of reading it. The
+      file must not be modified while it is mapped.
+    - When SI_CHAR is char, line scanning during load uses SSE2 or AVX2 when
+      the compiler targets them. Define SI_NO_SIMD to use the scalar scanner.
+    - When compiled as C++17 the accessors also take std::basic_string_view
+      names, and GetValueView() is available. Define SI_NO_STRING_VIEW to
+      disable them.
+    - When compiled as C++17 GetInt64Value(), GetUInt64Value(),
+      GetFloatValue() and their setters use <charconv>, and are independent
+      of the locale. Define SI_NO_CHARCONV to use strtoll() etc. instead.
     - On non-Windows platforms with SI_CONVERT_ICU, wide-character LoadFile()
       and SaveFile() convert paths to UTF-8 dynamically (no fixed path-length limit).
 
@@ -244,16 +264,99 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <errno.h>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
+#include <new>
+#include <stdint.h>
 #include <stdio.h>
 #include <string>
+#include <utility>
+#include <vector>
 
 #ifdef SI_SUPPORT_IOSTREAMS
 #include <iostream>
 #endif // SI_SUPPORT_IOSTREAMS
 
+// the file watcher publishes through CSimpleIniShared
+#if defined(SI_SUPPORT_WATCH) && !defined(SI_SUPPORT_THREADS)
+#define SI_SUPPORT_THREADS
+#endif
+
+#ifdef SI_SUPPORT_THREADS
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif // SI_SUPPORT_THREADS
+
+#ifdef SI_SUPPORT_MMAP
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif // SI_SUPPORT_MMAP
+
+#ifdef SI_SUPPORT_WATCH
+#ifndef __linux__
+#error SI_SUPPORT_WATCH requires inotify, which is only available on Linux
+#endif
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif // SI_SUPPORT_WATCH
+
+// Vectorized line scanning is used when parsing char data. The instruction
+// set is selected at compile time. Define SI_NO_SIMD to use only the scalar
+// scanner.
+#ifndef SI_NO_SIMD
+#if defined(__AVX2__)
+#define SI_SCAN_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                  \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SI_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && (defined(SI_SCAN_AVX2) || defined(SI_SCAN_SSE2))
+#include <intrin.h>
+#endif
+#endif // SI_NO_SIMD
+
+// Save() passes its output to the OutputWriter in blocks of this many chars
+#ifndef SI_SAVE_BUFFER_SIZE
+#define SI_SAVE_BUFFER_SIZE 65536
+#endif
+
+// Accessors that take string views are added when compiling as C++17.
+// Define SI_NO_STRING_VIEW to leave them out.
+#if !defined(SI_NO_STRING_VIEW) &&                                             \
+    (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#define SI_HAS_STRING_VIEW
+#include <string_view>
+#endif
+
+// GetInt64Value(), GetFloatValue() etc. convert with <charconv> when
+// compiling as C++17, which doesn't depend on the locale. Floating point
+// values also need library support for them, see __cpp_lib_to_chars. Define
+// SI_NO_CHARCONV to use the C library functions instead.
+#if !defined(SI_NO_CHARCONV) &&                                                \
+    (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#define SI_HAS_CHARCONV
+#include <charconv>
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define SI_HAS_CHARCONV_FLOAT
+#endif
+#endif
+
 #ifdef _DEBUG
 #ifndef assert
 #include <cassert>
@@ -300,6 +403,432 @@ constexpr size_t SI_MAX_FILE_SIZE = 1024ULL * 1024ULL * 1024ULL;
 #define SI_WCHAR_T UChar
 #endif
 
+template <class SI_CHAR> class SI_ConvertA;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+class CSimpleIniFrozenTempl;
+#ifdef SI_SUPPORT_THREADS
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+class CSimpleIniSharedTempl;
+#endif // SI_SUPPORT_THREADS
+
+/** Is the converter a plain copy of the stored data? When it is, the data
+    read from a file can be parsed in place without converting it into a
+    second buffer.
+ */
+template <class SI_CONVERTER> struct SI_IsIdentityConverter {
+  static constexpr bool value = false;
+};
+template <> struct SI_IsIdentityConverter<SI_ConvertA<char>> {
+  static constexpr bool value = true;
+};
+
+/** Hash of a string that is consistent with the string comparison
+    SI_STRLESS, so that strings which compare as equal have the same hash.
+    It is provided for SI_GenericCase and SI_GenericNoCase, other
+    comparisons can't be used with SetHashIndex().
+ */
+template <class SI_STRLESS> struct SI_StrHash {
+  static constexpr bool value = false;
+  template <class SI_CHAR> static size_t Hash(const SI_CHAR *) { return 0; }
+  template <class SI_CHAR> static size_t Hash(const SI_CHAR *, size_t) {
+    return 0;
+  }
+};
+
+/** Three way comparison of strings of a known length that is consistent
+    with SI_STRLESS. A name given as a string view is looked up with it
+    directly, for other comparisons the name is first copied to a NUL
+    terminated string. It is provided for SI_GenericCase and
+    SI_GenericNoCase.
+ */
+template <class SI_STRLESS> struct SI_StrCompareN {
+  static constexpr bool value = false;
+  template <class SI_CHAR>
+  static int Compare(const SI_CHAR *, size_t, const SI_CHAR *, size_t) {
+    return 0;
+  }
+};
+
+namespace SI_Internal {
+/** Open addressing hash table with linear probing that is used to index
+    the sections and keys. Only the hash and the value are stored, the
+    caller supplies the equality test so that a value can be an iterator.
+ */
+template <class T> class HashIndex {
+public:
+  HashIndex() : m_uSize(0) {}
+
+  /** Find the value with this hash that a_match accepts */
+  template <class MATCH> T *Find(size_t a_uHash, const MATCH &a_match) {
+    size_t uSlot = FindSlot(a_uHash, a_match);
+    return uSlot < m_slots.size() ? &m_slots[uSlot].value : NULL;
+  }
+
+  /** Add a value, there is no check for an existing value */
+  void Insert(size_t a_uHash, const T &a_value) {
+    if ((m_uSize + 1) * 2 > m_slots.size()) {
+      Grow();
+    }
+    const size_t uMask = m_slots.size() - 1;
+    size_t uSlot = a_uHash & uMask;
+    while (m_slots[uSlot].bUsed) {
+      uSlot = (uSlot + 1) & uMask;
+    }
+    m_slots[uSlot].uHash = a_uHash;
+    m_slots[uSlot].value = a_value;
+    m_slots[uSlot].bUsed = true;
+    ++m_uSize;
+  }
+
+  /** Remove the value with this hash that a_match accepts */
+  template <class MATCH> bool Erase(size_t a_uHash, const MATCH &a_match) {
+    size_t uSlot = FindSlot(a_uHash, a_match);
+    if (uSlot >= m_slots.size()) {
+      return false;
+    }
+
+    // move the following values back so that no probe sequence has a gap,
+    // a value can fill the gap if its home slot is not after the gap
+    const size_t uMask = m_slots.size() - 1;
+    for (size_t uNext = (uSlot + 1) & uMask; m_slots[uNext].bUsed;
+         uNext = (uNext + 1) & uMask) {
+      const size_t uHome = m_slots[uNext].uHash & uMask;
+      if (uSlot < uNext ? (uHome <= uSlot || uHome > uNext)
+                        : (uHome <= uSlot && uHome > uNext)) {
+        m_slots[uSlot] = m_slots[uNext];
+        uSlot = uNext;
+      }
+    }
+    m_slots[uSlot] = Slot();
+    --m_uSize;
+    return true;
+  }
+
+  void Clear() {
+    std::vector<Slot>().swap(m_slots);
+    m_uSize = 0;
+  }
+
+  void Swap(HashIndex &a_other) {
+    m_slots.swap(a_other.m_slots);
+    std::swap(m_uSize, a_other.m_uSize);
+  }
+
+  size_t Size() const { return m_uSize; }
+
+  /** Call a_func for every value, the table must not be changed by it */
+  template <class FUNC> void ForEach(FUNC &a_func) const {
+    for (size_t n = 0; n < m_slots.size(); ++n) {
+      if (m_slots[n].bUsed) {
+        a_func(m_slots[n].value);
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    Slot() : uHash(0), value(), bUsed(false) {}
+    size_t uHash;
+    T value;
+    bool bUsed;
+  };
+
+  template <class MATCH>
+  size_t FindSlot(size_t a_uHash, const MATCH &a_match) const {
+    if (m_slots.empty()) {
+      return 0;
+    }
+    const size_t uMask = m_slots.size() - 1;
+    for (size_t uSlot = a_uHash & uMask; m_slots[uSlot].bUsed;
+         uSlot = (uSlot + 1) & uMask) {
+      if (m_slots[uSlot].uHash == a_uHash && a_match(m_slots[uSlot].value)) {
+        return uSlot;
+      }
+    }
+    return m_slots.size();
+  }
+
+  void Grow() {
+    std::vector<Slot> oldSlots(m_slots.empty() ? 16 : m_slots.size() * 2);
+    oldSlots.swap(m_slots);
+    m_uSize = 0;
+    for (size_t n = 0; n < oldSlots.size(); ++n) {
+      if (oldSlots[n].bUsed) {
+        Insert(oldSlots[n].uHash, oldSlots[n].value);
+      }
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  size_t m_uSize;
+};
+
+/** Memory for the strings that are copied into the object. Small strings
+    are cut from slabs and when they are freed they are put on a free list
+    for their size to be reused. Large strings are allocated individually.
+    The blocks are found by address in a hash table, so that a string is
+    freed in constant time and the object can tell which of its strings
+    were copied. All memory is released together by Clear().
+ */
+class StringArena {
+public:
+  /** Memory use of the copied strings. The fragmentation of the arena is
+      uFreeBytes / uReservedBytes.
+   */
+  struct Stats {
+    size_t uStrings;       //!< Number of strings that are allocated
+    size_t uUsedBytes;     //!< Bytes used by the allocated strings
+    size_t uFreeBytes;     //!< Bytes of freed strings held for reuse
+    size_t uReservedBytes; //!< Bytes allocated from the heap
+  };
+
+  StringArena()
+      : m_pSlabs(NULL), m_pCursor(NULL), m_pCursorEnd(NULL), m_uSlabSize(0),
+        m_uUsed(0), m_uFree(0), m_uSlabBytes(0), m_uLargeBytes(0),
+        m_uNextSeq(0) {
+    for (size_t n = 0; n < NUM_CLASSES; ++n) {
+      m_pFreeList[n] = NULL;
+    }
+  }
+
+  ~StringArena() { Clear(); }
+
+  /** Allocate a block of at least a_uBytes, returns NULL when out of
+      memory. The block is aligned for any character type.
+   */
+  void *Allocate(size_t a_uBytes) {
+    const size_t uSize = RoundUp(a_uBytes ? a_uBytes : 1);
+    char *p = NULL;
+    if (uSize > MAX_SMALL) {
+      p = new (std::nothrow) char[uSize];
+      if (!p) {
+        return NULL;
+      }
+      m_uLargeBytes += uSize;
+    } else {
+      char *&pFree = m_pFreeList[uSize / GRAIN - 1];
+      if (pFree) {
+        p = pFree;
+        memcpy(&pFree, p, sizeof(char *));
+        m_uFree -= uSize;
+      } else {
+        if (static_cast<size_t>(m_pCursorEnd - m_pCursor) < uSize &&
+            !AddSlab()) {
+          return NULL;
+        }
+        p = m_pCursor;
+        m_pCursor += uSize;
+      }
+    }
+    Block block = {p, uSize, m_uNextSeq++};
+    m_blocks.Insert(Hash(p), block);
+    m_uUsed += uSize;
+    return p;
+  }
+
+  /** Free a block, returns false if it wasn't allocated by this arena */
+  bool Free(const void *a_p) {
+    const size_t uHash = Hash(a_p);
+    const BlockMatch match = {a_p};
+    const Block *pBlock = m_blocks.Find(uHash, match);
+    if (!pBlock) {
+      return false;
+    }
+    char *p = pBlock->p;
+    const size_t uSize = pBlock->uSize;
+    m_blocks.Erase(uHash, match);
+    m_uUsed -= uSize;
+    if (uSize > MAX_SMALL) {
+      delete[] p;
+      m_uLargeBytes -= uSize;
+    } else {
+      PushFree(p, uSize);
+    }
+    // nothing is held for reuse once there are no strings
+    if (m_blocks.Size() == 0) {
+      m_blocks.Clear();
+      ReleaseSlabs();
+    }
+    return true;
+  }
+
+  /** Bytes that a block of a_uBytes uses in a slab, 0 if it is allocated
+      from the heap by itself.
+   */
+  static size_t SlabBytes(size_t a_uBytes) {
+    const size_t uSize = RoundUp(a_uBytes ? a_uBytes : 1);
+    return uSize > MAX_SMALL ? 0 : uSize;
+  }
+
+  /** Make sure that the next a_uBytes of small blocks, as counted by
+      SlabBytes(), are cut from a single slab. Returns false when out of
+      memory.
+   */
+  bool Reserve(size_t a_uBytes) {
+    if (static_cast<size_t>(m_pCursorEnd - m_pCursor) >= a_uBytes) {
+      return true;
+    }
+    return AddSlab(a_uBytes);
+  }
+
+  /** Position to roll back to, all blocks allocated after it are later */
+  size_t Mark() const { return m_uNextSeq; }
+
+  /** Free all of the blocks that were allocated after a_uMark */
+  void Rollback(size_t a_uMark) {
+    CollectSince collect = {a_uMark, std::vector<const void *>()};
+    m_blocks.ForEach(collect);
+    for (size_t n = 0; n < collect.blocks.size(); ++n) {
+      Free(collect.blocks[n]);
+    }
+  }
+
+  /** Free all blocks and release all memory */
+  void Clear() {
+    DeleteLarge large;
+    m_blocks.ForEach(large);
+    m_blocks.Clear();
+    ReleaseSlabs();
+    m_uUsed = 0;
+    m_uLargeBytes = 0;
+    m_uNextSeq = 0;
+  }
+
+  /** Exchange all blocks with another arena */
+  void Swap(StringArena &a_other) {
+    m_blocks.Swap(a_other.m_blocks);
+    std::swap(m_pSlabs, a_other.m_pSlabs);
+    std::swap(m_pCursor, a_other.m_pCursor);
+    std::swap(m_pCursorEnd, a_other.m_pCursorEnd);
+    for (size_t n = 0; n < NUM_CLASSES; ++n) {
+      std::swap(m_pFreeList[n], a_other.m_pFreeList[n]);
+    }
+    std::swap(m_uSlabSize, a_other.m_uSlabSize);
+    std::swap(m_uUsed, a_other.m_uUsed);
+    std::swap(m_uFree, a_other.m_uFree);
+    std::swap(m_uSlabBytes, a_other.m_uSlabBytes);
+    std::swap(m_uLargeBytes, a_other.m_uLargeBytes);
+    std::swap(m_uNextSeq, a_other.m_uNextSeq);
+  }
+
+  Stats GetStats() const {
+    Stats stats = {m_blocks.Size(), m_uUsed, m_uFree,
+                   m_uSlabBytes + m_uLargeBytes};
+    return stats;
+  }
+
+private:
+  StringArena(const StringArena &);            // disable
+  StringArena &operator=(const StringArena &); // disable
+
+  static constexpr size_t GRAIN = 8;         // allocation size granularity
+  static constexpr size_t MAX_SMALL = 256;   // largest block cut from a slab
+  static constexpr size_t NUM_CLASSES = MAX_SMALL / GRAIN;
+  static constexpr size_t SLAB_HEADER = 16;  // link to the next slab
+  static constexpr size_t MIN_SLAB = 1024;   // size of the first slab
+  static constexpr size_t MAX_SLAB = 65536;  // slabs double up to this size
+
+  struct Block {
+    char *p;
+    size_t uSize;
+    size_t uSeq;
+  };
+  struct BlockMatch {
+    const void *p;
+    bool operator()(const Block &a_block) const { return a_block.p == p; }
+  };
+  struct CollectSince {
+    size_t uMark;
+    std::vector<const void *> blocks;
+    void operator()(const Block &a_block) {
+      if (a_block.uSeq >= uMark) {
+        blocks.push_back(a_block.p);
+      }
+    }
+  };
+  struct DeleteLarge {
+    void operator()(const Block &a_block) const {
+      if (a_block.uSize > MAX_SMALL) {
+        delete[] a_block.p;
+      }
+    }
+  };
+
+  static size_t RoundUp(size_t a_uBytes) {
+    return (a_uBytes + GRAIN - 1) & ~static_cast<size_t>(GRAIN - 1);
+  }
+
+  static size_t Hash(const void *a_p) {
+    size_t uHash = reinterpret_cast<size_t>(a_p) / GRAIN;
+    return uHash ^ (uHash >> 16);
+  }
+
+  void PushFree(char *a_p, size_t a_uSize) {
+    char *&pFree = m_pFreeList[a_uSize / GRAIN - 1];
+    memcpy(a_p, &pFree, sizeof(char *));
+    pFree = a_p;
+    m_uFree += a_uSize;
+  }
+
+  bool AddSlab(size_t a_uMinSize = 0) {
+    size_t uSize = m_uSlabSize ? m_uSlabSize * 2 : MIN_SLAB;
+    if (uSize > MAX_SLAB) {
+      uSize = MAX_SLAB;
+    }
+    if (uSize < a_uMinSize) {
+      uSize = a_uMinSize;
+    }
+    char *pSlab = new (std::nothrow) char[SLAB_HEADER + uSize];
+    if (!pSlab) {
+      return false;
+    }
+    // the end of the current slab is kept as free blocks, which can be
+    // larger than a small block after Reserve()
+    size_t uTail = static_cast<size_t>(m_pCursorEnd - m_pCursor);
+    while (uTail >= GRAIN) {
+      const size_t uBlock = uTail < MAX_SMALL ? uTail : MAX_SMALL;
+      PushFree(m_pCursor, uBlock);
+      m_pCursor += uBlock;
+      uTail -= uBlock;
+    }
+    memcpy(pSlab, &m_pSlabs, sizeof(char *));
+    m_pSlabs = pSlab;
+    m_pCursor = pSlab + SLAB_HEADER;
+    m_pCursorEnd = m_pCursor + uSize;
+    m_uSlabSize = uSize;
+    m_uSlabBytes += SLAB_HEADER + uSize;
+    return true;
+  }
+
+  void ReleaseSlabs() {
+    while (m_pSlabs) {
+      char *pSlab = m_pSlabs;
+      memcpy(&m_pSlabs, pSlab, sizeof(char *));
+      delete[] pSlab;
+    }
+    for (size_t n = 0; n < NUM_CLASSES; ++n) {
+      m_pFreeList[n] = NULL;
+    }
+    m_pCursor = m_pCursorEnd = NULL;
+    m_uSlabSize = 0;
+    m_uSlabBytes = 0;
+    m_uFree = 0;
+  }
+
+  HashIndex<Block> m_blocks;
+  char *m_pSlabs;
+  char *m_pCursor;
+  char *m_pCursorEnd;
+  char *m_pFreeList[NUM_CLASSES];
+  size_t m_uSlabSize;
+  size_t m_uUsed;
+  size_t m_uFree;
+  size_t m_uSlabBytes;
+  size_t m_uLargeBytes;
+  size_t m_uNextSeq;
+};
+} // namespace SI_Internal
+
 // ---------------------------------------------------------------------------
 //                              MAIN TEMPLATE CLASS
 // ---------------------------------------------------------------------------
@@ -328,24 +857,124 @@ class CSimpleIniTempl {
 public:
   typedef SI_CHAR SI_CHAR_T;
 
+#ifdef SI_HAS_STRING_VIEW
+  /** names and values given or returned without a NUL terminator */
+  typedef std::basic_string_view<SI_CHAR> TStringView;
+#endif // SI_HAS_STRING_VIEW
+
+  /** Typed value of a key, as converted by GetLongValue(), GetDoubleValue()
+        or GetBoolValue() when SetValueCache() is enabled.
+     */
+  struct ValueCache {
+    enum Type { NONE, LONG, DOUBLE, BOOL, INT64, UINT64, FLOAT };
+    unsigned char nType; //!< Type of the conversion, NONE if not converted
+    bool bValid;         //!< Was the value valid for this type
+    uint64_t uData;      //!< Converted value, see Get() and Set()
+
+    ValueCache() : nType(NONE), bValid(false), uData(0) {}
+
+    template <class T> void Get(T &a_value) const {
+      memcpy(&a_value, &uData, sizeof(T));
+    }
+    template <class T> void Set(const T &a_value) {
+      memcpy(&uData, &a_value, sizeof(T));
+    }
+  };
+
   /** key entry */
   struct Entry {
     const SI_CHAR *pItem;
     const SI_CHAR *pComment;
     int nOrder;
+    // The length and hash are set for the stored names and the names that
+    // are returned, but not for the temporary entries used to find a name.
+    size_t uLen;  //!< Length of pItem in characters
+    size_t uHash; //!< SI_StrHash of pItem, 0 if the comparison has no hash
+    // Links of the load order lists, which point to the map nodes. They
+    // are set for the stored entries only, copies start out unlinked.
+    mutable const void *pPrevLoaded; //!< Loaded before, circular list
+    mutable const void *pNextLoaded; //!< Loaded after, circular list
+    union {
+      mutable const void *pLastKey;   //!< Section: key loaded last
+      mutable const void *pNextValue; //!< Key: next value of the key
+    };
+    mutable bool bFirstValue; //!< Key: is the first value of the key
 
     Entry(const SI_CHAR *a_pszItem = NULL, int a_nOrder = 0)
-        : pItem(a_pszItem), pComment(NULL), nOrder(a_nOrder) {}
+        : pItem(a_pszItem), pComment(NULL), nOrder(a_nOrder), uLen(0),
+          uHash(0) {
+      Unlink();
+    }
     Entry(const SI_CHAR *a_pszItem, const SI_CHAR *a_pszComment, int a_nOrder)
-        : pItem(a_pszItem), pComment(a_pszComment), nOrder(a_nOrder) {}
+        : pItem(a_pszItem), pComment(a_pszComment), nOrder(a_nOrder) {
+      Measure();
+      Unlink();
+    }
     Entry(const Entry &rhs) { operator=(rhs); }
     Entry &operator=(const Entry &rhs) {
       pItem = rhs.pItem;
       pComment = rhs.pComment;
       nOrder = rhs.nOrder;
+      uLen = rhs.uLen;
+      uHash = rhs.uHash;
+      Unlink();
       return *this;
     }
 
+    /** Clear the load order links */
+    void Unlink() const {
+      pPrevLoaded = NULL;
+      pNextLoaded = NULL;
+      pLastKey = NULL;
+      bFirstValue = true;
+    }
+
+    /** Do the names compare as equal. Names with a different hash are
+        rejected without comparing them.
+     */
+    bool IsSameName(const Entry &rhs) const {
+      if (SI_StrHash<SI_STRLESS>::value && uHash != rhs.uHash) {
+        return false;
+      }
+      return pItem == rhs.pItem ||
+             (!KeyOrder()(*this, rhs) && !KeyOrder()(rhs, *this));
+    }
+
+    /** An entry for a value, as returned by GetAllValues(). Values are
+        never compared by name so only the length is set.
+     */
+    static Entry Value(const SI_CHAR *a_pszValue, const SI_CHAR *a_pszComment,
+                       int a_nOrder) {
+      Entry oValue;
+      oValue.pItem = a_pszValue;
+      oValue.pComment = a_pszComment;
+      oValue.nOrder = a_nOrder;
+      oValue.uLen = a_pszValue ? Length(a_pszValue) : 0;
+      return oValue;
+    }
+
+    /** Set the length and the hash for pItem */
+    void Measure() {
+      uLen = 0;
+      uHash = 0;
+      if (pItem) {
+        uLen = Length(pItem);
+        uHash = SI_StrHash<SI_STRLESS>::Hash(pItem);
+      }
+    }
+
+    static size_t Length(const SI_CHAR *a_pString) {
+      if (sizeof(SI_CHAR) == sizeof(char)) {
+        return strlen((const char *)a_pString);
+      } else if (sizeof(SI_CHAR) == sizeof(wchar_t)) {
+        return wcslen((const wchar_t *)a_pString);
+      }
+      size_t uLen = 0;
+      for (; a_pString[uLen]; ++uLen) /*loop*/
+        ;
+      return uLen;
+    }
+
 #if defined(_MSC_VER) && _MSC_VER <= 1200
     /** STL of VC6 doesn't allow me to specify my own comparator for list::sort() */
     bool operator<(const Entry &rhs) const { return LoadOrder()(*this, rhs); }
@@ -358,6 +987,27 @@ public:
         const static SI_STRLESS isLess = SI_STRLESS();
         return isLess(lhs.pItem, rhs.pItem);
       }
+#ifdef SI_HAS_STRING_VIEW
+      // a name can be found without constructing an Entry, and a name
+      // given as a view is compared by length
+      typedef void is_transparent;
+      bool operator()(const Entry &lhs, const SI_CHAR *rhs) const {
+        const static SI_STRLESS isLess = SI_STRLESS();
+        return isLess(lhs.pItem, rhs);
+      }
+      bool operator()(const SI_CHAR *lhs, const Entry &rhs) const {
+        const static SI_STRLESS isLess = SI_STRLESS();
+        return isLess(lhs, rhs.pItem);
+      }
+      bool operator()(const Entry &lhs, TStringView rhs) const {
+        return SI_StrCompareN<SI_STRLESS>::Compare(
+                   lhs.pItem, lhs.uLen, rhs.data(), rhs.size()) < 0;
+      }
+      bool operator()(TStringView lhs, const Entry &rhs) const {
+        return SI_StrCompareN<SI_STRLESS>::Compare(
+                   lhs.data(), lhs.size(), rhs.pItem, rhs.uLen) < 0;
+      }
+#endif // SI_HAS_STRING_VIEW
     };
 
     /** Strict less ordering by order, and then name of key */
@@ -384,13 +1034,28 @@ public:
   typedef std::list<Entry> TNamesDepend;
 
   /** interface definition for the OutputWriter object to pass to Save()
-        in order to output the INI file data.
+        in order to output the INI file data. Save() collects its output
+        and passes it on in large blocks of known length, which a writer
+        can accept by overriding Write(const char *, size_t). By default
+        the blocks are passed to Write(const char *) in pieces.
     */
   class OutputWriter {
   public:
     OutputWriter() {}
     virtual ~OutputWriter() {}
     virtual void Write(const char *a_pBuf) = 0;
+    /** Write a_uLen chars of a_pBuf, which is not NULL terminated */
+    virtual void Write(const char *a_pBuf, size_t a_uLen) {
+      char szPiece[256];
+      while (a_uLen > 0) {
+        size_t uPiece = a_uLen < sizeof(szPiece) ? a_uLen : sizeof(szPiece) - 1;
+        memcpy(szPiece, a_pBuf, uPiece);
+        szPiece[uPiece] = '\0';
+        Write(szPiece);
+        a_pBuf += uPiece;
+        a_uLen -= uPiece;
+      }
+    }
 
   private:
     OutputWriter(const OutputWriter &);            // disable
@@ -404,6 +1069,9 @@ public:
   public:
     FileWriter(FILE *a_file) : m_file(a_file) {}
     void Write(const char *a_pBuf) { fputs(a_pBuf, m_file); }
+    void Write(const char *a_pBuf, size_t a_uLen) {
+      fwrite(a_pBuf, 1, a_uLen, m_file);
+    }
 
   private:
     FileWriter(const FileWriter &);            // disable
@@ -417,12 +1085,50 @@ public:
   public:
     StringWriter(std::string &a_string) : m_string(a_string) {}
     void Write(const char *a_pBuf) { m_string.append(a_pBuf); }
+    void Write(const char *a_pBuf, size_t a_uLen) {
+      m_string.append(a_pBuf, a_uLen);
+    }
 
   private:
     StringWriter(const StringWriter &);            // disable
     StringWriter &operator=(const StringWriter &); // disable
   };
 
+  /** interface definition for the Visitor object to pass to Parse() in
+        order to receive the INI file data without loading it. All strings
+        are only valid until the callback returns. Return false from a
+        callback to stop the parse.
+    */
+  class Visitor {
+  public:
+    Visitor() {}
+    virtual ~Visitor() {}
+    /** A comment. This is the file comment, the comment before the entry
+          of the next callback, or a comment at the end of the data. */
+    virtual bool OnComment(const SI_CHAR *a_pComment) {
+      (void)a_pComment;
+      return true;
+    }
+    /** A section header. Keys before the first header are in the section
+          named by an empty string, which is not reported. */
+    virtual bool OnSection(const SI_CHAR *a_pSection) {
+      (void)a_pSection;
+      return true;
+    }
+    /** A key. The value is an empty string for keys without a value. */
+    virtual bool OnKey(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                       const SI_CHAR *a_pValue) {
+      (void)a_pSection;
+      (void)a_pKey;
+      (void)a_pValue;
+      return true;
+    }
+
+  private:
+    Visitor(const Visitor &);            // disable
+    Visitor &operator=(const Visitor &); // disable
+  };
+
 #ifdef SI_SUPPORT_IOSTREAMS
   /** OutputWriter class to write the INI data to an ostream */
   class StreamWriter : public OutputWriter {
@@ -431,6 +1137,9 @@ public:
   public:
     StreamWriter(std::ostream &a_ostream) : m_ostream(a_ostream) {}
     void Write(const char *a_pBuf) { m_ostream << a_pBuf; }
+    void Write(const char *a_pBuf, size_t a_uLen) {
+      m_ostream.write(a_pBuf, static_cast<std::streamsize>(a_uLen));
+    }
 
   private:
     StreamWriter(const StreamWriter &);            // disable
@@ -443,29 +1152,122 @@ public:
     */
   class Converter : private SI_CONVERTER {
   public:
-    Converter(bool a_bStoreIsUtf8) : SI_CONVERTER(a_bStoreIsUtf8) {
-      m_scratch.resize(1024);
-    }
+    Converter(bool a_bStoreIsUtf8)
+        : SI_CONVERTER(a_bStoreIsUtf8), m_pData(NULL), m_uDataLen(0) {}
     Converter(const Converter &rhs) { operator=(rhs); }
     Converter &operator=(const Converter &rhs) {
       m_scratch = rhs.m_scratch;
+      m_pData = NULL;
+      m_uDataLen = 0;
       return *this;
     }
     bool ConvertToStore(const SI_CHAR *a_pszString) {
+      m_pData = NULL;
       size_t uLen = SI_CONVERTER::SizeToStore(a_pszString);
       if (uLen == (size_t)(-1)) {
         return false;
       }
+      if (m_scratch.empty()) {
+        m_scratch.resize(1024);
+      }
       while (uLen > m_scratch.size()) {
         m_scratch.resize(m_scratch.size() * 2);
       }
       return SI_CONVERTER::ConvertToStore(
           a_pszString, const_cast<char *>(m_scratch.data()), m_scratch.size());
     }
-    const char *Data() { return m_scratch.data(); }
+    /** Convert a string of a known length. When the stored data is a plain
+        copy the string is used as it is, without copying or scanning it.
+     */
+    bool ConvertToStore(const SI_CHAR *a_pszString, size_t a_uLen) {
+      if (!SI_IsIdentityConverter<SI_CONVERTER>::value) {
+        return ConvertToStore(a_pszString);
+      }
+      m_pData = reinterpret_cast<const char *>(a_pszString);
+      m_uDataLen = a_uLen;
+      return true;
+    }
+    const char *Data() { return m_pData ? m_pData : m_scratch.data(); }
+    /** Length of Data(), which is only NULL terminated when converted */
+    size_t DataLength() const {
+      return m_pData ? m_uDataLen : strlen(m_scratch.data());
+    }
 
   private:
     std::string m_scratch;
+    const char *m_pData; //!< unconverted string, or NULL to use m_scratch
+    size_t m_uDataLen;   //!< length of m_pData
+  };
+
+private:
+  /** Output of Save(), collected and passed to the OutputWriter in blocks
+        of SI_SAVE_BUFFER_SIZE chars. Without memory for the buffer the
+        output is passed on directly. */
+  class OutputBuffer {
+  public:
+    explicit OutputBuffer(OutputWriter &a_oOutput)
+        : m_pOutput(&a_oOutput), m_pBuf(new (std::nothrow) char[SIZE]),
+          m_uSize(m_pBuf ? SIZE : 0), m_uUsed(0) {}
+    /** Copy the output into a buffer of the caller. Output that doesn't
+          fit is only counted, so a_pBuf may be NULL to size the output. */
+    OutputBuffer(char *a_pBuf, size_t a_uSize)
+        : m_pOutput(NULL), m_pBuf(a_pBuf), m_uSize(a_uSize), m_uUsed(0) {}
+    /** Output that was not flushed is dropped, Save() flushes it when the
+          output is complete */
+    ~OutputBuffer() {
+      if (m_pOutput) {
+        delete[] m_pBuf;
+      }
+    }
+    void Write(const char *a_pBuf, size_t a_uLen) {
+      if (a_uLen == 0) {
+        return;
+      }
+      if (m_uUsed <= m_uSize && a_uLen <= m_uSize - m_uUsed) {
+        memcpy(m_pBuf + m_uUsed, a_pBuf, a_uLen);
+        m_uUsed += a_uLen;
+      } else if (!m_pOutput) {
+        if (m_uUsed < m_uSize) {
+          memcpy(m_pBuf + m_uUsed, a_pBuf, m_uSize - m_uUsed);
+        }
+        m_uUsed += a_uLen;
+      } else {
+        Flush();
+        if (a_uLen < m_uSize) {
+          memcpy(m_pBuf, a_pBuf, a_uLen);
+          m_uUsed = a_uLen;
+        } else {
+          m_pOutput->Write(a_pBuf, a_uLen);
+        }
+      }
+    }
+    /** Write a string literal */
+    template <size_t N> void Write(const char (&a_szText)[N]) {
+      Write(a_szText, N - 1);
+    }
+    void Write(Converter &a_oConverter) {
+      Write(a_oConverter.Data(), a_oConverter.DataLength());
+    }
+    void Flush() {
+      if (m_pOutput && m_uUsed > 0) {
+        // the block is written once even if the writer throws
+        const size_t uUsed = m_uUsed;
+        m_uUsed = 0;
+        m_pOutput->Write(m_pBuf, uUsed);
+      }
+    }
+    /** Length of the output written to a buffer of the caller */
+    size_t Length() const { return m_uUsed; }
+
+  private:
+    enum { SIZE = SI_SAVE_BUFFER_SIZE };
+    OutputBuffer(const OutputBuffer &);            // disable
+    OutputBuffer &operator=(const OutputBuffer &); // disable
+
+    OutputWriter *m_pOutput; //!< NULL when writing to a buffer of the caller
+    char *m_pBuf;
+    size_t m_uSize;
+    size_t m_uUsed;
   };
 
 public:
@@ -480,15 +1282,56 @@ public:
   CSimpleIniTempl(bool a_bIsUtf8 = false, bool a_bMultiKey = false,
                   bool a_bMultiLine = false);
 
+  /** Move constructor. All data, settings and resolved keys are moved
+        from a_rhs, which is left empty with the default settings. Pointers
+        to strings, TKeyHandle handles and the data returned by GetSection()
+        stay valid and now refer to this object.
+     */
+  CSimpleIniTempl(CSimpleIniTempl &&a_rhs) noexcept;
+
+  /** Move assignment, see the move constructor. The previous data of this
+        object is released. */
+  CSimpleIniTempl &operator=(CSimpleIniTempl &&a_rhs) noexcept;
+
   /** Destructor */
   ~CSimpleIniTempl();
 
+  /** Exchange all data, settings and resolved keys with another object in
+        constant time. Pointers into the data stay valid and refer to the
+        object that now holds the data.
+     */
+  void Swap(CSimpleIniTempl &a_other) noexcept;
+
+  /** Replace the contents of a_copy with a deep copy of this object, with
+        the same settings. The loaded data block is copied at once and the
+        maps are copied without comparing names, so this is much faster
+        than saving and loading the data. The copy doesn't refer to this
+        object. Keys resolved with ResolveKey() and data of an incremental
+        load in progress are not copied.
+
+        @return SI_Error    See error definitions. SI_NOMEM if memory runs
+                            out, a_copy is then empty.
+     */
+  SI_Error Clone(CSimpleIniTempl &a_copy) const;
+
   /** Deallocate all memory stored by this object */
   void Reset();
 
   /** Has any data been loaded */
   bool IsEmpty() const { return m_data.empty(); }
 
+  /** Memory use of the strings that have been copied into this object */
+  typedef SI_Internal::StringArena::Stats StringStats;
+
+  /** Return the memory used by the strings that have been copied into this
+        object, that is the strings supplied by SetValue() and the strings
+        that were loaded into an object which already had data. Freed
+        strings are kept for reuse until Reset() is called or until there
+        are no more copied strings, uFreeBytes / uReservedBytes is the
+        fragmentation of that memory.
+     */
+  StringStats GetStringStats() const { return m_strings.GetStats(); }
+
   /*-----------------------------------------------------------------------*/
   /** @{ @name Settings */
 
@@ -590,6 +1433,92 @@ public:
   /** Do we allow keys to exist without a value or equals sign? */
   bool GetAllowKeyOnly() const { return m_bAllowKeyOnly; }
 
+  /** Should the keys of a section only be parsed when the section is first
+        used? When enabled, loading data into an empty object only finds the
+        section headers. The keys of each section are parsed by the first
+        call that needs them, e.g. GetValue(), GetSection(), GetAllKeys(),
+        SetValue() or Save(). This makes loading a large file fast when only
+        a few of its sections are used. Data that contains a '[' line
+        without a closing ']' is always parsed immediately.
+
+        The load order of a key is assigned when its section is parsed, so
+        it is only comparable with other keys in the same section. As const
+        methods may parse a section, a lazily loaded object must not be used
+        by multiple threads at the same time even for reading.
+
+        \param a_bLazyLoad  Parse the keys of a section on first use.
+     */
+  void SetLazyLoad(bool a_bLazyLoad = true) { m_bLazyLoad = a_bLazyLoad; }
+
+  /** Are the keys of a section parsed when the section is first used? */
+  bool IsLazyLoad() const { return m_bLazyLoad; }
+
+  /** Should sections and keys be found with hash tables? This adds hash
+        tables of all sections and keys to the ordered maps, so that a
+        lookup by GetValue(), SetValue(), GetSection() etc. takes constant
+        time instead of comparing the name with each level of a tree. Load
+        order and multiple keys are unchanged. Each section and key uses
+        some more memory.
+
+        Only the generic string comparisons (SI_Case, and SI_NoCase except
+        for SI_CONVERT_WIN32 with MBCS) have a matching hash function, for
+        other comparisons this setting is ignored.
+
+        \param a_bHashIndex  Use hash tables to find sections and keys.
+     */
+  void SetHashIndex(bool a_bHashIndex = true);
+
+  /** Are hash tables used to find sections and keys? */
+  bool IsHashIndex() const { return m_bHashIndex; }
+
+  /** Should GetLongValue(), GetDoubleValue(), GetBoolValue() and the other
+        typed accessors keep the converted values? A value is converted on
+        the first read, and later reads of the same type return the stored
+        result until the value is changed by SetValue(), SetLongValue() etc.
+        The key is still looked up on every read. The converted values are
+        kept in a table of their own, which is released when the cache is
+        turned off.
+
+        As const methods then modify the table, the object must not be used
+        by multiple threads at the same time even for reading.
+
+        \param a_bValueCache  Keep converted values.
+     */
+  void SetValueCache(bool a_bValueCache = true) {
+    m_bValueCache = a_bValueCache;
+    if (!m_bValueCache) {
+      m_valueCache.Clear();
+    }
+  }
+
+  /** Are converted values kept? */
+  bool IsValueCache() const { return m_bValueCache; }
+
+#ifdef SI_SUPPORT_THREADS
+  /** Should large data be parsed by multiple threads? The data is split into
+        parts at section headers and each part is parsed by its own thread.
+        The entries are then added in file order on the calling thread, so
+        the result, including the order used by Save(), is the same as a
+        sequential load. Data with less than 64K characters per thread uses
+        fewer threads. If a part turns out to end inside a multi-line value
+        then the data is parsed again sequentially.
+
+        Requires SI_SUPPORT_THREADS to be defined before including
+        SimpleIni.h.
+
+        \param a_nThreads  Maximum number of threads to use when loading.
+                            0 or 1 parses on the calling thread only.
+     */
+  void SetParallelLoad(unsigned a_nThreads) {
+    m_nLoadThreads = a_nThreads;
+    m_pfnParseParallel =
+        a_nThreads > 1 ? &CSimpleIniTempl::ParseParallel : NULL;
+  }
+
+  /** Query the number of threads used to parse data */
+  unsigned GetParallelLoad() const { return m_nLoadThreads; }
+#endif // SI_SUPPORT_THREADS
+
   /*-----------------------------------------------------------------------*/
   /** @}
         @{ @name Loading INI Data */
@@ -623,10 +1552,35 @@ public:
     */
   SI_Error LoadFile(FILE *a_fpFile);
 
-#ifdef SI_SUPPORT_IOSTREAMS
-  /** Load INI file data from an istream.
+#ifdef SI_SUPPORT_MMAP
+  /** Load an INI file from disk by mapping it into memory.
 
-        Reads text INI data from the stream until end-of-file. Streams
+        The file is mapped copy-on-write so that it can be parsed in place.
+        When the converter stores the file data unchanged (CSimpleIniA and
+        CSimpleIniCaseA) the mapping becomes the data block that all of the
+        loaded strings point into and it stays mapped until Reset() or
+        destruction. The file must not be modified or truncated while it is
+        mapped: pages that the parser did not write to are still shared
+        with the file, so a write to the file silently changes the loaded
+        strings, and truncating it makes them unreadable. Other converters
+        parse a converted copy and unmap the file before returning.
+
+        If the file size is an exact multiple of the page size there is no
+        room for the terminating NUL and the file is read with LoadFile().
+
+        Requires SI_SUPPORT_MMAP to be defined before including SimpleIni.h.
+
+        @param a_pszFile    Path of the file to be loaded.
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error LoadFileMapped(const char *a_pszFile);
+#endif // SI_SUPPORT_MMAP
+
+#ifdef SI_SUPPORT_IOSTREAMS
+  /** Load INI file data from an istream.
+
+        Reads text INI data from the stream until end-of-file. Streams
         containing a NUL (zero) byte are rejected with SI_FAIL. Streams
         larger than SI_MAX_FILE_SIZE are rejected with SI_FILE.
 
@@ -647,6 +1601,41 @@ public:
     return LoadData(a_strData.c_str(), a_strData.size());
   }
 
+  /** Load INI file data from a std::string, taking ownership of it.
+
+        When the converter stores the data unchanged (CSimpleIniA and
+        CSimpleIniCaseA) the string buffer is parsed in place and becomes
+        the data block that the loaded strings point into, so no copy of the
+        data is made. Other converters load a converted copy. In either case
+        a_strData is left in a valid but unspecified state.
+
+        @param a_strData    Data to be loaded
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error LoadData(std::string &&a_strData);
+
+  /** Load INI file data from a buffer, taking ownership of it.
+
+        When the converter stores the data unchanged (CSimpleIniA and
+        CSimpleIniCaseA) the buffer is parsed in place and kept until Reset()
+        or destruction. Other converters load a converted copy and free the
+        buffer before returning. The buffer is always released, even on
+        error.
+
+        The byte after the data is overwritten with a NUL terminator, so the
+        buffer must be larger than the data.
+
+        @param a_pData      Buffer holding the data
+        @param a_uDataLen   Length of the data in bytes
+        @param a_uBufferSize  Size of the buffer in bytes
+
+        @return SI_Error    See error definitions. SI_FAIL if a_uBufferSize
+                            is not larger than a_uDataLen.
+     */
+  SI_Error LoadData(std::unique_ptr<char[]> a_pData, size_t a_uDataLen,
+                    size_t a_uBufferSize);
+
   /** Load INI file data direct from memory
 
         @param a_pData      Data to be loaded
@@ -656,6 +1645,80 @@ public:
      */
   SI_Error LoadData(const char *a_pData, size_t a_uDataLen);
 
+  /** Start an incremental load of INI file data. The data is supplied in
+        chunks of any size with Feed() and the load is completed with
+        EndLoad(). The result is the same as calling LoadData() with all of
+        the chunks joined together.
+
+        Entries are added as soon as they are complete, so entries, comments
+        and multi-line values may be split across chunks at any byte. Only
+        the text of incomplete entries is held between calls and all loaded
+        strings are copied, so memory use follows the stored data rather
+        than the size of the input.
+
+        The data must not be modified until EndLoad() or CancelLoad() is
+        called. If a Feed() or EndLoad() fails then the load is cancelled.
+
+        @return SI_Error    SI_FAIL if an incremental load is already active
+     */
+  SI_Error BeginLoad();
+
+  /** Supply the next chunk of data to an incremental load started with
+        BeginLoad(). Data containing a NUL (zero) byte is rejected with
+        SI_FAIL. Data larger than SI_MAX_FILE_SIZE in total is rejected with
+        SI_FILE.
+
+        @param a_pData      Data to be loaded
+        @param a_uDataLen   Length of the data in bytes
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error Feed(const char *a_pData, size_t a_uDataLen);
+
+  /** Finish an incremental load started with BeginLoad(), adding any
+        remaining entries including a final line without a newline.
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error EndLoad();
+
+  /** Abandon an incremental load started with BeginLoad(). Sections and
+        keys added by the load are removed. If the load started with no data
+        then all data is reset. Values of keys that already existed and were
+        replaced by the load are not restored.
+     */
+  void CancelLoad();
+
+  /** Is an incremental load in progress? */
+  bool IsLoading() const { return m_pStream != NULL; }
+
+  /** Parse INI file data without loading it. Every entry is passed to the
+        visitor in file order and nothing is stored in this object, so
+        sections and keys may be repeated. The data is parsed with the
+        current settings for UTF-8, multi-line values, quotes and keys
+        without values. The only allocation is a single working copy of the
+        data.
+
+        @param a_pData      Data to be parsed
+        @param a_uDataLen   Length of the data in bytes
+        @param a_visitor    Object that receives the entries
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error Parse(const char *a_pData, size_t a_uDataLen,
+                 Visitor &a_visitor) const;
+
+  /** Parse INI file data from a std::string without loading it
+
+        @param a_strData    Data to be parsed
+        @param a_visitor    Object that receives the entries
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error Parse(const std::string &a_strData, Visitor &a_visitor) const {
+    return Parse(a_strData.c_str(), a_strData.size(), a_visitor);
+  }
+
   /*-----------------------------------------------------------------------*/
   /** @}
         @{ @name Saving INI Data */
@@ -725,6 +1788,10 @@ public:
         To add a BOM to UTF-8 data, write it out manually at the very beginning
         like is done in SaveFile when a_bUseBOM is true.
 
+        The output is collected in blocks of SI_SAVE_BUFFER_SIZE chars and
+        passed to OutputWriter::Write(const char *, size_t), all of it has
+        been written when Save() returns.
+
         @param a_oOutput    Output writer to write the data to.
 
         @param a_bAddSignature  Prepend the UTF-8 BOM if the output data is in
@@ -754,7 +1821,8 @@ public:
   }
 #endif // SI_SUPPORT_IOSTREAMS
 
-  /** Append the INI data to a string. See Save() for details.
+  /** Append the INI data to a string. See Save() for details. The string
+        is reserved once, from the size of the data that is held.
 
         @param a_sBuffer    String to have the INI data appended to.
 
@@ -765,10 +1833,35 @@ public:
 
         @return SI_Error    See error definitions
      */
-  SI_Error Save(std::string &a_sBuffer, bool a_bAddSignature = false) const {
-    StringWriter writer(a_sBuffer);
-    return Save(writer, a_bAddSignature);
-  }
+  SI_Error Save(std::string &a_sBuffer, bool a_bAddSignature = false) const;
+
+  /** Save the INI data to a buffer supplied by the caller. See Save() for
+        details. The data is not NULL terminated. When the data is stored as
+        char no memory is allocated, except to parse lazily loaded sections.
+        Other types allocate one buffer to convert the strings.
+
+        To find the size of buffer that is needed, call this with a_pBuffer
+        NULL and a_uSize 0 first.
+
+        @param a_pBuffer    Buffer to write the data to. May be NULL if
+                            a_uSize is 0.
+
+        @param a_uSize      Size of a_pBuffer in chars.
+
+        @param a_uLength    Set to the length of the INI data in chars, even
+                            when it is larger than a_uSize.
+
+        @param a_bAddSignature  Prepend the UTF-8 BOM if the output data is in
+                            UTF-8 format. If it is not UTF-8 then this value is
+                            ignored.
+
+        @return SI_Error    See error definitions
+        @return SI_FAIL     The data doesn't fit in a_pBuffer, which holds the
+                            first a_uSize chars of it, or it could not be
+                            converted.
+     */
+  SI_Error Save(char *a_pBuffer, size_t a_uSize, size_t &a_uLength,
+                bool a_bAddSignature = false) const;
 
   /*-----------------------------------------------------------------------*/
   /** @}
@@ -792,8 +1885,8 @@ public:
 
   /** Retrieve all unique key names in a section. The sort order of the
         returned strings is NOT DEFINED. You can sort the names into the load 
-        order if desired. Search this file for ".sort" for an example. Only 
-        unique key names are returned.
+        order if desired with Entry::LoadOrder, or use ForEachInLoadOrder().
+        Only unique key names are returned.
 
         NOTE! This structure contains only pointers to strings. The actual
         string data is stored in memory owned by CSimpleIni. Ensure that the
@@ -812,7 +1905,7 @@ public:
   /** Retrieve all values for a specific key. This method can be used when
         multiple keys are both enabled and disabled. Note that the sort order 
         of the returned strings is NOT DEFINED. You can sort the names into 
-        the load order if desired. Search this file for ".sort" for an example.
+        the load order if desired with Entry::LoadOrder.
 
         NOTE! The returned values are pointers to string data stored in memory
         owned by CSimpleIni. Ensure that the CSimpleIni object is not destroyed
@@ -828,6 +1921,31 @@ public:
   bool GetAllValues(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
                     TNamesDepend &a_values) const;
 
+  /** Call a visitor for every value in the order that Save() writes them:
+        the section with an empty name first, then the other sections in
+        load order, each with its keys in load order and all values of a
+        key together (only the first value of a key if multiple keys are
+        not allowed). The entries are kept in load order as they are added,
+        so this takes time linear in the size of the data and allocates
+        nothing. Lazily loaded sections are parsed first.
+
+        The visitor is called as
+
+            bool a_visitor(const Entry &a_section, const Entry *a_pKey,
+                           const SI_CHAR *a_pValue)
+
+        a_pKey is the stored entry of the value, with its comment. For a
+        section without keys it is called once with a_pKey and a_pValue
+        NULL. If it returns false then no more values are visited. Entries
+        must not be added or deleted during the walk.
+
+        @param a_visitor        Function or function object to call
+
+        @return true            Every value was visited.
+        @return false           The visitor stopped the walk.
+     */
+  template <class TVisitor> bool ForEachInLoadOrder(TVisitor a_visitor) const;
+
   /** Query the number of keys in a specific section. Note that if multiple
         keys are enabled, then this value may be different to the number of
         keys returned by GetAllKeys.
@@ -856,7 +1974,9 @@ public:
 
   /** Test if a section exists. Convenience function */
   inline bool SectionExists(const SI_CHAR *a_pSection) const {
-    return GetSection(a_pSection) != NULL;
+    return a_pSection &&
+           const_cast<CSimpleIniTempl *>(this)->LookupSection(a_pSection) !=
+               m_data.end();
   }
 
   /** Test if the key exists in a section. Convenience function. */
@@ -886,6 +2006,38 @@ public:
                           const SI_CHAR *a_pDefault = NULL,
                           bool *a_pHasMultiple = NULL) const;
 
+  /** Retrieve the values of many keys of one section. The section is found
+        once, and the keys are then matched in order with a single walk
+        over the keys of the section. When only a few keys are requested
+        from a large section, or the hash index is enabled, each key is
+        looked up instead. The first value of each key is returned, as with
+        GetValue().
+
+        NOTE! The returned values are pointers to string data stored in
+        memory owned by CSimpleIni, see GetValue().
+
+        @param a_pSection       Section to search
+        @param a_pKeys          Array of a_uKeys keys to search for. NULL
+                                entries are ignored.
+        @param a_uKeys          Number of keys
+        @param a_pValues        Array of a_uKeys values that receives the
+                                value of each key, or NULL if the key was
+                                not found.
+        @param a_pMissing       Optionally receive the keys that were not
+                                found, in the order given. The nOrder of
+                                each entry is its index in a_pKeys.
+        @param a_bSorted        Are the keys already sorted by the
+                                SI_STRLESS comparison? Otherwise they are
+                                sorted first. Keys that are out of order
+                                may be reported as missing.
+
+        @return Number of keys that were found
+     */
+  size_t GetValues(const SI_CHAR *a_pSection, const SI_CHAR *const *a_pKeys,
+                   size_t a_uKeys, const SI_CHAR **a_pValues,
+                   TNamesDepend *a_pMissing = NULL,
+                   bool a_bSorted = false) const;
+
   /** Retrieve a numeric value for a specific key. If multiple keys are enabled
         (see SetMultiKey) then only the first value associated with that key
         will be returned, see GetAllValues for getting all values with multikey.
@@ -940,6 +2092,50 @@ public:
   bool GetBoolValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
                     bool a_bDefault = false, bool *a_pHasMultiple = NULL) const;
 
+  /** Retrieve a 64-bit integer value for a specific key, see GetLongValue().
+        Values prefixed with "0x" or "-0x" are hexadecimal. The conversion
+        doesn't depend on the locale when <charconv> is available. Values
+        that are out of range are invalid.
+
+        @param a_pSection       Section to search
+        @param a_pKey           Key to search for
+        @param a_nDefault       Value to return if the key is not found or
+                                the value is invalid
+        @param a_pHasMultiple   Optionally receive notification of if there are
+                                multiple entries for this key.
+
+        @return a_nDefault      Key was not found in the section
+        @return other           Value of the key
+     */
+  int64_t GetInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                        int64_t a_nDefault = 0,
+                        bool *a_pHasMultiple = NULL) const;
+
+  /** Retrieve an unsigned 64-bit integer value for a specific key, see
+        GetInt64Value(). Negative values are invalid.
+     */
+  uint64_t GetUInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                          uint64_t a_nDefault = 0,
+                          bool *a_pHasMultiple = NULL) const;
+
+  /** Retrieve a floating point value for a specific key, see
+        GetDoubleValue(). The decimal point is always '.' when <charconv>
+        supports floating point values, otherwise strtod() is used.
+
+        @param a_pSection       Section to search
+        @param a_pKey           Key to search for
+        @param a_nDefault       Value to return if the key is not found or
+                                the value is invalid
+        @param a_pHasMultiple   Optionally receive notification of if there are
+                                multiple entries for this key.
+
+        @return a_nDefault      Key was not found in the section
+        @return other           Value of the key
+     */
+  double GetFloatValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                       double a_nDefault = 0,
+                       bool *a_pHasMultiple = NULL) const;
+
   /** Add or update a section or value. This will always insert
         when multiple keys are enabled.
 
@@ -1051,6 +2247,68 @@ public:
                         bool a_bValue, const SI_CHAR *a_pComment = NULL,
                         bool a_bForceReplace = false);
 
+  /** Add or update a 64-bit integer value, see SetLongValue(). Negative
+        values are written in hexadecimal as "-0x" followed by the digits.
+
+        @return SI_Error    See error definitions
+        @return SI_UPDATED  Value was updated
+        @return SI_INSERTED Value was inserted
+     */
+  SI_Error SetInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                         int64_t a_nValue, const SI_CHAR *a_pComment = NULL,
+                         bool a_bUseHex = false, bool a_bForceReplace = false);
+
+  /** Add or update an unsigned 64-bit integer value, see SetLongValue().
+
+        @return SI_Error    See error definitions
+        @return SI_UPDATED  Value was updated
+        @return SI_INSERTED Value was inserted
+     */
+  SI_Error SetUInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                          uint64_t a_nValue, const SI_CHAR *a_pComment = NULL,
+                          bool a_bUseHex = false,
+                          bool a_bForceReplace = false);
+
+  /** Add or update a floating point value, see SetDoubleValue(). The value
+        is written with the fewest digits that read back as the same double
+        with GetFloatValue(), e.g. "0.1" or "1e+300", where SetDoubleValue()
+        writes "0.100000".
+
+        @return SI_Error    See error definitions
+        @return SI_UPDATED  Value was updated
+        @return SI_INSERTED Value was inserted
+     */
+  SI_Error SetFloatValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                         double a_nValue, const SI_CHAR *a_pComment = NULL,
+                         bool a_bForceReplace = false);
+
+  /** Add or update many keys of one section. This is the same as calling
+        SetValue() for each key in turn, but the section is found once, the
+        memory for the copied strings is reserved up front, and new keys are
+        inserted next to the previous one, which takes constant time when
+        the keys are given in sorted order.
+
+        @param a_pSection   Section to add or update
+        @param a_pKeys      Array of a_uCount keys to add or update
+        @param a_pValues    Array of a_uCount values for the keys. A NULL
+                            value is set as an empty string.
+        @param a_uCount     Number of keys
+        @param a_bNewKeys   Set this when none of the keys exist in the
+                            section yet and each key is given only once.
+                            The keys are then inserted without checking for
+                            an existing entry. If this is not true then the
+                            data will be corrupted.
+
+        @return SI_Error    See error definitions. The keys before the one
+                            that failed stay set, and so does the section
+                            if it was added.
+        @return SI_UPDATED  All of the keys already existed
+        @return SI_INSERTED At least one key was inserted
+     */
+  SI_Error SetValues(const SI_CHAR *a_pSection, const SI_CHAR *const *a_pKeys,
+                     const SI_CHAR *const *a_pValues, size_t a_uCount,
+                     bool a_bNewKeys = false);
+
   /** Delete an entire section, or a key from a section. Note that the
         data returned by GetSection is invalid and must not be used after
         anything has been deleted from that section using this method.
@@ -1095,6 +2353,310 @@ public:
   bool DeleteValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
                    const SI_CHAR *a_pValue, bool a_bRemoveEmpty = false);
 
+  /*-----------------------------------------------------------------------*/
+  /** @}
+        @{ @name Comparing INI Data */
+
+  /** A difference between this object and another, found by Diff() */
+  struct DiffEntry {
+    enum Type {
+      ADDED,   //!< the section or value is only in the other object
+      REMOVED, //!< the section or value is only in this object
+      CHANGED  //!< the value is different in the other object
+    };
+    Type nType;
+    const SI_CHAR *pSection; //!< Section name
+    const SI_CHAR *pKey;     //!< Key name, NULL for a whole section
+    const SI_CHAR *pValue;   //!< Value in this object, NULL if added
+    const SI_CHAR *pOther;   //!< Value in the other object, NULL if removed
+  };
+
+  /** Differences in the order that Diff() found them */
+  typedef std::vector<DiffEntry> TDiff;
+
+  /** Find the sections, keys and values that differ between this object
+        and a_other. Both are walked once in their sorted order, so this
+        takes time linear in their size, and nothing is allocated except
+        the entries of a_diff.
+
+        A section that is only in one object is reported once with a NULL
+        key. For a section in both, each value of a key is compared with
+        the value at the same position in the other object: a value
+        without a counterpart is ADDED or REMOVED, and a different value
+        is CHANGED. Comments are not compared. Values are compared exactly,
+        names with SI_STRLESS. The names and values point into the object
+        that holds them, into this object if it is in both.
+
+        Lazily loaded sections of both objects are parsed first.
+
+        @param a_other      Object to compare with
+        @param a_diff       Receives the differences, it is cleared first
+
+        @return Number of differences
+     */
+  size_t Diff(const CSimpleIniTempl &a_other, TDiff &a_diff) const;
+
+  /*-----------------------------------------------------------------------*/
+  /** @}
+        @{ @name Resolved Keys
+
+        A key that is read often can be resolved once into a handle. The
+        handle refers to the entry of the key, and the functions that add,
+        delete, reset or load keys update the handles of the keys they
+        change. Reading through a handle doesn't look up the section or key,
+        and always reads the current value.
+
+        Reading through a handle doesn't change this object, so any number
+        of threads may read through handles as long as no thread changes the
+        data. The exception is a section that is not yet parsed because of
+        SetLazyLoad(), which is parsed by the first read.
+     */
+
+  /** A key resolved by ResolveKey() */
+  struct KeySlot {
+    std::basic_string<SI_CHAR> section;
+    std::basic_string<SI_CHAR> key;
+    /** The first entry of the key, NULL if the key doesn't exist */
+    const typename TKeyVal::value_type *pNode;
+  };
+
+  /** Handle of a resolved key. It stays valid until this object is
+        destroyed, whether or not the key exists.
+     */
+  typedef const KeySlot *TKeyHandle;
+
+  /** Resolve a key into a handle. The key doesn't need to exist yet.
+        Resolving the same key again returns the same handle.
+
+        @param a_pSection       Section of the key
+        @param a_pKey           Key to resolve
+
+        @return NULL            A parameter is NULL
+        @return other           Handle of the key
+     */
+  TKeyHandle ResolveKey(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey);
+
+  /** Retrieve the value of a resolved key, see GetValue().
+
+        @param a_hKey           Handle from ResolveKey(), may be NULL
+        @param a_pDefault       Value to return if the key is not found
+     */
+  const SI_CHAR *GetValue(TKeyHandle a_hKey,
+                          const SI_CHAR *a_pDefault = NULL) const {
+    if (!a_hKey) {
+      return a_pDefault;
+    }
+    if (a_hKey->pNode) {
+      return a_hKey->pNode->second;
+    }
+    if (m_lazySections.empty()) {
+      return a_pDefault;
+    }
+    // the key may be in a section that is not parsed yet
+    return GetValue(a_hKey->section.c_str(), a_hKey->key.c_str(), a_pDefault);
+  }
+
+  /** Test if a resolved key exists */
+  bool KeyExists(TKeyHandle a_hKey) const { return GetValue(a_hKey) != NULL; }
+
+#ifdef SI_HAS_STRING_VIEW
+  /*-----------------------------------------------------------------------*/
+  /** @}
+        @{ @name Accessing INI Data with String Views
+
+        These are the same as the functions above, with the names given as
+        string views that don't need to be NUL terminated. When the string
+        comparison is SI_GenericCase or SI_GenericNoCase (see SI_StrCompareN)
+        a name is found without copying it, with other comparisons the name
+        is first copied to a NUL terminated string. The functions that
+        change the data make copies of the strings as the functions above
+        do. Requires C++17.
+     */
+
+  bool SectionExists(TStringView a_section) const {
+    return const_cast<CSimpleIniTempl *>(this)->LookupSection(a_section) !=
+           m_data.end();
+  }
+
+  bool KeyExists(TStringView a_section, TStringView a_key) const {
+    return GetValue(a_section, a_key) != NULL;
+  }
+
+  const SI_CHAR *GetValue(TStringView a_section, TStringView a_key,
+                          const SI_CHAR *a_pDefault = NULL,
+                          bool *a_pHasMultiple = NULL) const;
+
+  /** Retrieve the value for a specific key as a string view, see
+        GetValue(). The view refers to string data owned by CSimpleIni.
+
+        @return a_default       Key was not found in the section
+        @return other           Value of the key
+     */
+  TStringView GetValueView(TStringView a_section, TStringView a_key,
+                           TStringView a_default = TStringView(),
+                           bool *a_pHasMultiple = NULL) const {
+    const SI_CHAR *pValue = GetValue(a_section, a_key, NULL, a_pHasMultiple);
+    return pValue ? TStringView(pValue) : a_default;
+  }
+
+  long GetLongValue(TStringView a_section, TStringView a_key,
+                    long a_nDefault = 0, bool *a_pHasMultiple = NULL) const {
+    long nValue = a_nDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::LONG, &ParseLong, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  double GetDoubleValue(TStringView a_section, TStringView a_key,
+                        double a_nDefault = 0,
+                        bool *a_pHasMultiple = NULL) const {
+    double nValue = a_nDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::DOUBLE, &ParseDouble, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  bool GetBoolValue(TStringView a_section, TStringView a_key,
+                    bool a_bDefault = false,
+                    bool *a_pHasMultiple = NULL) const {
+    bool bValue = a_bDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::BOOL, &ParseBoolValue, bValue)
+               ? bValue
+               : a_bDefault;
+  }
+
+  int64_t GetInt64Value(TStringView a_section, TStringView a_key,
+                        int64_t a_nDefault = 0,
+                        bool *a_pHasMultiple = NULL) const {
+    int64_t nValue = a_nDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::INT64, &ParseInt64, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  uint64_t GetUInt64Value(TStringView a_section, TStringView a_key,
+                          uint64_t a_nDefault = 0,
+                          bool *a_pHasMultiple = NULL) const {
+    uint64_t nValue = a_nDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::UINT64, &ParseUInt64, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  double GetFloatValue(TStringView a_section, TStringView a_key,
+                       double a_nDefault = 0,
+                       bool *a_pHasMultiple = NULL) const {
+    double nValue = a_nDefault;
+    return ConvertValue(FindFirstValue(a_section, a_key, a_pHasMultiple),
+                        ValueCache::FLOAT, &ParseFloat, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  bool GetAllValues(TStringView a_section, TStringView a_key,
+                    TNamesDepend &a_values) const;
+
+  int GetSectionSize(TStringView a_section) const {
+    typename TSection::const_iterator iSection = FindSection(a_section);
+    return iSection == m_data.end() ? -1 : CountKeys(iSection->second);
+  }
+
+  const TKeyVal *GetSection(TStringView a_section) const {
+    typename TSection::const_iterator iSection = FindSection(a_section);
+    return iSection == m_data.end() ? NULL : &iSection->second;
+  }
+
+  bool GetAllKeys(TStringView a_section, TNamesDepend &a_names) const {
+    a_names.clear();
+    typename TSection::const_iterator iSection = FindSection(a_section);
+    if (iSection == m_data.end()) {
+      return false;
+    }
+    CollectKeys(iSection->second, a_names);
+    return true;
+  }
+
+  SI_Error SetValue(TStringView a_section, TStringView a_key,
+                    TStringView a_value, const SI_CHAR *a_pComment = NULL,
+                    bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key), value(a_value);
+    return AddEntry(section.c_str(), key.c_str(), value.c_str(), a_pComment,
+                    a_bForceReplace, true);
+  }
+
+  SI_Error SetLongValue(TStringView a_section, TStringView a_key,
+                        long a_nValue, const SI_CHAR *a_pComment = NULL,
+                        bool a_bUseHex = false, bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetLongValue(section.c_str(), key.c_str(), a_nValue, a_pComment,
+                        a_bUseHex, a_bForceReplace);
+  }
+
+  SI_Error SetDoubleValue(TStringView a_section, TStringView a_key,
+                          double a_nValue, const SI_CHAR *a_pComment = NULL,
+                          bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetDoubleValue(section.c_str(), key.c_str(), a_nValue, a_pComment,
+                          a_bForceReplace);
+  }
+
+  SI_Error SetBoolValue(TStringView a_section, TStringView a_key,
+                        bool a_bValue, const SI_CHAR *a_pComment = NULL,
+                        bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetBoolValue(section.c_str(), key.c_str(), a_bValue, a_pComment,
+                        a_bForceReplace);
+  }
+
+  SI_Error SetInt64Value(TStringView a_section, TStringView a_key,
+                         int64_t a_nValue, const SI_CHAR *a_pComment = NULL,
+                         bool a_bUseHex = false, bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetInt64Value(section.c_str(), key.c_str(), a_nValue, a_pComment,
+                         a_bUseHex, a_bForceReplace);
+  }
+
+  SI_Error SetUInt64Value(TStringView a_section, TStringView a_key,
+                          uint64_t a_nValue, const SI_CHAR *a_pComment = NULL,
+                          bool a_bUseHex = false,
+                          bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetUInt64Value(section.c_str(), key.c_str(), a_nValue, a_pComment,
+                          a_bUseHex, a_bForceReplace);
+  }
+
+  SI_Error SetFloatValue(TStringView a_section, TStringView a_key,
+                         double a_nValue, const SI_CHAR *a_pComment = NULL,
+                         bool a_bForceReplace = false) {
+    const ViewString section(a_section), key(a_key);
+    return SetFloatValue(section.c_str(), key.c_str(), a_nValue, a_pComment,
+                         a_bForceReplace);
+  }
+
+  bool Delete(TStringView a_section, TStringView a_key,
+              bool a_bRemoveEmpty = false) {
+    const ViewString section(a_section), key(a_key);
+    return DeleteValue(section.c_str(), key.c_str(), NULL, a_bRemoveEmpty);
+  }
+
+  bool DeleteValue(TStringView a_section, TStringView a_key,
+                   TStringView a_value, bool a_bRemoveEmpty = false) {
+    const ViewString section(a_section), key(a_key), value(a_value);
+    return DeleteValue(section.c_str(), key.c_str(), value.c_str(),
+                       a_bRemoveEmpty);
+  }
+
+  TKeyHandle ResolveKey(TStringView a_section, TStringView a_key) {
+    const ViewString section(a_section), key(a_key);
+    return ResolveKey(section.c_str(), key.c_str());
+  }
+#endif // SI_HAS_STRING_VIEW
+
   /*-----------------------------------------------------------------------*/
   /** @}
         @{ @name Converter */
@@ -1114,17 +2676,71 @@ private:
   CSimpleIniTempl(const CSimpleIniTempl &);            // disabled
   CSimpleIniTempl &operator=(const CSimpleIniTempl &); // disabled
 
+  // a frozen copy reads the data and the value conversions directly
+  friend class CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>;
+#ifdef SI_SUPPORT_THREADS
+  // a shared object prepares the data for reading by many threads
+  friend class CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>;
+#endif // SI_SUPPORT_THREADS
+
+  /** Describes how to release a data block that was not allocated with
+        new[]. When pfnRelease is NULL the block is deleted with delete[].
+     */
+  struct DataOwner {
+    void *pOwner;
+    size_t uSize;
+    void (*pfnRelease)(void *a_pOwner, size_t a_uSize);
+  };
+
   /** Parse the data looking for a file comment and store it if found.
     */
-  SI_Error FindFileComment(SI_CHAR *&a_pData, bool a_bCopyStrings);
+  SI_Error FindFileComment(SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd,
+                           bool a_bCopyStrings);
 
   /** Parse the data looking for the next valid entry. The memory pointed to
         by a_pData is modified by inserting NULL characters. The pointer is
-        updated to the current location in the block of text.
+        updated to the current location in the block of text. a_pDataEnd is
+        the terminating NULL of the block of text.
     */
-  bool FindEntry(SI_CHAR *&a_pData, const SI_CHAR *&a_pSection,
-                 const SI_CHAR *&a_pKey, const SI_CHAR *&a_pVal,
-                 const SI_CHAR *&a_pComment) const;
+  bool FindEntry(SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd,
+                 const SI_CHAR *&a_pSection, const SI_CHAR *&a_pKey,
+                 const SI_CHAR *&a_pVal, const SI_CHAR *&a_pComment,
+                 bool *a_pbTruncated = NULL) const;
+
+  /** An entry found by FindEntry(). A NULL section is the current section. */
+  struct ParsedEntry {
+    const SI_CHAR *pSection;
+    const SI_CHAR *pKey;
+    const SI_CHAR *pVal;
+    const SI_CHAR *pComment;
+  };
+  typedef std::vector<ParsedEntry> TParsedEntries;
+
+#ifdef SI_SUPPORT_THREADS
+  /** Part of the data parsed by one thread of ParseParallel() */
+  struct Shard {
+    SI_CHAR *pStart;
+    SI_CHAR *pEnd;
+    TParsedEntries entries;
+    const SI_CHAR *pComment;
+    bool bTruncated;
+  };
+
+  /** Parse the entries of a_pData using multiple threads. Returns false
+        without changing the data if it should be parsed sequentially.
+     */
+  bool ParseParallel(SI_CHAR *a_pData, const SI_CHAR *a_pDataEnd,
+                     TParsedEntries &a_entries) const;
+
+  /** Find the start of the first section header after a_pData, including
+        the comments and blank lines before it. Returns NULL if there is no
+        header before a_pLimit or if it would start at a_pPrev.
+     */
+  SI_CHAR *FindShardStart(SI_CHAR *a_pPrev, SI_CHAR *a_pData,
+                          const SI_CHAR *a_pLimit) const;
+
+  void ParseShard(Shard &a_shard) const;
+#endif // SI_SUPPORT_THREADS
 
   /** Add the section/key/value to our data.
 
@@ -1152,8 +2768,29 @@ private:
                     const SI_CHAR *a_pValue, const SI_CHAR *a_pComment,
                     bool a_bForceReplace, bool a_bCopyStrings);
 
+  /** Insert a new entry of a key, used by AddEntry() and SetValues(). The
+        entry is linked after a_pAfter in the load order of the section, see
+        LinkKey(), and is added to the key count, the hash index and the key
+        slots. The strings of the entry must already be copied.
+
+        @param a_iSection   Section to insert into
+        @param a_iHint      Position hint for the key map
+        @param a_oKey       Measured entry of the key, with its comment
+        @param a_pValue     Value of the key, not NULL
+        @param a_pAfter     Key to follow in the load order, or NULL
+     */
+  typename TKeyVal::iterator InsertKey(typename TSection::iterator a_iSection,
+                                       typename TKeyVal::iterator a_iHint,
+                                       const Entry &a_oKey,
+                                       const SI_CHAR *a_pValue,
+                                       const void *a_pAfter);
+
+  /** Replace the value of an existing key entry. The previous value is
+        deleted, the new one must already be copied. */
+  void ReplaceValue(typename TKeyVal::iterator a_iKey, const SI_CHAR *a_pValue);
+
   /** Is the supplied character a whitespace character? */
-  inline bool IsSpace(SI_CHAR ch) const {
+  static bool IsSpace(SI_CHAR ch) {
     return (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n');
   }
 
@@ -1165,34 +2802,545 @@ private:
     a_pData += (*a_pData == '\r' && *(a_pData + 1) == '\n') ? 2 : 1;
   }
 
-  /** Make a copy of the supplied string, replacing the original pointer */
-  SI_Error CopyString(const SI_CHAR *&a_pString);
-
-  /** Undo m_data changes from a failed incremental LoadData. */
-  void UndoIncrementalLoadData(const TNamesDepend &a_oAddedSections,
-                               const TNamesDepend &a_oAddedKeys);
+  /** State of an incremental load between BeginLoad() and EndLoad() */
+  struct StreamState {
+    /** incomplete last line of the input in storage format */
+    std::string raw;
+    /** converted complete lines that have not been added yet */
+    std::vector<SI_CHAR> pending;
+    /** copy of pending that is modified by the parser */
+    std::vector<SI_CHAR> work;
+    /** section of the last added entry, stored in m_data */
+    const SI_CHAR *pSection;
+    /** total bytes of input */
+    size_t uTotal;
+    /** size of pending after the last parse */
+    size_t uParsedSize;
+    bool bSignatureChecked;
+    bool bFileCommentDone;
+    bool bStartedEmpty;
+    const SI_CHAR *pFileCommentBefore;
+    TNamesDepend oAddedSections;
+    TNamesDepend oAddedKeys;
+  };
 
-  /** Delete a string from the copied strings buffer if necessary */
-  void DeleteString(const SI_CHAR *a_pString);
+  /** Convert complete lines of streamed input and append them to the
+        pending text. */
+  SI_Error AppendStreamData(const char *a_pData, size_t a_uDataLen);
 
-  /** Internal use of our string comparison function */
-  bool IsLess(const SI_CHAR *a_pLeft, const SI_CHAR *a_pRight) const {
-    const static SI_STRLESS isLess = SI_STRLESS();
-    return isLess(a_pLeft, a_pRight);
+  /** Parse the pending text of an incremental load and add all entries
+        that are known to be complete. If a_bFinal is set then the pending
+        text is the end of the data and all entries are added.
+     */
+  SI_Error ParseStream(bool a_bFinal);
+
+  /** Add one entry found by an incremental load */
+  SI_Error AddStreamEntry(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                          const SI_CHAR *a_pVal, const SI_CHAR *a_pComment);
+
+  /** Part of the data that holds the keys of a lazily loaded section */
+  struct LazyRange {
+    SI_CHAR *pStart;
+    SI_CHAR *pEnd;
+    /** next range of the same section, 0 if none */
+    size_t uNext;
+  };
+  /** Stored section name -> index of its first range */
+  typedef std::map<const SI_CHAR *, size_t> TLazySections;
+
+  /** Add the sections of the data that follows the file comment and
+        record where their keys are for LoadLazySection(). Returns false
+        without modifying the data if it can't be indexed exactly. */
+  bool IndexSections(SI_CHAR *a_pData, SI_CHAR *a_pDataEnd);
+
+  /** Find the end of a multi-line value as LoadMultiLineText() would,
+        without modifying the data. a_pData is the end of the line that
+        contains the value a_pVal, which starts with "<<<". Returns NULL if
+        the tag is on the first line, which can't be indexed. */
+  SI_CHAR *SkipMultiLineValue(SI_CHAR *a_pVal, SI_CHAR *a_pData,
+                              const SI_CHAR *a_pDataEnd);
+
+  /** Parse the keys of a section if it was lazily loaded */
+  void LoadLazySection(typename TSection::iterator a_iSection);
+
+  /** Parse the keys of every section that was lazily loaded */
+  void LoadLazySections() const;
+
+  /** Map nodes, as linked by the load order lists */
+  typedef typename TSection::value_type TSectionNode;
+  typedef typename TKeyVal::value_type TKeyNode;
+
+  /** Insert a node into a circular load order list after a_pAfter, or
+        first if a_pAfter is NULL. a_pLast is the last node of the list. */
+  template <class TNode>
+  static void LinkLoaded(const void *&a_pLast, const void *a_pAfter,
+                         const TNode *a_pNode);
+
+  /** Remove a node from a circular load order list */
+  template <class TNode>
+  static void UnlinkLoaded(const void *&a_pLast, const TNode *a_pNode);
+
+  /** Add a new section to the end of the load order */
+  void LinkSection(typename TSection::iterator a_iSection) {
+    const TSectionNode *pNode = &*a_iSection;
+    LinkLoaded(m_pLastSection, m_pLastSection, pNode);
+  }
+
+  /** Add a new key to the load order of its section after a_pAfter, or
+        first if a_pAfter is NULL, and link it with the other values of the
+        same key. */
+  static void LinkKey(const TSectionNode &a_section,
+                      typename TKeyVal::iterator a_iKey,
+                      const void *a_pAfter);
+
+  /** Remove a key that is about to be erased from the lists */
+  static void UnlinkKey(const TSectionNode &a_section,
+                        typename TKeyVal::iterator a_iKey);
+
+  /** Link the entries of maps that were copied, by sorting them */
+  void RebuildLoadOrder();
+
+  /** Bytes of a string in the saved data. A wide character takes the
+        bytes it encodes to in UTF-8. Each line of a_bLines text ends with
+        SI_NEWLINE_A in place of its '\n'. The settings are not used, so
+        that an entry has the same size when it is added and removed. */
+  static size_t TextBytes(const SI_CHAR *a_pText, size_t a_uLen,
+                          bool a_bLines);
+
+  /** Bytes that an entry adds to the saved data, see m_uSaveBytes. A
+        value that starts or ends with whitespace is counted in quotes. */
+  static size_t SectionBytes(const Entry &a_section);
+  static size_t KeyBytes(const Entry &a_key, const SI_CHAR *a_pValue);
+
+  /** Add a key to m_uSaveBytes and m_uPaddedValues, or remove it */
+  void CountKey(const Entry &a_key, const SI_CHAR *a_pValue) {
+    m_uSaveBytes += KeyBytes(a_key, a_pValue);
+    if (IsSingleLineQuotedValue(a_pValue)) {
+      ++m_uPaddedValues;
+    }
+  }
+  void UncountKey(const Entry &a_key, const SI_CHAR *a_pValue) {
+    m_uSaveBytes -= KeyBytes(a_key, a_pValue);
+    if (IsSingleLineQuotedValue(a_pValue)) {
+      --m_uPaddedValues;
+    }
   }
 
-  bool IsMultiLineTag(const SI_CHAR *a_pData) const;
-  bool IsMultiLineData(const SI_CHAR *a_pData) const;
-  bool IsSingleLineQuotedValue(const SI_CHAR *a_pData) const;
-  bool LoadMultiLineText(SI_CHAR *&a_pData, const SI_CHAR *&a_pVal,
-                         const SI_CHAR *a_pTagName,
-                         bool a_bAllowBlankLinesInComment = false) const;
-  bool IsNewLineChar(SI_CHAR a_c) const;
-
-  bool OutputMultiLineText(OutputWriter &a_oOutput, Converter &a_oConverter,
-                           const SI_CHAR *a_pText) const;
+  /** The section that Save() writes after a_pSection, or first if
+        a_pSection is NULL. a_pEmpty is the section with an empty name,
+        which is written first. */
+  const TSectionNode *NextSectionToSave(const TSectionNode *a_pSection,
+                                        const TSectionNode *a_pEmpty) const {
+    if (!m_pLastSection) {
+      return NULL;
+    }
+    const TSectionNode *pLast =
+        static_cast<const TSectionNode *>(m_pLastSection);
+    const TSectionNode *pNext;
+    if (!a_pSection && a_pEmpty) {
+      return a_pEmpty;
+    } else if (!a_pSection || a_pSection == a_pEmpty) {
+      pNext = static_cast<const TSectionNode *>(pLast->first.pNextLoaded);
+    } else if (a_pSection == pLast) {
+      return NULL;
+    } else {
+      pNext =
+          static_cast<const TSectionNode *>(a_pSection->first.pNextLoaded);
+    }
 
-private:
+    // the section with an empty name was written first
+    if (pNext == a_pEmpty) {
+      pNext = pNext == pLast ? NULL
+                             : static_cast<const TSectionNode *>(
+                                   pNext->first.pNextLoaded);
+    }
+    return pNext;
+  }
+
+  /** The keys of a section in load order, NULL after the last */
+  static const TKeyNode *FirstKeyLoaded(const TSectionNode &a_section) {
+    const void *pLast = a_section.first.pLastKey;
+    return pLast ? static_cast<const TKeyNode *>(
+                       static_cast<const TKeyNode *>(pLast)->first.pNextLoaded)
+                 : NULL;
+  }
+  static const TKeyNode *NextKeyLoaded(const TSectionNode &a_section,
+                                       const TKeyNode *a_pKey) {
+    return a_pKey == a_section.first.pLastKey
+               ? NULL
+               : static_cast<const TKeyNode *>(a_pKey->first.pNextLoaded);
+  }
+
+  /** The next value of the same key, NULL after the last */
+  static const TKeyNode *NextValue(const TKeyNode *a_pKey) {
+    return static_cast<const TKeyNode *>(a_pKey->first.pNextValue);
+  }
+
+  /** Add the differences between the keys of a section to a_diff */
+  static void DiffKeys(const SI_CHAR *a_pSection, const TKeyVal &a_keyval,
+                       const TKeyVal &a_other, TDiff &a_diff);
+
+  static void AddDiff(TDiff &a_diff, typename DiffEntry::Type a_nType,
+                      const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                      const SI_CHAR *a_pValue, const SI_CHAR *a_pOther) {
+    DiffEntry entry;
+    entry.nType = a_nType;
+    entry.pSection = a_pSection;
+    entry.pKey = a_pKey;
+    entry.pValue = a_pValue;
+    entry.pOther = a_pOther;
+    a_diff.push_back(entry);
+  }
+
+  /** Are the strings the same, ignoring SI_STRLESS */
+  static bool IsIdentical(const SI_CHAR *a_pLeft, const SI_CHAR *a_pRight) {
+    while (*a_pLeft && *a_pLeft == *a_pRight) {
+      ++a_pLeft;
+      ++a_pRight;
+    }
+    return *a_pLeft == *a_pRight;
+  }
+
+  /** Find a section, first parsing its keys if it was lazily loaded */
+  typename TSection::iterator FindSection(const SI_CHAR *a_pSection);
+  typename TSection::const_iterator
+  FindSection(const SI_CHAR *a_pSection) const {
+    return const_cast<CSimpleIniTempl *>(this)->FindSection(a_pSection);
+  }
+
+  /** Find a section without parsing its keys */
+  typename TSection::iterator LookupSection(const SI_CHAR *a_pSection);
+
+  /** Find the first entry of a key in a section */
+  typename TKeyVal::iterator FindKey(TKeyVal &a_keyval,
+                                     const SI_CHAR *a_pKey);
+  typename TKeyVal::const_iterator FindKey(const TKeyVal &a_keyval,
+                                           const SI_CHAR *a_pKey) const {
+    return const_cast<CSimpleIniTempl *>(this)->FindKey(
+        const_cast<TKeyVal &>(a_keyval), a_pKey);
+  }
+
+#ifdef SI_HAS_STRING_VIEW
+  /** Find a section or key given as a view */
+  typename TSection::iterator FindSection(TStringView a_section);
+  typename TSection::const_iterator FindSection(TStringView a_section) const {
+    return const_cast<CSimpleIniTempl *>(this)->FindSection(a_section);
+  }
+  typename TSection::iterator LookupSection(TStringView a_section);
+  typename TKeyVal::iterator FindKey(TKeyVal &a_keyval, TStringView a_key);
+  typename TKeyVal::const_iterator FindKey(const TKeyVal &a_keyval,
+                                           TStringView a_key) const {
+    return const_cast<CSimpleIniTempl *>(this)->FindKey(
+        const_cast<TKeyVal &>(a_keyval), a_key);
+  }
+
+  /** NUL terminated copy of a view, short strings are kept on the stack */
+  class ViewString {
+  public:
+    explicit ViewString(TStringView a_view) : m_pString(m_buffer) {
+      if (a_view.size() < sizeof(m_buffer) / sizeof(SI_CHAR)) {
+        std::copy(a_view.begin(), a_view.end(), m_buffer);
+        m_buffer[a_view.size()] = 0;
+      } else {
+        m_string.assign(a_view.data(), a_view.size());
+        m_pString = m_string.c_str();
+      }
+    }
+    const SI_CHAR *c_str() const { return m_pString; }
+
+  private:
+    SI_CHAR m_buffer[64];
+    std::basic_string<SI_CHAR> m_string;
+    const SI_CHAR *m_pString;
+
+    ViewString(const ViewString &);            // disable
+    ViewString &operator=(const ViewString &); // disable
+  };
+#endif // SI_HAS_STRING_VIEW
+
+  /** Names of a key slot, compared as sections and keys are */
+  struct SlotName {
+    const SI_CHAR *pSection;
+    const SI_CHAR *pKey;
+  };
+  struct SlotNameLess {
+    bool operator()(const SlotName &a_lhs, const SlotName &a_rhs) const {
+      const static SI_STRLESS isLess = SI_STRLESS();
+      if (isLess(a_lhs.pSection, a_rhs.pSection)) {
+        return true;
+      }
+      if (isLess(a_rhs.pSection, a_lhs.pSection)) {
+        return false;
+      }
+      return isLess(a_lhs.pKey, a_rhs.pKey);
+    }
+  };
+
+  /** Key slots by name, the names are the strings of the slots */
+  typedef std::map<SlotName, KeySlot *, SlotNameLess> TKeySlotIndex;
+
+  /** Point the slot of a key, if it was resolved, at the first entry of
+        the key. Called whenever the first entry of a key may have changed.
+     */
+  void BindKeySlot(typename TSection::iterator a_iSection,
+                   const SI_CHAR *a_pKey);
+
+  /** Point every key slot at its key, after the data was replaced */
+  void BindKeySlots();
+
+  /** Clear the slots of the keys of a section that is removed, or of every
+        section if a_pSection is NULL */
+  void UnbindKeySlots(const SI_CHAR *a_pSection);
+
+  /** The parts of the accessors that follow the lookup */
+  const SI_CHAR *FirstValue(const TKeyVal &a_keyval,
+                            typename TKeyVal::const_iterator a_iKeyVal,
+                            bool *a_pHasMultiple) const;
+  void CollectValues(const TKeyVal &a_keyval,
+                     typename TKeyVal::const_iterator a_iKeyVal,
+                     TNamesDepend &a_values) const;
+  int CountKeys(const TKeyVal &a_section) const;
+  void CollectKeys(const TKeyVal &a_section, TNamesDepend &a_names) const;
+
+  /** Entry of the key hash table, the first entry of a key in a section */
+  struct KeyRef {
+    KeyRef() : pKeyVal(NULL), iKey() {}
+    KeyRef(const TKeyVal *a_pKeyVal, typename TKeyVal::iterator a_iKey)
+        : pKeyVal(a_pKeyVal), iKey(a_iKey) {}
+    const TKeyVal *pKeyVal;
+    typename TKeyVal::iterator iKey;
+  };
+
+  /** Hash table equality tests */
+  struct SectionNameMatch {
+    const CSimpleIniTempl *pIni;
+    const SI_CHAR *pName;
+    bool operator()(typename TSection::iterator a_iSection) const {
+      return pIni->IsEqual(a_iSection->first.pItem, pName);
+    }
+  };
+  struct SectionMatch {
+    typename TSection::iterator iSection;
+    bool operator()(typename TSection::iterator a_iSection) const {
+      return a_iSection == iSection;
+    }
+  };
+  struct KeyNameMatch {
+    const CSimpleIniTempl *pIni;
+    const TKeyVal *pKeyVal;
+    const SI_CHAR *pName;
+    bool operator()(const KeyRef &a_ref) const {
+      return a_ref.pKeyVal == pKeyVal &&
+             pIni->IsEqual(a_ref.iKey->first.pItem, pName);
+    }
+  };
+  struct KeyMatch {
+    typename TKeyVal::iterator iKey;
+    bool operator()(const KeyRef &a_ref) const { return a_ref.iKey == iKey; }
+  };
+#ifdef SI_HAS_STRING_VIEW
+  struct SectionViewMatch {
+    TStringView name;
+    bool operator()(typename TSection::iterator a_iSection) const {
+      return SI_StrCompareN<SI_STRLESS>::Compare(
+                 a_iSection->first.pItem, a_iSection->first.uLen,
+                 name.data(), name.size()) == 0;
+    }
+  };
+  struct KeyViewMatch {
+    const TKeyVal *pKeyVal;
+    TStringView name;
+    bool operator()(const KeyRef &a_ref) const {
+      return a_ref.pKeyVal == pKeyVal &&
+             SI_StrCompareN<SI_STRLESS>::Compare(
+                 a_ref.iKey->first.pItem, a_ref.iKey->first.uLen,
+                 name.data(), name.size()) == 0;
+    }
+  };
+#endif // SI_HAS_STRING_VIEW
+
+  /** Entry of the value cache, the converted value of a key entry */
+  struct CachedValue {
+    CachedValue() : pNode(NULL), cache() {}
+    const TKeyNode *pNode;
+    ValueCache cache;
+  };
+  struct CachedValueMatch {
+    const TKeyNode *pNode;
+    bool operator()(const CachedValue &a_cached) const {
+      return a_cached.pNode == pNode;
+    }
+  };
+  static size_t NodeHash(const TKeyNode *a_pNode) {
+    return reinterpret_cast<size_t>(a_pNode) / sizeof(void *) * 2654435761u;
+  }
+
+  /** Forget the converted value of a key entry that is changed or erased */
+  void UncacheValue(const TKeyNode *a_pNode) {
+    if (m_valueCache.Size() > 0) {
+      CachedValueMatch match = {a_pNode};
+      m_valueCache.Erase(NodeHash(a_pNode), match);
+    }
+  }
+
+  /** Hash of a key name in a section */
+  static size_t KeyHash(const TKeyVal *a_pKeyVal, const SI_CHAR *a_pKey) {
+    return KeyHash(a_pKeyVal, SI_StrHash<SI_STRLESS>::Hash(a_pKey));
+  }
+  static size_t KeyHash(const TKeyVal *a_pKeyVal, size_t a_uNameHash) {
+    const size_t uSection =
+        reinterpret_cast<size_t>(a_pKeyVal) / sizeof(void *);
+    return a_uNameHash ^ (uSection * 2654435761u);
+  }
+
+  /** Add a new section or key to the hash tables */
+  void IndexSection(typename TSection::iterator a_iSection);
+  void IndexKey(TKeyVal &a_keyval, typename TKeyVal::iterator a_iKey);
+
+  /** Remove a section with all of its keys, or a key that is about to be
+        erased, from the hash tables */
+  void UnindexSection(typename TSection::iterator a_iSection);
+  void UnindexKey(TKeyVal &a_keyval, typename TKeyVal::iterator a_iKey);
+
+  /** Consume a UTF-8 signature at the start of the data and switch to
+        UTF-8 mode if one is found. */
+  void SkipUtf8Signature(const char *&a_pData, size_t &a_uDataLen);
+
+  /** Parse a NUL terminated block of data of a_uLen characters that has
+        already been converted to SI_CHAR. The block is adopted: it becomes
+        m_pData when the strings are stored in place, otherwise it is
+        released with a_owner before returning.
+     */
+  SI_Error LoadBuffer(SI_CHAR *a_pData, size_t a_uLen,
+                      const DataOwner &a_owner);
+
+  /** Release a data block that was passed to LoadBuffer() */
+  static void ReleaseData(SI_CHAR *a_pData, const DataOwner &a_owner) {
+    if (a_owner.pfnRelease) {
+      a_owner.pfnRelease(a_owner.pOwner, a_owner.uSize);
+    } else {
+      delete[] a_pData;
+    }
+  }
+
+  /** Make a copy of the supplied string, replacing the original pointer */
+  SI_Error CopyString(const SI_CHAR *&a_pString) {
+    return CopyString(a_pString, Entry::Length(a_pString));
+  }
+
+  /** Make a copy of a string of a known length */
+  SI_Error CopyString(const SI_CHAR *&a_pString, size_t a_uLen);
+
+  /** Replace a string of a_source with the same string of this copy of it,
+        see Clone() */
+  SI_Error CloneString(const CSimpleIniTempl &a_source,
+                       const SI_CHAR *&a_pString);
+
+  /** Copy the data of this object into a_copy, which was reset, see
+        Clone(). The containers may throw std::bad_alloc. */
+  SI_Error CloneData(CSimpleIniTempl &a_copy) const;
+
+  /** Undo m_data changes from a failed incremental LoadData. */
+  void UndoIncrementalLoadData(const TNamesDepend &a_oAddedSections,
+                               const TNamesDepend &a_oAddedKeys);
+
+  /** Delete a string from the copied strings buffer if necessary */
+  void DeleteString(const SI_CHAR *a_pString);
+
+  /** Convert a value for GetLongValue(), GetDoubleValue() and
+        GetBoolValue(). Returns false if the value is missing or invalid.
+     */
+  static bool ParseLong(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                        long &a_nValue);
+  static bool ParseDouble(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                          double &a_nValue);
+  static bool ParseBool(const SI_CHAR *a_pValue, bool &a_bValue);
+
+  /** Convert a value for GetInt64Value(), GetUInt64Value() and
+        GetFloatValue(). Returns false if the value is missing or invalid.
+     */
+  static bool ParseInt64(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                         int64_t &a_nValue);
+  static bool ParseUInt64(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                          uint64_t &a_nValue);
+  static bool ParseFloat(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                         double &a_nValue);
+
+  /** Get the text of a numeric value as char. For a char store this is the
+        value itself, otherwise it is converted into a_szBuffer. Returns NULL
+        if the value can't be converted. */
+  static const char *NumericText(const SI_CHAR *a_pValue, bool a_bStoreIsUtf8,
+                                 char (&a_szBuffer)[64], size_t &a_uLen);
+
+  /** Parse an integer of a_uLen chars, with an optional "0x" prefix for
+        hexadecimal. The sign has already been removed. */
+  static bool ParseDigits(const char *a_pText, size_t a_uLen,
+                          uint64_t &a_nValue);
+
+  /** Add a numeric value that was formatted as char */
+  SI_Error SetNumericValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                           const char *a_pszValue, const SI_CHAR *a_pComment,
+                           bool a_bForceReplace);
+
+  /** Find the first value of a key for the typed accessors. Returns NULL
+        if the key doesn't exist. */
+  const typename TKeyVal::value_type *
+  FindFirstValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                 bool *a_pHasMultiple) const;
+#ifdef SI_HAS_STRING_VIEW
+  const typename TKeyVal::value_type *
+  FindFirstValue(TStringView a_section, TStringView a_key,
+                 bool *a_pHasMultiple) const;
+#endif // SI_HAS_STRING_VIEW
+
+  /** Convert a value found by FindFirstValue() with a_pfnParse, using and
+        updating the cached conversion when m_bValueCache is set. */
+  template <class T>
+  bool ConvertValue(const typename TKeyVal::value_type *a_pValue,
+                    unsigned char a_nType,
+                    bool (*a_pfnParse)(const SI_CHAR *, bool, T &),
+                    T &a_value) const;
+
+  /** Orders indexes of an array of keys by the keys */
+  struct KeyIndexLess {
+    const SI_CHAR *const *pKeys;
+    bool operator()(size_t a_uLeft, size_t a_uRight) const {
+      const static SI_STRLESS isLess = SI_STRLESS();
+      return isLess(pKeys[a_uLeft], pKeys[a_uRight]);
+    }
+  };
+
+  /** ParseBool() with the signature of the other conversions */
+  static bool ParseBoolValue(const SI_CHAR *a_pValue, bool, bool &a_bValue) {
+    return ParseBool(a_pValue, a_bValue);
+  }
+
+  /** Internal use of our string comparison function */
+  bool IsLess(const SI_CHAR *a_pLeft, const SI_CHAR *a_pRight) const {
+    const static SI_STRLESS isLess = SI_STRLESS();
+    return isLess(a_pLeft, a_pRight);
+  }
+
+  bool IsEqual(const SI_CHAR *a_pLeft, const SI_CHAR *a_pRight) const {
+    return !IsLess(a_pLeft, a_pRight) && !IsLess(a_pRight, a_pLeft);
+  }
+
+  bool IsMultiLineTag(const SI_CHAR *a_pData) const;
+  static bool IsMultiLineData(const SI_CHAR *a_pData);
+  static bool IsSingleLineQuotedValue(const SI_CHAR *a_pData);
+  bool LoadMultiLineText(SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd,
+                         const SI_CHAR *&a_pVal, const SI_CHAR *a_pTagName,
+                         bool a_bAllowBlankLinesInComment = false,
+                         bool *a_pbTruncated = NULL) const;
+  static bool IsNewLineChar(SI_CHAR a_c);
+
+  /** Write the INI data, used by all of the Save() functions */
+  SI_Error SaveTo(OutputBuffer &a_oOutput, bool a_bAddSignature) const;
+
+  bool OutputMultiLineText(OutputBuffer &a_oOutput, Converter &a_oConverter,
+                           const SI_CHAR *a_pText) const;
+
+private:
   /** Copy of the INI file data in our character format. This will be
         modified when parsed to have NULL characters added after all
         interesting string entries. All of the string pointers to sections,
@@ -1206,20 +3354,63 @@ private:
      */
   size_t m_uDataLen;
 
+  /** Owner of m_pData when it was not allocated by LoadData() */
+  DataOwner m_dataOwner;
+
+  /** Incremental load state, NULL unless BeginLoad() is active */
+  StreamState *m_pStream;
+
+  /** Number of threads used by ParseParallel() */
+  unsigned m_nLoadThreads;
+
+  /** ParseParallel() when parallel loading is enabled, otherwise NULL */
+  bool (CSimpleIniTempl::*m_pfnParseParallel)(SI_CHAR *, const SI_CHAR *,
+                                              TParsedEntries &) const;
+
   /** File comment for this data, if one exists. */
   const SI_CHAR *m_pFileComment;
 
-  /** constant empty string */
-  const SI_CHAR m_cEmptyString;
+  /** constant empty string, shared so that values that refer to it stay
+        valid when the data is moved to another object */
+  static const SI_CHAR m_cEmptyString;
 
   /** Parsed INI data. Section -> (Key -> Value). */
   TSection m_data;
 
-  /** This vector stores allocated memory for copies of strings that have
+  /** Last section of the circular load order list of the sections. The
+        keys of each section are listed from the section's entry. */
+  const void *m_pLastSection;
+
+  /** Number of keys in m_data, counting each value of a multi-key */
+  size_t m_uKeys;
+
+  /** Bytes that the entries of m_data take in the saved data, with their
+        separators and comments, kept so that Save() can size its output */
+  size_t m_uSaveBytes;
+
+  /** Values in m_data that start or end with whitespace. Save() writes
+        them in quotes or as multi-line text, depending on the settings. */
+  size_t m_uPaddedValues;
+
+  /** Lazily loaded sections whose keys have not been parsed yet */
+  TLazySections m_lazySections;
+
+  /** Data ranges of the sections in m_lazySections */
+  std::vector<LazyRange> m_lazyRanges;
+
+  /** Hash tables of all sections and keys when m_bHashIndex is set */
+  SI_Internal::HashIndex<typename TSection::iterator> m_sectionIndex;
+  SI_Internal::HashIndex<KeyRef> m_keyIndex;
+
+  /** Converted values of the keys when m_bValueCache is set, kept apart
+        from the entries so that they cost nothing while it is not set */
+  mutable SI_Internal::HashIndex<CachedValue> m_valueCache;
+
+  /** This arena stores allocated memory for copies of strings that have
         been supplied after the file load. It will be empty unless SetValue()
         has been called.
      */
-  TNamesDepend m_strings;
+  SI_Internal::StringArena m_strings;
 
   /** Is the format of our datafile UTF-8 or MBCS? */
   bool m_bStoreIsUtf8;
@@ -1239,10 +3430,25 @@ private:
   /** Do keys always need to have an equals sign when reading/writing? */
   bool m_bAllowKeyOnly;
 
+  /** Are the keys of a section parsed when it is first used? */
+  bool m_bLazyLoad;
+
+  /** Are sections and keys found with m_sectionIndex and m_keyIndex? */
+  bool m_bHashIndex;
+
+  /** Are converted values kept in m_valueCache? */
+  bool m_bValueCache;
+
   /** Next order value, used to ensure sections and keys are output in the
         same order that they are loaded/added.
      */
   int m_nOrder;
+
+  /** Keys resolved by ResolveKey() */
+  std::list<KeySlot> m_keySlots;
+
+  /** The slots of m_keySlots by name */
+  TKeySlotIndex m_keySlotIndex;
 };
 
 // ---------------------------------------------------------------------------
@@ -1252,36 +3458,225 @@ private:
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CSimpleIniTempl(
     bool a_bIsUtf8, bool a_bAllowMultiKey, bool a_bAllowMultiLine)
-    : m_pData(0), m_uDataLen(0), m_pFileComment(NULL), m_cEmptyString(0),
-      m_bStoreIsUtf8(a_bIsUtf8), m_bAllowMultiKey(a_bAllowMultiKey),
-      m_bAllowMultiLine(a_bAllowMultiLine), m_bSpaces(true),
-      m_bParseQuotes(false), m_bAllowKeyOnly(false), m_nOrder(0) {}
+    : m_pData(0), m_uDataLen(0), m_dataOwner(), m_pStream(NULL),
+      m_nLoadThreads(1), m_pfnParseParallel(NULL), m_pFileComment(NULL),
+      m_pLastSection(NULL), m_uKeys(0), m_uSaveBytes(0), m_uPaddedValues(0),
+      m_bStoreIsUtf8(a_bIsUtf8),
+      m_bAllowMultiKey(a_bAllowMultiKey), m_bAllowMultiLine(a_bAllowMultiLine),
+      m_bSpaces(true), m_bParseQuotes(false), m_bAllowKeyOnly(false),
+      m_bLazyLoad(false), m_bHashIndex(false), m_bValueCache(false),
+      m_nOrder(0) {}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const SI_CHAR CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::m_cEmptyString =
+    0;
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CSimpleIniTempl(
+    CSimpleIniTempl &&a_rhs) noexcept
+    : CSimpleIniTempl() {
+  Swap(a_rhs);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER> &
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::operator=(
+    CSimpleIniTempl &&a_rhs) noexcept {
+  if (this != &a_rhs) {
+    // the previous data is released by the temporary
+    CSimpleIniTempl oTemp(std::move(a_rhs));
+    Swap(oTemp);
+  }
+  return *this;
+}
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::~CSimpleIniTempl() {
   Reset();
 }
 
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Swap(
+    CSimpleIniTempl &a_other) noexcept {
+  // the maps and lists keep their nodes, so iterators and pointers to
+  // entries, which the hash index and the key handles hold, stay valid
+  std::swap(m_pData, a_other.m_pData);
+  std::swap(m_uDataLen, a_other.m_uDataLen);
+  std::swap(m_dataOwner, a_other.m_dataOwner);
+  std::swap(m_pStream, a_other.m_pStream);
+  std::swap(m_nLoadThreads, a_other.m_nLoadThreads);
+  std::swap(m_pfnParseParallel, a_other.m_pfnParseParallel);
+  std::swap(m_pFileComment, a_other.m_pFileComment);
+  m_data.swap(a_other.m_data);
+  std::swap(m_pLastSection, a_other.m_pLastSection);
+  std::swap(m_uKeys, a_other.m_uKeys);
+  std::swap(m_uSaveBytes, a_other.m_uSaveBytes);
+  std::swap(m_uPaddedValues, a_other.m_uPaddedValues);
+  m_lazySections.swap(a_other.m_lazySections);
+  m_lazyRanges.swap(a_other.m_lazyRanges);
+  m_sectionIndex.Swap(a_other.m_sectionIndex);
+  m_keyIndex.Swap(a_other.m_keyIndex);
+  m_valueCache.Swap(a_other.m_valueCache);
+  m_strings.Swap(a_other.m_strings);
+  std::swap(m_bStoreIsUtf8, a_other.m_bStoreIsUtf8);
+  std::swap(m_bAllowMultiKey, a_other.m_bAllowMultiKey);
+  std::swap(m_bAllowMultiLine, a_other.m_bAllowMultiLine);
+  std::swap(m_bSpaces, a_other.m_bSpaces);
+  std::swap(m_bParseQuotes, a_other.m_bParseQuotes);
+  std::swap(m_bAllowKeyOnly, a_other.m_bAllowKeyOnly);
+  std::swap(m_bLazyLoad, a_other.m_bLazyLoad);
+  std::swap(m_bHashIndex, a_other.m_bHashIndex);
+  std::swap(m_bValueCache, a_other.m_bValueCache);
+  std::swap(m_nOrder, a_other.m_nOrder);
+  m_keySlots.swap(a_other.m_keySlots);
+  m_keySlotIndex.swap(a_other.m_keySlotIndex);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CloneString(
+    const CSimpleIniTempl &a_source, const SI_CHAR *&a_pString) {
+  if (!a_pString || a_pString == &m_cEmptyString) {
+    return SI_OK;
+  }
+  // strings in the data block have the same offset in the copy of it
+  if (a_source.m_pData && a_pString >= a_source.m_pData &&
+      a_pString < a_source.m_pData + a_source.m_uDataLen) {
+    a_pString = m_pData + (a_pString - a_source.m_pData);
+    return SI_OK;
+  }
+  return CopyString(a_pString);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Clone(
+    CSimpleIniTempl &a_copy) const {
+  if (&a_copy == this) {
+    return SI_OK;
+  }
+  a_copy.Reset();
+  a_copy.m_nLoadThreads = m_nLoadThreads;
+  a_copy.m_pfnParseParallel = m_pfnParseParallel;
+  a_copy.m_bStoreIsUtf8 = m_bStoreIsUtf8;
+  a_copy.m_bAllowMultiKey = m_bAllowMultiKey;
+  a_copy.m_bAllowMultiLine = m_bAllowMultiLine;
+  a_copy.m_bSpaces = m_bSpaces;
+  a_copy.m_bParseQuotes = m_bParseQuotes;
+  a_copy.m_bAllowKeyOnly = m_bAllowKeyOnly;
+  a_copy.m_bLazyLoad = m_bLazyLoad;
+  a_copy.m_bHashIndex = false;
+  a_copy.m_bValueCache = m_bValueCache;
+  a_copy.m_nOrder = m_nOrder;
+
+  // the containers are copied with allocators that throw
+  SI_Error rc;
+  try {
+    rc = CloneData(a_copy);
+  } catch (const std::bad_alloc &) {
+    rc = SI_NOMEM;
+  }
+  if (rc < 0) {
+    // strings that were not replaced refer to this object
+    a_copy.m_data.clear();
+    a_copy.Reset();
+  }
+  return rc;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CloneData(
+    CSimpleIniTempl &a_copy) const {
+  if (m_pData) {
+    a_copy.m_pData = new (std::nothrow) SI_CHAR[m_uDataLen];
+    if (!a_copy.m_pData) {
+      return SI_NOMEM;
+    }
+    memcpy(a_copy.m_pData, m_pData, sizeof(SI_CHAR) * m_uDataLen);
+    a_copy.m_uDataLen = m_uDataLen;
+  }
+
+  // the names are the same, so the copied maps are still in order after
+  // their strings are replaced
+  a_copy.m_data = m_data;
+  a_copy.m_pFileComment = m_pFileComment;
+  SI_Error rc = a_copy.CloneString(*this, a_copy.m_pFileComment);
+  typename TSection::iterator iSection = a_copy.m_data.begin();
+  for (; rc >= 0 && iSection != a_copy.m_data.end(); ++iSection) {
+    Entry &oSection = const_cast<Entry &>(iSection->first);
+    rc = a_copy.CloneString(*this, oSection.pItem);
+    if (rc >= 0) {
+      rc = a_copy.CloneString(*this, oSection.pComment);
+    }
+    TKeyVal &keyval = iSection->second;
+    typename TKeyVal::iterator iKey = keyval.begin();
+    for (; rc >= 0 && iKey != keyval.end(); ++iKey) {
+      Entry &oKey = const_cast<Entry &>(iKey->first);
+      rc = a_copy.CloneString(*this, oKey.pItem);
+      if (rc >= 0) {
+        rc = a_copy.CloneString(*this, oKey.pComment);
+      }
+      if (rc >= 0) {
+        rc = a_copy.CloneString(*this, iKey->second);
+      }
+    }
+  }
+  if (rc < 0) {
+    return rc;
+  }
+  a_copy.RebuildLoadOrder();
+  a_copy.m_uSaveBytes = m_uSaveBytes;
+  a_copy.m_uPaddedValues = m_uPaddedValues;
+  a_copy.BindKeySlots();
+
+  // the keys of lazily loaded sections are in the data block
+  a_copy.m_lazyRanges = m_lazyRanges;
+  for (size_t n = 0; n < a_copy.m_lazyRanges.size(); ++n) {
+    LazyRange &range = a_copy.m_lazyRanges[n];
+    range.pStart = a_copy.m_pData + (range.pStart - m_pData);
+    range.pEnd = a_copy.m_pData + (range.pEnd - m_pData);
+  }
+  typename TLazySections::const_iterator iLazy = m_lazySections.begin();
+  for (; iLazy != m_lazySections.end(); ++iLazy) {
+    typename TSection::iterator iCopy =
+        a_copy.m_data.find(Entry(iLazy->first));
+    if (iCopy != a_copy.m_data.end()) {
+      a_copy.m_lazySections.insert(
+          std::make_pair(iCopy->first.pItem, iLazy->second));
+    }
+  }
+
+  if (m_bHashIndex) {
+    a_copy.SetHashIndex(true);
+  }
+  return SI_OK;
+}
+
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Reset() {
   // remove all data
-  delete[] m_pData;
+  delete m_pStream;
+  m_pStream = NULL;
+  ReleaseData(m_pData, m_dataOwner);
   m_pData = NULL;
   m_uDataLen = 0;
+  m_dataOwner = DataOwner();
   m_pFileComment = NULL;
   m_nOrder = 0;
+  UnbindKeySlots(NULL);
   if (!m_data.empty()) {
     m_data.erase(m_data.begin(), m_data.end());
   }
+  m_pLastSection = NULL;
+  m_uKeys = 0;
+  m_uSaveBytes = 0;
+  m_uPaddedValues = 0;
+  m_lazySections.clear();
+  m_lazyRanges.clear();
+  m_sectionIndex.Clear();
+  m_keyIndex.Clear();
+  m_valueCache.Clear();
 
   // remove all strings
-  if (!m_strings.empty()) {
-    typename TNamesDepend::iterator i = m_strings.begin();
-    for (; i != m_strings.end(); ++i) {
-      delete[] const_cast<SI_CHAR *>(i->pItem);
-    }
-    m_strings.erase(m_strings.begin(), m_strings.end());
-  }
+  m_strings.Clear();
 }
 
 namespace SI_Internal {
@@ -1378,6 +3773,179 @@ inline bool GetFileSize(FILE *a_fpFile, size_t &a_uSize) {
   return true;
 #endif
 }
+
+/** Release a char buffer that was allocated with new[]. */
+inline void DeleteCharArray(void *a_pData, size_t a_uSize) {
+  (void)a_uSize;
+  delete[] static_cast<char *>(a_pData);
+}
+
+/** Release a std::string that was allocated with new. */
+inline void DeleteStdString(void *a_pString, size_t a_uSize) {
+  (void)a_uSize;
+  delete static_cast<std::string *>(a_pString);
+}
+
+#ifdef SI_SUPPORT_MMAP
+/** Release a mapping created by MapFile(). */
+inline void UnmapFile(void *a_pData, size_t a_uSize) {
+#ifdef _WIN32
+  (void)a_uSize;
+  UnmapViewOfFile(a_pData);
+#else
+  munmap(a_pData, a_uSize);
+#endif
+}
+
+/** Map a file copy-on-write so that it can be modified in memory. On success
+    a_pData is the mapping of a_uSize bytes followed by at least one NUL, or
+    NULL if the file is empty or its size leaves no room for the NUL in the
+    last page.
+ */
+inline SI_Error MapFile(const char *a_pszFile, char *&a_pData,
+                        size_t &a_uSize) {
+  a_pData = NULL;
+  a_uSize = 0;
+
+#ifdef _WIN32
+  HANDLE hFile = CreateFileA(a_pszFile, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return SI_FILE;
+  }
+  LARGE_INTEGER nSize;
+  if (!GetFileSizeEx(hFile, &nSize) || nSize.QuadPart < 0 ||
+      static_cast<unsigned long long>(nSize.QuadPart) >
+          static_cast<unsigned long long>(SI_MAX_FILE_SIZE)) {
+    CloseHandle(hFile);
+    return SI_FILE;
+  }
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  a_uSize = static_cast<size_t>(nSize.QuadPart);
+  if (a_uSize == 0 || a_uSize % info.dwPageSize == 0) {
+    CloseHandle(hFile);
+    return SI_OK;
+  }
+  HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(hFile);
+  if (!hMap) {
+    return SI_FILE;
+  }
+  void *pMap = MapViewOfFile(hMap, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(hMap);
+  if (!pMap) {
+    return SI_FILE;
+  }
+#else
+  int fd = open(a_pszFile, O_RDONLY);
+  if (fd < 0) {
+    return SI_FILE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 0 ||
+      static_cast<unsigned long long>(st.st_size) >
+          static_cast<unsigned long long>(SI_MAX_FILE_SIZE)) {
+    close(fd);
+    return SI_FILE;
+  }
+  const long nPageSize = sysconf(_SC_PAGESIZE);
+  a_uSize = static_cast<size_t>(st.st_size);
+  if (a_uSize == 0 || nPageSize <= 0 ||
+      a_uSize % static_cast<size_t>(nPageSize) == 0) {
+    close(fd);
+    return SI_OK;
+  }
+  void *pMap =
+      mmap(NULL, a_uSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (pMap == MAP_FAILED) {
+    return SI_FILE;
+  }
+#endif
+
+  a_pData = static_cast<char *>(pMap);
+  return SI_OK;
+}
+#endif // SI_SUPPORT_MMAP
+
+/** Find the first NUL, '\\r', '\\n' or a_cStop character in a NUL terminated
+    string. a_pDataEnd must not be before the terminating NUL. It is used to
+    bound the block reads of the vectorized char version and is otherwise
+    ignored.
+ */
+template <class SI_CHAR>
+inline SI_CHAR *ScanLine(SI_CHAR *a_pData, const SI_CHAR *a_pDataEnd,
+                         SI_CHAR a_cStop) {
+  (void)a_pDataEnd;
+  while (*a_pData && *a_pData != '\n' && *a_pData != '\r' &&
+         *a_pData != a_cStop) {
+    ++a_pData;
+  }
+  return a_pData;
+}
+
+#if defined(SI_SCAN_AVX2) || defined(SI_SCAN_SSE2)
+/** Index of the lowest set bit in a non-zero mask */
+inline unsigned LowestBit(unsigned a_uMask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long uIndex;
+  _BitScanForward(&uIndex, a_uMask);
+  return static_cast<unsigned>(uIndex);
+#else
+  return static_cast<unsigned>(__builtin_ctz(a_uMask));
+#endif
+}
+#endif
+
+/** char version of ScanLine which tests 16 or 32 characters at a time. */
+inline char *ScanLine(char *a_pData, const char *a_pDataEnd, char a_cStop) {
+  (void)a_pDataEnd;
+#if defined(SI_SCAN_AVX2)
+  const __m256i vNul = _mm256_setzero_si256();
+  const __m256i vCR = _mm256_set1_epi8('\r');
+  const __m256i vLF = _mm256_set1_epi8('\n');
+  const __m256i vStop = _mm256_set1_epi8(a_cStop);
+  while (a_pDataEnd - a_pData >= 32) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_pData));
+    const __m256i vHit =
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, vNul),
+                                        _mm256_cmpeq_epi8(v, vCR)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(v, vLF),
+                                        _mm256_cmpeq_epi8(v, vStop)));
+    const unsigned uMask =
+        static_cast<unsigned>(_mm256_movemask_epi8(vHit));
+    if (uMask) {
+      return a_pData + LowestBit(uMask);
+    }
+    a_pData += 32;
+  }
+#elif defined(SI_SCAN_SSE2)
+  const __m128i vNul = _mm_setzero_si128();
+  const __m128i vCR = _mm_set1_epi8('\r');
+  const __m128i vLF = _mm_set1_epi8('\n');
+  const __m128i vStop = _mm_set1_epi8(a_cStop);
+  while (a_pDataEnd - a_pData >= 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_pData));
+    const __m128i vHit = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, vNul), _mm_cmpeq_epi8(v, vCR)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, vLF), _mm_cmpeq_epi8(v, vStop)));
+    const unsigned uMask = static_cast<unsigned>(_mm_movemask_epi8(vHit));
+    if (uMask) {
+      return a_pData + LowestBit(uMask);
+    }
+    a_pData += 16;
+  }
+#endif
+  // remaining characters (or all of them without SIMD support)
+  while (*a_pData && *a_pData != '\n' && *a_pData != '\r' &&
+         *a_pData != a_cStop) {
+    ++a_pData;
+  }
+  return a_pData;
+}
 } // namespace SI_Internal
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
@@ -1451,35 +4019,128 @@ CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadFile(FILE *a_fpFile) {
     return SI_FILE;
   }
 
+  // data that needs no conversion is parsed in the buffer that it was read
+  // into instead of being copied again by LoadData
+  if (SI_IsIdentityConverter<SI_CONVERTER>::value) {
+    const char *pText = pData;
+    size_t uLen = uRead;
+    SkipUtf8Signature(pText, uLen);
+    DataOwner owner = {pData, uSize + 1, &SI_Internal::DeleteCharArray};
+    return LoadBuffer(reinterpret_cast<SI_CHAR *>(const_cast<char *>(pText)),
+                      uLen, owner);
+  }
+
   // convert the raw data to unicode
   SI_Error rc = LoadData(pData, uRead);
   delete[] pData;
   return rc;
 }
 
+#ifdef SI_SUPPORT_MMAP
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
-    const char *a_pData, size_t a_uDataLen) {
-  if (!a_pData) {
-    return SI_OK;
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadFileMapped(
+    const char *a_pszFile) {
+  char *pMap = NULL;
+  size_t uSize = 0;
+  SI_Error rc = SI_Internal::MapFile(a_pszFile, pMap, uSize);
+  if (rc < 0) {
+    return rc;
+  }
+  if (!pMap) {
+    // empty, or no room in the mapping for the NUL terminator
+    return LoadFile(a_pszFile);
   }
 
-  // if the UTF-8 BOM exists, consume it and set mode to unicode, if we have
-  // already loaded data and try to change mode half-way through then this will
-  // be ignored and we will assert in debug versions
-  if (a_uDataLen >= 3 && memcmp(a_pData, SI_UTF8_SIGNATURE, 3) == 0) {
-    a_pData += 3;
-    a_uDataLen -= 3;
-    SI_ASSERT(m_bStoreIsUtf8 || !m_pData); // we don't expect mixed mode data
-    SetUnicode();
+  if (!SI_IsIdentityConverter<SI_CONVERTER>::value) {
+    rc = LoadData(pMap, uSize);
+    SI_Internal::UnmapFile(pMap, uSize);
+    return rc;
   }
 
-  if (a_uDataLen == 0) {
-    return SI_OK;
+  // parse directly out of the copy-on-write mapping
+  const char *pText = pMap;
+  size_t uLen = uSize;
+  SkipUtf8Signature(pText, uLen);
+  DataOwner owner = {pMap, uSize, &SI_Internal::UnmapFile};
+  return LoadBuffer(reinterpret_cast<SI_CHAR *>(const_cast<char *>(pText)),
+                    uLen, owner);
+}
+#endif // SI_SUPPORT_MMAP
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
+    std::string &&a_strData) {
+  if (!SI_IsIdentityConverter<SI_CONVERTER>::value) {
+    return LoadData(a_strData.data(), a_strData.size());
   }
 
-  // determine the length of the converted data
-  SI_CONVERTER converter(m_bStoreIsUtf8);
+  std::string *pOwner = new (std::nothrow) std::string(std::move(a_strData));
+  if (!pOwner) {
+    return SI_NOMEM;
+  }
+
+  // std::string is always NUL terminated so it can be parsed in place
+  const char *pText = &(*pOwner)[0];
+  size_t uLen = pOwner->size();
+  SkipUtf8Signature(pText, uLen);
+  DataOwner owner = {pOwner, 0, &SI_Internal::DeleteStdString};
+  return LoadBuffer(reinterpret_cast<SI_CHAR *>(const_cast<char *>(pText)),
+                    uLen, owner);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
+    std::unique_ptr<char[]> a_pData, size_t a_uDataLen, size_t a_uBufferSize) {
+  if (!a_pData) {
+    return SI_OK;
+  }
+  // there must be room for the terminator
+  if (a_uBufferSize <= a_uDataLen) {
+    return SI_FAIL;
+  }
+  a_pData[a_uDataLen] = 0;
+  if (!SI_IsIdentityConverter<SI_CONVERTER>::value) {
+    return LoadData(a_pData.get(), a_uDataLen);
+  }
+
+  const char *pText = a_pData.get();
+  size_t uLen = a_uDataLen;
+  SkipUtf8Signature(pText, uLen);
+  DataOwner owner = {a_pData.release(), a_uBufferSize,
+                     &SI_Internal::DeleteCharArray};
+  return LoadBuffer(reinterpret_cast<SI_CHAR *>(const_cast<char *>(pText)),
+                    uLen, owner);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SkipUtf8Signature(
+    const char *&a_pData, size_t &a_uDataLen) {
+  // if the UTF-8 BOM exists, consume it and set mode to unicode, if we have
+  // already loaded data and try to change mode half-way through then this will
+  // be ignored and we will assert in debug versions
+  if (a_uDataLen >= 3 && memcmp(a_pData, SI_UTF8_SIGNATURE, 3) == 0) {
+    a_pData += 3;
+    a_uDataLen -= 3;
+    SI_ASSERT(m_bStoreIsUtf8 || !m_pData); // we don't expect mixed mode data
+    SetUnicode();
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
+    const char *a_pData, size_t a_uDataLen) {
+  if (!a_pData) {
+    return SI_OK;
+  }
+
+  SkipUtf8Signature(a_pData, a_uDataLen);
+
+  if (a_uDataLen == 0) {
+    return SI_OK;
+  }
+
+  // determine the length of the converted data
+  SI_CONVERTER converter(m_bStoreIsUtf8);
   size_t uLen = converter.SizeFromStore(a_pData, a_uDataLen);
   if (uLen == (size_t)(-1)) {
     return SI_FAIL;
@@ -1504,6 +4165,19 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
     return SI_FAIL;
   }
 
+  return LoadBuffer(pData, uLen, DataOwner());
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadBuffer(
+    SI_CHAR *a_pData, size_t a_uLen, const DataOwner &a_owner) {
+  if (a_uLen == 0 || a_uLen >= (SI_MAX_FILE_SIZE / sizeof(SI_CHAR))) {
+    ReleaseData(a_pData, a_owner);
+    return a_uLen ? SI_FILE : SI_OK;
+  }
+  SI_CHAR *pData = a_pData;
+  size_t uLen = a_uLen;
+
   // parse it
   const static SI_CHAR empty = 0;
   SI_CHAR *pWork = pData;
@@ -1521,29 +4195,58 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
   TNamesDepend oAddedSections;
   TNamesDepend oAddedKeys;
   if (bCopyStrings) {
-    nStringsBefore = m_strings.size();
+    nStringsBefore = m_strings.Mark();
     pFileCommentBefore = m_pFileComment;
   }
 
   // find a file comment if it exists, this is a comment that starts at the
   // beginning of the file and continues until the first blank line.
-  SI_Error rc = FindFileComment(pWork, bCopyStrings);
+  SI_Error rc = FindFileComment(pWork, pData + uLen, bCopyStrings);
   if (rc < 0) {
-    delete[] pData;
+    ReleaseData(pData, a_owner);
     if (bCopyStrings) {
       m_pFileComment = pFileCommentBefore;
-      while (m_strings.size() > nStringsBefore) {
-        delete[] const_cast<SI_CHAR *>(m_strings.back().pItem);
-        m_strings.pop_back();
-      }
+      m_strings.Rollback(nStringsBefore);
     } else {
       m_pFileComment = NULL;
     }
     return rc;
   }
 
+  // only find the sections now if the keys can be parsed from this buffer
+  // when they are needed
+  if (m_bLazyLoad && !bCopyStrings && IndexSections(pWork, pData + uLen)) {
+    m_pData = pData;
+    m_uDataLen = uLen + 1;
+    m_dataOwner = a_owner;
+    return SI_OK;
+  }
+
+  // find the entries using multiple threads if that is enabled
+  TParsedEntries oParsed;
+  const bool bParallel =
+      m_pfnParseParallel &&
+      (this->*m_pfnParseParallel)(pWork, pData + uLen, oParsed);
+  size_t uParsed = 0;
+
   // add every entry in the file to the data table
-  while (FindEntry(pWork, pSection, pItem, pVal, pComment)) {
+  for (;;) {
+    if (bParallel) {
+      if (uParsed == oParsed.size()) {
+        break;
+      }
+      const ParsedEntry &oEntry = oParsed[uParsed++];
+      if (oEntry.pSection) {
+        pSection = oEntry.pSection;
+      }
+      pItem = oEntry.pKey;
+      pVal = oEntry.pVal;
+      pComment = oEntry.pComment;
+    } else if (!FindEntry(pWork, pData + uLen, pSection, pItem, pVal,
+                          pComment)) {
+      break;
+    }
+
     bool bSectionExisted = SectionExists(pSection);
     bool bKeyExisted = pItem && bSectionExisted && KeyExists(pSection, pItem);
 
@@ -1552,16 +4255,21 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
       if (bCopyStrings) {
         m_pFileComment = pFileCommentBefore;
         UndoIncrementalLoadData(oAddedSections, oAddedKeys);
-        while (m_strings.size() > nStringsBefore) {
-          delete[] const_cast<SI_CHAR *>(m_strings.back().pItem);
-          m_strings.pop_back();
-        }
+        m_strings.Rollback(nStringsBefore);
       } else {
         m_data.clear();
+        m_pLastSection = NULL;
+        m_uKeys = 0;
+        m_uSaveBytes = 0;
+        m_uPaddedValues = 0;
+        m_sectionIndex.Clear();
+        m_keyIndex.Clear();
+        m_valueCache.Clear();
         m_pFileComment = NULL;
         m_nOrder = 0;
+        UnbindKeySlots(NULL);
       }
-      delete[] pData;
+      ReleaseData(pData, a_owner);
       return rc;
     }
 
@@ -1577,12 +4285,297 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
 
   // store these strings if we didn't copy them
   if (bCopyStrings) {
-    delete[] pData;
+    ReleaseData(pData, a_owner);
   } else {
     m_pData = pData;
     m_uDataLen = uLen + 1;
+    m_dataOwner = a_owner;
+  }
+
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::BeginLoad() {
+  if (m_pStream) {
+    return SI_FAIL;
+  }
+  m_pStream = new (std::nothrow) StreamState();
+  if (!m_pStream) {
+    return SI_NOMEM;
+  }
+
+  const static SI_CHAR empty = 0;
+  m_pStream->pSection = &empty;
+  m_pStream->uTotal = 0;
+  m_pStream->uParsedSize = 0;
+  m_pStream->bSignatureChecked = false;
+  m_pStream->bFileCommentDone = false;
+  m_pStream->bStartedEmpty = m_data.empty() && !m_pFileComment;
+  m_pStream->pFileCommentBefore = m_pFileComment;
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Feed(
+    const char *a_pData, size_t a_uDataLen) {
+  if (!m_pStream) {
+    return SI_FAIL;
+  }
+  if (!a_pData || a_uDataLen == 0) {
+    return SI_OK;
+  }
+  StreamState &state = *m_pStream;
+
+  if (memchr(a_pData, 0, a_uDataLen)) {
+    CancelLoad();
+    return SI_FAIL;
+  }
+  if (a_uDataLen > SI_MAX_FILE_SIZE - state.uTotal) {
+    CancelLoad();
+    return SI_FILE;
+  }
+  state.uTotal += a_uDataLen;
+
+  // only complete lines are converted and parsed, the remainder of the
+  // last line waits for the next chunk
+  const char *pEnd = a_pData + a_uDataLen;
+  const char *pLineEnd = pEnd;
+  while (pLineEnd > a_pData && pLineEnd[-1] != '\n') {
+    --pLineEnd;
+  }
+  if (pLineEnd == a_pData) {
+    state.raw.append(a_pData, a_uDataLen);
+    return SI_OK;
+  }
+
+  SI_Error rc;
+  if (state.raw.empty()) {
+    rc = AppendStreamData(a_pData, (size_t)(pLineEnd - a_pData));
+  } else {
+    state.raw.append(a_pData, (size_t)(pLineEnd - a_pData));
+    rc = AppendStreamData(state.raw.data(), state.raw.size());
+  }
+  state.raw.assign(pLineEnd, (size_t)(pEnd - pLineEnd));
+
+  if (rc >= 0) {
+    rc = ParseStream(false);
+  }
+  if (rc < 0) {
+    CancelLoad();
+  }
+  return rc;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::EndLoad() {
+  if (!m_pStream) {
+    return SI_FAIL;
+  }
+
+  SI_Error rc = AppendStreamData(m_pStream->raw.data(), m_pStream->raw.size());
+  if (rc >= 0) {
+    rc = ParseStream(true);
+  }
+  if (rc < 0) {
+    CancelLoad();
+    return rc;
+  }
+
+  delete m_pStream;
+  m_pStream = NULL;
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CancelLoad() {
+  if (!m_pStream) {
+    return;
+  }
+  if (m_pStream->bStartedEmpty) {
+    Reset();
+    return;
+  }
+
+  // Delete() frees the stored key name while still comparing against it,
+  // so remove each added key using a copy of the name
+  std::vector<SI_CHAR> name;
+  typename TNamesDepend::const_iterator iKey = m_pStream->oAddedKeys.begin();
+  for (; iKey != m_pStream->oAddedKeys.end(); ++iKey) {
+    size_t uLen = 0;
+    while (iKey->pItem[uLen]) {
+      ++uLen;
+    }
+    name.assign(iKey->pItem, iKey->pItem + uLen + 1);
+    Delete(iKey->pComment, &name[0], false);
+  }
+  typename TNamesDepend::const_iterator iSection =
+      m_pStream->oAddedSections.begin();
+  for (; iSection != m_pStream->oAddedSections.end(); ++iSection) {
+    Delete(iSection->pItem, NULL, false);
+  }
+
+  if (m_pFileComment != m_pStream->pFileCommentBefore) {
+    DeleteString(m_pFileComment);
+    m_pFileComment = m_pStream->pFileCommentBefore;
+  }
+  delete m_pStream;
+  m_pStream = NULL;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::AppendStreamData(
+    const char *a_pData, size_t a_uDataLen) {
+  StreamState &state = *m_pStream;
+  if (!state.bSignatureChecked && a_uDataLen > 0) {
+    SkipUtf8Signature(a_pData, a_uDataLen);
+    state.bSignatureChecked = true;
+  }
+  if (a_uDataLen == 0) {
+    return SI_OK;
+  }
+
+  SI_CONVERTER converter(m_bStoreIsUtf8);
+  size_t uLen = converter.SizeFromStore(a_pData, a_uDataLen);
+  if (uLen == (size_t)(-1)) {
+    return SI_FAIL;
+  }
+  size_t uOffset = state.pending.size();
+  state.pending.resize(uOffset + uLen);
+  if (!converter.ConvertFromStore(a_pData, a_uDataLen, &state.pending[uOffset],
+                                  uLen)) {
+    return SI_FAIL;
+  }
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseStream(
+    bool a_bFinal) {
+  StreamState &state = *m_pStream;
+  if (state.pending.empty()) {
+    return SI_OK;
+  }
+
+  // the last entry is parsed again when more data arrives in case it is
+  // incomplete. Wait for the pending text to double so that long multi-line
+  // values arriving in small chunks are not scanned over and over.
+  if (!a_bFinal && state.pending.size() < 2 * state.uParsedSize) {
+    return SI_OK;
+  }
+
+  // the parser modifies the text so work on a copy, the pending text for
+  // the last entry must be kept unchanged
+  state.work.assign(state.pending.begin(), state.pending.end());
+  state.work.push_back(0);
+  SI_CHAR *pData = &state.work[0];
+  const SI_CHAR *pDataEnd = pData + state.pending.size();
+  SI_CHAR *pWork = pData;
+  SI_CHAR *pDone = pData;
+  SI_Error rc;
+
+  // the file comment ends at the first line that isn't a comment. If we
+  // reach the end of the data first then it may continue in the next chunk.
+  if (!state.bFileCommentDone) {
+    const SI_CHAR *pFileCommentBefore = m_pFileComment;
+    FindFileComment(pWork, pDataEnd, false);
+    if (m_pFileComment != pFileCommentBefore) {
+      if (!*pWork && !a_bFinal) {
+        m_pFileComment = pFileCommentBefore;
+        state.uParsedSize = state.pending.size();
+        return SI_OK;
+      }
+      rc = CopyString(m_pFileComment);
+      if (rc < 0) {
+        m_pFileComment = pFileCommentBefore;
+        return rc;
+      }
+    }
+    state.bFileCommentDone = true;
+    pDone = pWork;
+  }
+
+  // each entry is added when the next one is found, as only then is it
+  // known to be complete
+  const SI_CHAR *pSection = state.pSection;
+  const SI_CHAR *pItem = NULL;
+  const SI_CHAR *pVal = NULL;
+  const SI_CHAR *pComment = NULL;
+  const SI_CHAR *pLastSection = NULL;
+  const SI_CHAR *pLastItem = NULL;
+  const SI_CHAR *pLastVal = NULL;
+  const SI_CHAR *pLastComment = NULL;
+  bool bHaveLast = false;
+  for (;;) {
+    SI_CHAR *pEntry = pWork;
+    if (!FindEntry(pWork, pDataEnd, pSection, pItem, pVal, pComment)) {
+      break;
+    }
+    if (bHaveLast) {
+      rc = AddStreamEntry(pLastSection, pLastItem, pLastVal, pLastComment);
+      if (rc < 0) {
+        return rc;
+      }
+      pDone = pEntry;
+    }
+    pLastSection = pSection;
+    pLastItem = pItem;
+    pLastVal = pVal;
+    pLastComment = pComment;
+    bHaveLast = true;
+  }
+
+  if (a_bFinal) {
+    if (bHaveLast) {
+      rc = AddStreamEntry(pLastSection, pLastItem, pLastVal, pLastComment);
+      if (rc < 0) {
+        return rc;
+      }
+    }
+    state.pending.clear();
+    state.work.clear();
+    return SI_OK;
+  }
+
+  state.pending.erase(state.pending.begin(),
+                      state.pending.begin() + (pDone - pData));
+  state.uParsedSize = state.pending.size();
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::AddStreamEntry(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pVal,
+    const SI_CHAR *a_pComment) {
+  StreamState &state = *m_pStream;
+
+  // remember what was added so that it can be removed by CancelLoad()
+  bool bSectionExisted = true;
+  bool bKeyExisted = true;
+  if (!state.bStartedEmpty) {
+    bSectionExisted = SectionExists(a_pSection);
+    bKeyExisted = a_pKey && bSectionExisted && KeyExists(a_pSection, a_pKey);
+  }
+
+  SI_Error rc = AddEntry(a_pSection, a_pKey, a_pVal, a_pComment, false, true);
+  if (rc < 0) {
+    return rc;
   }
 
+  // the section name may point into the parse buffer, keep the stored copy
+  // for the next chunk
+  if (a_pSection != state.pSection) {
+    typename TSection::const_iterator iSection = m_data.find(a_pSection);
+    state.pSection = iSection->first.pItem;
+    if (!bSectionExisted && *a_pSection) {
+      state.oAddedSections.push_back(Entry(state.pSection, NULL, 0));
+    }
+  }
+  if (a_pKey && !bKeyExisted) {
+    typename TSection::const_iterator iSection = m_data.find(a_pSection);
+    typename TKeyVal::const_iterator iKey = iSection->second.find(a_pKey);
+    state.oAddedKeys.push_back(Entry(iKey->first.pItem, state.pSection, 0));
+  }
   return SI_OK;
 }
 
@@ -1590,27 +4583,98 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
     std::istream &a_istream) {
-  std::string strData;
+  SI_Error rc = BeginLoad();
+  if (rc < 0) {
+    return rc;
+  }
   char buf[4096];
   while (a_istream.read(buf, sizeof(buf)) || a_istream.gcount() > 0) {
-    const std::streamsize nRead = a_istream.gcount();
-    for (std::streamsize i = 0; i < nRead; ++i) {
-      if (buf[i] == '\0') {
-        return SI_FAIL;
+    rc = Feed(buf, static_cast<size_t>(a_istream.gcount()));
+    if (rc < 0) {
+      return rc;
+    }
+  }
+  return EndLoad();
+}
+#endif // SI_SUPPORT_IOSTREAMS
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Parse(
+    const char *a_pData, size_t a_uDataLen, Visitor &a_visitor) const {
+  if (!a_pData) {
+    return SI_OK;
+  }
+
+  // a UTF-8 signature only applies to this data
+  bool bIsUtf8 = m_bStoreIsUtf8;
+  if (a_uDataLen >= 3 && memcmp(a_pData, SI_UTF8_SIGNATURE, 3) == 0) {
+    a_pData += 3;
+    a_uDataLen -= 3;
+    bIsUtf8 = true;
+  }
+  if (a_uDataLen == 0) {
+    return SI_OK;
+  }
+
+  // convert the data into a working copy as the parser modifies it
+  SI_CONVERTER converter(bIsUtf8);
+  size_t uLen = converter.SizeFromStore(a_pData, a_uDataLen);
+  if (uLen == (size_t)(-1)) {
+    return SI_FAIL;
+  }
+  if (uLen >= (SI_MAX_FILE_SIZE / sizeof(SI_CHAR))) {
+    return SI_FILE;
+  }
+  SI_CHAR *pData = new (std::nothrow) SI_CHAR[uLen + 1];
+  if (!pData) {
+    return SI_NOMEM;
+  }
+  memset(pData, 0, sizeof(SI_CHAR) * (uLen + 1));
+  if (!converter.ConvertFromStore(a_pData, a_uDataLen, pData, uLen)) {
+    delete[] pData;
+    return SI_FAIL;
+  }
+
+  // the file comment is the same as FindFileComment() would find
+  const static SI_CHAR empty = 0;
+  SI_CHAR *pWork = pData;
+  const SI_CHAR *pDataEnd = pData + uLen;
+  const SI_CHAR *pSection = &empty;
+  const SI_CHAR *pItem = NULL;
+  const SI_CHAR *pVal = NULL;
+  const SI_CHAR *pComment = NULL;
+  bool bContinue = true;
+  if (LoadMultiLineText(pWork, pDataEnd, pComment, NULL, false)) {
+    bContinue = a_visitor.OnComment(pComment);
+  }
+
+  while (bContinue &&
+         FindEntry(pWork, pDataEnd, pSection, pItem, pVal, pComment)) {
+    if (pComment) {
+      bContinue = a_visitor.OnComment(pComment);
+      if (!bContinue) {
+        break;
       }
     }
-    if (strData.size() + static_cast<size_t>(nRead) > SI_MAX_FILE_SIZE) {
-      return SI_FILE;
+    if (pItem) {
+      bContinue = a_visitor.OnKey(pSection, pItem, pVal ? pVal : &empty);
+    } else {
+      bContinue = a_visitor.OnSection(pSection);
     }
-    strData.append(buf, static_cast<size_t>(nRead));
   }
-  return LoadData(strData.data(), strData.size());
+
+  // a comment that isn't followed by an entry
+  if (bContinue && pComment) {
+    a_visitor.OnComment(pComment);
+  }
+
+  delete[] pData;
+  return SI_OK;
 }
-#endif // SI_SUPPORT_IOSTREAMS
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindFileComment(
-    SI_CHAR *&a_pData, bool a_bCopyStrings) {
+    SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd, bool a_bCopyStrings) {
   // there can only be a single file comment
   if (m_pFileComment) {
     return SI_OK;
@@ -1618,7 +4682,7 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindFileComment(
 
   // Load the file comment as multi-line text, this will modify all of
   // the newline characters to be single \n chars
-  if (!LoadMultiLineText(a_pData, m_pFileComment, NULL, false)) {
+  if (!LoadMultiLineText(a_pData, a_pDataEnd, m_pFileComment, NULL, false)) {
     return SI_OK;
   }
 
@@ -1634,8 +4698,9 @@ SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindFileComment(
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
 bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
-    SI_CHAR *&a_pData, const SI_CHAR *&a_pSection, const SI_CHAR *&a_pKey,
-    const SI_CHAR *&a_pVal, const SI_CHAR *&a_pComment) const {
+    SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd, const SI_CHAR *&a_pSection,
+    const SI_CHAR *&a_pKey, const SI_CHAR *&a_pVal, const SI_CHAR *&a_pComment,
+    bool *a_pbTruncated) const {
   a_pComment = NULL;
 
   bool bHaveValue = false;
@@ -1652,7 +4717,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
     // skip processing of comment lines but keep a pointer to
     // the start of the comment.
     if (IsComment(*a_pData)) {
-      LoadMultiLineText(a_pData, a_pComment, NULL, true);
+      LoadMultiLineText(a_pData, a_pDataEnd, a_pComment, NULL, true);
       continue;
     }
 
@@ -1667,9 +4732,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
       // find the end of the section name (it may contain spaces)
       // and convert it to lowercase as necessary
       a_pSection = a_pData;
-      while (*a_pData && *a_pData != ']' && !IsNewLineChar(*a_pData)) {
-        ++a_pData;
-      }
+      a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR(']'));
 
       // if it's an invalid line, just skip it
       if (*a_pData != ']') {
@@ -1686,9 +4749,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
 
       // skip to the end of the line
       ++a_pData; // safe as checked that it == ']' above
-      while (*a_pData && !IsNewLineChar(*a_pData)) {
-        ++a_pData;
-      }
+      a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('\n'));
 
       a_pKey = NULL;
       a_pVal = NULL;
@@ -1697,9 +4758,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
 
     // find the end of the key name (it may contain spaces)
     a_pKey = a_pData;
-    while (*a_pData && *a_pData != '=' && !IsNewLineChar(*a_pData)) {
-      ++a_pData;
-    }
+    a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('='));
     // *a_pData is null, equals, or newline
 
     // if no value and we don't allow no value, then invalid
@@ -1710,9 +4769,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
 
     // empty keys are invalid
     if (bHaveValue && a_pKey == a_pData) {
-      while (*a_pData && !IsNewLineChar(*a_pData)) {
-        ++a_pData;
-      }
+      a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('\n'));
       continue;
     }
 
@@ -1735,9 +4792,7 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
 
       // find the end of the value which is the end of this line
       a_pVal = a_pData;
-      while (*a_pData && !IsNewLineChar(*a_pData)) {
-        ++a_pData;
-      }
+      a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('\n'));
 
       // remove trailing spaces from the value
       pTrail = a_pData - 1;
@@ -1754,7 +4809,8 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
       if (m_bAllowMultiLine && IsMultiLineTag(a_pVal)) {
         // skip the "<<<" to get the tag that will end the multiline
         const SI_CHAR *pTagName = a_pVal + 3;
-        return LoadMultiLineText(a_pData, a_pVal, pTagName);
+        return LoadMultiLineText(a_pData, a_pDataEnd, a_pVal, pTagName, false,
+                                 a_pbTruncated);
       }
 
       // check for quoted values, we are not supporting escapes in quoted values (yet)
@@ -1771,6 +4827,9 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
         SkipNewLine(a_pData);
       }
       *pTrail = 0;
+
+      // a key-only entry has no value, not the value of the entry before
+      a_pVal = NULL;
     }
 
     // return the standard entry
@@ -1781,1048 +4840,2671 @@ bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindEntry(
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsMultiLineTag(
-    const SI_CHAR *a_pVal) const {
-  // check for the "<<<" prefix for a multi-line entry
-  if (*a_pVal++ != '<')
-    return false;
-  if (*a_pVal++ != '<')
-    return false;
-  if (*a_pVal++ != '<')
-    return false;
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IndexSections(
+    SI_CHAR *a_pData, SI_CHAR *a_pDataEnd) {
+  // Find the section headers in the same way as FindEntry() but without
+  // modifying the data, so that it can still be parsed normally if it
+  // turns out that it can't be indexed. Each header is recorded with the
+  // start of the comments before it as they belong to the section.
+  std::vector<SI_CHAR *> oHeaders;
+  SI_CHAR *pPendingComment = NULL;
+  SI_CHAR *p = a_pData;
+  while (*p) {
+    // skip spaces and empty lines
+    while (*p && IsSpace(*p)) {
+      ++p;
+    }
+    if (!*p) {
+      break;
+    }
+    SI_CHAR *pLine = p;
+
+    // comments are attached to the next entry
+    if (IsComment(*p)) {
+      if (!pPendingComment) {
+        pPendingComment = p;
+      }
+      p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR('\n'));
+      continue;
+    }
+
+    // section names
+    if (*p == '[') {
+      ++p;
+      while (*p && IsSpace(*p)) {
+        ++p;
+      }
+      p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR(']'));
+
+      // FindEntry() uses the text of an invalid section line as the
+      // section of the keys that follow it, which can't be indexed
+      if (*p != ']') {
+        return false;
+      }
+      oHeaders.push_back(pPendingComment ? pPendingComment : pLine);
+      pPendingComment = NULL;
+      p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR('\n'));
+      continue;
+    }
+
+    // keys, only the invalid ones keep the pending comment
+    p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR('='));
+    const bool bHaveValue = (*p == '=');
+    if (!bHaveValue && !m_bAllowKeyOnly) {
+      continue;
+    }
+    if (bHaveValue && p == pLine) {
+      p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR('\n'));
+      continue;
+    }
+    pPendingComment = NULL;
+    if (!bHaveValue) {
+      continue;
+    }
+
+    // skip the value, which may span multiple lines
+    ++p;
+    while (*p && !IsNewLineChar(*p) && IsSpace(*p)) {
+      ++p;
+    }
+    SI_CHAR *pVal = p;
+    p = SI_Internal::ScanLine(p, a_pDataEnd, SI_CHAR('\n'));
+    if (m_bAllowMultiLine && IsMultiLineTag(pVal)) {
+      p = SkipMultiLineValue(pVal, p, a_pDataEnd);
+      if (!p) {
+        return false;
+      }
+    }
+  }
+
+  // The keys before the first section header are added now. The keys of
+  // each section are left in place, terminated before the next header.
+  const static SI_CHAR empty = 0;
+  const SI_CHAR *pSection = &empty;
+  const SI_CHAR *pItem = NULL;
+  const SI_CHAR *pVal = NULL;
+  const SI_CHAR *pComment = NULL;
+  SI_CHAR *pBody = a_pData;
+  for (size_t n = 0;; ++n) {
+    SI_CHAR *pBodyEnd = a_pDataEnd;
+    if (n < oHeaders.size()) {
+      pBodyEnd = oHeaders[n];
+      if (pBodyEnd > pBody) {
+        *--pBodyEnd = 0;
+      }
+    }
+    if (pBodyEnd <= pBody) {
+      // nothing before this header
+    } else if (n == 0) {
+      while (FindEntry(pBody, pBodyEnd, pSection, pItem, pVal, pComment)) {
+        AddEntry(pSection, pItem, pVal, pComment, false, false);
+      }
+    } else {
+      LazyRange oRange = {pBody, pBodyEnd, 0};
+      m_lazyRanges.push_back(oRange);
+      const size_t uRange = m_lazyRanges.size() - 1;
+      std::pair<typename TLazySections::iterator, bool> i =
+          m_lazySections.insert(std::make_pair(pSection, uRange));
+      if (!i.second) {
+        // the section header is repeated, append to the list of ranges
+        size_t uLast = i.first->second;
+        while (m_lazyRanges[uLast].uNext) {
+          uLast = m_lazyRanges[uLast].uNext;
+        }
+        m_lazyRanges[uLast].uNext = uRange;
+      }
+    }
+    if (n == oHeaders.size()) {
+      break;
+    }
+
+    // add the section with its comment
+    pBody = oHeaders[n];
+    FindEntry(pBody, a_pDataEnd, pSection, pItem, pVal, pComment);
+    SI_ASSERT(!pItem);
+    typename TSection::iterator iSection = m_data.find(pSection);
+    if (iSection == m_data.end()) {
+      AddEntry(pSection, NULL, NULL, pComment, false, false);
+      iSection = m_data.find(pSection);
+    }
+    pSection = iSection->first.pItem;
+  }
+
   return true;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsMultiLineData(
-    const SI_CHAR *a_pData) const {
-  // data is multi-line if it has any of the following features:
-  //  * whitespace prefix
-  //  * embedded newlines
-  //  * whitespace suffix
+SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SkipMultiLineValue(
+    SI_CHAR *a_pVal, SI_CHAR *a_pData, const SI_CHAR *a_pDataEnd) {
+  // the tag is the value after "<<<" without trailing whitespace, it is
+  // terminated while searching for it
+  SI_CHAR *pTagEnd = a_pData - 1;
+  while (pTagEnd >= a_pVal && IsSpace(*pTagEnd)) {
+    --pTagEnd;
+  }
+  ++pTagEnd;
+  if (*a_pData) {
+    SkipNewLine(a_pData);
+  }
+  const SI_CHAR cTagEnd = *pTagEnd;
+  *pTagEnd = 0;
+  const SI_CHAR *pTagName = a_pVal + 3;
+
+  // LoadMultiLineText() ignores the whitespace at the end of a line when
+  // comparing it with the tag, but only until a line has been moved to
+  // remove a '\r' from the line ending before it.
+  bool bMoved = false;
+  const SI_CHAR *pValue = a_pData;
+  SI_CHAR *pLine = a_pData;
+  bool bTag = false;
+  for (;;) {
+    pLine = a_pData;
+    a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('\n'));
+    SI_CHAR *pc = a_pData;
+    if (!bMoved) {
+      for (--pc; pc > pLine && IsSpace(*pc); --pc) {
+      }
+      ++pc;
+    }
+    const SI_CHAR ch = *pc;
+    *pc = 0;
+    bTag = !IsLess(pLine, pTagName) && !IsLess(pTagName, pLine);
+    *pc = ch;
+    if (bTag || !*a_pData) {
+      break;
+    }
+    SI_CHAR *pNewLine = a_pData;
+    SkipNewLine(a_pData);
+    bMoved = bMoved || (a_pData - pNewLine > 1);
+  }
+  *pTagEnd = cTagEnd;
 
-  // empty string
-  if (!*a_pData) {
-    return false;
+  // an empty value ends the parsing, and the tag on the first line leaves
+  // the rest of the data in the value until a later entry terminates it
+  if (bTag && pLine == pValue) {
+    return NULL;
+  }
+  if (*a_pData) {
+    SkipNewLine(a_pData);
   }
+  return a_pData;
+}
 
-  // check for prefix
-  if (IsSpace(*a_pData)) {
-    return true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadLazySection(
+    typename TSection::iterator a_iSection) {
+  typename TLazySections::iterator iLazy =
+      m_lazySections.find(a_iSection->first.pItem);
+  if (iLazy == m_lazySections.end()) {
+    return;
   }
+  size_t uRange = iLazy->second;
+  m_lazySections.erase(iLazy);
 
-  // embedded newlines
-  const SI_CHAR *pStart = a_pData;
-  while (*a_pData) {
-    if (IsNewLineChar(*a_pData)) {
-      return true;
+  // the strings stay in m_pData so adding the keys can't fail
+  const SI_CHAR *pSection = a_iSection->first.pItem;
+  const SI_CHAR *pItem = NULL;
+  const SI_CHAR *pVal = NULL;
+  const SI_CHAR *pComment = NULL;
+  for (;;) {
+    const LazyRange &oRange = m_lazyRanges[uRange];
+    SI_CHAR *pWork = oRange.pStart;
+    while (FindEntry(pWork, oRange.pEnd, pSection, pItem, pVal, pComment)) {
+      SI_ASSERT(pItem);
+      AddEntry(pSection, pItem, pVal, pComment, false, false);
     }
-    ++a_pData;
+    if (!oRange.uNext) {
+      break;
+    }
+    uRange = oRange.uNext;
   }
 
-  // check for suffix (ensure we don't go before start of string)
-  if (a_pData > pStart && IsSpace(*(a_pData - 1))) {
-    return true;
+  if (m_lazySections.empty()) {
+    std::vector<LazyRange>().swap(m_lazyRanges);
   }
-
-  return false;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::
-    IsSingleLineQuotedValue(const SI_CHAR *a_pData) const {
-  // data needs quoting if it starts or ends with whitespace
-  // and doesn't have embedded newlines
-
-  // empty string
-  if (!*a_pData) {
-    return false;
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadLazySections()
+    const {
+  CSimpleIniTempl *pThis = const_cast<CSimpleIniTempl *>(this);
+  typename TSection::iterator iSection = pThis->m_data.begin();
+  for (; !m_lazySections.empty() && iSection != pThis->m_data.end();
+       ++iSection) {
+    pThis->LoadLazySection(iSection);
   }
+}
 
-  // check for prefix
-  if (IsSpace(*a_pData)) {
-    return true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+template <class TNode>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LinkLoaded(
+    const void *&a_pLast, const void *a_pAfter, const TNode *a_pNode) {
+  const Entry &oNode = a_pNode->first;
+  if (!a_pLast) {
+    oNode.pPrevLoaded = a_pNode;
+    oNode.pNextLoaded = a_pNode;
+    a_pLast = a_pNode;
+    return;
   }
 
-  // embedded newlines
-  const SI_CHAR *pStart = a_pData;
-  while (*a_pData) {
-    if (IsNewLineChar(*a_pData)) {
-      return false;
-    }
-    ++a_pData;
+  // the first node of a circular list follows the last one
+  const TNode *pPrev =
+      static_cast<const TNode *>(a_pAfter ? a_pAfter : a_pLast);
+  const TNode *pNext = static_cast<const TNode *>(pPrev->first.pNextLoaded);
+  oNode.pPrevLoaded = pPrev;
+  oNode.pNextLoaded = pNext;
+  pPrev->first.pNextLoaded = a_pNode;
+  pNext->first.pPrevLoaded = a_pNode;
+  if (a_pAfter == a_pLast) {
+    a_pLast = a_pNode;
   }
+}
 
-  // check for suffix (ensure we don't go before start of string)
-  if (a_pData > pStart && IsSpace(*(a_pData - 1))) {
-    return true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+template <class TNode>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::UnlinkLoaded(
+    const void *&a_pLast, const TNode *a_pNode) {
+  const Entry &oNode = a_pNode->first;
+  if (oNode.pNextLoaded == a_pNode) {
+    a_pLast = NULL;
+    return;
+  }
+  const TNode *pPrev = static_cast<const TNode *>(oNode.pPrevLoaded);
+  const TNode *pNext = static_cast<const TNode *>(oNode.pNextLoaded);
+  pPrev->first.pNextLoaded = pNext;
+  pNext->first.pPrevLoaded = pPrev;
+  if (a_pLast == a_pNode) {
+    a_pLast = pPrev;
   }
-
-  return false;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsNewLineChar(
-    SI_CHAR a_c) const {
-  return (a_c == '\n' || a_c == '\r');
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LinkKey(
+    const TSectionNode &a_section, typename TKeyVal::iterator a_iKey,
+    const void *a_pAfter) {
+  const TKeyNode *pNode = &*a_iKey;
+  LinkLoaded(a_section.first.pLastKey, a_pAfter, pNode);
+
+  // the values of a key are next to each other in the map
+  const TKeyVal &keyval = a_section.second;
+  const Entry &oKey = a_iKey->first;
+  oKey.pNextValue = NULL;
+  oKey.bFirstValue = true;
+  typename TKeyVal::iterator iNext = a_iKey;
+  if (++iNext != keyval.end() && iNext->first.IsSameName(oKey)) {
+    oKey.pNextValue = &*iNext;
+    iNext->first.bFirstValue = false;
+  }
+  if (a_iKey != keyval.begin()) {
+    typename TKeyVal::iterator iPrev = a_iKey;
+    if ((--iPrev)->first.IsSameName(oKey)) {
+      iPrev->first.pNextValue = pNode;
+      oKey.bFirstValue = false;
+    }
+  }
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadMultiLineText(
-    SI_CHAR *&a_pData, const SI_CHAR *&a_pVal, const SI_CHAR *a_pTagName,
-    bool a_bAllowBlankLinesInComment) const {
-  // we modify this data to strip all newlines down to a single '\n'
-  // character. This means that on Windows we need to strip out some
-  // characters which will make the data shorter.
-  // i.e.  LINE1-LINE1\r\nLINE2-LINE2\0 will become
-  //       LINE1-LINE1\nLINE2-LINE2\0
-  // The pDataLine entry is the pointer to the location in memory that
-  // the current line needs to start to run following the existing one.
-  // This may be the same as pCurrLine in which case no move is needed.
-  SI_CHAR *pDataLine = a_pData;
-  SI_CHAR *pCurrLine;
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::UnlinkKey(
+    const TSectionNode &a_section, typename TKeyVal::iterator a_iKey) {
+  UnlinkLoaded(a_section.first.pLastKey, &*a_iKey);
 
-  // value starts at the current line
-  a_pVal = a_pData;
+  const Entry &oKey = a_iKey->first;
+  if (!oKey.bFirstValue) {
+    typename TKeyVal::iterator iPrev = a_iKey;
+    (--iPrev)->first.pNextValue = oKey.pNextValue;
+  } else if (oKey.pNextValue) {
+    NextValue(&*a_iKey)->first.bFirstValue = true;
+  }
+}
 
-  // find the end tag. This tag must start in column 1 and be
-  // followed by a newline. We ignore any whitespace after the end
-  // tag but not whitespace before it.
-  SI_CHAR cEndOfLineChar = *a_pData;
-  for (;;) {
-    // if we are loading comments then we need a comment character as
-    // the first character on every line
-    if (!a_pTagName && !IsComment(*a_pData)) {
-      // if we aren't allowing blank lines then we're done
-      if (!a_bAllowBlankLinesInComment) {
-        break;
-      }
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::RebuildLoadOrder() {
+  struct LoadedBefore {
+    bool operator()(const TSectionNode *a_pLeft,
+                    const TSectionNode *a_pRight) const {
+      typename Entry::LoadOrder isLess;
+      return isLess(a_pLeft->first, a_pRight->first);
+    }
+    bool operator()(const TKeyNode *a_pLeft, const TKeyNode *a_pRight) const {
+      typename Entry::LoadOrder isLess;
+      return isLess(a_pLeft->first, a_pRight->first);
+    }
+  };
 
-      // if we are allowing blank lines then we only include them
-      // in this comment if another comment follows, so read ahead
-      // to find out.
-      SI_CHAR *pCurr = a_pData;
-      int nNewLines = 0;
-      while (IsSpace(*pCurr)) {
-        if (IsNewLineChar(*pCurr)) {
-          ++nNewLines;
-          SkipNewLine(pCurr);
-        } else {
-          ++pCurr;
-        }
+  m_pLastSection = NULL;
+  m_uKeys = 0;
+  std::vector<const TSectionNode *> sections;
+  std::vector<const TKeyNode *> keys;
+  sections.reserve(m_data.size());
+  typename TSection::iterator iSection = m_data.begin();
+  for (; iSection != m_data.end(); ++iSection) {
+    sections.push_back(&*iSection);
+    iSection->first.pLastKey = NULL;
+    keys.clear();
+    TKeyVal &keyval = iSection->second;
+    typename TKeyVal::iterator iKey = keyval.begin();
+    for (; iKey != keyval.end(); ++iKey) {
+      keys.push_back(&*iKey);
+    }
+    std::sort(keys.begin(), keys.end(), LoadedBefore());
+    m_uKeys += keys.size();
+    for (size_t n = 0; n < keys.size(); ++n) {
+      LinkLoaded(iSection->first.pLastKey, iSection->first.pLastKey, keys[n]);
+    }
+
+    // link the values of each key in map order
+    const TKeyNode *pPrev = NULL;
+    for (iKey = keyval.begin(); iKey != keyval.end(); ++iKey) {
+      const Entry &oKey = iKey->first;
+      oKey.pNextValue = NULL;
+      oKey.bFirstValue = !pPrev || !pPrev->first.IsSameName(oKey);
+      if (!oKey.bFirstValue) {
+        pPrev->first.pNextValue = &*iKey;
       }
+      pPrev = &*iKey;
+    }
+  }
+  std::sort(sections.begin(), sections.end(), LoadedBefore());
+  for (size_t n = 0; n < sections.size(); ++n) {
+    LinkLoaded(m_pLastSection, m_pLastSection, sections[n]);
+  }
+}
 
-      // we have a comment, add the blank lines to the output
-      // and continue processing from here
-      if (IsComment(*pCurr)) {
-        for (; nNewLines > 0; --nNewLines)
-          *pDataLine++ = '\n';
-        a_pData = pCurr;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TextBytes(
+    const SI_CHAR *a_pText, size_t a_uLen, bool a_bLines) {
+  size_t uBytes = a_uLen;
+  if (sizeof(SI_CHAR) > 1) {
+    for (size_t n = 0; n < a_uLen; ++n) {
+      const unsigned long c = static_cast<unsigned long>(a_pText[n]);
+      if (c < 0x80) {
         continue;
       }
-
-      // the comment ends here
-      break;
+      // a UTF-16 surrogate is half of a 4 byte character
+      if (c < 0x800 || (c >= 0xD800 && c < 0xE000)) {
+        uBytes += 1;
+      } else {
+        uBytes += c < 0x10000 ? 2 : 3;
+      }
     }
-
-    // find the end of this line
-    pCurrLine = a_pData;
-    while (*a_pData && !IsNewLineChar(*a_pData))
-      ++a_pData;
-
-    // move this line down to the location that it should be if necessary
-    if (pDataLine < pCurrLine) {
-      size_t nLen = (size_t)(a_pData - pCurrLine);
-      memmove(pDataLine, pCurrLine, nLen * sizeof(SI_CHAR));
-      pDataLine[nLen] = '\0';
+  }
+  if (a_bLines) {
+    const size_t uNewLine = sizeof(SI_NEWLINE_A) - 1;
+    size_t uLines = 1;
+    for (size_t n = 0; n < a_uLen; ++n) {
+      if (a_pText[n] == '\n') {
+        ++uLines;
+      }
     }
+    uBytes += uLines * uNewLine - (uLines - 1);
+  }
+  return uBytes;
+}
 
-    // end the line with a NULL
-    cEndOfLineChar = *a_pData;
-    *a_pData = 0;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SectionBytes(
+    const Entry &a_section) {
+  // "[section]" and the blank line before it
+  const size_t uNewLine = sizeof(SI_NEWLINE_A) - 1;
+  size_t uBytes = TextBytes(a_section.pItem, a_section.uLen, false) + 2 +
+                  3 * uNewLine;
+  if (a_section.pComment) {
+    uBytes += TextBytes(a_section.pComment,
+                        Entry::Length(a_section.pComment), true);
+  }
+  return uBytes;
+}
 
-    // if are looking for a tag then do the check now. This is done before
-    // checking for end of the data, so that if we have the tag at the end
-    // of the data then the tag is removed correctly.
-    if (a_pTagName) {
-      // strip whitespace from the end of this tag
-      SI_CHAR *pc = a_pData - 1;
-      while (pc > pDataLine && IsSpace(*pc))
-        --pc;
-      SI_CHAR ch = *++pc;
-      *pc = 0;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::KeyBytes(
+    const Entry &a_key, const SI_CHAR *a_pValue) {
+  // "key = value", and the comment after a blank line
+  const size_t uNewLine = sizeof(SI_NEWLINE_A) - 1;
+  size_t uBytes = TextBytes(a_key.pItem, a_key.uLen, false) + 3 + uNewLine;
+  if (a_key.pComment) {
+    uBytes += uNewLine + TextBytes(a_key.pComment,
+                                   Entry::Length(a_key.pComment), true);
+  }
+  const size_t uValue = Entry::Length(a_pValue);
+  if (IsSingleLineQuotedValue(a_pValue)) {
+    uBytes += 2 + TextBytes(a_pValue, uValue, false);
+  } else if (IsMultiLineData(a_pValue)) {
+    // "<<<END_OF_TEXT" and "END_OF_TEXT" around the lines of the value
+    uBytes += 25 + uNewLine + TextBytes(a_pValue, uValue, true);
+  } else {
+    uBytes += TextBytes(a_pValue, uValue, false);
+  }
+  return uBytes;
+}
 
-      if (!IsLess(pDataLine, a_pTagName) && !IsLess(a_pTagName, pDataLine)) {
-        break;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+template <class TVisitor>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ForEachInLoadOrder(
+    TVisitor a_visitor) const {
+  LoadLazySections();
+  typename TSection::const_iterator iEmpty =
+      m_data.find(Entry(&m_cEmptyString));
+  const TSectionNode *pEmpty = iEmpty != m_data.end() ? &*iEmpty : NULL;
+
+  const TSectionNode *pSection = NextSectionToSave(NULL, pEmpty);
+  for (; pSection; pSection = NextSectionToSave(pSection, pEmpty)) {
+    const TKeyNode *pKey = FirstKeyLoaded(*pSection);
+    if (!pKey && !a_visitor(pSection->first, static_cast<const Entry *>(NULL),
+                            static_cast<const SI_CHAR *>(NULL))) {
+      return false;
+    }
+    for (; pKey; pKey = NextKeyLoaded(*pSection, pKey)) {
+      // the values of a key are visited with its first value
+      if (!pKey->first.bFirstValue) {
+        continue;
+      }
+      const TKeyNode *pValue = pKey;
+      for (; pValue; pValue = m_bAllowMultiKey ? NextValue(pValue) : NULL) {
+        if (!a_visitor(pSection->first, &pValue->first, pValue->second)) {
+          return false;
+        }
       }
-
-      *pc = ch;
     }
+  }
+  return true;
+}
 
-    // if we are at the end of the data then we just automatically end
-    // this entry and return the current data.
-    if (!cEndOfLineChar) {
-      return true;
-    }
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TSection::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindSection(
+    const SI_CHAR *a_pSection) {
+  typename TSection::iterator iSection = LookupSection(a_pSection);
+  if (!m_lazySections.empty() && iSection != m_data.end()) {
+    LoadLazySection(iSection);
+  }
+  return iSection;
+}
 
-    // otherwise we need to process this newline to ensure that it consists
-    // of just a single \n character.
-    pDataLine += (a_pData - pCurrLine);
-    *a_pData = cEndOfLineChar;
-    SkipNewLine(a_pData);
-    *pDataLine++ = '\n';
-  }
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TSection::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LookupSection(
+    const SI_CHAR *a_pSection) {
+  if (!m_bHashIndex) {
+    return m_data.find(a_pSection);
+  }
+  SectionNameMatch match = {this, a_pSection};
+  typename TSection::iterator *pSection = m_sectionIndex.Find(
+      SI_StrHash<SI_STRLESS>::Hash(a_pSection), match);
+  return pSection ? *pSection : m_data.end();
+}
 
-  // if we didn't find a comment at all then return false
-  if (a_pVal == a_pData) {
-    a_pVal = NULL;
-    return false;
-  }
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyVal::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindKey(
+    TKeyVal &a_keyval, const SI_CHAR *a_pKey) {
+  if (!m_bHashIndex) {
+    return a_keyval.find(a_pKey);
+  }
+  KeyNameMatch match = {this, &a_keyval, a_pKey};
+  KeyRef *pRef = m_keyIndex.Find(KeyHash(&a_keyval, a_pKey), match);
+  return pRef ? pRef->iKey : a_keyval.end();
+}
 
-  // the data (which ends at the end of the last line) needs to be
-  // null-terminated BEFORE before the newline character(s). If the
-  // user wants a new line in the multi-line data then they need to
-  // add an empty line before the tag.
-  *--pDataLine = '\0';
+#ifdef SI_HAS_STRING_VIEW
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TSection::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindSection(
+    TStringView a_section) {
+  typename TSection::iterator iSection = LookupSection(a_section);
+  if (!m_lazySections.empty() && iSection != m_data.end()) {
+    LoadLazySection(iSection);
+  }
+  return iSection;
+}
 
-  // if looking for a tag and if we aren't at the end of the data,
-  // then move a_pData to the start of the next line.
-  if (a_pTagName && cEndOfLineChar) {
-    SI_ASSERT(IsNewLineChar(cEndOfLineChar));
-    *a_pData = cEndOfLineChar;
-    SkipNewLine(a_pData);
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TSection::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LookupSection(
+    TStringView a_section) {
+  if constexpr (!SI_StrCompareN<SI_STRLESS>::value) {
+    const ViewString section(a_section);
+    return LookupSection(section.c_str());
+  } else {
+    if (!m_bHashIndex) {
+      return m_data.find(a_section);
+    }
+    SectionViewMatch match = {a_section};
+    typename TSection::iterator *pSection = m_sectionIndex.Find(
+        SI_StrHash<SI_STRLESS>::Hash(a_section.data(), a_section.size()),
+        match);
+    return pSection ? *pSection : m_data.end();
   }
-
-  return true;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CopyString(
-    const SI_CHAR *&a_pString) {
-  size_t uLen = 0;
-  if (sizeof(SI_CHAR) == sizeof(char)) {
-    uLen = strlen((const char *)a_pString);
-  } else if (sizeof(SI_CHAR) == sizeof(wchar_t)) {
-    uLen = wcslen((const wchar_t *)a_pString);
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyVal::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindKey(
+    TKeyVal &a_keyval, TStringView a_key) {
+  if constexpr (!SI_StrCompareN<SI_STRLESS>::value) {
+    const ViewString key(a_key);
+    return FindKey(a_keyval, key.c_str());
   } else {
-    for (; a_pString[uLen]; ++uLen) /*loop*/
-      ;
-  }
-  if (uLen >= (SI_MAX_FILE_SIZE / sizeof(SI_CHAR))) {
-    return SI_NOMEM;
-  }
-  ++uLen; // NULL character
-  SI_CHAR *pCopy = new (std::nothrow) SI_CHAR[uLen];
-  if (!pCopy) {
-    return SI_NOMEM;
+    if (!m_bHashIndex) {
+      return a_keyval.find(a_key);
+    }
+    KeyViewMatch match = {&a_keyval, a_key};
+    KeyRef *pRef = m_keyIndex.Find(
+        KeyHash(&a_keyval,
+                SI_StrHash<SI_STRLESS>::Hash(a_key.data(), a_key.size())),
+        match);
+    return pRef ? pRef->iKey : a_keyval.end();
   }
-  memcpy(pCopy, a_pString, sizeof(SI_CHAR) * uLen);
-  m_strings.push_back(pCopy);
-  a_pString = pCopy;
-  return SI_OK;
 }
+#endif // SI_HAS_STRING_VIEW
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::
-    UndoIncrementalLoadData(const TNamesDepend &a_oAddedSections,
-                            const TNamesDepend &a_oAddedKeys) {
-  typename TNamesDepend::const_iterator iAddedKey = a_oAddedKeys.begin();
-  for (; iAddedKey != a_oAddedKeys.end(); ++iAddedKey) {
-    Delete(iAddedKey->pComment, iAddedKey->pItem, false);
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetHashIndex(
+    bool a_bHashIndex) {
+  m_sectionIndex.Clear();
+  m_keyIndex.Clear();
+  m_bHashIndex = a_bHashIndex && SI_StrHash<SI_STRLESS>::value;
+  if (!m_bHashIndex) {
+    return;
   }
 
-  typename TNamesDepend::const_iterator iAddedSection =
-      a_oAddedSections.begin();
-  for (; iAddedSection != a_oAddedSections.end(); ++iAddedSection) {
-    Delete(iAddedSection->pItem, NULL, false);
+  // index the existing data
+  typename TSection::iterator iSection = m_data.begin();
+  for (; iSection != m_data.end(); ++iSection) {
+    IndexSection(iSection);
+    TKeyVal &keyval = iSection->second;
+    typename TKeyVal::iterator iKey = keyval.begin();
+    for (; iKey != keyval.end(); ++iKey) {
+      IndexKey(keyval, iKey);
+    }
   }
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::AddEntry(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pValue,
-    const SI_CHAR *a_pComment, bool a_bForceReplace, bool a_bCopyStrings) {
-  SI_Error rc;
-  bool bInserted = false;
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IndexSection(
+    typename TSection::iterator a_iSection) {
+  m_sectionIndex.Insert(a_iSection->first.uHash, a_iSection);
+}
 
-  SI_ASSERT(!a_pComment || IsComment(*a_pComment));
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IndexKey(
+    TKeyVal &a_keyval, typename TKeyVal::iterator a_iKey) {
+  // only the first entry of a key is indexed, further entries of the same
+  // key are inserted after it
+  const size_t uHash = KeyHash(&a_keyval, a_iKey->first.uHash);
+  KeyNameMatch match = {this, &a_keyval, a_iKey->first.pItem};
+  if (!m_keyIndex.Find(uHash, match)) {
+    m_keyIndex.Insert(uHash, KeyRef(&a_keyval, a_iKey));
+  }
+}
 
-  // if we are copying strings then make a copy of the comment now
-  // because we will need it when we add the entry.
-  if (a_bCopyStrings && a_pComment) {
-    rc = CopyString(a_pComment);
-    if (rc < 0)
-      return rc;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::UnindexSection(
+    typename TSection::iterator a_iSection) {
+  TKeyVal &keyval = a_iSection->second;
+  typename TKeyVal::iterator iKey = keyval.begin();
+  for (; iKey != keyval.end(); ++iKey) {
+    KeyMatch match = {iKey};
+    m_keyIndex.Erase(KeyHash(&keyval, iKey->first.uHash), match);
+  }
+  SectionMatch match = {a_iSection};
+  m_sectionIndex.Erase(a_iSection->first.uHash, match);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::UnindexKey(
+    TKeyVal &a_keyval, typename TKeyVal::iterator a_iKey) {
+  // when the first entry of a key is erased the next one takes its place
+  const size_t uHash = KeyHash(&a_keyval, a_iKey->first.uHash);
+  KeyMatch match = {a_iKey};
+  KeyRef *pRef = m_keyIndex.Find(uHash, match);
+  if (!pRef) {
+    return;
+  }
+  typename TKeyVal::iterator iNext = a_iKey;
+  ++iNext;
+  if (iNext != a_keyval.end() && iNext->first.IsSameName(a_iKey->first)) {
+    pRef->iKey = iNext;
+  } else {
+    m_keyIndex.Erase(uHash, match);
   }
+}
 
-  // create the section entry if necessary
-  typename TSection::iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
-    // if the section doesn't exist then we need a copy as the
-    // string needs to last beyond the end of this function
-    if (a_bCopyStrings) {
-      rc = CopyString(a_pSection);
-      if (rc < 0)
-        return rc;
-    }
+#ifdef SI_SUPPORT_THREADS
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseParallel(
+    SI_CHAR *a_pData, const SI_CHAR *a_pDataEnd,
+    TParsedEntries &a_entries) const {
+  // each thread gets at least 64K characters
+  const size_t uLen = (size_t)(a_pDataEnd - a_pData);
+  const size_t uThreads = std::min<size_t>(m_nLoadThreads, uLen / 65536);
+  if (uThreads < 2) {
+    return false;
+  }
 
-    // only set the comment if this is a section only entry
-    Entry oSection(a_pSection, ++m_nOrder);
-    if (a_pComment && !a_pKey) {
-      oSection.pComment = a_pComment;
+  // split the data at section headers near evenly spaced points
+  std::vector<SI_CHAR *> starts(1, a_pData);
+  for (size_t n = 1; n < uThreads; ++n) {
+    SI_CHAR *pStart =
+        FindShardStart(starts.back(), a_pData + uLen / uThreads * n,
+                       a_pData + uLen / uThreads * (n + 1));
+    if (pStart) {
+      starts.push_back(pStart);
     }
-
-    typename TSection::value_type oEntry(oSection, TKeyVal());
-    typedef typename TSection::iterator SectionIterator;
-    std::pair<SectionIterator, bool> i = m_data.insert(oEntry);
-    iSection = i.first;
-    bInserted = true;
   }
-  if (!a_pKey) {
-    // section only entries are specified with pItem as NULL
-    return bInserted ? SI_INSERTED : SI_UPDATED;
+  if (starts.size() < 2) {
+    return false;
   }
 
-  // check for existence of the key
-  TKeyVal &keyval = iSection->second;
-  typename TKeyVal::iterator iKey = keyval.find(a_pKey);
-  bInserted = iKey == keyval.end();
-
-  // remove all existing entries but save the load order and
-  // comment of the first entry
-  int nLoadOrder = ++m_nOrder;
-  if (iKey != keyval.end() && m_bAllowMultiKey && a_bForceReplace) {
-    const SI_CHAR *pComment = NULL;
-    while (iKey != keyval.end() && !IsLess(a_pKey, iKey->first.pItem)) {
-      if (iKey->first.nOrder < nLoadOrder) {
-        nLoadOrder = iKey->first.nOrder;
-        pComment = iKey->first.pComment;
+  // A '[' line may be inside a multi-line value. If so the part before it
+  // ends in an unterminated value and the whole data is parsed again, which
+  // needs a copy of the original text.
+  std::vector<SI_CHAR> backup;
+  if (m_bAllowMultiLine) {
+    for (const SI_CHAR *p = a_pData; p + 2 < a_pDataEnd; ++p) {
+      if (IsMultiLineTag(p)) {
+        backup.assign(const_cast<const SI_CHAR *>(a_pData), a_pDataEnd);
+        break;
       }
-      ++iKey;
     }
-    if (pComment) {
-      DeleteString(a_pComment);
-      a_pComment = pComment;
-      rc = CopyString(a_pComment);
-      if (rc < 0)
-        return rc;
+  }
+
+  // terminate each part by replacing the final newline of the part before
+  std::vector<Shard> shards(starts.size());
+  for (size_t n = 0; n < shards.size(); ++n) {
+    shards[n].pStart = starts[n];
+    shards[n].pEnd = const_cast<SI_CHAR *>(a_pDataEnd);
+    shards[n].pComment = NULL;
+    shards[n].bTruncated = false;
+    if (n > 0) {
+      shards[n - 1].pEnd = starts[n] - 1;
+      *shards[n - 1].pEnd = 0;
     }
-    Delete(a_pSection, a_pKey);
-    iKey = keyval.end();
   }
 
-  // values need to be a valid string, even if they are an empty string
-  if (!a_pValue) {
-    a_pValue = &m_cEmptyString;
+  std::vector<std::thread> threads;
+  threads.reserve(shards.size() - 1);
+  for (size_t n = 1; n < shards.size(); ++n) {
+    threads.push_back(
+        std::thread(&CSimpleIniTempl::ParseShard, this, std::ref(shards[n])));
+  }
+  ParseShard(shards[0]);
+  for (size_t n = 0; n < threads.size(); ++n) {
+    threads[n].join();
   }
 
-  // make string copies if necessary
-  bool bForceCreateNewKey = m_bAllowMultiKey && !a_bForceReplace;
-  if (a_bCopyStrings) {
-    if (bForceCreateNewKey || iKey == keyval.end()) {
-      // if the key doesn't exist then we need a copy as the
-      // string needs to last beyond the end of this function
-      // because we will be inserting the key next
-      rc = CopyString(a_pKey);
-      if (rc < 0)
-        return rc;
+  for (size_t n = 0; n + 1 < shards.size(); ++n) {
+    if (shards[n].bTruncated) {
+      SI_ASSERT(!backup.empty());
+      std::copy(backup.begin(), backup.end(), a_pData);
+      return false;
     }
-
-    // we always need a copy of the value
-    rc = CopyString(a_pValue);
-    if (rc < 0)
-      return rc;
   }
 
-  // create the key entry
-  if (iKey == keyval.end() || bForceCreateNewKey) {
-    Entry oKey(a_pKey, nLoadOrder);
-    if (a_pComment) {
-      oKey.pComment = a_pComment;
+  // A comment after the last entry of a part belongs to the first entry of
+  // a following part, unless that entry has its own comment.
+  size_t uEntries = 0;
+  for (size_t n = 0; n < shards.size(); ++n) {
+    uEntries += shards[n].entries.size();
+  }
+  a_entries.reserve(uEntries);
+  const SI_CHAR *pComment = NULL;
+  for (size_t n = 0; n < shards.size(); ++n) {
+    TParsedEntries &entries = shards[n].entries;
+    if (!entries.empty()) {
+      if (!entries[0].pComment) {
+        entries[0].pComment = pComment;
+      }
+      pComment = NULL;
+    }
+    a_entries.insert(a_entries.end(), entries.begin(), entries.end());
+    if (shards[n].pComment) {
+      pComment = shards[n].pComment;
     }
-    typename TKeyVal::value_type oEntry(oKey,
-                                        static_cast<const SI_CHAR *>(NULL));
-    iKey = keyval.insert(oEntry);
-  } else {
-    DeleteString(iKey->second);
   }
-
-  iKey->second = a_pValue;
-  return bInserted ? SI_INSERTED : SI_UPDATED;
+  return true;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-const SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pDefault,
-    bool *a_pHasMultiple) const {
-  if (a_pHasMultiple) {
-    *a_pHasMultiple = false;
-  }
-  if (!a_pSection || !a_pKey) {
-    return a_pDefault;
-  }
-  typename TSection::const_iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
-    return a_pDefault;
-  }
-  typename TKeyVal::const_iterator iKeyVal = iSection->second.find(a_pKey);
-  if (iKeyVal == iSection->second.end()) {
-    return a_pDefault;
+SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindShardStart(
+    SI_CHAR *a_pPrev, SI_CHAR *a_pData, const SI_CHAR *a_pLimit) const {
+  // find the next line that starts with '['
+  for (;;) {
+    while (a_pData < a_pLimit && *a_pData != '\n') {
+      ++a_pData;
+    }
+    if (a_pData >= a_pLimit) {
+      return NULL;
+    }
+    ++a_pData;
+    if (*a_pData == '[') {
+      break;
+    }
   }
 
-  // check for multiple entries with the same key
-  if (m_bAllowMultiKey && a_pHasMultiple) {
-    typename TKeyVal::const_iterator iTemp = iKeyVal;
-    if (++iTemp != iSection->second.end()) {
-      if (!IsLess(a_pKey, iTemp->first.pItem)) {
-        *a_pHasMultiple = true;
-      }
+  // comments and blank lines before the header are part of its entry
+  SI_CHAR *pStart = a_pData;
+  while (pStart > a_pPrev) {
+    SI_CHAR *pLine = pStart - 1;
+    while (pLine > a_pPrev && pLine[-1] != '\n') {
+      --pLine;
     }
+    const SI_CHAR *pc = pLine;
+    while (pc < pStart && IsSpace(*pc)) {
+      ++pc;
+    }
+    if (pc < pStart && !IsComment(*pc)) {
+      break;
+    }
+    pStart = pLine;
+  }
+  return pStart > a_pPrev ? pStart : NULL;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseShard(
+    Shard &a_shard) const {
+  const SI_CHAR *pSection = NULL;
+  const SI_CHAR *pItem = NULL;
+  const SI_CHAR *pVal = NULL;
+  const SI_CHAR *pComment = NULL;
+  SI_CHAR *pWork = a_shard.pStart;
+  while (FindEntry(pWork, a_shard.pEnd, pSection, pItem, pVal, pComment,
+                   &a_shard.bTruncated)) {
+    ParsedEntry oEntry = {pSection, pItem, pVal, pComment};
+    a_shard.entries.push_back(oEntry);
   }
+  a_shard.pComment = pComment;
+}
+#endif // SI_SUPPORT_THREADS
 
-  return iKeyVal->second;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsMultiLineTag(
+    const SI_CHAR *a_pVal) const {
+  // check for the "<<<" prefix for a multi-line entry
+  if (*a_pVal++ != '<')
+    return false;
+  if (*a_pVal++ != '<')
+    return false;
+  if (*a_pVal++ != '<')
+    return false;
+  return true;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-long CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetLongValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, long a_nDefault,
-    bool *a_pHasMultiple) const {
-  // return the default if we don't have a value
-  const SI_CHAR *pszValue = GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple);
-  if (!pszValue || !*pszValue)
-    return a_nDefault;
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsMultiLineData(
+    const SI_CHAR *a_pData) {
+  // data is multi-line if it has any of the following features:
+  //  * whitespace prefix
+  //  * embedded newlines
+  //  * whitespace suffix
 
-  // convert to UTF-8/MBCS which for a numeric value will be the same as ASCII
-  char szValue[64] = {0};
-  SI_CONVERTER c(m_bStoreIsUtf8);
-  if (!c.ConvertToStore(pszValue, szValue, sizeof(szValue))) {
-    return a_nDefault;
+  // empty string
+  if (!*a_pData) {
+    return false;
   }
 
-  // handle the value as hex if prefaced with "0x"
-  long nValue = a_nDefault;
-  char *pszSuffix = szValue;
-  if (szValue[0] == '0' && (szValue[1] == 'x' || szValue[1] == 'X')) {
-    if (!szValue[2])
-      return a_nDefault;
-    nValue = strtol(&szValue[2], &pszSuffix, 16);
-  } else {
-    nValue = strtol(szValue, &pszSuffix, 10);
+  // check for prefix
+  if (IsSpace(*a_pData)) {
+    return true;
   }
 
-  // any invalid strings will return the default value
-  if (*pszSuffix) {
-    return a_nDefault;
+  // embedded newlines
+  const SI_CHAR *pStart = a_pData;
+  while (*a_pData) {
+    if (IsNewLineChar(*a_pData)) {
+      return true;
+    }
+    ++a_pData;
+  }
+
+  // check for suffix (ensure we don't go before start of string)
+  if (a_pData > pStart && IsSpace(*(a_pData - 1))) {
+    return true;
   }
 
-  return nValue;
+  return false;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetLongValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, long a_nValue,
-    const SI_CHAR *a_pComment, bool a_bUseHex, bool a_bForceReplace) {
-  // use SetValue to create sections
-  if (!a_pSection || !a_pKey)
-    return SI_FAIL;
-
-  // convert to an ASCII string
-  char szInput[64];
-#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
-  sprintf_s(szInput, a_bUseHex ? "0x%lx" : "%ld", a_nValue);
-#else  // !__STDC_WANT_SECURE_LIB__
-  snprintf(szInput, sizeof(szInput), a_bUseHex ? "0x%lx" : "%ld", a_nValue);
-#endif // __STDC_WANT_SECURE_LIB__
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::
+    IsSingleLineQuotedValue(const SI_CHAR *a_pData) {
+  // data needs quoting if it starts or ends with whitespace
+  // and doesn't have embedded newlines
 
-  // convert to output text
-  SI_CHAR szOutput[64];
-  SI_CONVERTER c(m_bStoreIsUtf8);
-  if (!c.ConvertFromStore(szInput, strlen(szInput) + 1, szOutput,
-                          sizeof(szOutput) / sizeof(SI_CHAR))) {
-    return SI_FAIL;
+  // empty string
+  if (!*a_pData) {
+    return false;
   }
 
-  // actually add it
-  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
-                  true);
-}
-
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-double CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetDoubleValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nDefault,
-    bool *a_pHasMultiple) const {
-  // return the default if we don't have a value
-  const SI_CHAR *pszValue = GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple);
-  if (!pszValue || !*pszValue)
-    return a_nDefault;
-
-  // convert to UTF-8/MBCS which for a numeric value will be the same as ASCII
-  char szValue[64] = {0};
-  SI_CONVERTER c(m_bStoreIsUtf8);
-  if (!c.ConvertToStore(pszValue, szValue, sizeof(szValue))) {
-    return a_nDefault;
+  // check for prefix
+  if (IsSpace(*a_pData)) {
+    return true;
   }
 
-  char *pszSuffix = szValue;
-  double nValue = strtod(szValue, &pszSuffix);
+  // embedded newlines
+  const SI_CHAR *pStart = a_pData;
+  while (*a_pData) {
+    if (IsNewLineChar(*a_pData)) {
+      return false;
+    }
+    ++a_pData;
+  }
 
-  // any invalid strings will return the default value
-  // check if no conversion was performed or if there are trailing characters
-  if (pszSuffix == szValue || *pszSuffix) {
-    return a_nDefault;
+  // check for suffix (ensure we don't go before start of string)
+  if (a_pData > pStart && IsSpace(*(a_pData - 1))) {
+    return true;
   }
 
-  return nValue;
+  return false;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetDoubleValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nValue,
-    const SI_CHAR *a_pComment, bool a_bForceReplace) {
-  // use SetValue to create sections
-  if (!a_pSection || !a_pKey)
-    return SI_FAIL;
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::IsNewLineChar(
+    SI_CHAR a_c) {
+  return (a_c == '\n' || a_c == '\r');
+}
 
-  // convert to an ASCII string
-  char szInput[64];
-#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
-  sprintf_s(szInput, "%f", a_nValue);
-#else  // !__STDC_WANT_SECURE_LIB__
-  snprintf(szInput, sizeof(szInput), "%f", a_nValue);
-#endif // __STDC_WANT_SECURE_LIB__
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadMultiLineText(
+    SI_CHAR *&a_pData, const SI_CHAR *a_pDataEnd, const SI_CHAR *&a_pVal,
+    const SI_CHAR *a_pTagName, bool a_bAllowBlankLinesInComment,
+    bool *a_pbTruncated) const {
+  // we modify this data to strip all newlines down to a single '\n'
+  // character. This means that on Windows we need to strip out some
+  // characters which will make the data shorter.
+  // i.e.  LINE1-LINE1\r\nLINE2-LINE2\0 will become
+  //       LINE1-LINE1\nLINE2-LINE2\0
+  // The pDataLine entry is the pointer to the location in memory that
+  // the current line needs to start to run following the existing one.
+  // This may be the same as pCurrLine in which case no move is needed.
+  SI_CHAR *pDataLine = a_pData;
+  SI_CHAR *pCurrLine;
 
-  // convert to output text
-  SI_CHAR szOutput[64];
-  SI_CONVERTER c(m_bStoreIsUtf8);
-  if (!c.ConvertFromStore(szInput, strlen(szInput) + 1, szOutput,
-                          sizeof(szOutput) / sizeof(SI_CHAR))) {
-    return SI_FAIL;
-  }
+  // value starts at the current line
+  a_pVal = a_pData;
 
-  // actually add it
-  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
-                  true);
-}
+  // find the end tag. This tag must start in column 1 and be
+  // followed by a newline. We ignore any whitespace after the end
+  // tag but not whitespace before it.
+  SI_CHAR cEndOfLineChar = *a_pData;
+  for (;;) {
+    // if we are loading comments then we need a comment character as
+    // the first character on every line
+    if (!a_pTagName && !IsComment(*a_pData)) {
+      // if we aren't allowing blank lines then we're done
+      if (!a_bAllowBlankLinesInComment) {
+        break;
+      }
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetBoolValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bDefault,
-    bool *a_pHasMultiple) const {
-  // return the default if we don't have a value
-  const SI_CHAR *pszValue = GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple);
-  if (!pszValue || !*pszValue)
-    return a_bDefault;
+      // if we are allowing blank lines then we only include them
+      // in this comment if another comment follows, so read ahead
+      // to find out.
+      SI_CHAR *pCurr = a_pData;
+      int nNewLines = 0;
+      while (IsSpace(*pCurr)) {
+        if (IsNewLineChar(*pCurr)) {
+          ++nNewLines;
+          SkipNewLine(pCurr);
+        } else {
+          ++pCurr;
+        }
+      }
 
-  // we only look at the minimum number of characters
-  switch (pszValue[0]) {
-  case 't':
-  case 'T': // true
-  case 'y':
-  case 'Y': // yes
-  case '1': // 1 (one)
-    return true;
+      // we have a comment, add the blank lines to the output
+      // and continue processing from here
+      if (IsComment(*pCurr)) {
+        for (; nNewLines > 0; --nNewLines)
+          *pDataLine++ = '\n';
+        a_pData = pCurr;
+        continue;
+      }
 
-  case 'f':
-  case 'F': // false
-  case 'n':
-  case 'N': // no
-  case '0': // 0 (zero)
-    return false;
+      // the comment ends here
+      break;
+    }
 
-  case 'o':
-  case 'O':
-    if (pszValue[1] == 'n' || pszValue[1] == 'N')
-      return true; // on
-    if (pszValue[1] == 'f' || pszValue[1] == 'F')
-      return false; // off
-    break;
-  }
+    // find the end of this line
+    pCurrLine = a_pData;
+    a_pData = SI_Internal::ScanLine(a_pData, a_pDataEnd, SI_CHAR('\n'));
 
-  // no recognized value, return the default
-  return a_bDefault;
-}
+    // move this line down to the location that it should be if necessary
+    if (pDataLine < pCurrLine) {
+      size_t nLen = (size_t)(a_pData - pCurrLine);
+      memmove(pDataLine, pCurrLine, nLen * sizeof(SI_CHAR));
+      pDataLine[nLen] = '\0';
+    }
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetBoolValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bValue,
-    const SI_CHAR *a_pComment, bool a_bForceReplace) {
-  // use SetValue to create sections
-  if (!a_pSection || !a_pKey)
-    return SI_FAIL;
+    // end the line with a NULL
+    cEndOfLineChar = *a_pData;
+    *a_pData = 0;
 
-  // convert to an ASCII string
-  const char *pszInput = a_bValue ? "true" : "false";
+    // if are looking for a tag then do the check now. This is done before
+    // checking for end of the data, so that if we have the tag at the end
+    // of the data then the tag is removed correctly.
+    if (a_pTagName) {
+      // strip whitespace from the end of this tag
+      SI_CHAR *pc = a_pData - 1;
+      while (pc > pDataLine && IsSpace(*pc))
+        --pc;
+      SI_CHAR ch = *++pc;
+      *pc = 0;
 
-  // convert to output text
-  SI_CHAR szOutput[64];
-  SI_CONVERTER c(m_bStoreIsUtf8);
-  if (!c.ConvertFromStore(pszInput, strlen(pszInput) + 1, szOutput,
-                          sizeof(szOutput) / sizeof(SI_CHAR))) {
-    return SI_FAIL;
-  }
+      if (!IsLess(pDataLine, a_pTagName) && !IsLess(a_pTagName, pDataLine)) {
+        break;
+      }
 
-  // actually add it
-  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
-                  true);
-}
+      *pc = ch;
+    }
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllValues(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
-    TNamesDepend &a_values) const {
-  a_values.clear();
+    // if we are at the end of the data then we just automatically end
+    // this entry and return the current data.
+    if (!cEndOfLineChar) {
+      if (a_pTagName && a_pbTruncated) {
+        *a_pbTruncated = true;
+      }
+      return true;
+    }
 
-  if (!a_pSection || !a_pKey) {
-    return false;
-  }
-  typename TSection::const_iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
-    return false;
+    // otherwise we need to process this newline to ensure that it consists
+    // of just a single \n character.
+    pDataLine += (a_pData - pCurrLine);
+    *a_pData = cEndOfLineChar;
+    SkipNewLine(a_pData);
+    *pDataLine++ = '\n';
   }
-  typename TKeyVal::const_iterator iKeyVal = iSection->second.find(a_pKey);
-  if (iKeyVal == iSection->second.end()) {
+
+  // if we didn't find a comment at all then return false
+  if (a_pVal == a_pData) {
+    a_pVal = NULL;
     return false;
   }
 
-  // insert all values for this key
-  a_values.push_back(
-      Entry(iKeyVal->second, iKeyVal->first.pComment, iKeyVal->first.nOrder));
-  if (m_bAllowMultiKey) {
-    ++iKeyVal;
-    while (iKeyVal != iSection->second.end() &&
-           !IsLess(a_pKey, iKeyVal->first.pItem)) {
-      a_values.push_back(Entry(iKeyVal->second, iKeyVal->first.pComment,
-                               iKeyVal->first.nOrder));
-      ++iKeyVal;
-    }
+  // the data (which ends at the end of the last line) needs to be
+  // null-terminated BEFORE before the newline character(s). If the
+  // user wants a new line in the multi-line data then they need to
+  // add an empty line before the tag.
+  *--pDataLine = '\0';
+
+  // if looking for a tag and if we aren't at the end of the data,
+  // then move a_pData to the start of the next line.
+  if (a_pTagName && cEndOfLineChar) {
+    SI_ASSERT(IsNewLineChar(cEndOfLineChar));
+    *a_pData = cEndOfLineChar;
+    SkipNewLine(a_pData);
   }
 
   return true;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-int CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSectionSize(
-    const SI_CHAR *a_pSection) const {
-  if (!a_pSection) {
-    return -1;
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CopyString(
+    const SI_CHAR *&a_pString, size_t a_uLen) {
+  size_t uLen = a_uLen;
+  if (uLen >= (SI_MAX_FILE_SIZE / sizeof(SI_CHAR))) {
+    return SI_NOMEM;
   }
-
-  typename TSection::const_iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
-    return -1;
+  ++uLen; // NULL character
+  SI_CHAR *pCopy =
+      static_cast<SI_CHAR *>(m_strings.Allocate(sizeof(SI_CHAR) * uLen));
+  if (!pCopy) {
+    return SI_NOMEM;
   }
-  const TKeyVal &section = iSection->second;
+  memcpy(pCopy, a_pString, sizeof(SI_CHAR) * uLen);
+  a_pString = pCopy;
+  return SI_OK;
+}
 
-  // if multi-key isn't permitted then the section size is
-  // the number of keys that we have.
-  if (!m_bAllowMultiKey || section.empty()) {
-    return (int)section.size();
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::
+    UndoIncrementalLoadData(const TNamesDepend &a_oAddedSections,
+                            const TNamesDepend &a_oAddedKeys) {
+  typename TNamesDepend::const_iterator iAddedKey = a_oAddedKeys.begin();
+  for (; iAddedKey != a_oAddedKeys.end(); ++iAddedKey) {
+    Delete(iAddedKey->pComment, iAddedKey->pItem, false);
   }
 
-  // otherwise we need to count them
-  int nCount = 0;
-  const SI_CHAR *pLastKey = NULL;
-  typename TKeyVal::const_iterator iKeyVal = section.begin();
-  for (; iKeyVal != section.end(); ++iKeyVal) {
-    if (!pLastKey || IsLess(pLastKey, iKeyVal->first.pItem)) {
-      ++nCount;
-      pLastKey = iKeyVal->first.pItem;
-    }
+  typename TNamesDepend::const_iterator iAddedSection =
+      a_oAddedSections.begin();
+  for (; iAddedSection != a_oAddedSections.end(); ++iAddedSection) {
+    Delete(iAddedSection->pItem, NULL, false);
   }
-  return nCount;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-const typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyVal *
-CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSection(
-    const SI_CHAR *a_pSection) const {
-  if (a_pSection) {
-    typename TSection::const_iterator i = m_data.find(a_pSection);
-    if (i != m_data.end()) {
-      return &(i->second);
-    }
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::AddEntry(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pValue,
+    const SI_CHAR *a_pComment, bool a_bForceReplace, bool a_bCopyStrings) {
+  SI_Error rc;
+  bool bInserted = false;
+
+  SI_ASSERT(!a_pComment || IsComment(*a_pComment));
+
+  // if we are copying strings then make a copy of the comment now
+  // because we will need it when we add the entry.
+  if (a_bCopyStrings && a_pComment) {
+    rc = CopyString(a_pComment);
+    if (rc < 0)
+      return rc;
   }
-  return 0;
-}
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllSections(
-    TNamesDepend &a_names) const {
-  a_names.clear();
-  typename TSection::const_iterator i = m_data.begin();
-  for (; i != m_data.end(); ++i) {
-    a_names.push_back(i->first);
+  // create the section entry if necessary
+  typename TSection::iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    // if the section doesn't exist then we need a copy as the
+    // string needs to last beyond the end of this function
+    Entry oSection(a_pSection);
+    oSection.Measure();
+    if (a_bCopyStrings) {
+      rc = CopyString(oSection.pItem, oSection.uLen);
+      if (rc < 0)
+        return rc;
+    }
+    oSection.nOrder = ++m_nOrder;
+
+    // only set the comment if this is a section only entry
+    if (a_pComment && !a_pKey) {
+      oSection.pComment = a_pComment;
+    }
+
+    typename TSection::value_type oEntry(oSection, TKeyVal());
+    typedef typename TSection::iterator SectionIterator;
+    std::pair<SectionIterator, bool> i = m_data.insert(oEntry);
+    iSection = i.first;
+    LinkSection(iSection);
+    m_uSaveBytes += SectionBytes(iSection->first);
+    bInserted = true;
+    if (m_bHashIndex) {
+      IndexSection(iSection);
+    }
+  }
+  if (!a_pKey) {
+    // section only entries are specified with pItem as NULL
+    return bInserted ? SI_INSERTED : SI_UPDATED;
   }
-}
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllKeys(
-    const SI_CHAR *a_pSection, TNamesDepend &a_names) const {
-  a_names.clear();
+  // check for existence of the key
+  TKeyVal &keyval = iSection->second;
+  typename TKeyVal::iterator iKey = FindKey(keyval, a_pKey);
+  bInserted = iKey == keyval.end();
 
-  if (!a_pSection) {
-    return false;
+  // remove all existing entries but save the load order and
+  // comment of the first entry
+  int nLoadOrder = ++m_nOrder;
+  const void *pLoadedAfter = iSection->first.pLastKey;
+  if (iKey != keyval.end() && m_bAllowMultiKey && a_bForceReplace) {
+    const SI_CHAR *pComment = NULL;
+    const Entry oFound = iKey->first;
+    const TKeyNode *pFirstLoaded = NULL;
+    while (iKey != keyval.end() && iKey->first.IsSameName(oFound)) {
+      if (iKey->first.nOrder < nLoadOrder) {
+        nLoadOrder = iKey->first.nOrder;
+        pComment = iKey->first.pComment;
+        pFirstLoaded = &*iKey;
+      }
+      ++iKey;
+    }
+
+    // the new entry takes the place of the first one in the load order,
+    // after a key that is not deleted
+    if (pFirstLoaded) {
+      pLoadedAfter = pFirstLoaded == FirstKeyLoaded(*iSection)
+                         ? NULL
+                         : pFirstLoaded->first.pPrevLoaded;
+    }
+    if (pComment) {
+      DeleteString(a_pComment);
+      a_pComment = pComment;
+      rc = CopyString(a_pComment);
+      if (rc < 0)
+        return rc;
+    }
+    Delete(a_pSection, a_pKey);
+    iKey = keyval.end();
   }
 
-  typename TSection::const_iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
-    return false;
+  // values need to be a valid string, even if they are an empty string
+  if (!a_pValue) {
+    a_pValue = &m_cEmptyString;
   }
 
-  const TKeyVal &section = iSection->second;
-  const SI_CHAR *pLastKey = NULL;
-  typename TKeyVal::const_iterator iKeyVal = section.begin();
-  for (; iKeyVal != section.end(); ++iKeyVal) {
-    if (!pLastKey || IsLess(pLastKey, iKeyVal->first.pItem)) {
-      a_names.push_back(iKeyVal->first);
-      pLastKey = iKeyVal->first.pItem;
+  // make string copies if necessary
+  bool bForceCreateNewKey = m_bAllowMultiKey && !a_bForceReplace;
+  bool bCreateKey = iKey == keyval.end() || bForceCreateNewKey;
+  Entry oKey(bCreateKey ? a_pKey : NULL, nLoadOrder);
+  oKey.Measure();
+  if (a_bCopyStrings) {
+    if (bCreateKey) {
+      // if the key doesn't exist then we need a copy as the
+      // string needs to last beyond the end of this function
+      // because we will be inserting the key next
+      rc = CopyString(oKey.pItem, oKey.uLen);
+      if (rc < 0)
+        return rc;
     }
-  }
 
-  return true;
-}
+    // we always need a copy of the value
+    rc = CopyString(a_pValue);
+    if (rc < 0)
+      return rc;
+  }
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
-    const char *a_pszFile, bool a_bAddSignature) const {
-  FILE *fp = NULL;
-#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
-  fopen_s(&fp, a_pszFile, "wb");
-#else  // !__STDC_WANT_SECURE_LIB__
-  fp = fopen(a_pszFile, "wb");
-#endif // __STDC_WANT_SECURE_LIB__
-  if (!fp)
-    return SI_FILE;
-  SI_Error rc = SaveFile(fp, a_bAddSignature);
-  fclose(fp);
-  return rc;
+  // create the key entry
+  if (bCreateKey) {
+    if (a_pComment) {
+      oKey.pComment = a_pComment;
+    }
+    InsertKey(iSection, keyval.end(), oKey, a_pValue, pLoadedAfter);
+  } else {
+    ReplaceValue(iKey, a_pValue);
+  }
+  return bInserted ? SI_INSERTED : SI_UPDATED;
 }
 
-#ifdef SI_HAS_WIDE_FILE
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
-    const SI_WCHAR_T *a_pwszFile, bool a_bAddSignature) const {
-#ifdef _WIN32
-  FILE *fp = NULL;
-#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
-  _wfopen_s(&fp, a_pwszFile, L"wb");
-#else  // !__STDC_WANT_SECURE_LIB__
-  fp = _wfopen(a_pwszFile, L"wb");
-#endif // __STDC_WANT_SECURE_LIB__
-  if (!fp)
-    return SI_FILE;
-  SI_Error rc = SaveFile(fp, a_bAddSignature);
-  fclose(fp);
-  return rc;
-#else  // !_WIN32 (therefore SI_CONVERT_ICU)
-  char *szFile = NULL;
-  SI_Error rcPath = SI_Internal::UCharPathToUtf8(a_pwszFile, szFile);
-  if (rcPath < 0) {
-    return rcPath;
-  }
-  SI_Error rc = SaveFile(szFile, a_bAddSignature);
-  delete[] szFile;
-  return rc;
-#endif // _WIN32
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyVal::iterator
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::InsertKey(
+    typename TSection::iterator a_iSection, typename TKeyVal::iterator a_iHint,
+    const Entry &a_oKey, const SI_CHAR *a_pValue, const void *a_pAfter) {
+  TKeyVal &keyval = a_iSection->second;
+  typename TKeyVal::iterator iKey =
+      keyval.insert(a_iHint, typename TKeyVal::value_type(a_oKey, a_pValue));
+  LinkKey(*a_iSection, iKey, a_pAfter);
+  ++m_uKeys;
+  CountKey(iKey->first, a_pValue);
+  if (m_bHashIndex) {
+    IndexKey(keyval, iKey);
+  }
+  BindKeySlot(a_iSection, iKey->first.pItem);
+  return iKey;
 }
-#endif // SI_HAS_WIDE_FILE
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
-    FILE *a_pFile, bool a_bAddSignature) const {
-  FileWriter writer(a_pFile);
-  return Save(writer, a_bAddSignature);
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ReplaceValue(
+    typename TKeyVal::iterator a_iKey, const SI_CHAR *a_pValue) {
+  CountKey(a_iKey->first, a_pValue);
+  UncountKey(a_iKey->first, a_iKey->second);
+  DeleteString(a_iKey->second);
+  UncacheValue(&*a_iKey);
+  a_iKey->second = a_pValue;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Save(
-    OutputWriter &a_oOutput, bool a_bAddSignature) const {
-  Converter convert(m_bStoreIsUtf8);
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetValues(
+    const SI_CHAR *a_pSection, const SI_CHAR *const *a_pKeys,
+    const SI_CHAR *const *a_pValues, size_t a_uCount, bool a_bNewKeys) {
+  if (!a_pSection) {
+    return SI_FAIL;
+  }
+  for (size_t n = 0; n < a_uCount; ++n) {
+    if (!a_pKeys[n]) {
+      return SI_FAIL;
+    }
+  }
 
-  // add the UTF-8 signature if it is desired
-  if (m_bStoreIsUtf8 && a_bAddSignature) {
-    a_oOutput.Write(SI_UTF8_SIGNATURE);
+  // create the section if necessary
+  SI_Error rc = AddEntry(a_pSection, NULL, NULL, NULL, false, true);
+  if (rc < 0) {
+    return rc;
+  }
+  bool bInserted = rc == SI_INSERTED;
+
+  // measure the strings once, and reserve space for all of the copies
+  std::vector<size_t> lengths(a_uCount * 2);
+  size_t uReserve = 0;
+  for (size_t n = 0; n < a_uCount; ++n) {
+    lengths[n * 2] = Entry::Length(a_pKeys[n]);
+    lengths[n * 2 + 1] = a_pValues[n] ? Entry::Length(a_pValues[n]) : 0;
+    uReserve +=
+        SI_Internal::StringArena::SlabBytes((lengths[n * 2] + 1) *
+                                            sizeof(SI_CHAR)) +
+        SI_Internal::StringArena::SlabBytes((lengths[n * 2 + 1] + 1) *
+                                            sizeof(SI_CHAR));
+  }
+  if (!m_strings.Reserve(uReserve)) {
+    return SI_NOMEM;
   }
 
-  // get all of the sections sorted in load order
-  TNamesDepend oSections;
-  GetAllSections(oSections);
-#if defined(_MSC_VER) && _MSC_VER <= 1200
-  oSections.sort();
-#elif defined(__BORLANDC__)
-  oSections.sort(Entry::LoadOrder());
-#else
-  oSections.sort(typename Entry::LoadOrder());
-#endif
+  typename TSection::iterator iSection = FindSection(a_pSection);
+  TKeyVal &keyval = iSection->second;
+  typename TKeyVal::iterator iHint = keyval.end();
+  for (size_t n = 0; n < a_uCount; ++n) {
+    const SI_CHAR *pValue = a_pValues[n] ? a_pValues[n] : &m_cEmptyString;
+    rc = CopyString(pValue, lengths[n * 2 + 1]);
+    if (rc < 0) {
+      return rc;
+    }
 
-  // if there is an empty section name, then it must be written out first
-  // regardless of the load order
-  typename TNamesDepend::iterator is = oSections.begin();
-  for (; is != oSections.end(); ++is) {
-    if (!*is->pItem) {
-      // move the empty section name to the front of the section list
-      if (is != oSections.begin()) {
-        oSections.splice(oSections.begin(), oSections, is, std::next(is));
+    // update the value of an existing key
+    typename TKeyVal::iterator iKey = keyval.end();
+    if (!a_bNewKeys) {
+      iKey = FindKey(keyval, a_pKeys[n]);
+      if (iKey != keyval.end() && !m_bAllowMultiKey) {
+        ReplaceValue(iKey, pValue);
+        continue;
       }
-      break;
     }
-  }
 
-  // write the file comment if we have one
-  bool bNeedNewLine = false;
-  if (m_pFileComment) {
-    if (!OutputMultiLineText(a_oOutput, convert, m_pFileComment)) {
-      return SI_FAIL;
+    Entry oKey(a_pKeys[n], ++m_nOrder);
+    oKey.Measure();
+    rc = CopyString(oKey.pItem, lengths[n * 2]);
+    if (rc < 0) {
+      DeleteString(pValue);
+      return rc;
     }
-    bNeedNewLine = true;
+    // a new key is inserted just before the hint if the keys are sorted,
+    // further entries of a multi-key go after the existing ones
+    iKey = InsertKey(iSection, iKey == keyval.end() ? iHint : keyval.end(),
+                     oKey, pValue, iSection->first.pLastKey);
+    iHint = iKey;
+    ++iHint;
+    bInserted = true;
   }
+  return bInserted ? SI_INSERTED : SI_UPDATED;
+}
 
-  // iterate through our sections and output the data
-  typename TNamesDepend::const_iterator iSection = oSections.begin();
-  for (; iSection != oSections.end(); ++iSection) {
-    // write out the comment if there is one
-    if (iSection->pComment) {
-      if (bNeedNewLine) {
-        a_oOutput.Write(SI_NEWLINE_A);
-        a_oOutput.Write(SI_NEWLINE_A);
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pDefault,
+    bool *a_pHasMultiple) const {
+  if (a_pHasMultiple) {
+    *a_pHasMultiple = false;
+  }
+  if (!a_pSection || !a_pKey) {
+    return a_pDefault;
+  }
+  typename TSection::const_iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return a_pDefault;
+  }
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_pKey);
+  if (iKeyVal == iSection->second.end()) {
+    return a_pDefault;
+  }
+  return FirstValue(iSection->second, iKeyVal, a_pHasMultiple);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetValues(
+    const SI_CHAR *a_pSection, const SI_CHAR *const *a_pKeys, size_t a_uKeys,
+    const SI_CHAR **a_pValues, TNamesDepend *a_pMissing,
+    bool a_bSorted) const {
+  if (a_pMissing) {
+    a_pMissing->clear();
+  }
+  for (size_t n = 0; n < a_uKeys; ++n) {
+    a_pValues[n] = NULL;
+  }
+
+  size_t uFound = 0;
+  typename TSection::const_iterator iSection =
+      a_pSection ? FindSection(a_pSection) : m_data.end();
+  if (iSection != m_data.end() && a_uKeys > 0) {
+    const TKeyVal &keyval = iSection->second;
+
+    // the walk visits every key of the section, which is slower than
+    // separate lookups when only a few of them are wanted
+    size_t uDepth = 1;
+    for (size_t uSize = keyval.size(); uSize > 1; uSize >>= 1) {
+      ++uDepth;
+    }
+    if (m_bHashIndex || a_uKeys * uDepth < keyval.size()) {
+      for (size_t n = 0; n < a_uKeys; ++n) {
+        if (!a_pKeys[n]) {
+          continue;
+        }
+        typename TKeyVal::const_iterator iKeyVal =
+            FindKey(keyval, a_pKeys[n]);
+        if (iKeyVal != keyval.end()) {
+          a_pValues[n] = iKeyVal->second;
+          ++uFound;
+        }
       }
-      if (!OutputMultiLineText(a_oOutput, convert, iSection->pComment)) {
-        return SI_FAIL;
+    } else {
+      // visit the requested keys in sorted order
+      std::vector<size_t> order;
+      if (!a_bSorted) {
+        order.reserve(a_uKeys);
+        for (size_t n = 0; n < a_uKeys; ++n) {
+          if (a_pKeys[n]) {
+            order.push_back(n);
+          }
+        }
+        KeyIndexLess isLess = {a_pKeys};
+        std::stable_sort(order.begin(), order.end(), isLess);
+      }
+
+      typename TKeyVal::const_iterator iKeyVal = keyval.begin();
+      size_t uCount = a_bSorted ? a_uKeys : order.size();
+      for (size_t i = 0; i < uCount && iKeyVal != keyval.end(); ++i) {
+        size_t n = a_bSorted ? i : order[i];
+        const SI_CHAR *pKey = a_pKeys[n];
+        if (!pKey) {
+          continue;
+        }
+        while (iKeyVal != keyval.end() && IsLess(iKeyVal->first.pItem, pKey)) {
+          ++iKeyVal;
+        }
+        if (iKeyVal != keyval.end() && !IsLess(pKey, iKeyVal->first.pItem)) {
+          a_pValues[n] = iKeyVal->second;
+          ++uFound;
+        }
       }
-      bNeedNewLine = false;
     }
+  }
 
-    if (bNeedNewLine) {
-      a_oOutput.Write(SI_NEWLINE_A);
-      a_oOutput.Write(SI_NEWLINE_A);
-      bNeedNewLine = false;
-    }
-
-    // write the section (unless there is no section name)
-    if (*iSection->pItem) {
-      if (!convert.ConvertToStore(iSection->pItem)) {
-        return SI_FAIL;
+  if (a_pMissing) {
+    for (size_t n = 0; n < a_uKeys; ++n) {
+      if (a_pKeys[n] && !a_pValues[n]) {
+        a_pMissing->push_back(Entry(a_pKeys[n], (int)n));
       }
-      a_oOutput.Write("[");
-      a_oOutput.Write(convert.Data());
-      a_oOutput.Write("]");
-      a_oOutput.Write(SI_NEWLINE_A);
     }
+  }
+  return uFound;
+}
 
-    // get all of the keys sorted in load order
-    TNamesDepend oKeys;
-    GetAllKeys(iSection->pItem, oKeys);
-#if defined(_MSC_VER) && _MSC_VER <= 1200
-    oKeys.sort();
-#elif defined(__BORLANDC__)
-    oKeys.sort(Entry::LoadOrder());
-#else
-    oKeys.sort(typename Entry::LoadOrder());
-#endif
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyHandle
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ResolveKey(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey) {
+  if (!a_pSection || !a_pKey) {
+    return NULL;
+  }
+  SlotName name = {a_pSection, a_pKey};
+  typename TKeySlotIndex::const_iterator iSlot = m_keySlotIndex.find(name);
+  if (iSlot != m_keySlotIndex.end()) {
+    return iSlot->second;
+  }
 
-    // write all keys and values
-    typename TNamesDepend::const_iterator iKey = oKeys.begin();
-    for (; iKey != oKeys.end(); ++iKey) {
-      // get all values for this key
-      TNamesDepend oValues;
-      GetAllValues(iSection->pItem, iKey->pItem, oValues);
+  KeySlot slot;
+  slot.section = a_pSection;
+  slot.key = a_pKey;
+  slot.pNode = NULL;
+  m_keySlots.push_back(slot);
+  KeySlot &oSlot = m_keySlots.back();
+  name.pSection = oSlot.section.c_str();
+  name.pKey = oSlot.key.c_str();
+  m_keySlotIndex.insert(std::make_pair(name, &oSlot));
 
-      typename TNamesDepend::const_iterator iValue = oValues.begin();
-      for (; iValue != oValues.end(); ++iValue) {
-        // write out the comment if there is one
-        if (iValue->pComment) {
-          a_oOutput.Write(SI_NEWLINE_A);
-          if (!OutputMultiLineText(a_oOutput, convert, iValue->pComment)) {
-            return SI_FAIL;
-          }
-        }
+  typename TSection::iterator iSection = FindSection(a_pSection);
+  if (iSection != m_data.end()) {
+    BindKeySlot(iSection, a_pKey);
+  }
+  return &oSlot;
+}
 
-        // write the key
-        if (!convert.ConvertToStore(iKey->pItem)) {
-          return SI_FAIL;
-        }
-        a_oOutput.Write(convert.Data());
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::BindKeySlot(
+    typename TSection::iterator a_iSection, const SI_CHAR *a_pKey) {
+  if (m_keySlotIndex.empty()) {
+    return;
+  }
+  SlotName name = {a_iSection->first.pItem, a_pKey};
+  typename TKeySlotIndex::iterator iSlot = m_keySlotIndex.find(name);
+  if (iSlot == m_keySlotIndex.end()) {
+    return;
+  }
+  typename TKeyVal::iterator iKey = FindKey(a_iSection->second, a_pKey);
+  iSlot->second->pNode = iKey == a_iSection->second.end() ? NULL : &*iKey;
+}
 
-        // write the value as long
-        if (*iValue->pItem || !m_bAllowKeyOnly) {
-          if (!convert.ConvertToStore(iValue->pItem)) {
-            return SI_FAIL;
-          }
-          a_oOutput.Write(m_bSpaces ? " = " : "=");
-          if (m_bParseQuotes && IsSingleLineQuotedValue(iValue->pItem)) {
-            // the only way to preserve external whitespace on a value (i.e. before or after)
-            // is to quote it. This is simple quoting, we don't escape quotes within the data.
-            a_oOutput.Write("\"");
-            a_oOutput.Write(convert.Data());
-            a_oOutput.Write("\"");
-          } else if (m_bAllowMultiLine && IsMultiLineData(iValue->pItem)) {
-            // multi-line data needs to be processed specially to ensure
-            // that we use the correct newline format for the current system
-            a_oOutput.Write("<<<END_OF_TEXT" SI_NEWLINE_A);
-            if (!OutputMultiLineText(a_oOutput, convert, iValue->pItem)) {
-              return SI_FAIL;
-            }
-            a_oOutput.Write("END_OF_TEXT");
-          } else {
-            a_oOutput.Write(convert.Data());
-          }
-        }
-        a_oOutput.Write(SI_NEWLINE_A);
-      }
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::BindKeySlots() {
+  typename std::list<KeySlot>::iterator iSlot = m_keySlots.begin();
+  for (; iSlot != m_keySlots.end(); ++iSlot) {
+    iSlot->pNode = NULL;
+    typename TSection::iterator iSection =
+        LookupSection(iSlot->section.c_str());
+    if (iSection != m_data.end()) {
+      BindKeySlot(iSection, iSlot->key.c_str());
     }
+  }
+}
 
-    bNeedNewLine = true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::UnbindKeySlots(
+    const SI_CHAR *a_pSection) {
+  if (!a_pSection) {
+    typename std::list<KeySlot>::iterator iSlot = m_keySlots.begin();
+    for (; iSlot != m_keySlots.end(); ++iSlot) {
+      iSlot->pNode = NULL;
+    }
+    return;
   }
 
-  return SI_OK;
+  // the slots of a section follow the one with an empty key
+  SlotName name = {a_pSection, &m_cEmptyString};
+  typename TKeySlotIndex::iterator iSlot = m_keySlotIndex.lower_bound(name);
+  for (; iSlot != m_keySlotIndex.end() &&
+         IsEqual(iSlot->first.pSection, a_pSection);
+       ++iSlot) {
+    iSlot->second->pNode = NULL;
+  }
 }
 
-template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::OutputMultiLineText(
-    OutputWriter &a_oOutput, Converter &a_oConverter,
-    const SI_CHAR *a_pText) const {
-  const SI_CHAR *pEndOfLine;
-  SI_CHAR cEndOfLineChar = *a_pText;
-  while (cEndOfLineChar) {
-    // find the end of this line
-    pEndOfLine = a_pText;
-    for (; *pEndOfLine && *pEndOfLine != '\n'; ++pEndOfLine) /*loop*/
-      ;
-    cEndOfLineChar = *pEndOfLine;
 
-    const std::basic_string<SI_CHAR> line(
-        a_pText, static_cast<size_t>(pEndOfLine - a_pText));
-    if (!a_oConverter.ConvertToStore(line.c_str())) {
-      return false;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FirstValue(
+    const TKeyVal &a_keyval, typename TKeyVal::const_iterator a_iKeyVal,
+    bool *a_pHasMultiple) const {
+  // check for multiple entries with the same key
+  if (m_bAllowMultiKey && a_pHasMultiple) {
+    typename TKeyVal::const_iterator iTemp = a_iKeyVal;
+    if (++iTemp != a_keyval.end()) {
+      if (iTemp->first.IsSameName(a_iKeyVal->first)) {
+        *a_pHasMultiple = true;
+      }
     }
-    a_pText += (pEndOfLine - a_pText) + 1;
-    a_oOutput.Write(a_oConverter.Data());
-    a_oOutput.Write(SI_NEWLINE_A);
   }
-  return true;
+
+  return a_iKeyVal->second;
 }
 
+#ifdef SI_HAS_STRING_VIEW
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Delete(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bRemoveEmpty) {
-  return DeleteValue(a_pSection, a_pKey, NULL, a_bRemoveEmpty);
+const SI_CHAR *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetValue(
+    TStringView a_section, TStringView a_key, const SI_CHAR *a_pDefault,
+    bool *a_pHasMultiple) const {
+  if (a_pHasMultiple) {
+    *a_pHasMultiple = false;
+  }
+  typename TSection::const_iterator iSection = FindSection(a_section);
+  if (iSection == m_data.end()) {
+    return a_pDefault;
+  }
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_key);
+  if (iKeyVal == iSection->second.end()) {
+    return a_pDefault;
+  }
+  return FirstValue(iSection->second, iKeyVal, a_pHasMultiple);
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::DeleteValue(
-    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pValue,
-    bool a_bRemoveEmpty) {
-  if (!a_pSection) {
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllValues(
+    TStringView a_section, TStringView a_key, TNamesDepend &a_values) const {
+  a_values.clear();
+  typename TSection::const_iterator iSection = FindSection(a_section);
+  if (iSection == m_data.end()) {
     return false;
   }
-
-  typename TSection::iterator iSection = m_data.find(a_pSection);
-  if (iSection == m_data.end()) {
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_key);
+  if (iKeyVal == iSection->second.end()) {
     return false;
   }
+  CollectValues(iSection->second, iKeyVal, a_values);
+  return true;
+}
+#endif // SI_HAS_STRING_VIEW
 
-  // remove a single key if we have a keyname
-  if (a_pKey) {
-    typename TKeyVal::iterator iKeyVal = iSection->second.find(a_pKey);
-    if (iKeyVal == iSection->second.end()) {
-      return false;
-    }
-
-    const static SI_STRLESS isLess = SI_STRLESS();
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const typename CSimpleIniTempl<SI_CHAR, SI_STRLESS,
+                               SI_CONVERTER>::TKeyVal::value_type *
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindFirstValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+    bool *a_pHasMultiple) const {
+  if (a_pHasMultiple) {
+    *a_pHasMultiple = false;
+  }
+  if (!a_pSection || !a_pKey) {
+    return NULL;
+  }
+  typename TSection::const_iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return NULL;
+  }
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_pKey);
+  if (iKeyVal == iSection->second.end()) {
+    return NULL;
+  }
+  FirstValue(iSection->second, iKeyVal, a_pHasMultiple);
+  return &*iKeyVal;
+}
 
-    // remove any copied strings and then the key
-    typename TKeyVal::iterator iDelete;
-    bool bDeleted = false;
-    do {
-      iDelete = iKeyVal++;
+#ifdef SI_HAS_STRING_VIEW
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const typename CSimpleIniTempl<SI_CHAR, SI_STRLESS,
+                               SI_CONVERTER>::TKeyVal::value_type *
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindFirstValue(
+    TStringView a_section, TStringView a_key, bool *a_pHasMultiple) const {
+  if (a_pHasMultiple) {
+    *a_pHasMultiple = false;
+  }
+  typename TSection::const_iterator iSection = FindSection(a_section);
+  if (iSection == m_data.end()) {
+    return NULL;
+  }
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_key);
+  if (iKeyVal == iSection->second.end()) {
+    return NULL;
+  }
+  FirstValue(iSection->second, iKeyVal, a_pHasMultiple);
+  return &*iKeyVal;
+}
+#endif // SI_HAS_STRING_VIEW
 
-      if (a_pValue == NULL || (isLess(a_pValue, iDelete->second) == false &&
-                               isLess(iDelete->second, a_pValue) == false)) {
-        DeleteString(iDelete->first.pItem);
-        DeleteString(iDelete->first.pComment);
-        DeleteString(iDelete->second);
-        iSection->second.erase(iDelete);
-        bDeleted = true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+template <class T>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ConvertValue(
+    const typename TKeyVal::value_type *a_pValue, unsigned char a_nType,
+    bool (*a_pfnParse)(const SI_CHAR *, bool, T &), T &a_value) const {
+  if (!a_pValue) {
+    return false;
+  }
+  CachedValue *pCached = NULL;
+  if (m_bValueCache) {
+    CachedValueMatch match = {a_pValue};
+    pCached = m_valueCache.Find(NodeHash(a_pValue), match);
+    if (pCached && pCached->cache.nType == a_nType) {
+      if (pCached->cache.bValid) {
+        pCached->cache.Get(a_value);
       }
-    } while (iKeyVal != iSection->second.end() &&
-             !IsLess(a_pKey, iKeyVal->first.pItem));
-
-    if (!bDeleted) {
-      return false;
-    }
-
-    // done now if the section is not empty or we are not pruning away
-    // the empty sections. Otherwise let it fall through into the section
-    // deletion code
-    if (!a_bRemoveEmpty || !iSection->second.empty()) {
-      return true;
+      return pCached->cache.bValid;
     }
-  } else {
-    // delete all copied strings from this section. The actual
-    // entries will be removed when the section is removed.
-    typename TKeyVal::iterator iKeyVal = iSection->second.begin();
-    for (; iKeyVal != iSection->second.end(); ++iKeyVal) {
-      DeleteString(iKeyVal->first.pItem);
-      DeleteString(iKeyVal->first.pComment);
-      DeleteString(iKeyVal->second);
+  }
+  T value = T();
+  bool bValid = a_pfnParse(a_pValue->second, m_bStoreIsUtf8, value);
+  if (bValid) {
+    a_value = value;
+  }
+  if (m_bValueCache) {
+    // a value read as another type replaces the earlier conversion
+    ValueCache cache;
+    cache.nType = a_nType;
+    cache.bValid = bValid;
+    cache.Set(value);
+    if (pCached) {
+      pCached->cache = cache;
+    } else {
+      CachedValue oCached;
+      oCached.pNode = a_pValue;
+      oCached.cache = cache;
+      m_valueCache.Insert(NodeHash(a_pValue), oCached);
     }
   }
+  return bValid;
+}
 
-  // delete the section itself
-  DeleteString(iSection->first.pItem);
-  DeleteString(iSection->first.pComment);
-  m_data.erase(iSection);
-
-  return true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+long CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetLongValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, long a_nDefault,
+    bool *a_pHasMultiple) const {
+  // return the default if we don't have a value
+  long nValue = a_nDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::LONG, &ParseLong, nValue)
+             ? nValue
+             : a_nDefault;
 }
 
 template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
-void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::DeleteString(
-    const SI_CHAR *a_pString) {
-  if (!a_pString) {
-    return;
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseLong(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, long &a_nValue) {
+  if (!a_pValue || !*a_pValue)
+    return false;
+
+  // convert to UTF-8/MBCS which for a numeric value will be the same as ASCII
+  char szValue[64] = {0};
+  SI_CONVERTER c(a_bStoreIsUtf8);
+  if (!c.ConvertToStore(a_pValue, szValue, sizeof(szValue))) {
+    return false;
   }
-  // strings may exist either inside the data block, or they will be
-  // individually allocated and stored in m_strings. We only physically
-  // delete those stored in m_strings.
-  if (!m_pData || a_pString < m_pData || a_pString >= m_pData + m_uDataLen) {
-    typename TNamesDepend::iterator i = m_strings.begin();
-    for (; i != m_strings.end(); ++i) {
-      if (a_pString == i->pItem) {
-        delete[] const_cast<SI_CHAR *>(i->pItem);
-        m_strings.erase(i);
-        break;
-      }
-    }
+
+  // handle the value as hex if prefaced with "0x"
+  char *pszSuffix = szValue;
+  if (szValue[0] == '0' && (szValue[1] == 'x' || szValue[1] == 'X')) {
+    if (!szValue[2])
+      return false;
+    a_nValue = strtol(&szValue[2], &pszSuffix, 16);
+  } else {
+    a_nValue = strtol(szValue, &pszSuffix, 10);
   }
+
+  // any invalid strings will return the default value
+  return !*pszSuffix;
 }
 
-// ---------------------------------------------------------------------------
-//                              CONVERSION FUNCTIONS
-// ---------------------------------------------------------------------------
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetLongValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, long a_nValue,
+    const SI_CHAR *a_pComment, bool a_bUseHex, bool a_bForceReplace) {
+  // use SetValue to create sections
+  if (!a_pSection || !a_pKey)
+    return SI_FAIL;
 
-// Defines the conversion classes for different libraries. Before including
-// SimpleIni.h, set the converter that you wish you use by defining one of the
-// following symbols.
-//
-//  SI_NO_CONVERSION        Do not make the "W" wide character version of the
-//                          library available. Only CSimpleIniA etc is defined.
-//                          Default on Linux/MacOS/etc.
-//  SI_CONVERT_WIN32        Use the Win32 API functions for conversion.
-//                          Default on Windows.
-//  SI_CONVERT_GENERIC      Use built-in locale-independent UTF-8 conversion
-//                          (no additional source files required)
-//  SI_CONVERT_ICU          Use the IBM ICU conversion library. Requires
-//                          ICU headers on include path and icuuc.lib
+  // convert to an ASCII string
+  char szInput[64];
+#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
+  sprintf_s(szInput, a_bUseHex ? "0x%lx" : "%ld", a_nValue);
+#else  // !__STDC_WANT_SECURE_LIB__
+  snprintf(szInput, sizeof(szInput), a_bUseHex ? "0x%lx" : "%ld", a_nValue);
+#endif // __STDC_WANT_SECURE_LIB__
 
-#if !defined(SI_NO_CONVERSION) && !defined(SI_CONVERT_GENERIC) &&              \
-    !defined(SI_CONVERT_WIN32) && !defined(SI_CONVERT_ICU)
-#ifdef _WIN32
-#define SI_CONVERT_WIN32
-#else
-#define SI_NO_CONVERSION
-#endif
-#endif
+  // convert to output text
+  SI_CHAR szOutput[64];
+  SI_CONVERTER c(m_bStoreIsUtf8);
+  if (!c.ConvertFromStore(szInput, strlen(szInput) + 1, szOutput,
+                          sizeof(szOutput) / sizeof(SI_CHAR))) {
+    return SI_FAIL;
+  }
+
+  // actually add it
+  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
+                  true);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+double CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetDoubleValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nDefault,
+    bool *a_pHasMultiple) const {
+  // return the default if we don't have a value
+  double nValue = a_nDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::DOUBLE, &ParseDouble, nValue)
+             ? nValue
+             : a_nDefault;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseDouble(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, double &a_nValue) {
+  if (!a_pValue || !*a_pValue)
+    return false;
+
+  // convert to UTF-8/MBCS which for a numeric value will be the same as ASCII
+  char szValue[64] = {0};
+  SI_CONVERTER c(a_bStoreIsUtf8);
+  if (!c.ConvertToStore(a_pValue, szValue, sizeof(szValue))) {
+    return false;
+  }
+
+  char *pszSuffix = szValue;
+  a_nValue = strtod(szValue, &pszSuffix);
+
+  // any invalid strings will return the default value
+  // check if no conversion was performed or if there are trailing characters
+  return pszSuffix != szValue && !*pszSuffix;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetDoubleValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nValue,
+    const SI_CHAR *a_pComment, bool a_bForceReplace) {
+  // use SetValue to create sections
+  if (!a_pSection || !a_pKey)
+    return SI_FAIL;
+
+  // convert to an ASCII string
+  char szInput[64];
+#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
+  sprintf_s(szInput, "%f", a_nValue);
+#else  // !__STDC_WANT_SECURE_LIB__
+  snprintf(szInput, sizeof(szInput), "%f", a_nValue);
+#endif // __STDC_WANT_SECURE_LIB__
+
+  // convert to output text
+  SI_CHAR szOutput[64];
+  SI_CONVERTER c(m_bStoreIsUtf8);
+  if (!c.ConvertFromStore(szInput, strlen(szInput) + 1, szOutput,
+                          sizeof(szOutput) / sizeof(SI_CHAR))) {
+    return SI_FAIL;
+  }
+
+  // actually add it
+  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
+                  true);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetBoolValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bDefault,
+    bool *a_pHasMultiple) const {
+  // return the default if we don't have a value
+  bool bValue = a_bDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::BOOL, &ParseBoolValue, bValue)
+             ? bValue
+             : a_bDefault;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseBool(
+    const SI_CHAR *a_pValue, bool &a_bValue) {
+  if (!a_pValue || !*a_pValue)
+    return false;
+
+  // we only look at the minimum number of characters
+  switch (a_pValue[0]) {
+  case 't':
+  case 'T': // true
+  case 'y':
+  case 'Y': // yes
+  case '1': // 1 (one)
+    a_bValue = true;
+    return true;
+
+  case 'f':
+  case 'F': // false
+  case 'n':
+  case 'N': // no
+  case '0': // 0 (zero)
+    a_bValue = false;
+    return true;
+
+  case 'o':
+  case 'O':
+    if (a_pValue[1] == 'n' || a_pValue[1] == 'N') {
+      a_bValue = true; // on
+      return true;
+    }
+    if (a_pValue[1] == 'f' || a_pValue[1] == 'F') {
+      a_bValue = false; // off
+      return true;
+    }
+    break;
+  }
+
+  // no recognized value, return the default
+  return false;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetBoolValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bValue,
+    const SI_CHAR *a_pComment, bool a_bForceReplace) {
+  // use SetValue to create sections
+  if (!a_pSection || !a_pKey)
+    return SI_FAIL;
+
+  // convert to an ASCII string
+  const char *pszInput = a_bValue ? "true" : "false";
+
+  // convert to output text
+  SI_CHAR szOutput[64];
+  SI_CONVERTER c(m_bStoreIsUtf8);
+  if (!c.ConvertFromStore(pszInput, strlen(pszInput) + 1, szOutput,
+                          sizeof(szOutput) / sizeof(SI_CHAR))) {
+    return SI_FAIL;
+  }
+
+  // actually add it
+  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
+                  true);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+int64_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetInt64Value(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, int64_t a_nDefault,
+    bool *a_pHasMultiple) const {
+  int64_t nValue = a_nDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::INT64, &ParseInt64, nValue)
+             ? nValue
+             : a_nDefault;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+uint64_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetUInt64Value(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, uint64_t a_nDefault,
+    bool *a_pHasMultiple) const {
+  uint64_t nValue = a_nDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::UINT64, &ParseUInt64, nValue)
+             ? nValue
+             : a_nDefault;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+double CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetFloatValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nDefault,
+    bool *a_pHasMultiple) const {
+  double nValue = a_nDefault;
+  return ConvertValue(FindFirstValue(a_pSection, a_pKey, a_pHasMultiple),
+                      ValueCache::FLOAT, &ParseFloat, nValue)
+             ? nValue
+             : a_nDefault;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const char *CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::NumericText(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, char (&a_szBuffer)[64],
+    size_t &a_uLen) {
+  if (!a_pValue || !*a_pValue) {
+    return NULL;
+  }
+
+  // a numeric value is ASCII, which is stored unchanged in UTF-8 and MBCS
+  const char *pText = a_szBuffer;
+  if (sizeof(SI_CHAR) == sizeof(char)) {
+    pText = (const char *)a_pValue;
+  } else {
+    SI_CONVERTER c(a_bStoreIsUtf8);
+    if (!c.ConvertToStore(a_pValue, a_szBuffer, sizeof(a_szBuffer))) {
+      return NULL;
+    }
+  }
+
+  // skip leading whitespace as strtol() does
+  while (*pText == ' ' || *pText == '\t') {
+    ++pText;
+  }
+  a_uLen = strlen(pText);
+  return pText;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseDigits(
+    const char *a_pText, size_t a_uLen, uint64_t &a_nValue) {
+  int nBase = 10;
+  if (a_uLen > 2 && a_pText[0] == '0' &&
+      (a_pText[1] == 'x' || a_pText[1] == 'X')) {
+    nBase = 16;
+    a_pText += 2;
+    a_uLen -= 2;
+  }
+  if (a_uLen == 0 || *a_pText == '+' || *a_pText == '-') {
+    return false;
+  }
+
+#ifdef SI_HAS_CHARCONV
+  std::from_chars_result result =
+      std::from_chars(a_pText, a_pText + a_uLen, a_nValue, nBase);
+  return result.ec == std::errc() && result.ptr == a_pText + a_uLen;
+#else  // !SI_HAS_CHARCONV
+  if (*a_pText == ' ' || *a_pText == '\t') {
+    return false;
+  }
+  char *pszSuffix = NULL;
+  errno = 0;
+  a_nValue = strtoull(a_pText, &pszSuffix, nBase);
+  return errno == 0 && pszSuffix == a_pText + a_uLen;
+#endif // SI_HAS_CHARCONV
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseInt64(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, int64_t &a_nValue) {
+  char szBuffer[64];
+  size_t uLen = 0;
+  const char *pText = NumericText(a_pValue, a_bStoreIsUtf8, szBuffer, uLen);
+  if (!pText) {
+    return false;
+  }
+
+  bool bNegative = *pText == '-';
+  if (bNegative || *pText == '+') {
+    ++pText;
+    --uLen;
+  }
+  uint64_t nMagnitude = 0;
+  if (!ParseDigits(pText, uLen, nMagnitude)) {
+    return false;
+  }
+
+  const uint64_t nMax = (uint64_t)std::numeric_limits<int64_t>::max();
+  if (bNegative) {
+    if (nMagnitude > nMax + 1) {
+      return false;
+    }
+    // negate without overflowing for the minimum value
+    a_nValue = nMagnitude == nMax + 1 ? std::numeric_limits<int64_t>::min()
+                                      : -(int64_t)nMagnitude;
+  } else {
+    if (nMagnitude > nMax) {
+      return false;
+    }
+    a_nValue = (int64_t)nMagnitude;
+  }
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseUInt64(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, uint64_t &a_nValue) {
+  char szBuffer[64];
+  size_t uLen = 0;
+  const char *pText = NumericText(a_pValue, a_bStoreIsUtf8, szBuffer, uLen);
+  if (!pText) {
+    return false;
+  }
+  if (*pText == '+') {
+    ++pText;
+    --uLen;
+  }
+  return ParseDigits(pText, uLen, a_nValue);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ParseFloat(
+    const SI_CHAR *a_pValue, bool a_bStoreIsUtf8, double &a_nValue) {
+  char szBuffer[64];
+  size_t uLen = 0;
+  const char *pText = NumericText(a_pValue, a_bStoreIsUtf8, szBuffer, uLen);
+  if (!pText) {
+    return false;
+  }
+  if (*pText == '+' && pText[1] != '-') {
+    ++pText;
+    --uLen;
+  }
+  if (uLen == 0) {
+    return false;
+  }
+
+#ifdef SI_HAS_CHARCONV_FLOAT
+  std::from_chars_result result =
+      std::from_chars(pText, pText + uLen, a_nValue);
+  if (result.ptr != pText + uLen) {
+    return false;
+  }
+  if (result.ec != std::errc::result_out_of_range) {
+    return result.ec == std::errc();
+  }
+  // some runtimes report every subnormal as out of range
+#endif // SI_HAS_CHARCONV_FLOAT
+
+  // strtod reads subnormals and rounds smaller values to zero, only an
+  // overflow is an error
+  char *pszSuffix = NULL;
+  errno = 0;
+  a_nValue = strtod(pText, &pszSuffix);
+  const double dMax = (std::numeric_limits<double>::max)();
+  if (errno == ERANGE && (a_nValue > dMax || a_nValue < -dMax)) {
+    return false;
+  }
+  return pszSuffix == pText + uLen;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetNumericValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const char *a_pszValue,
+    const SI_CHAR *a_pComment, bool a_bForceReplace) {
+  // use SetValue to create sections
+  if (!a_pSection || !a_pKey)
+    return SI_FAIL;
+
+  // a char store holds the ASCII text unchanged
+  if (sizeof(SI_CHAR) == sizeof(char)) {
+    return AddEntry(a_pSection, a_pKey, (const SI_CHAR *)a_pszValue,
+                    a_pComment, a_bForceReplace, true);
+  }
+
+  // convert to output text
+  SI_CHAR szOutput[64];
+  SI_CONVERTER c(m_bStoreIsUtf8);
+  if (!c.ConvertFromStore(a_pszValue, strlen(a_pszValue) + 1, szOutput,
+                          sizeof(szOutput) / sizeof(SI_CHAR))) {
+    return SI_FAIL;
+  }
+  return AddEntry(a_pSection, a_pKey, szOutput, a_pComment, a_bForceReplace,
+                  true);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetInt64Value(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, int64_t a_nValue,
+    const SI_CHAR *a_pComment, bool a_bUseHex, bool a_bForceReplace) {
+  // format the magnitude, which can't overflow, and add the sign
+  uint64_t nMagnitude = a_nValue < 0 ? 0 - (uint64_t)a_nValue : a_nValue;
+  char szInput[64];
+  char *pszEnd = szInput;
+  if (a_nValue < 0) {
+    *pszEnd++ = '-';
+  }
+  if (a_bUseHex) {
+    *pszEnd++ = '0';
+    *pszEnd++ = 'x';
+  }
+#ifdef SI_HAS_CHARCONV
+  pszEnd = std::to_chars(pszEnd, szInput + sizeof(szInput) - 1, nMagnitude,
+                         a_bUseHex ? 16 : 10)
+               .ptr;
+  *pszEnd = 0;
+#else  // !SI_HAS_CHARCONV
+  snprintf(pszEnd, szInput + sizeof(szInput) - pszEnd,
+           a_bUseHex ? "%llx" : "%llu", (unsigned long long)nMagnitude);
+#endif // SI_HAS_CHARCONV
+  return SetNumericValue(a_pSection, a_pKey, szInput, a_pComment,
+                         a_bForceReplace);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetUInt64Value(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, uint64_t a_nValue,
+    const SI_CHAR *a_pComment, bool a_bUseHex, bool a_bForceReplace) {
+  char szInput[64];
+  char *pszEnd = szInput;
+  if (a_bUseHex) {
+    *pszEnd++ = '0';
+    *pszEnd++ = 'x';
+  }
+#ifdef SI_HAS_CHARCONV
+  pszEnd = std::to_chars(pszEnd, szInput + sizeof(szInput) - 1, a_nValue,
+                         a_bUseHex ? 16 : 10)
+               .ptr;
+  *pszEnd = 0;
+#else  // !SI_HAS_CHARCONV
+  snprintf(pszEnd, szInput + sizeof(szInput) - pszEnd,
+           a_bUseHex ? "%llx" : "%llu", (unsigned long long)a_nValue);
+#endif // SI_HAS_CHARCONV
+  return SetNumericValue(a_pSection, a_pKey, szInput, a_pComment,
+                         a_bForceReplace);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SetFloatValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, double a_nValue,
+    const SI_CHAR *a_pComment, bool a_bForceReplace) {
+  char szInput[64];
+#ifdef SI_HAS_CHARCONV_FLOAT
+  // without a format or precision this is the shortest round trip text
+  *std::to_chars(szInput, szInput + sizeof(szInput) - 1, a_nValue).ptr = 0;
+#else  // !SI_HAS_CHARCONV_FLOAT
+  // use the fewest significant digits that read back as the same value
+  for (int nPrecision = 1; nPrecision <= 17; ++nPrecision) {
+    snprintf(szInput, sizeof(szInput), "%.*g", nPrecision, a_nValue);
+    if (strtod(szInput, NULL) == a_nValue) {
+      break;
+    }
+  }
+#endif // SI_HAS_CHARCONV_FLOAT
+  return SetNumericValue(a_pSection, a_pKey, szInput, a_pComment,
+                         a_bForceReplace);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllValues(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+    TNamesDepend &a_values) const {
+  a_values.clear();
+
+  if (!a_pSection || !a_pKey) {
+    return false;
+  }
+  typename TSection::const_iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return false;
+  }
+  typename TKeyVal::const_iterator iKeyVal = FindKey(iSection->second, a_pKey);
+  if (iKeyVal == iSection->second.end()) {
+    return false;
+  }
+  CollectValues(iSection->second, iKeyVal, a_values);
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CollectValues(
+    const TKeyVal &a_keyval, typename TKeyVal::const_iterator a_iKeyVal,
+    TNamesDepend &a_values) const {
+  // insert all values for this key
+  a_values.push_back(Entry::Value(a_iKeyVal->second, a_iKeyVal->first.pComment,
+                                  a_iKeyVal->first.nOrder));
+  if (m_bAllowMultiKey) {
+    const Entry &oFirst = a_iKeyVal->first;
+    ++a_iKeyVal;
+    while (a_iKeyVal != a_keyval.end() &&
+           a_iKeyVal->first.IsSameName(oFirst)) {
+      a_values.push_back(Entry::Value(a_iKeyVal->second,
+                                      a_iKeyVal->first.pComment,
+                                      a_iKeyVal->first.nOrder));
+      ++a_iKeyVal;
+    }
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+int CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSectionSize(
+    const SI_CHAR *a_pSection) const {
+  if (!a_pSection) {
+    return -1;
+  }
+
+  typename TSection::const_iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return -1;
+  }
+  return CountKeys(iSection->second);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+int CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CountKeys(
+    const TKeyVal &a_section) const {
+  // if multi-key isn't permitted then the section size is
+  // the number of keys that we have.
+  if (!m_bAllowMultiKey || a_section.empty()) {
+    return (int)a_section.size();
+  }
+
+  // otherwise we need to count them
+  int nCount = 0;
+  const Entry *pLastKey = NULL;
+  typename TKeyVal::const_iterator iKeyVal = a_section.begin();
+  for (; iKeyVal != a_section.end(); ++iKeyVal) {
+    if (!pLastKey || !iKeyVal->first.IsSameName(*pLastKey)) {
+      ++nCount;
+      pLastKey = &iKeyVal->first;
+    }
+  }
+  return nCount;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const typename CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::TKeyVal *
+CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSection(
+    const SI_CHAR *a_pSection) const {
+  if (a_pSection) {
+    typename TSection::const_iterator i = FindSection(a_pSection);
+    if (i != m_data.end()) {
+      return &(i->second);
+    }
+  }
+  return 0;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllSections(
+    TNamesDepend &a_names) const {
+  a_names.clear();
+  typename TSection::const_iterator i = m_data.begin();
+  for (; i != m_data.end(); ++i) {
+    a_names.push_back(i->first);
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllKeys(
+    const SI_CHAR *a_pSection, TNamesDepend &a_names) const {
+  a_names.clear();
+
+  if (!a_pSection) {
+    return false;
+  }
+
+  typename TSection::const_iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return false;
+  }
+  CollectKeys(iSection->second, a_names);
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CollectKeys(
+    const TKeyVal &a_section, TNamesDepend &a_names) const {
+  const Entry *pLastKey = NULL;
+  typename TKeyVal::const_iterator iKeyVal = a_section.begin();
+  for (; iKeyVal != a_section.end(); ++iKeyVal) {
+    if (!pLastKey || !iKeyVal->first.IsSameName(*pLastKey)) {
+      a_names.push_back(iKeyVal->first);
+      pLastKey = &iKeyVal->first;
+    }
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
+    const char *a_pszFile, bool a_bAddSignature) const {
+  FILE *fp = NULL;
+#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
+  fopen_s(&fp, a_pszFile, "wb");
+#else  // !__STDC_WANT_SECURE_LIB__
+  fp = fopen(a_pszFile, "wb");
+#endif // __STDC_WANT_SECURE_LIB__
+  if (!fp)
+    return SI_FILE;
+  SI_Error rc = SaveFile(fp, a_bAddSignature);
+  fclose(fp);
+  return rc;
+}
+
+#ifdef SI_HAS_WIDE_FILE
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
+    const SI_WCHAR_T *a_pwszFile, bool a_bAddSignature) const {
+#ifdef _WIN32
+  FILE *fp = NULL;
+#if __STDC_WANT_SECURE_LIB__ && !_WIN32_WCE
+  _wfopen_s(&fp, a_pwszFile, L"wb");
+#else  // !__STDC_WANT_SECURE_LIB__
+  fp = _wfopen(a_pwszFile, L"wb");
+#endif // __STDC_WANT_SECURE_LIB__
+  if (!fp)
+    return SI_FILE;
+  SI_Error rc = SaveFile(fp, a_bAddSignature);
+  fclose(fp);
+  return rc;
+#else  // !_WIN32 (therefore SI_CONVERT_ICU)
+  char *szFile = NULL;
+  SI_Error rcPath = SI_Internal::UCharPathToUtf8(a_pwszFile, szFile);
+  if (rcPath < 0) {
+    return rcPath;
+  }
+  SI_Error rc = SaveFile(szFile, a_bAddSignature);
+  delete[] szFile;
+  return rc;
+#endif // _WIN32
+}
+#endif // SI_HAS_WIDE_FILE
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveFile(
+    FILE *a_pFile, bool a_bAddSignature) const {
+  FileWriter writer(a_pFile);
+  return Save(writer, a_bAddSignature);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Save(
+    OutputWriter &a_oOutput, bool a_bAddSignature) const {
+  OutputBuffer output(a_oOutput);
+  SI_Error rc = SaveTo(output, a_bAddSignature);
+  output.Flush();
+  return rc;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Save(
+    std::string &a_sBuffer, bool a_bAddSignature) const {
+  // Finding the exact length takes a walk of all entries, which costs as
+  // much as the save itself. The size of the entries is kept as they are
+  // added and removed instead. Values with whitespace at either end are
+  // counted in quotes, and get the longer multi-line form here if that is
+  // how they are written.
+  LoadLazySections();
+  size_t uLength = sizeof(SI_UTF8_SIGNATURE) + m_uSaveBytes;
+  if (m_bAllowMultiLine && !m_bParseQuotes) {
+    const size_t uNewLine = sizeof(SI_NEWLINE_A) - 1;
+    uLength += m_uPaddedValues * (23 + 2 * uNewLine);
+  }
+  if (m_pFileComment) {
+    uLength += TextBytes(m_pFileComment, Entry::Length(m_pFileComment), true);
+  }
+  uLength += uLength / 64;
+  a_sBuffer.reserve(a_sBuffer.size() + uLength);
+
+  StringWriter writer(a_sBuffer);
+  return Save(writer, a_bAddSignature);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Save(
+    char *a_pBuffer, size_t a_uSize, size_t &a_uLength,
+    bool a_bAddSignature) const {
+  OutputBuffer output(a_pBuffer, a_uSize);
+  SI_Error rc = SaveTo(output, a_bAddSignature);
+  a_uLength = output.Length();
+  if (rc >= 0 && a_uLength > a_uSize) {
+    return SI_FAIL;
+  }
+  return rc;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::SaveTo(
+    OutputBuffer &a_oOutput, bool a_bAddSignature) const {
+  Converter convert(m_bStoreIsUtf8);
+
+  // add the UTF-8 signature if it is desired
+  if (m_bStoreIsUtf8 && a_bAddSignature) {
+    a_oOutput.Write(SI_UTF8_SIGNATURE);
+  }
+
+  // the sections and keys are linked in load order, the section with an
+  // empty name is written first regardless of the load order
+  LoadLazySections();
+  typename TSection::const_iterator iEmpty =
+      m_data.find(Entry(&m_cEmptyString));
+  const TSectionNode *pEmpty = iEmpty != m_data.end() ? &*iEmpty : NULL;
+
+  // write the file comment if we have one
+  bool bNeedNewLine = false;
+  if (m_pFileComment) {
+    if (!OutputMultiLineText(a_oOutput, convert, m_pFileComment)) {
+      return SI_FAIL;
+    }
+    bNeedNewLine = true;
+  }
+
+  // iterate through our sections and output the data
+  const TSectionNode *pSection = NextSectionToSave(NULL, pEmpty);
+  for (; pSection; pSection = NextSectionToSave(pSection, pEmpty)) {
+    const Entry &oSection = pSection->first;
+
+    // write out the comment if there is one
+    if (oSection.pComment) {
+      if (bNeedNewLine) {
+        a_oOutput.Write(SI_NEWLINE_A);
+        a_oOutput.Write(SI_NEWLINE_A);
+      }
+      if (!OutputMultiLineText(a_oOutput, convert, oSection.pComment)) {
+        return SI_FAIL;
+      }
+      bNeedNewLine = false;
+    }
+
+    if (bNeedNewLine) {
+      a_oOutput.Write(SI_NEWLINE_A);
+      a_oOutput.Write(SI_NEWLINE_A);
+      bNeedNewLine = false;
+    }
+
+    // write the section (unless there is no section name)
+    if (*oSection.pItem) {
+      if (!convert.ConvertToStore(oSection.pItem, oSection.uLen)) {
+        return SI_FAIL;
+      }
+      a_oOutput.Write("[");
+      a_oOutput.Write(convert);
+      a_oOutput.Write("]");
+      a_oOutput.Write(SI_NEWLINE_A);
+    }
+
+    // write all keys and values, the values of a key with its first value
+    const TKeyNode *pKey = FirstKeyLoaded(*pSection);
+    for (; pKey; pKey = NextKeyLoaded(*pSection, pKey)) {
+      if (!pKey->first.bFirstValue) {
+        continue;
+      }
+      const Entry &oKey = pKey->first;
+      const TKeyNode *pValue = pKey;
+      for (; pValue; pValue = m_bAllowMultiKey ? NextValue(pValue) : NULL) {
+        // write out the comment if there is one
+        if (pValue->first.pComment) {
+          a_oOutput.Write(SI_NEWLINE_A);
+          if (!OutputMultiLineText(a_oOutput, convert,
+                                   pValue->first.pComment)) {
+            return SI_FAIL;
+          }
+        }
+
+        // write the key
+        if (!convert.ConvertToStore(oKey.pItem, oKey.uLen)) {
+          return SI_FAIL;
+        }
+        a_oOutput.Write(convert);
+
+        // write the value as long
+        const SI_CHAR *pItem = pValue->second;
+        if (*pItem || !m_bAllowKeyOnly) {
+          if (!convert.ConvertToStore(pItem, Entry::Length(pItem))) {
+            return SI_FAIL;
+          }
+          if (m_bSpaces) {
+            a_oOutput.Write(" = ");
+          } else {
+            a_oOutput.Write("=");
+          }
+          if (m_bParseQuotes && IsSingleLineQuotedValue(pItem)) {
+            // the only way to preserve external whitespace on a value (i.e. before or after)
+            // is to quote it. This is simple quoting, we don't escape quotes within the data.
+            a_oOutput.Write("\"");
+            a_oOutput.Write(convert);
+            a_oOutput.Write("\"");
+          } else if (m_bAllowMultiLine && IsMultiLineData(pItem)) {
+            // multi-line data needs to be processed specially to ensure
+            // that we use the correct newline format for the current system
+            a_oOutput.Write("<<<END_OF_TEXT" SI_NEWLINE_A);
+            if (!OutputMultiLineText(a_oOutput, convert, pItem)) {
+              return SI_FAIL;
+            }
+            a_oOutput.Write("END_OF_TEXT");
+          } else {
+            a_oOutput.Write(convert);
+          }
+        }
+        a_oOutput.Write(SI_NEWLINE_A);
+      }
+    }
+
+    bNeedNewLine = true;
+  }
+
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::OutputMultiLineText(
+    OutputBuffer &a_oOutput, Converter &a_oConverter,
+    const SI_CHAR *a_pText) const {
+  const SI_CHAR *pEndOfLine;
+  SI_CHAR cEndOfLineChar = *a_pText;
+  while (cEndOfLineChar) {
+    // find the end of this line
+    pEndOfLine = a_pText;
+    for (; *pEndOfLine && *pEndOfLine != '\n'; ++pEndOfLine) /*loop*/
+      ;
+    cEndOfLineChar = *pEndOfLine;
+
+    // a line is only copied to terminate it when it must be converted
+    const size_t uLine = static_cast<size_t>(pEndOfLine - a_pText);
+    if (SI_IsIdentityConverter<SI_CONVERTER>::value) {
+      if (!a_oConverter.ConvertToStore(a_pText, uLine)) {
+        return false;
+      }
+    } else {
+      const std::basic_string<SI_CHAR> line(a_pText, uLine);
+      if (!a_oConverter.ConvertToStore(line.c_str())) {
+        return false;
+      }
+    }
+    a_pText += (pEndOfLine - a_pText) + 1;
+    a_oOutput.Write(a_oConverter);
+    a_oOutput.Write(SI_NEWLINE_A);
+  }
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Delete(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, bool a_bRemoveEmpty) {
+  return DeleteValue(a_pSection, a_pKey, NULL, a_bRemoveEmpty);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::DeleteValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pValue,
+    bool a_bRemoveEmpty) {
+  if (!a_pSection) {
+    return false;
+  }
+
+  typename TSection::iterator iSection = FindSection(a_pSection);
+  if (iSection == m_data.end()) {
+    return false;
+  }
+
+  // remove a single key if we have a keyname
+  if (a_pKey) {
+    typename TKeyVal::iterator iKeyVal = FindKey(iSection->second, a_pKey);
+    if (iKeyVal == iSection->second.end()) {
+      return false;
+    }
+
+    const static SI_STRLESS isLess = SI_STRLESS();
+    // the caller's name, it may be one of the strings that is deleted
+    Entry oKey = iKeyVal->first;
+    oKey.pItem = a_pKey;
+
+    // remove any copied strings and then the key
+    typename TKeyVal::iterator iDelete;
+    bool bDeleted = false;
+    do {
+      iDelete = iKeyVal++;
+
+      if (a_pValue == NULL || (isLess(a_pValue, iDelete->second) == false &&
+                               isLess(iDelete->second, a_pValue) == false)) {
+        if (m_bHashIndex) {
+          UnindexKey(iSection->second, iDelete);
+        }
+        UnlinkKey(*iSection, iDelete);
+        --m_uKeys;
+        UncountKey(iDelete->first, iDelete->second);
+        UncacheValue(&*iDelete);
+        DeleteString(iDelete->first.pItem);
+        DeleteString(iDelete->first.pComment);
+        DeleteString(iDelete->second);
+        iSection->second.erase(iDelete);
+        bDeleted = true;
+      }
+    } while (iKeyVal != iSection->second.end() &&
+             iKeyVal->first.IsSameName(oKey));
+
+    if (!bDeleted) {
+      return false;
+    }
+    BindKeySlot(iSection, oKey.pItem);
+
+    // done now if the section is not empty or we are not pruning away
+    // the empty sections. Otherwise let it fall through into the section
+    // deletion code
+    if (!a_bRemoveEmpty || !iSection->second.empty()) {
+      return true;
+    }
+  } else {
+    // delete all copied strings from this section. The actual
+    // entries will be removed when the section is removed.
+    if (m_bHashIndex) {
+      UnindexSection(iSection);
+    }
+    typename TKeyVal::iterator iKeyVal = iSection->second.begin();
+    for (; iKeyVal != iSection->second.end(); ++iKeyVal) {
+      UncountKey(iKeyVal->first, iKeyVal->second);
+      UncacheValue(&*iKeyVal);
+      DeleteString(iKeyVal->first.pItem);
+      DeleteString(iKeyVal->first.pComment);
+      DeleteString(iKeyVal->second);
+    }
+  }
+
+  // delete the section itself, a whole section was unindexed above
+  if (m_bHashIndex && a_pKey) {
+    UnindexSection(iSection);
+  }
+  UnbindKeySlots(iSection->first.pItem);
+  m_uSaveBytes -= SectionBytes(iSection->first);
+  DeleteString(iSection->first.pItem);
+  DeleteString(iSection->first.pComment);
+  UnlinkLoaded(m_pLastSection, &*iSection);
+  m_uKeys -= iSection->second.size();
+  m_data.erase(iSection);
+
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Diff(
+    const CSimpleIniTempl &a_other, TDiff &a_diff) const {
+  a_diff.clear();
+  LoadLazySections();
+  a_other.LoadLazySections();
+
+  // both maps are sorted by the same order, so one pass over each finds
+  // the sections that are in only one of them
+  typename TSection::key_compare isLess = m_data.key_comp();
+  typename TSection::const_iterator iSection = m_data.begin();
+  typename TSection::const_iterator iOther = a_other.m_data.begin();
+  while (iSection != m_data.end() || iOther != a_other.m_data.end()) {
+    if (iOther == a_other.m_data.end() ||
+        (iSection != m_data.end() && isLess(iSection->first, iOther->first))) {
+      AddDiff(a_diff, DiffEntry::REMOVED, iSection->first.pItem, NULL, NULL,
+              NULL);
+      ++iSection;
+    } else if (iSection == m_data.end() ||
+               isLess(iOther->first, iSection->first)) {
+      AddDiff(a_diff, DiffEntry::ADDED, iOther->first.pItem, NULL, NULL, NULL);
+      ++iOther;
+    } else {
+      DiffKeys(iSection->first.pItem, iSection->second, iOther->second,
+               a_diff);
+      ++iSection;
+      ++iOther;
+    }
+  }
+  return a_diff.size();
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::DiffKeys(
+    const SI_CHAR *a_pSection, const TKeyVal &a_keyval, const TKeyVal &a_other,
+    TDiff &a_diff) {
+  typename TKeyVal::key_compare isLess = a_keyval.key_comp();
+  typename TKeyVal::const_iterator iKeyVal = a_keyval.begin();
+  typename TKeyVal::const_iterator iOther = a_other.begin();
+  while (iKeyVal != a_keyval.end() || iOther != a_other.end()) {
+    // the first key of either map. The values of a key are in load order,
+    // so they are compared in pairs until both maps have passed the key.
+    const Entry &oKey =
+        (iOther == a_other.end() ||
+         (iKeyVal != a_keyval.end() && !isLess(iOther->first, iKeyVal->first)))
+            ? iKeyVal->first
+            : iOther->first;
+    for (;;) {
+      const bool bThis =
+          iKeyVal != a_keyval.end() && !isLess(oKey, iKeyVal->first);
+      const bool bOther =
+          iOther != a_other.end() && !isLess(oKey, iOther->first);
+      if (bThis && bOther) {
+        if (!IsIdentical(iKeyVal->second, iOther->second)) {
+          AddDiff(a_diff, DiffEntry::CHANGED, a_pSection,
+                  iKeyVal->first.pItem, iKeyVal->second, iOther->second);
+        }
+        ++iKeyVal;
+        ++iOther;
+      } else if (bThis) {
+        AddDiff(a_diff, DiffEntry::REMOVED, a_pSection, iKeyVal->first.pItem,
+                iKeyVal->second, NULL);
+        ++iKeyVal;
+      } else if (bOther) {
+        AddDiff(a_diff, DiffEntry::ADDED, a_pSection, iOther->first.pItem, NULL,
+                iOther->second);
+        ++iOther;
+      } else {
+        break;
+      }
+    }
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::DeleteString(
+    const SI_CHAR *a_pString) {
+  if (!a_pString) {
+    return;
+  }
+  // strings may exist either inside the data block, or they will be
+  // allocated from m_strings. We only physically delete those allocated
+  // from m_strings, which knows its own strings.
+  if (!m_pData || a_pString < m_pData || a_pString >= m_pData + m_uDataLen) {
+    m_strings.Free(a_pString);
+  }
+}
+
+// ---------------------------------------------------------------------------
+//                              CONVERSION FUNCTIONS
+// ---------------------------------------------------------------------------
+
+// Defines the conversion classes for different libraries. Before including
+// SimpleIni.h, set the converter that you wish you use by defining one of the
+// following symbols.
+//
+//  SI_NO_CONVERSION        Do not make the "W" wide character version of the
+//                          library available. Only CSimpleIniA etc is defined.
+//                          Default on Linux/MacOS/etc.
+//  SI_CONVERT_WIN32        Use the Win32 API functions for conversion.
+//                          Default on Windows.
+//  SI_CONVERT_GENERIC      Use built-in locale-independent UTF-8 conversion
+//                          (no additional source files required)
+//  SI_CONVERT_ICU          Use the IBM ICU conversion library. Requires
+//                          ICU headers on include path and icuuc.lib
+
+#if !defined(SI_NO_CONVERSION) && !defined(SI_CONVERT_GENERIC) &&              \
+    !defined(SI_CONVERT_WIN32) && !defined(SI_CONVERT_ICU)
+#ifdef _WIN32
+#define SI_CONVERT_WIN32
+#else
+#define SI_NO_CONVERSION
+#endif
+#endif
 
 /**
  * Generic case-sensitive less than comparison. This class returns numerically
@@ -2838,47 +7520,380 @@ template <class SI_CHAR> struct SI_GenericCase {
         return cmp < 0;
       }
     }
-    return *pRight != 0;
+    return *pRight != 0;
+  }
+};
+
+/**
+ * Generic ASCII case-insensitive less than comparison. This class returns
+ * numerically ordered ASCII case-insensitive text for all possible sizes
+ * and types of SI_CHAR. It is not safe for MBCS text comparison where
+ * ASCII A-Z characters are used in the encoding of multi-byte characters.
+ */
+template <class SI_CHAR> struct SI_GenericNoCase {
+  inline SI_CHAR locase(SI_CHAR ch) const {
+    return (ch < 'A' || ch > 'Z') ? ch : (ch - 'A' + 'a');
+  }
+  bool operator()(const SI_CHAR *pLeft, const SI_CHAR *pRight) const {
+    long cmp;
+    for (; *pLeft && *pRight; ++pLeft, ++pRight) {
+      cmp = (long)locase(*pLeft) - (long)locase(*pRight);
+      if (cmp != 0) {
+        return cmp < 0;
+      }
+    }
+    return *pRight != 0;
+  }
+};
+
+/** FNV-1a hash that matches SI_GenericCase */
+template <class SI_CHAR> struct SI_StrHash<SI_GenericCase<SI_CHAR>> {
+  static constexpr bool value = true;
+  static size_t Hash(const SI_CHAR *a_pStr) {
+    size_t uHash = 2166136261u;
+    for (; *a_pStr; ++a_pStr) {
+      uHash = (uHash ^ (size_t)*a_pStr) * 16777619u;
+    }
+    return uHash;
+  }
+  static size_t Hash(const SI_CHAR *a_pStr, size_t a_uLen) {
+    size_t uHash = 2166136261u;
+    for (size_t n = 0; n < a_uLen; ++n) {
+      uHash = (uHash ^ (size_t)a_pStr[n]) * 16777619u;
+    }
+    return uHash;
+  }
+};
+
+/** FNV-1a hash of the ASCII lowercase text that matches SI_GenericNoCase */
+template <class SI_CHAR> struct SI_StrHash<SI_GenericNoCase<SI_CHAR>> {
+  static constexpr bool value = true;
+  static size_t Hash(const SI_CHAR *a_pStr) {
+    size_t uHash = 2166136261u;
+    for (; *a_pStr; ++a_pStr) {
+      const SI_CHAR ch = *a_pStr;
+      const SI_CHAR lower = (ch < 'A' || ch > 'Z') ? ch : (ch - 'A' + 'a');
+      uHash = (uHash ^ (size_t)lower) * 16777619u;
+    }
+    return uHash;
+  }
+  static size_t Hash(const SI_CHAR *a_pStr, size_t a_uLen) {
+    size_t uHash = 2166136261u;
+    for (size_t n = 0; n < a_uLen; ++n) {
+      const SI_CHAR ch = a_pStr[n];
+      const SI_CHAR lower = (ch < 'A' || ch > 'Z') ? ch : (ch - 'A' + 'a');
+      uHash = (uHash ^ (size_t)lower) * 16777619u;
+    }
+    return uHash;
+  }
+};
+
+/** Comparison of strings of a known length that matches SI_GenericCase */
+template <class SI_CHAR> struct SI_StrCompareN<SI_GenericCase<SI_CHAR>> {
+  static constexpr bool value = true;
+  static int Compare(const SI_CHAR *a_pLeft, size_t a_uLeft,
+                     const SI_CHAR *a_pRight, size_t a_uRight) {
+    const size_t uLen = a_uLeft < a_uRight ? a_uLeft : a_uRight;
+    for (size_t n = 0; n < uLen; ++n) {
+      if (a_pLeft[n] != a_pRight[n]) {
+        return (long)a_pLeft[n] < (long)a_pRight[n] ? -1 : 1;
+      }
+    }
+    return a_uLeft == a_uRight ? 0 : (a_uLeft < a_uRight ? -1 : 1);
+  }
+};
+
+/** Comparison of strings of a known length that matches SI_GenericNoCase */
+template <class SI_CHAR> struct SI_StrCompareN<SI_GenericNoCase<SI_CHAR>> {
+  static constexpr bool value = true;
+  static int Compare(const SI_CHAR *a_pLeft, size_t a_uLeft,
+                     const SI_CHAR *a_pRight, size_t a_uRight) {
+    const SI_GenericNoCase<SI_CHAR> noCase;
+    const size_t uLen = a_uLeft < a_uRight ? a_uLeft : a_uRight;
+    for (size_t n = 0; n < uLen; ++n) {
+      const long cmp =
+          (long)noCase.locase(a_pLeft[n]) - (long)noCase.locase(a_pRight[n]);
+      if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+      }
+    }
+    return a_uLeft == a_uRight ? 0 : (a_uLeft < a_uRight ? -1 : 1);
   }
 };
 
 /**
- * Generic ASCII case-insensitive less than comparison. This class returns
- * numerically ordered ASCII case-insensitive text for all possible sizes
- * and types of SI_CHAR. It is not safe for MBCS text comparison where
- * ASCII A-Z characters are used in the encoding of multi-byte characters.
+ * Null conversion class for MBCS/UTF-8 to char (or equivalent).
  */
-template <class SI_CHAR> struct SI_GenericNoCase {
-  inline SI_CHAR locase(SI_CHAR ch) const {
-    return (ch < 'A' || ch > 'Z') ? ch : (ch - 'A' + 'a');
+template <class SI_CHAR> class SI_ConvertA {
+  bool m_bStoreIsUtf8;
+
+protected:
+  SI_ConvertA() {}
+
+public:
+  SI_ConvertA(bool a_bStoreIsUtf8) : m_bStoreIsUtf8(a_bStoreIsUtf8) {}
+
+  /* copy and assignment */
+  SI_ConvertA(const SI_ConvertA &rhs) { operator=(rhs); }
+  SI_ConvertA &operator=(const SI_ConvertA &rhs) {
+    m_bStoreIsUtf8 = rhs.m_bStoreIsUtf8;
+    return *this;
   }
-  bool operator()(const SI_CHAR *pLeft, const SI_CHAR *pRight) const {
-    long cmp;
-    for (; *pLeft && *pRight; ++pLeft, ++pRight) {
-      cmp = (long)locase(*pLeft) - (long)locase(*pRight);
-      if (cmp != 0) {
-        return cmp < 0;
+
+  /** Calculate the number of SI_CHAR required for converting the input
+     * from the storage format. The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
+     * @param a_uInputDataLen Length of storage format data in bytes. This
+     *                      must be the actual length of the data, including
+     *                      NULL byte if NULL terminated string is required.
+     * @return              Number of SI_CHAR required by the string when
+     *                      converted. If there are embedded NULL bytes in the
+     *                      input data, only the string up and not including
+     *                      the NULL byte will be converted.
+     * @return              -1 cast to size_t on a conversion error.
+     */
+  size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
+    (void)a_pInputData;
+    SI_ASSERT(a_uInputDataLen != (size_t)-1);
+
+    // ASCII/MBCS/UTF-8 needs no conversion
+    return a_uInputDataLen;
+  }
+
+  /** Convert the input string from the storage format to SI_CHAR.
+     * The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
+     * @param a_uInputDataLen Length of storage format data in bytes. This
+     *                      must be the actual length of the data, including
+     *                      NULL byte if NULL terminated string is required.
+     * @param a_pOutputData Pointer to the output buffer to received the
+     *                      converted data.
+     * @param a_uOutputDataSize Size of the output buffer in SI_CHAR.
+     * @return              true if all of the input data was successfully
+     *                      converted.
+     */
+  bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
+                        SI_CHAR *a_pOutputData, size_t a_uOutputDataSize) {
+    // ASCII/MBCS/UTF-8 needs no conversion
+    if (a_uInputDataLen > a_uOutputDataSize) {
+      return false;
+    }
+    memcpy(a_pOutputData, a_pInputData, a_uInputDataLen);
+    return true;
+  }
+
+  /** Calculate the number of char required by the storage format of this
+     * data. The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  NULL terminated string to calculate the number of
+     *                      bytes required to be converted to storage format.
+     * @return              Number of bytes required by the string when
+     *                      converted to storage format. This size always
+     *                      includes space for the terminating NULL character.
+     * @return              -1 cast to size_t on a conversion error.
+     */
+  size_t SizeToStore(const SI_CHAR *a_pInputData) {
+    // ASCII/MBCS/UTF-8 needs no conversion
+    return strlen((const char *)a_pInputData) + 1;
+  }
+
+  /** Convert the input string to the storage format of this data.
+     * The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  NULL terminated source string to convert. All of
+     *                      the data will be converted including the
+     *                      terminating NULL character.
+     * @param a_pOutputData Pointer to the buffer to receive the converted
+     *                      string.
+     * @param a_uOutputDataSize Size of the output buffer in char.
+     * @return              true if all of the input data, including the
+     *                      terminating NULL character was successfully
+     *                      converted.
+     */
+  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
+                      size_t a_uOutputDataSize) {
+    // calc input string length (SI_CHAR type and size independent)
+    size_t uInputLen = strlen((const char *)a_pInputData) + 1;
+    if (uInputLen > a_uOutputDataSize) {
+      return false;
+    }
+
+    // ascii/UTF-8 needs no conversion
+    memcpy(a_pOutputData, a_pInputData, uInputLen);
+    return true;
+  }
+};
+
+// ---------------------------------------------------------------------------
+//                              SI_CONVERT_GENERIC
+// ---------------------------------------------------------------------------
+#ifdef SI_CONVERT_GENERIC
+
+#define SI_Case SI_GenericCase
+#define SI_NoCase SI_GenericNoCase
+
+#include <wchar.h>
+
+namespace SI_UTF8 {
+
+constexpr char32_t REPLACEMENT = 0xFFFD;
+
+/** Decode one UTF-8 code point. Returns false on illegal or truncated input. */
+inline bool Decode(const char *&a_src, const char *a_end, char32_t &a_cp) {
+  if (a_src >= a_end) {
+    return false;
+  }
+  const unsigned char c0 = (unsigned char)*a_src++;
+  if (c0 < 0x80) {
+    a_cp = c0;
+    return true;
+  }
+  if (c0 < 0xC2) {
+    return false;
+  }
+
+  int extra = 0;
+  char32_t ch = 0;
+  if (c0 < 0xE0) {
+    extra = 1;
+    ch = c0 & 0x1F;
+  } else if (c0 < 0xF0) {
+    extra = 2;
+    ch = c0 & 0x0F;
+  } else if (c0 < 0xF5) {
+    extra = 3;
+    ch = c0 & 0x07;
+  } else {
+    return false;
+  }
+  if (a_src + extra > a_end) {
+    a_src -= 1;
+    return false;
+  }
+
+  for (int i = 0; i < extra; ++i) {
+    const unsigned char cx = (unsigned char)*a_src++;
+    if ((cx & 0xC0) != 0x80) {
+      a_src -= (i + 2);
+      return false;
+    }
+    ch = (ch << 6) | (cx & 0x3F);
+  }
+
+  if ((extra == 1 && ch < 0x80) || (extra == 2 && ch < 0x800) ||
+      (extra == 3 && ch < 0x10000) || ch > 0x10FFFF ||
+      (ch >= 0xD800 && ch <= 0xDFFF)) {
+    a_src -= (extra + 1);
+    return false;
+  }
+
+  a_cp = ch;
+  return true;
+}
+
+/** Encode one code point as UTF-8. Returns bytes written, or -1 on error.
+ *  Surrogate code points (U+D800..U+DFFF) and values above U+10FFFF are
+ *  encoded as U+FFFD so output is always well-formed UTF-8. */
+inline int Encode(char32_t a_cp, char *a_dst, size_t a_cap) {
+  if (a_cp >= 0x110000 || (a_cp >= 0xD800 && a_cp <= 0xDFFF)) {
+    a_cp = REPLACEMENT;
+  }
+
+  if (a_cp < 0x80) {
+    if (a_cap < 1)
+      return -1;
+    a_dst[0] = (char)a_cp;
+    return 1;
+  }
+  if (a_cp < 0x800) {
+    if (a_cap < 2)
+      return -1;
+    a_dst[0] = (char)(0xC0 | (a_cp >> 6));
+    a_dst[1] = (char)(0x80 | (a_cp & 0x3F));
+    return 2;
+  }
+  if (a_cp < 0x10000) {
+    if (a_cap < 3)
+      return -1;
+    a_dst[0] = (char)(0xE0 | (a_cp >> 12));
+    a_dst[1] = (char)(0x80 | ((a_cp >> 6) & 0x3F));
+    a_dst[2] = (char)(0x80 | (a_cp & 0x3F));
+    return 3;
+  }
+  if (a_cap < 4)
+    return -1;
+  a_dst[0] = (char)(0xF0 | (a_cp >> 18));
+  a_dst[1] = (char)(0x80 | ((a_cp >> 12) & 0x3F));
+  a_dst[2] = (char)(0x80 | ((a_cp >> 6) & 0x3F));
+  a_dst[3] = (char)(0x80 | (a_cp & 0x3F));
+  return 4;
+}
+
+template <class SI_CHAR>
+inline bool AppendCodePoint(char32_t a_cp, SI_CHAR *&a_dst, SI_CHAR *a_dstEnd) {
+  if (sizeof(SI_CHAR) >= sizeof(char32_t)) {
+    if (a_dst >= a_dstEnd)
+      return false;
+    *a_dst++ = (SI_CHAR)a_cp;
+    return true;
+  }
+  if (sizeof(SI_CHAR) == 2) {
+    if (a_cp < 0x10000) {
+      if (a_dst >= a_dstEnd)
+        return false;
+      *a_dst++ = (SI_CHAR)a_cp;
+      return true;
+    }
+    if (a_dst + 1 >= a_dstEnd)
+      return false;
+    a_cp -= 0x10000;
+    *a_dst++ = (SI_CHAR)(0xD800 + (a_cp >> 10));
+    *a_dst++ = (SI_CHAR)(0xDC00 + (a_cp & 0x3FF));
+    return true;
+  }
+  return false;
+}
+
+template <class SI_CHAR>
+inline bool ReadCodePoint(const SI_CHAR *&a_src, char32_t &a_cp) {
+  if (sizeof(SI_CHAR) >= sizeof(char32_t)) {
+    a_cp = (char32_t)*a_src++;
+    return true;
+  }
+  if (sizeof(SI_CHAR) == 2) {
+    const char32_t w = (char32_t)*a_src++;
+    if (w >= 0xD800 && w <= 0xDBFF) {
+      if (*a_src >= 0xDC00 && *a_src <= 0xDFFF) {
+        a_cp = 0x10000 + ((w - 0xD800) << 10) + ((char32_t)*a_src++ - 0xDC00);
+        return true;
       }
     }
-    return *pRight != 0;
+    a_cp = w;
+    return true;
   }
-};
+  return false;
+}
+
+} // namespace SI_UTF8
 
 /**
- * Null conversion class for MBCS/UTF-8 to char (or equivalent).
+ * Converts UTF-8 to a wchar_t (or equivalent) using built-in UTF-8 conversion.
+ * This can be used on all platforms without locale configuration.
  */
-template <class SI_CHAR> class SI_ConvertA {
+template <class SI_CHAR> class SI_ConvertW {
   bool m_bStoreIsUtf8;
 
 protected:
-  SI_ConvertA() {}
+  SI_ConvertW() {}
 
 public:
-  SI_ConvertA(bool a_bStoreIsUtf8) : m_bStoreIsUtf8(a_bStoreIsUtf8) {}
+  SI_ConvertW(bool a_bStoreIsUtf8) : m_bStoreIsUtf8(a_bStoreIsUtf8) {}
 
   /* copy and assignment */
-  SI_ConvertA(const SI_ConvertA &rhs) { operator=(rhs); }
-  SI_ConvertA &operator=(const SI_ConvertA &rhs) {
+  SI_ConvertW(const SI_ConvertW &rhs) { operator=(rhs); }
+  SI_ConvertW &operator=(const SI_ConvertW &rhs) {
     m_bStoreIsUtf8 = rhs.m_bStoreIsUtf8;
     return *this;
   }
@@ -2897,11 +7912,28 @@ public:
      * @return              -1 cast to size_t on a conversion error.
      */
   size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
-    (void)a_pInputData;
     SI_ASSERT(a_uInputDataLen != (size_t)-1);
 
-    // ASCII/MBCS/UTF-8 needs no conversion
+    if (m_bStoreIsUtf8) {
+      // worst case scenario for UTF-8 to wchar_t is 1 char -> 1 wchar_t
+      // so we just return the same number of characters required as for
+      // the source text.
+      return a_uInputDataLen;
+    }
+
+    // get the required buffer size
+#if defined(_MSC_VER)
+    size_t uBufSiz;
+    errno_t e = mbstowcs_s(&uBufSiz, NULL, 0, a_pInputData, a_uInputDataLen);
+    return (e == 0) ? uBufSiz : (size_t)-1;
+#elif !defined(SI_NO_MBSTOWCS_NULL)
+    return mbstowcs(NULL, a_pInputData, a_uInputDataLen);
+#else
+    // fall back processing for platforms that don't support a NULL dest to mbstowcs
+    // worst case scenario is 1:1, this will be a sufficient buffer size
+    (void)a_pInputData;
     return a_uInputDataLen;
+#endif
   }
 
   /** Convert the input string from the storage format to SI_CHAR.
@@ -2909,21 +7941,246 @@ public:
      *
      * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
      * @param a_uInputDataLen Length of storage format data in bytes. This
+     *                       must be the actual length of the data, including
+     *                       NULL byte if NULL terminated string is required.
+     * @param a_pOutputData Pointer to the output buffer to received the
+     *                       converted data.
+     * @param a_uOutputDataSize Size of the output buffer in SI_CHAR.
+     * @return              true if all of the input data was successfully
+     *                       converted.
+     */
+  bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
+                        SI_CHAR *a_pOutputData, size_t a_uOutputDataSize) {
+    if (m_bStoreIsUtf8) {
+      const char *src = a_pInputData;
+      const char *srcEnd = a_pInputData + a_uInputDataLen;
+      SI_CHAR *dst = a_pOutputData;
+      SI_CHAR *dstEnd = a_pOutputData + a_uOutputDataSize;
+      if (sizeof(SI_CHAR) != 2 && sizeof(SI_CHAR) < sizeof(char32_t)) {
+        return false;
+      }
+      while (src < srcEnd) {
+        char32_t cp;
+        if (!SI_UTF8::Decode(src, srcEnd, cp)) {
+          return false;
+        }
+        if (!SI_UTF8::AppendCodePoint(cp, dst, dstEnd)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // convert to wchar_t
+#if defined(_MSC_VER)
+    size_t uBufSiz;
+    errno_t e = mbstowcs_s(&uBufSiz, a_pOutputData, a_uOutputDataSize,
+                           a_pInputData, a_uInputDataLen);
+    (void)uBufSiz;
+    return (e == 0);
+#else
+    size_t retval = mbstowcs(a_pOutputData, a_pInputData, a_uOutputDataSize);
+    return retval != (size_t)(-1);
+#endif
+  }
+
+  /** Calculate the number of char required by the storage format of this
+     * data. The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  NULL terminated string to calculate the number of
+     *                       bytes required to be converted to storage format.
+     * @return              Number of bytes required by the string when
+     *                       converted to storage format. This size always
+     *                       includes space for the terminating NULL character.
+     * @return              -1 cast to size_t on a conversion error.
+     */
+  size_t SizeToStore(const SI_CHAR *a_pInputData) {
+    if (m_bStoreIsUtf8) {
+      // worst case scenario for wchar_t to UTF-8 is 1 wchar_t -> 6 char
+      size_t uLen = 0;
+      while (a_pInputData[uLen]) {
+        ++uLen;
+      }
+      return (6 * uLen) + 1;
+    } else {
+#if defined(_MSC_VER)
+      size_t uLen = 0;
+      errno_t e = wcstombs_s(&uLen, NULL, 0, a_pInputData, 0);
+      if (e != 0) {
+        return (size_t)-1;
+      }
+      return uLen + 1; // include NULL terminator
+#else
+      size_t uLen = wcstombs(NULL, a_pInputData, 0);
+      if (uLen == (size_t)(-1)) {
+        return uLen;
+      }
+      return uLen + 1; // include NULL terminator
+#endif
+    }
+  }
+
+  /** Convert the input string to the storage format of this data.
+     * The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  NULL terminated source string to convert. All of
+     *                       the data will be converted including the
+     *                       terminating NULL character.
+     * @param a_pOutputData Pointer to the buffer to receive the converted
+     *                       string.
+     * @param a_uOutputDataSize Size of the output buffer in char.
+     * @return              true if all of the input data, including the
+     *                       terminating NULL character was successfully
+     *                       converted.
+     */
+  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
+                      size_t a_uOutputDataSize) {
+    if (m_bStoreIsUtf8) {
+      const SI_CHAR *src = a_pInputData;
+      char *dst = a_pOutputData;
+      char *dstEnd = a_pOutputData + a_uOutputDataSize;
+      if (sizeof(SI_CHAR) != 2 && sizeof(SI_CHAR) < sizeof(char32_t)) {
+        return false;
+      }
+      while (*src) {
+        char32_t cp;
+        if (!SI_UTF8::ReadCodePoint(src, cp)) {
+          return false;
+        }
+        char buf[4];
+        const int n = SI_UTF8::Encode(cp, buf, sizeof(buf));
+        if (n < 0 || (size_t)(dstEnd - dst) < (size_t)n) {
+          return false;
+        }
+        memcpy(dst, buf, (size_t)n);
+        dst += n;
+      }
+      if (dst >= dstEnd) {
+        return false;
+      }
+      *dst = '\0';
+      return true;
+    } else {
+#if defined(_MSC_VER)
+      size_t converted = 0;
+      errno_t e = wcstombs_s(&converted, a_pOutputData, a_uOutputDataSize,
+                             a_pInputData, 0);
+      return (e == 0);
+#else
+      size_t retval = wcstombs(a_pOutputData, a_pInputData, a_uOutputDataSize);
+      return retval != (size_t)-1;
+#endif
+    }
+  }
+};
+
+#endif // SI_CONVERT_GENERIC
+
+// ---------------------------------------------------------------------------
+//                              SI_CONVERT_ICU
+// ---------------------------------------------------------------------------
+#ifdef SI_CONVERT_ICU
+
+#define SI_Case SI_GenericCase
+#define SI_NoCase SI_GenericNoCase
+
+#include <unicode/ucnv.h>
+
+/**
+ * Converts MBCS/UTF-8 to UChar using ICU. This can be used on all platforms.
+ */
+template <class SI_CHAR> class SI_ConvertW {
+  const char *m_pEncoding;
+  UConverter *m_pConverter;
+
+protected:
+  SI_ConvertW() : m_pEncoding(NULL), m_pConverter(NULL) {}
+
+public:
+  SI_ConvertW(bool a_bStoreIsUtf8) : m_pConverter(NULL) {
+    m_pEncoding = a_bStoreIsUtf8 ? "UTF-8" : NULL;
+  }
+
+  /* copy and assignment */
+  SI_ConvertW(const SI_ConvertW &rhs) { operator=(rhs); }
+  SI_ConvertW &operator=(const SI_ConvertW &rhs) {
+    m_pEncoding = rhs.m_pEncoding;
+    m_pConverter = NULL;
+    return *this;
+  }
+  ~SI_ConvertW() {
+    if (m_pConverter)
+      ucnv_close(m_pConverter);
+  }
+
+  /** Calculate the number of UChar required for converting the input
+     * from the storage format. The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  Data in storage format to be converted to UChar.
+     * @param a_uInputDataLen Length of storage format data in bytes. This
+     *                      must be the actual length of the data, including
+     *                      NULL byte if NULL terminated string is required.
+     * @return              Number of UChar required by the string when
+     *                      converted. If there are embedded NULL bytes in the
+     *                      input data, only the string up and not including
+     *                      the NULL byte will be converted.
+     * @return              -1 cast to size_t on a conversion error.
+     */
+  size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
+    SI_ASSERT(a_uInputDataLen != (size_t)-1);
+
+    UErrorCode nError;
+
+    if (!m_pConverter) {
+      nError = U_ZERO_ERROR;
+      m_pConverter = ucnv_open(m_pEncoding, &nError);
+      if (U_FAILURE(nError)) {
+        return (size_t)-1;
+      }
+    }
+
+    nError = U_ZERO_ERROR;
+    int32_t nLen = ucnv_toUChars(m_pConverter, NULL, 0, a_pInputData,
+                                 (int32_t)a_uInputDataLen, &nError);
+    if (U_FAILURE(nError) && nError != U_BUFFER_OVERFLOW_ERROR) {
+      return (size_t)-1;
+    }
+
+    return (size_t)nLen;
+  }
+
+  /** Convert the input string from the storage format to UChar.
+     * The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  Data in storage format to be converted to UChar.
+     * @param a_uInputDataLen Length of storage format data in bytes. This
      *                      must be the actual length of the data, including
      *                      NULL byte if NULL terminated string is required.
      * @param a_pOutputData Pointer to the output buffer to received the
      *                      converted data.
-     * @param a_uOutputDataSize Size of the output buffer in SI_CHAR.
+     * @param a_uOutputDataSize Size of the output buffer in UChar.
      * @return              true if all of the input data was successfully
      *                      converted.
      */
   bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
-                        SI_CHAR *a_pOutputData, size_t a_uOutputDataSize) {
-    // ASCII/MBCS/UTF-8 needs no conversion
-    if (a_uInputDataLen > a_uOutputDataSize) {
+                        UChar *a_pOutputData, size_t a_uOutputDataSize) {
+    UErrorCode nError;
+
+    if (!m_pConverter) {
+      nError = U_ZERO_ERROR;
+      m_pConverter = ucnv_open(m_pEncoding, &nError);
+      if (U_FAILURE(nError)) {
+        return false;
+      }
+    }
+
+    nError = U_ZERO_ERROR;
+    ucnv_toUChars(m_pConverter, a_pOutputData, (int32_t)a_uOutputDataSize,
+                  a_pInputData, (int32_t)a_uInputDataLen, &nError);
+    if (U_FAILURE(nError)) {
       return false;
     }
-    memcpy(a_pOutputData, a_pInputData, a_uInputDataLen);
+
     return true;
   }
 
@@ -2937,9 +8194,25 @@ public:
      *                      includes space for the terminating NULL character.
      * @return              -1 cast to size_t on a conversion error.
      */
-  size_t SizeToStore(const SI_CHAR *a_pInputData) {
-    // ASCII/MBCS/UTF-8 needs no conversion
-    return strlen((const char *)a_pInputData) + 1;
+  size_t SizeToStore(const UChar *a_pInputData) {
+    UErrorCode nError;
+
+    if (!m_pConverter) {
+      nError = U_ZERO_ERROR;
+      m_pConverter = ucnv_open(m_pEncoding, &nError);
+      if (U_FAILURE(nError)) {
+        return (size_t)-1;
+      }
+    }
+
+    nError = U_ZERO_ERROR;
+    int32_t nLen =
+        ucnv_fromUChars(m_pConverter, NULL, 0, a_pInputData, -1, &nError);
+    if (U_FAILURE(nError) && nError != U_BUFFER_OVERFLOW_ERROR) {
+      return (size_t)-1;
+    }
+
+    return (size_t)nLen + 1;
   }
 
   /** Convert the input string to the storage format of this data.
@@ -2950,194 +8223,98 @@ public:
      *                      terminating NULL character.
      * @param a_pOutputData Pointer to the buffer to receive the converted
      *                      string.
-     * @param a_uOutputDataSize Size of the output buffer in char.
+     * @param a_pOutputDataSize Size of the output buffer in char.
      * @return              true if all of the input data, including the
      *                      terminating NULL character was successfully
      *                      converted.
      */
-  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
+  bool ConvertToStore(const UChar *a_pInputData, char *a_pOutputData,
                       size_t a_uOutputDataSize) {
-    // calc input string length (SI_CHAR type and size independent)
-    size_t uInputLen = strlen((const char *)a_pInputData) + 1;
-    if (uInputLen > a_uOutputDataSize) {
+    UErrorCode nError;
+
+    if (!m_pConverter) {
+      nError = U_ZERO_ERROR;
+      m_pConverter = ucnv_open(m_pEncoding, &nError);
+      if (U_FAILURE(nError)) {
+        return false;
+      }
+    }
+
+    nError = U_ZERO_ERROR;
+    ucnv_fromUChars(m_pConverter, a_pOutputData, (int32_t)a_uOutputDataSize,
+                    a_pInputData, -1, &nError);
+    if (U_FAILURE(nError)) {
       return false;
     }
 
-    // ascii/UTF-8 needs no conversion
-    memcpy(a_pOutputData, a_pInputData, uInputLen);
     return true;
   }
 };
 
+#endif // SI_CONVERT_ICU
+
 // ---------------------------------------------------------------------------
-//                              SI_CONVERT_GENERIC
+//                              SI_CONVERT_WIN32
 // ---------------------------------------------------------------------------
-#ifdef SI_CONVERT_GENERIC
+#ifdef SI_CONVERT_WIN32
 
 #define SI_Case SI_GenericCase
-#define SI_NoCase SI_GenericNoCase
-
-#include <wchar.h>
-
-namespace SI_UTF8 {
-
-constexpr char32_t REPLACEMENT = 0xFFFD;
-
-/** Decode one UTF-8 code point. Returns false on illegal or truncated input. */
-inline bool Decode(const char *&a_src, const char *a_end, char32_t &a_cp) {
-  if (a_src >= a_end) {
-    return false;
-  }
-  const unsigned char c0 = (unsigned char)*a_src++;
-  if (c0 < 0x80) {
-    a_cp = c0;
-    return true;
-  }
-  if (c0 < 0xC2) {
-    return false;
-  }
-
-  int extra = 0;
-  char32_t ch = 0;
-  if (c0 < 0xE0) {
-    extra = 1;
-    ch = c0 & 0x1F;
-  } else if (c0 < 0xF0) {
-    extra = 2;
-    ch = c0 & 0x0F;
-  } else if (c0 < 0xF5) {
-    extra = 3;
-    ch = c0 & 0x07;
-  } else {
-    return false;
-  }
-  if (a_src + extra > a_end) {
-    a_src -= 1;
-    return false;
-  }
-
-  for (int i = 0; i < extra; ++i) {
-    const unsigned char cx = (unsigned char)*a_src++;
-    if ((cx & 0xC0) != 0x80) {
-      a_src -= (i + 2);
-      return false;
-    }
-    ch = (ch << 6) | (cx & 0x3F);
-  }
-
-  if ((extra == 1 && ch < 0x80) || (extra == 2 && ch < 0x800) ||
-      (extra == 3 && ch < 0x10000) || ch > 0x10FFFF ||
-      (ch >= 0xD800 && ch <= 0xDFFF)) {
-    a_src -= (extra + 1);
-    return false;
-  }
-
-  a_cp = ch;
-  return true;
-}
-
-/** Encode one code point as UTF-8. Returns bytes written, or -1 on error.
- *  Surrogate code points (U+D800..U+DFFF) and values above U+10FFFF are
- *  encoded as U+FFFD so output is always well-formed UTF-8. */
-inline int Encode(char32_t a_cp, char *a_dst, size_t a_cap) {
-  if (a_cp >= 0x110000 || (a_cp >= 0xD800 && a_cp <= 0xDFFF)) {
-    a_cp = REPLACEMENT;
-  }
 
-  if (a_cp < 0x80) {
-    if (a_cap < 1)
-      return -1;
-    a_dst[0] = (char)a_cp;
-    return 1;
-  }
-  if (a_cp < 0x800) {
-    if (a_cap < 2)
-      return -1;
-    a_dst[0] = (char)(0xC0 | (a_cp >> 6));
-    a_dst[1] = (char)(0x80 | (a_cp & 0x3F));
-    return 2;
-  }
-  if (a_cp < 0x10000) {
-    if (a_cap < 3)
-      return -1;
-    a_dst[0] = (char)(0xE0 | (a_cp >> 12));
-    a_dst[1] = (char)(0x80 | ((a_cp >> 6) & 0x3F));
-    a_dst[2] = (char)(0x80 | (a_cp & 0x3F));
-    return 3;
-  }
-  if (a_cap < 4)
-    return -1;
-  a_dst[0] = (char)(0xF0 | (a_cp >> 18));
-  a_dst[1] = (char)(0x80 | ((a_cp >> 12) & 0x3F));
-  a_dst[2] = (char)(0x80 | ((a_cp >> 6) & 0x3F));
-  a_dst[3] = (char)(0x80 | (a_cp & 0x3F));
-  return 4;
-}
+// Windows CE doesn't have errno or MBCS libraries
+#ifdef _WIN32_WCE
+#ifndef SI_NO_MBCS
+#define SI_NO_MBCS
+#endif
+#endif
 
-template <class SI_CHAR>
-inline bool AppendCodePoint(char32_t a_cp, SI_CHAR *&a_dst, SI_CHAR *a_dstEnd) {
-  if (sizeof(SI_CHAR) >= sizeof(char32_t)) {
-    if (a_dst >= a_dstEnd)
-      return false;
-    *a_dst++ = (SI_CHAR)a_cp;
-    return true;
-  }
-  if (sizeof(SI_CHAR) == 2) {
-    if (a_cp < 0x10000) {
-      if (a_dst >= a_dstEnd)
-        return false;
-      *a_dst++ = (SI_CHAR)a_cp;
-      return true;
+#include <windows.h>
+#ifdef SI_NO_MBCS
+#define SI_NoCase SI_GenericNoCase
+#else // !SI_NO_MBCS
+/**
+ * Case-insensitive comparison class using Win32 MBCS functions. This class
+ * returns a case-insensitive semi-collation order for MBCS text. It may not
+ * be safe for UTF-8 text returned in char format as we don't know what
+ * characters will be folded by the function! Therefore, if you are using
+ * SI_CHAR == char and SetUnicode(true), then you need to use the generic
+ * SI_NoCase class instead.
+ */
+#include <mbstring.h>
+template <class SI_CHAR> struct SI_NoCase {
+  bool operator()(const SI_CHAR *pLeft, const SI_CHAR *pRight) const {
+    if (sizeof(SI_CHAR) == sizeof(char)) {
+      return _mbsicmp((const unsigned char *)pLeft,
+                      (const unsigned char *)pRight) < 0;
     }
-    if (a_dst + 1 >= a_dstEnd)
-      return false;
-    a_cp -= 0x10000;
-    *a_dst++ = (SI_CHAR)(0xD800 + (a_cp >> 10));
-    *a_dst++ = (SI_CHAR)(0xDC00 + (a_cp & 0x3FF));
-    return true;
-  }
-  return false;
-}
-
-template <class SI_CHAR>
-inline bool ReadCodePoint(const SI_CHAR *&a_src, char32_t &a_cp) {
-  if (sizeof(SI_CHAR) >= sizeof(char32_t)) {
-    a_cp = (char32_t)*a_src++;
-    return true;
-  }
-  if (sizeof(SI_CHAR) == 2) {
-    const char32_t w = (char32_t)*a_src++;
-    if (w >= 0xD800 && w <= 0xDBFF) {
-      if (*a_src >= 0xDC00 && *a_src <= 0xDFFF) {
-        a_cp = 0x10000 + ((w - 0xD800) << 10) + ((char32_t)*a_src++ - 0xDC00);
-        return true;
-      }
+    if (sizeof(SI_CHAR) == sizeof(wchar_t)) {
+      return _wcsicmp((const wchar_t *)pLeft, (const wchar_t *)pRight) < 0;
     }
-    a_cp = w;
-    return true;
+    return SI_GenericNoCase<SI_CHAR>()(pLeft, pRight);
   }
-  return false;
-}
-
-} // namespace SI_UTF8
+};
+#endif // SI_NO_MBCS
 
 /**
- * Converts UTF-8 to a wchar_t (or equivalent) using built-in UTF-8 conversion.
- * This can be used on all platforms without locale configuration.
+ * Converts MBCS and UTF-8 to a wchar_t (or equivalent) on Windows. This uses
+ * only the Win32 functions and doesn't require the external Unicode UTF-8
+ * conversion library. It will not work on Windows 95 without using Microsoft
+ * Layer for Unicode in your application.
  */
 template <class SI_CHAR> class SI_ConvertW {
-  bool m_bStoreIsUtf8;
+  UINT m_uCodePage;
 
 protected:
   SI_ConvertW() {}
 
 public:
-  SI_ConvertW(bool a_bStoreIsUtf8) : m_bStoreIsUtf8(a_bStoreIsUtf8) {}
+  SI_ConvertW(bool a_bStoreIsUtf8) {
+    m_uCodePage = a_bStoreIsUtf8 ? CP_UTF8 : CP_ACP;
+  }
 
   /* copy and assignment */
   SI_ConvertW(const SI_ConvertW &rhs) { operator=(rhs); }
   SI_ConvertW &operator=(const SI_ConvertW &rhs) {
-    m_bStoreIsUtf8 = rhs.m_bStoreIsUtf8;
+    m_uCodePage = rhs.m_uCodePage;
     return *this;
   }
 
@@ -3157,26 +8334,9 @@ public:
   size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
     SI_ASSERT(a_uInputDataLen != (size_t)-1);
 
-    if (m_bStoreIsUtf8) {
-      // worst case scenario for UTF-8 to wchar_t is 1 char -> 1 wchar_t
-      // so we just return the same number of characters required as for
-      // the source text.
-      return a_uInputDataLen;
-    }
-
-    // get the required buffer size
-#if defined(_MSC_VER)
-    size_t uBufSiz;
-    errno_t e = mbstowcs_s(&uBufSiz, NULL, 0, a_pInputData, a_uInputDataLen);
-    return (e == 0) ? uBufSiz : (size_t)-1;
-#elif !defined(SI_NO_MBSTOWCS_NULL)
-    return mbstowcs(NULL, a_pInputData, a_uInputDataLen);
-#else
-    // fall back processing for platforms that don't support a NULL dest to mbstowcs
-    // worst case scenario is 1:1, this will be a sufficient buffer size
-    (void)a_pInputData;
-    return a_uInputDataLen;
-#endif
+    int retval = MultiByteToWideChar(m_uCodePage, 0, a_pInputData,
+                                     (int)a_uInputDataLen, 0, 0);
+    return (size_t)(retval > 0 ? retval : -1);
   }
 
   /** Convert the input string from the storage format to SI_CHAR.
@@ -3184,474 +8344,1105 @@ public:
      *
      * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
      * @param a_uInputDataLen Length of storage format data in bytes. This
-     *                       must be the actual length of the data, including
-     *                       NULL byte if NULL terminated string is required.
+     *                      must be the actual length of the data, including
+     *                      NULL byte if NULL terminated string is required.
      * @param a_pOutputData Pointer to the output buffer to received the
-     *                       converted data.
+     *                      converted data.
      * @param a_uOutputDataSize Size of the output buffer in SI_CHAR.
      * @return              true if all of the input data was successfully
-     *                       converted.
+     *                      converted.
      */
   bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
                         SI_CHAR *a_pOutputData, size_t a_uOutputDataSize) {
-    if (m_bStoreIsUtf8) {
-      const char *src = a_pInputData;
-      const char *srcEnd = a_pInputData + a_uInputDataLen;
-      SI_CHAR *dst = a_pOutputData;
-      SI_CHAR *dstEnd = a_pOutputData + a_uOutputDataSize;
-      if (sizeof(SI_CHAR) != 2 && sizeof(SI_CHAR) < sizeof(char32_t)) {
-        return false;
-      }
-      while (src < srcEnd) {
-        char32_t cp;
-        if (!SI_UTF8::Decode(src, srcEnd, cp)) {
-          return false;
-        }
-        if (!SI_UTF8::AppendCodePoint(cp, dst, dstEnd)) {
-          return false;
-        }
-      }
-      return true;
-    }
-
-    // convert to wchar_t
-#if defined(_MSC_VER)
-    size_t uBufSiz;
-    errno_t e = mbstowcs_s(&uBufSiz, a_pOutputData, a_uOutputDataSize,
-                           a_pInputData, a_uInputDataLen);
-    (void)uBufSiz;
-    return (e == 0);
-#else
-    size_t retval = mbstowcs(a_pOutputData, a_pInputData, a_uOutputDataSize);
-    return retval != (size_t)(-1);
-#endif
+    int nSize =
+        MultiByteToWideChar(m_uCodePage, 0, a_pInputData, (int)a_uInputDataLen,
+                            (wchar_t *)a_pOutputData, (int)a_uOutputDataSize);
+    return (nSize > 0);
   }
 
   /** Calculate the number of char required by the storage format of this
-     * data. The storage format is always UTF-8 or MBCS.
+     * data. The storage format is always UTF-8.
      *
      * @param a_pInputData  NULL terminated string to calculate the number of
-     *                       bytes required to be converted to storage format.
+     *                      bytes required to be converted to storage format.
      * @return              Number of bytes required by the string when
-     *                       converted to storage format. This size always
-     *                       includes space for the terminating NULL character.
+     *                      converted to storage format. This size always
+     *                      includes space for the terminating NULL character.
      * @return              -1 cast to size_t on a conversion error.
      */
   size_t SizeToStore(const SI_CHAR *a_pInputData) {
-    if (m_bStoreIsUtf8) {
-      // worst case scenario for wchar_t to UTF-8 is 1 wchar_t -> 6 char
-      size_t uLen = 0;
-      while (a_pInputData[uLen]) {
-        ++uLen;
-      }
-      return (6 * uLen) + 1;
-    } else {
-#if defined(_MSC_VER)
-      size_t uLen = 0;
-      errno_t e = wcstombs_s(&uLen, NULL, 0, a_pInputData, 0);
-      if (e != 0) {
-        return (size_t)-1;
-      }
-      return uLen + 1; // include NULL terminator
-#else
-      size_t uLen = wcstombs(NULL, a_pInputData, 0);
-      if (uLen == (size_t)(-1)) {
-        return uLen;
+    int retval = WideCharToMultiByte(
+        m_uCodePage, 0, (const wchar_t *)a_pInputData, -1, 0, 0, 0, 0);
+    return (size_t)(retval > 0 ? retval : -1);
+  }
+
+  /** Convert the input string to the storage format of this data.
+     * The storage format is always UTF-8 or MBCS.
+     *
+     * @param a_pInputData  NULL terminated source string to convert. All of
+     *                      the data will be converted including the
+     *                      terminating NULL character.
+     * @param a_pOutputData Pointer to the buffer to receive the converted
+     *                      string.
+     * @param a_pOutputDataSize Size of the output buffer in char.
+     * @return              true if all of the input data, including the
+     *                      terminating NULL character was successfully
+     *                      converted.
+     */
+  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
+                      size_t a_uOutputDataSize) {
+    int retval =
+        WideCharToMultiByte(m_uCodePage, 0, (const wchar_t *)a_pInputData, -1,
+                            a_pOutputData, (int)a_uOutputDataSize, 0, 0);
+    return retval > 0;
+  }
+};
+
+#endif // SI_CONVERT_WIN32
+
+// ---------------------------------------------------------------------------
+//                              SI_NO_CONVERSION
+// ---------------------------------------------------------------------------
+#ifdef SI_NO_CONVERSION
+
+#define SI_Case SI_GenericCase
+#define SI_NoCase SI_GenericNoCase
+
+#endif // SI_NO_CONVERSION
+
+// ---------------------------------------------------------------------------
+//                                  FROZEN COPY
+// ---------------------------------------------------------------------------
+
+/** A read-only copy of the data in a CSimpleIniTempl object. The sections
+    and keys are stored in sorted arrays and every string is stored once in
+    a single pool. Lookups are binary searches of contiguous memory, and the
+    copy uses a fraction of the memory of the maps in the original object.
+
+    The read functions behave as the functions of the same name in
+    CSimpleIniTempl. Use it for data that doesn't change after it has been
+    loaded.
+
+    <pre>
+    CSimpleIniA ini;
+    ini.LoadFile("config.ini");
+    CSimpleIniFrozenA config;
+    config.Freeze(ini);
+    ini.Reset();
+    const char *pszValue = config.GetValue("section", "key", "default");
+    </pre>
+ */
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+class CSimpleIniFrozenTempl {
+public:
+  typedef CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER> TIni;
+  typedef typename TIni::Entry Entry;
+  typedef typename TIni::TNamesDepend TNamesDepend;
+
+  CSimpleIniFrozenTempl() : m_bStoreIsUtf8(false), m_bAllowMultiKey(false) {}
+
+  /** Replace the contents with a copy of all sections, keys, values and
+        comments in a_ini. The copy doesn't refer to a_ini, which can be
+        changed or destroyed afterwards.
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error Freeze(const TIni &a_ini);
+
+  /** Deallocate all memory stored by this object */
+  void Reset();
+
+  /** Is there any data */
+  bool IsEmpty() const { return m_sections.empty(); }
+
+  /** The settings of the object that was frozen */
+  bool IsUnicode() const { return m_bStoreIsUtf8; }
+  bool IsMultiKey() const { return m_bAllowMultiKey; }
+
+  /** Bytes of memory used by the arrays and the string pool */
+  size_t GetMemorySize() const {
+    return m_pool.capacity() * sizeof(SI_CHAR) +
+           m_sections.capacity() * sizeof(Section) +
+           m_keys.capacity() * sizeof(Key);
+  }
+
+  /** See CSimpleIniTempl::GetAllSections() */
+  void GetAllSections(TNamesDepend &a_names) const;
+
+  /** See CSimpleIniTempl::GetAllKeys() */
+  bool GetAllKeys(const SI_CHAR *a_pSection, TNamesDepend &a_names) const;
+
+  /** See CSimpleIniTempl::GetAllValues() */
+  bool GetAllValues(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                    TNamesDepend &a_values) const;
+
+  /** See CSimpleIniTempl::GetSectionSize() */
+  int GetSectionSize(const SI_CHAR *a_pSection) const;
+
+  /** See CSimpleIniTempl::SectionExists() */
+  bool SectionExists(const SI_CHAR *a_pSection) const {
+    return FindSection(a_pSection) != NULL;
+  }
+
+  /** See CSimpleIniTempl::KeyExists() */
+  bool KeyExists(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey) const {
+    const Section *pSection = FindSection(a_pSection);
+    return pSection && FindKey(*pSection, a_pKey) != NULL;
+  }
+
+  /** See CSimpleIniTempl::GetValue() */
+  const SI_CHAR *GetValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                          const SI_CHAR *a_pDefault = NULL,
+                          bool *a_pHasMultiple = NULL) const;
+
+  /** See CSimpleIniTempl::GetLongValue() */
+  long GetLongValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                    long a_nDefault = 0, bool *a_pHasMultiple = NULL) const {
+    long nValue = a_nDefault;
+    return TIni::ParseLong(GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+                           m_bStoreIsUtf8, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  /** See CSimpleIniTempl::GetDoubleValue() */
+  double GetDoubleValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                        double a_nDefault = 0,
+                        bool *a_pHasMultiple = NULL) const {
+    double nValue = a_nDefault;
+    return TIni::ParseDouble(
+               GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+               m_bStoreIsUtf8, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  /** See CSimpleIniTempl::GetBoolValue() */
+  bool GetBoolValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                    bool a_bDefault = false,
+                    bool *a_pHasMultiple = NULL) const {
+    bool bValue = a_bDefault;
+    return TIni::ParseBool(GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+                           bValue)
+               ? bValue
+               : a_bDefault;
+  }
+
+  /** See CSimpleIniTempl::GetInt64Value() */
+  int64_t GetInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                        int64_t a_nDefault = 0,
+                        bool *a_pHasMultiple = NULL) const {
+    int64_t nValue = a_nDefault;
+    return TIni::ParseInt64(
+               GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+               m_bStoreIsUtf8, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  /** See CSimpleIniTempl::GetUInt64Value() */
+  uint64_t GetUInt64Value(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                          uint64_t a_nDefault = 0,
+                          bool *a_pHasMultiple = NULL) const {
+    uint64_t nValue = a_nDefault;
+    return TIni::ParseUInt64(
+               GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+               m_bStoreIsUtf8, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+  /** See CSimpleIniTempl::GetFloatValue() */
+  double GetFloatValue(const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+                       double a_nDefault = 0,
+                       bool *a_pHasMultiple = NULL) const {
+    double nValue = a_nDefault;
+    return TIni::ParseFloat(
+               GetValue(a_pSection, a_pKey, NULL, a_pHasMultiple),
+               m_bStoreIsUtf8, nValue)
+               ? nValue
+               : a_nDefault;
+  }
+
+private:
+  // strings are offsets into m_pool, offset 0 is a NULL string
+  struct Section {
+    size_t uName;
+    size_t uComment;
+    int nOrder;
+    size_t uFirstKey; //!< keys of the section are [uFirstKey, uEndKey)
+    size_t uEndKey;
+  };
+  struct Key {
+    size_t uName;
+    size_t uComment;
+    int nOrder;
+    size_t uValue;
+  };
+
+  /** Compare an array item by name for a binary search */
+  struct NameLess {
+    const SI_CHAR *pPool;
+    template <class ITEM>
+    bool operator()(const ITEM &a_item, const SI_CHAR *a_pName) const {
+      return IsLess(pPool + a_item.uName, a_pName);
+    }
+  };
+
+  /** Match a string in the pool exactly */
+  struct PoolMatch {
+    const std::vector<SI_CHAR> *pPool;
+    const SI_CHAR *pString;
+    size_t uLen;
+    bool operator()(size_t a_uOffset) const {
+      const SI_CHAR *pPooled = &(*pPool)[a_uOffset];
+      for (size_t n = 0; n < uLen; ++n) {
+        if (pPooled[n] != pString[n]) {
+          return false;
+        }
       }
-      return uLen + 1; // include NULL terminator
-#endif
+      return !pPooled[uLen];
+    }
+  };
+
+  const SI_CHAR *String(size_t a_uOffset) const {
+    return a_uOffset ? &m_pool[a_uOffset] : NULL;
+  }
+
+  /** Add a string to the pool if it isn't there, returns its offset */
+  static size_t AddString(std::vector<SI_CHAR> &a_pool,
+                          SI_Internal::HashIndex<size_t> &a_strings,
+                          const SI_CHAR *a_pString);
+
+  const Section *FindSection(const SI_CHAR *a_pSection) const;
+  const Key *FindKey(const Section &a_section, const SI_CHAR *a_pKey) const;
+
+  static bool IsLess(const SI_CHAR *a_pLeft, const SI_CHAR *a_pRight) {
+    const static SI_STRLESS isLess = SI_STRLESS();
+    return isLess(a_pLeft, a_pRight);
+  }
+
+  std::vector<SI_CHAR> m_pool;
+  std::vector<Section> m_sections;
+  std::vector<Key> m_keys;
+  bool m_bStoreIsUtf8;
+  bool m_bAllowMultiKey;
+};
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Freeze(
+    const TIni &a_ini) {
+  Reset();
+
+  std::vector<SI_CHAR> pool(1, 0);
+  SI_Internal::HashIndex<size_t> strings;
+  std::vector<Section> sections;
+  std::vector<Key> keys;
+  sections.reserve(a_ini.m_data.size());
+
+  // the maps are already in the order of the arrays
+  typename TIni::TSection::const_iterator iSection = a_ini.m_data.begin();
+  for (; iSection != a_ini.m_data.end(); ++iSection) {
+    // GetSection() parses the keys of a lazily loaded section
+    const typename TIni::TKeyVal *pKeyVal =
+        a_ini.GetSection(iSection->first.pItem);
+    Section section = {AddString(pool, strings, iSection->first.pItem),
+                       AddString(pool, strings, iSection->first.pComment),
+                       iSection->first.nOrder, keys.size(), 0};
+    typename TIni::TKeyVal::const_iterator iKeyVal = pKeyVal->begin();
+    for (; iKeyVal != pKeyVal->end(); ++iKeyVal) {
+      Key key = {AddString(pool, strings, iKeyVal->first.pItem),
+                 AddString(pool, strings, iKeyVal->first.pComment),
+                 iKeyVal->first.nOrder,
+                 AddString(pool, strings, iKeyVal->second)};
+      keys.push_back(key);
+    }
+    section.uEndKey = keys.size();
+    sections.push_back(section);
+  }
+
+  // copy to release the spare capacity
+  std::vector<SI_CHAR>(pool).swap(m_pool);
+  std::vector<Section>(sections).swap(m_sections);
+  std::vector<Key>(keys).swap(m_keys);
+  m_bStoreIsUtf8 = a_ini.m_bStoreIsUtf8;
+  m_bAllowMultiKey = a_ini.m_bAllowMultiKey;
+  return SI_OK;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Reset() {
+  std::vector<SI_CHAR>().swap(m_pool);
+  std::vector<Section>().swap(m_sections);
+  std::vector<Key>().swap(m_keys);
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::AddString(
+    std::vector<SI_CHAR> &a_pool, SI_Internal::HashIndex<size_t> &a_strings,
+    const SI_CHAR *a_pString) {
+  if (!a_pString) {
+    return 0;
+  }
+  size_t uLen = 0;
+  while (a_pString[uLen]) {
+    ++uLen;
+  }
+  const size_t uHash = SI_StrHash<SI_GenericCase<SI_CHAR>>::Hash(a_pString);
+  const PoolMatch match = {&a_pool, a_pString, uLen};
+  const size_t *pOffset = a_strings.Find(uHash, match);
+  if (pOffset) {
+    return *pOffset;
+  }
+  const size_t uOffset = a_pool.size();
+  a_pool.insert(a_pool.end(), a_pString, a_pString + uLen + 1);
+  a_strings.Insert(uHash, uOffset);
+  return uOffset;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const typename CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS,
+                                     SI_CONVERTER>::Section *
+CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindSection(
+    const SI_CHAR *a_pSection) const {
+  if (!a_pSection || m_sections.empty()) {
+    return NULL;
+  }
+  const NameLess isLess = {&m_pool[0]};
+  typename std::vector<Section>::const_iterator i = std::lower_bound(
+      m_sections.begin(), m_sections.end(), a_pSection, isLess);
+  if (i == m_sections.end() || IsLess(a_pSection, String(i->uName))) {
+    return NULL;
+  }
+  return &*i;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const typename CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Key *
+CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindKey(
+    const Section &a_section, const SI_CHAR *a_pKey) const {
+  if (!a_pKey) {
+    return NULL;
+  }
+  const NameLess isLess = {&m_pool[0]};
+  const Key *pBegin = m_keys.data() + a_section.uFirstKey;
+  const Key *pEnd = m_keys.data() + a_section.uEndKey;
+  const Key *pKey = std::lower_bound(pBegin, pEnd, a_pKey, isLess);
+  if (pKey == pEnd || IsLess(a_pKey, String(pKey->uName))) {
+    return NULL;
+  }
+  return pKey;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllSections(
+    TNamesDepend &a_names) const {
+  a_names.clear();
+  for (size_t n = 0; n < m_sections.size(); ++n) {
+    const Section &section = m_sections[n];
+    a_names.push_back(Entry(String(section.uName), String(section.uComment),
+                            section.nOrder));
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllKeys(
+    const SI_CHAR *a_pSection, TNamesDepend &a_names) const {
+  a_names.clear();
+  const Section *pSection = FindSection(a_pSection);
+  if (!pSection) {
+    return false;
+  }
+  const SI_CHAR *pLastKey = NULL;
+  for (size_t n = pSection->uFirstKey; n < pSection->uEndKey; ++n) {
+    const Key &key = m_keys[n];
+    if (!pLastKey || IsLess(pLastKey, String(key.uName))) {
+      a_names.push_back(
+          Entry(String(key.uName), String(key.uComment), key.nOrder));
+      pLastKey = String(key.uName);
+    }
+  }
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetAllValues(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey,
+    TNamesDepend &a_values) const {
+  a_values.clear();
+  const Section *pSection = FindSection(a_pSection);
+  const Key *pKey = pSection ? FindKey(*pSection, a_pKey) : NULL;
+  if (!pKey) {
+    return false;
+  }
+
+  // insert all values for this key
+  const Key *pEnd =
+      m_bAllowMultiKey ? m_keys.data() + pSection->uEndKey : pKey + 1;
+  do {
+    a_values.push_back(
+        Entry::Value(String(pKey->uValue), String(pKey->uComment),
+                     pKey->nOrder));
+  } while (++pKey != pEnd && !IsLess(a_pKey, String(pKey->uName)));
+  return true;
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+int CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSectionSize(
+    const SI_CHAR *a_pSection) const {
+  const Section *pSection = FindSection(a_pSection);
+  if (!pSection) {
+    return -1;
+  }
+  if (!m_bAllowMultiKey) {
+    return (int)(pSection->uEndKey - pSection->uFirstKey);
+  }
+
+  // count the different keys
+  int nCount = 0;
+  const SI_CHAR *pLastKey = NULL;
+  for (size_t n = pSection->uFirstKey; n < pSection->uEndKey; ++n) {
+    if (!pLastKey || IsLess(pLastKey, String(m_keys[n].uName))) {
+      ++nCount;
+      pLastKey = String(m_keys[n].uName);
     }
   }
+  return nCount;
+}
 
-  /** Convert the input string to the storage format of this data.
-     * The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  NULL terminated source string to convert. All of
-     *                       the data will be converted including the
-     *                       terminating NULL character.
-     * @param a_pOutputData Pointer to the buffer to receive the converted
-     *                       string.
-     * @param a_uOutputDataSize Size of the output buffer in char.
-     * @return              true if all of the input data, including the
-     *                       terminating NULL character was successfully
-     *                       converted.
-     */
-  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
-                      size_t a_uOutputDataSize) {
-    if (m_bStoreIsUtf8) {
-      const SI_CHAR *src = a_pInputData;
-      char *dst = a_pOutputData;
-      char *dstEnd = a_pOutputData + a_uOutputDataSize;
-      if (sizeof(SI_CHAR) != 2 && sizeof(SI_CHAR) < sizeof(char32_t)) {
-        return false;
-      }
-      while (*src) {
-        char32_t cp;
-        if (!SI_UTF8::ReadCodePoint(src, cp)) {
-          return false;
-        }
-        char buf[4];
-        const int n = SI_UTF8::Encode(cp, buf, sizeof(buf));
-        if (n < 0 || (size_t)(dstEnd - dst) < (size_t)n) {
-          return false;
-        }
-        memcpy(dst, buf, (size_t)n);
-        dst += n;
-      }
-      if (dst >= dstEnd) {
-        return false;
-      }
-      *dst = '\0';
-      return true;
-    } else {
-#if defined(_MSC_VER)
-      size_t converted = 0;
-      errno_t e = wcstombs_s(&converted, a_pOutputData, a_uOutputDataSize,
-                             a_pInputData, 0);
-      return (e == 0);
-#else
-      size_t retval = wcstombs(a_pOutputData, a_pInputData, a_uOutputDataSize);
-      return retval != (size_t)-1;
-#endif
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+const SI_CHAR *
+CSimpleIniFrozenTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetValue(
+    const SI_CHAR *a_pSection, const SI_CHAR *a_pKey, const SI_CHAR *a_pDefault,
+    bool *a_pHasMultiple) const {
+  if (a_pHasMultiple) {
+    *a_pHasMultiple = false;
+  }
+  const Section *pSection = FindSection(a_pSection);
+  const Key *pKey = pSection ? FindKey(*pSection, a_pKey) : NULL;
+  if (!pKey) {
+    return a_pDefault;
+  }
+
+  // check for multiple entries with the same key
+  if (m_bAllowMultiKey && a_pHasMultiple) {
+    const Key *pNext = pKey + 1;
+    if (pNext != m_keys.data() + pSection->uEndKey &&
+        !IsLess(a_pKey, String(pNext->uName))) {
+      *a_pHasMultiple = true;
     }
   }
-};
+  return String(pKey->uValue);
+}
 
-#endif // SI_CONVERT_GENERIC
+#ifdef SI_SUPPORT_THREADS
 
 // ---------------------------------------------------------------------------
-//                              SI_CONVERT_ICU
+//                                  SHARED OBJECT
 // ---------------------------------------------------------------------------
-#ifdef SI_CONVERT_ICU
 
-#define SI_Case SI_GenericCase
-#define SI_NoCase SI_GenericNoCase
+/** Data that is read by many threads while it is being replaced. New data is
+    loaded into a separate CSimpleIniTempl object, which is then published
+    with an atomic pointer exchange. Readers take a Snapshot of the current
+    object and read it through a const pointer. Taking a snapshot never
+    waits for a lock, and the object stays the same and stays valid until
+    the snapshot is released, even if newer data is published meanwhile.
 
-#include <unicode/ucnv.h>
+    Replaced objects are deleted by Publish() or Collect() once no snapshot
+    refers to them. A reader announces the object it is about to pin in one
+    of a fixed set of hazard slots, so the object can't be deleted between
+    reading the pointer and counting the reference.
 
-/**
- * Converts MBCS/UTF-8 to UChar using ICU. This can be used on all platforms.
- */
-template <class SI_CHAR> class SI_ConvertW {
-  const char *m_pEncoding;
-  UConverter *m_pConverter;
+    Only the const methods of the published object may be used. Publish()
+    parses the sections of a lazily loaded object and turns off the value
+    cache, as both would modify the object while it is being read. All
+    snapshots must be released before this object is destroyed.
 
-protected:
-  SI_ConvertW() : m_pEncoding(NULL), m_pConverter(NULL) {}
+    Requires SI_SUPPORT_THREADS to be defined before including SimpleIni.h.
 
-public:
-  SI_ConvertW(bool a_bStoreIsUtf8) : m_pConverter(NULL) {
-    m_pEncoding = a_bStoreIsUtf8 ? "UTF-8" : NULL;
-  }
+    <pre>
+    CSimpleIniSharedA config;
+    config.LoadFile("config.ini");
 
-  /* copy and assignment */
-  SI_ConvertW(const SI_ConvertW &rhs) { operator=(rhs); }
-  SI_ConvertW &operator=(const SI_ConvertW &rhs) {
-    m_pEncoding = rhs.m_pEncoding;
-    m_pConverter = NULL;
-    return *this;
-  }
-  ~SI_ConvertW() {
-    if (m_pConverter)
-      ucnv_close(m_pConverter);
-  }
+    // worker threads
+    CSimpleIniSharedA::Snapshot snapshot = config.GetSnapshot();
+    const char *pszValue = snapshot->GetValue("section", "key", "default");
 
-  /** Calculate the number of UChar required for converting the input
-     * from the storage format. The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  Data in storage format to be converted to UChar.
-     * @param a_uInputDataLen Length of storage format data in bytes. This
-     *                      must be the actual length of the data, including
-     *                      NULL byte if NULL terminated string is required.
-     * @return              Number of UChar required by the string when
-     *                      converted. If there are embedded NULL bytes in the
-     *                      input data, only the string up and not including
-     *                      the NULL byte will be converted.
-     * @return              -1 cast to size_t on a conversion error.
-     */
-  size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
-    SI_ASSERT(a_uInputDataLen != (size_t)-1);
+    // reload thread
+    config.LoadFile("config.ini");
+    </pre>
+ */
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+class CSimpleIniSharedTempl {
+public:
+  typedef CSimpleIniTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER> TIni;
 
-    UErrorCode nError;
+private:
+  /** A published object and the number of snapshots that refer to it */
+  struct Version {
+    TIni oIni;
+    mutable std::atomic<long> nRefs;
 
-    if (!m_pConverter) {
-      nError = U_ZERO_ERROR;
-      m_pConverter = ucnv_open(m_pEncoding, &nError);
-      if (U_FAILURE(nError)) {
-        return (size_t)-1;
+    Version() : nRefs(0) {}
+  };
+
+public:
+  /** A reference to the object that was current when the snapshot was
+        taken. Snapshots can be moved but not copied. A default constructed
+        snapshot, or one taken before any data was published, is empty.
+     */
+  class Snapshot {
+  public:
+    Snapshot() : m_pVersion(NULL) {}
+    Snapshot(Snapshot &&a_rhs) noexcept : m_pVersion(a_rhs.m_pVersion) {
+      a_rhs.m_pVersion = NULL;
+    }
+    Snapshot &operator=(Snapshot &&a_rhs) noexcept {
+      if (this != &a_rhs) {
+        Release();
+        m_pVersion = a_rhs.m_pVersion;
+        a_rhs.m_pVersion = NULL;
       }
+      return *this;
     }
-
-    nError = U_ZERO_ERROR;
-    int32_t nLen = ucnv_toUChars(m_pConverter, NULL, 0, a_pInputData,
-                                 (int32_t)a_uInputDataLen, &nError);
-    if (U_FAILURE(nError) && nError != U_BUFFER_OVERFLOW_ERROR) {
-      return (size_t)-1;
+    ~Snapshot() { Release(); }
+
+    /** The pinned object, NULL if the snapshot is empty */
+    const TIni *Get() const { return m_pVersion ? &m_pVersion->oIni : NULL; }
+    const TIni *operator->() const { return &m_pVersion->oIni; }
+    const TIni &operator*() const { return m_pVersion->oIni; }
+    explicit operator bool() const { return m_pVersion != NULL; }
+
+    /** Unpin the object early. The snapshot is empty afterwards. */
+    void Release() {
+      if (m_pVersion) {
+        m_pVersion->nRefs.fetch_sub(1, std::memory_order_release);
+        m_pVersion = NULL;
+      }
     }
 
-    return (size_t)nLen;
-  }
+  private:
+    friend class CSimpleIniSharedTempl;
+    explicit Snapshot(const Version *a_pVersion) : m_pVersion(a_pVersion) {}
 
-  /** Convert the input string from the storage format to UChar.
-     * The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  Data in storage format to be converted to UChar.
-     * @param a_uInputDataLen Length of storage format data in bytes. This
-     *                      must be the actual length of the data, including
-     *                      NULL byte if NULL terminated string is required.
-     * @param a_pOutputData Pointer to the output buffer to received the
-     *                      converted data.
-     * @param a_uOutputDataSize Size of the output buffer in UChar.
-     * @return              true if all of the input data was successfully
-     *                      converted.
+    // copying is not permitted
+    Snapshot(const Snapshot &);            // disabled
+    Snapshot &operator=(const Snapshot &); // disabled
+
+    const Version *m_pVersion;
+  };
+
+  /** Constructor. The settings are used for the objects created by
+        LoadFile() and LoadData(). Nothing is published until one of those
+        or Publish() is called.
      */
-  bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
-                        UChar *a_pOutputData, size_t a_uOutputDataSize) {
-    UErrorCode nError;
+  CSimpleIniSharedTempl(bool a_bIsUtf8 = false, bool a_bMultiKey = false,
+                        bool a_bMultiLine = false);
 
-    if (!m_pConverter) {
-      nError = U_ZERO_ERROR;
-      m_pConverter = ucnv_open(m_pEncoding, &nError);
-      if (U_FAILURE(nError)) {
-        return false;
-      }
-    }
+  /** Destructor. Deletes the current object and all replaced objects. */
+  ~CSimpleIniSharedTempl();
 
-    nError = U_ZERO_ERROR;
-    ucnv_toUChars(m_pConverter, a_pOutputData, (int32_t)a_uOutputDataSize,
-                  a_pInputData, (int32_t)a_uInputDataLen, &nError);
-    if (U_FAILURE(nError)) {
-      return false;
-    }
+  /** Pin the current object. This doesn't wait for writers, and readers
+        only contend with each other for the few instructions it takes to
+        count the reference.
+     */
+  Snapshot GetSnapshot() const;
 
-    return true;
-  }
+  /** Make a_ini the current object. Its contents are moved into a new
+        object, so a_ini is left empty. Snapshots taken earlier keep
+        referring to the previous object. Writers are serialized, readers
+        are not blocked.
 
-  /** Calculate the number of char required by the storage format of this
-     * data. The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  NULL terminated string to calculate the number of
-     *                      bytes required to be converted to storage format.
-     * @return              Number of bytes required by the string when
-     *                      converted to storage format. This size always
-     *                      includes space for the terminating NULL character.
-     * @return              -1 cast to size_t on a conversion error.
+        @return SI_Error    See error definitions
      */
-  size_t SizeToStore(const UChar *a_pInputData) {
-    UErrorCode nError;
+  SI_Error Publish(TIni &&a_ini);
 
-    if (!m_pConverter) {
-      nError = U_ZERO_ERROR;
-      m_pConverter = ucnv_open(m_pEncoding, &nError);
-      if (U_FAILURE(nError)) {
-        return (size_t)-1;
-      }
-    }
+  /** Load a file into a new object and publish it. The current object is
+        kept if the file can't be loaded.
 
-    nError = U_ZERO_ERROR;
-    int32_t nLen =
-        ucnv_fromUChars(m_pConverter, NULL, 0, a_pInputData, -1, &nError);
-    if (U_FAILURE(nError) && nError != U_BUFFER_OVERFLOW_ERROR) {
-      return (size_t)-1;
-    }
+        @return SI_Error    See error definitions
+     */
+  SI_Error LoadFile(const char *a_pszFile);
 
-    return (size_t)nLen + 1;
+  /** Load data into a new object and publish it. The current object is
+        kept if the data can't be loaded.
+
+        @return SI_Error    See error definitions
+     */
+  SI_Error LoadData(const char *a_pData, size_t a_uDataLen);
+  SI_Error LoadData(const std::string &a_strData) {
+    return LoadData(a_strData.c_str(), a_strData.size());
   }
 
-  /** Convert the input string to the storage format of this data.
-     * The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  NULL terminated source string to convert. All of
-     *                      the data will be converted including the
-     *                      terminating NULL character.
-     * @param a_pOutputData Pointer to the buffer to receive the converted
-     *                      string.
-     * @param a_pOutputDataSize Size of the output buffer in char.
-     * @return              true if all of the input data, including the
-     *                      terminating NULL character was successfully
-     *                      converted.
+  /** Delete the replaced objects that no snapshot refers to. This is done
+        by every Publish() too.
+
+        @return Number of replaced objects that are still in use.
      */
-  bool ConvertToStore(const UChar *a_pInputData, char *a_pOutputData,
-                      size_t a_uOutputDataSize) {
-    UErrorCode nError;
+  size_t Collect();
+
+private:
+  // copying is not permitted
+  CSimpleIniSharedTempl(const CSimpleIniSharedTempl &); // disabled
+  CSimpleIniSharedTempl &
+  operator=(const CSimpleIniSharedTempl &); // disabled
+
+  /** Make a loaded object safe to read from multiple threads */
+  static void PrepareForReaders(TIni &a_ini);
+
+  /** Collect() with m_writeLock held */
+  size_t CollectLocked();
+
+  enum { HAZARD_SLOTS = 64, CACHE_LINE = 64 };
+
+  /** The object a reader is pinning, each slot on its own cache line */
+  struct HazardSlot {
+    std::atomic<const Version *> pVersion;
+    char cPad[CACHE_LINE - sizeof(std::atomic<const Version *>)];
+  };
+
+  bool m_bStoreIsUtf8;
+  bool m_bAllowMultiKey;
+  bool m_bAllowMultiLine;
+
+  /** The published object, NULL until the first Publish() */
+  std::atomic<Version *> m_pCurrent;
+
+  /** Objects being pinned by readers */
+  mutable HazardSlot m_hazards[HAZARD_SLOTS];
 
-    if (!m_pConverter) {
-      nError = U_ZERO_ERROR;
-      m_pConverter = ucnv_open(m_pEncoding, &nError);
-      if (U_FAILURE(nError)) {
-        return false;
-      }
+  /** Serializes Publish() and Collect() */
+  std::mutex m_writeLock;
+
+  /** Replaced objects that may still be referred to by snapshots */
+  std::vector<Version *> m_retired;
+};
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::
+    CSimpleIniSharedTempl(bool a_bIsUtf8, bool a_bMultiKey, bool a_bMultiLine)
+    : m_bStoreIsUtf8(a_bIsUtf8), m_bAllowMultiKey(a_bMultiKey),
+      m_bAllowMultiLine(a_bMultiLine), m_pCurrent(NULL) {
+  for (size_t n = 0; n < HAZARD_SLOTS; ++n) {
+    m_hazards[n].pVersion.store(NULL, std::memory_order_relaxed);
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS,
+                      SI_CONVERTER>::~CSimpleIniSharedTempl() {
+  delete m_pCurrent.load();
+  for (size_t n = 0; n < m_retired.size(); ++n) {
+    delete m_retired[n];
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+typename CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Snapshot
+CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::GetSnapshot() const {
+  // threads start at different slots so that they rarely share one
+  static thread_local size_t uStart =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+
+  for (size_t uTry = 0;; ++uTry) {
+    const Version *pVersion = m_pCurrent.load();
+    if (!pVersion) {
+      return Snapshot();
+    }
+    std::atomic<const Version *> &hazard =
+        m_hazards[(uStart + uTry) % HAZARD_SLOTS].pVersion;
+    const Version *pFree = NULL;
+    if (!hazard.compare_exchange_strong(pFree, pVersion)) {
+      continue;
     }
 
-    nError = U_ZERO_ERROR;
-    ucnv_fromUChars(m_pConverter, a_pOutputData, (int32_t)a_uOutputDataSize,
-                    a_pInputData, -1, &nError);
-    if (U_FAILURE(nError)) {
-      return false;
+    // Collect() scans the slots after the object is replaced, so if it is
+    // still current then it can't be deleted until the slot is cleared
+    const bool bCurrent = m_pCurrent.load() == pVersion;
+    if (bCurrent) {
+      pVersion->nRefs.fetch_add(1, std::memory_order_relaxed);
+    }
+    hazard.store(NULL, std::memory_order_release);
+    if (bCurrent) {
+      return Snapshot(pVersion);
     }
+  }
+}
 
-    return true;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Publish(
+    TIni &&a_ini) {
+  Version *pVersion = new (std::nothrow) Version();
+  if (!pVersion) {
+    return SI_NOMEM;
   }
-};
+  pVersion->oIni.Swap(a_ini);
+  PrepareForReaders(pVersion->oIni);
 
-#endif // SI_CONVERT_ICU
+  std::lock_guard<std::mutex> lock(m_writeLock);
+  Version *pOld = m_pCurrent.exchange(pVersion);
+  if (pOld) {
+    m_retired.push_back(pOld);
+  }
+  CollectLocked();
+  return SI_OK;
+}
 
-// ---------------------------------------------------------------------------
-//                              SI_CONVERT_WIN32
-// ---------------------------------------------------------------------------
-#ifdef SI_CONVERT_WIN32
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadFile(
+    const char *a_pszFile) {
+  TIni ini(m_bStoreIsUtf8, m_bAllowMultiKey, m_bAllowMultiLine);
+  SI_Error rc = ini.LoadFile(a_pszFile);
+  if (rc < 0) {
+    return rc;
+  }
+  return Publish(std::move(ini));
+}
 
-#define SI_Case SI_GenericCase
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::LoadData(
+    const char *a_pData, size_t a_uDataLen) {
+  TIni ini(m_bStoreIsUtf8, m_bAllowMultiKey, m_bAllowMultiLine);
+  SI_Error rc = ini.LoadData(a_pData, a_uDataLen);
+  if (rc < 0) {
+    return rc;
+  }
+  return Publish(std::move(ini));
+}
 
-// Windows CE doesn't have errno or MBCS libraries
-#ifdef _WIN32_WCE
-#ifndef SI_NO_MBCS
-#define SI_NO_MBCS
-#endif
-#endif
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Collect() {
+  std::lock_guard<std::mutex> lock(m_writeLock);
+  return CollectLocked();
+}
 
-#include <windows.h>
-#ifdef SI_NO_MBCS
-#define SI_NoCase SI_GenericNoCase
-#else // !SI_NO_MBCS
-/**
- * Case-insensitive comparison class using Win32 MBCS functions. This class
- * returns a case-insensitive semi-collation order for MBCS text. It may not
- * be safe for UTF-8 text returned in char format as we don't know what
- * characters will be folded by the function! Therefore, if you are using
- * SI_CHAR == char and SetUnicode(true), then you need to use the generic
- * SI_NoCase class instead.
- */
-#include <mbstring.h>
-template <class SI_CHAR> struct SI_NoCase {
-  bool operator()(const SI_CHAR *pLeft, const SI_CHAR *pRight) const {
-    if (sizeof(SI_CHAR) == sizeof(char)) {
-      return _mbsicmp((const unsigned char *)pLeft,
-                      (const unsigned char *)pRight) < 0;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+size_t
+CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::CollectLocked() {
+  size_t uKept = 0;
+  for (size_t n = 0; n < m_retired.size(); ++n) {
+    Version *pVersion = m_retired[n];
+
+    // the slots must be checked before the count. A reader that isn't in a
+    // slot has either counted its reference or will see that the object
+    // was replaced.
+    bool bInUse = false;
+    for (size_t h = 0; h < HAZARD_SLOTS && !bInUse; ++h) {
+      bInUse = m_hazards[h].pVersion.load() == pVersion;
     }
-    if (sizeof(SI_CHAR) == sizeof(wchar_t)) {
-      return _wcsicmp((const wchar_t *)pLeft, (const wchar_t *)pRight) < 0;
+    if (!bInUse && pVersion->nRefs.load(std::memory_order_acquire) == 0) {
+      delete pVersion;
+    } else {
+      m_retired[uKept++] = pVersion;
     }
-    return SI_GenericNoCase<SI_CHAR>()(pLeft, pRight);
   }
-};
-#endif // SI_NO_MBCS
+  m_retired.resize(uKept);
+  return uKept;
+}
 
-/**
- * Converts MBCS and UTF-8 to a wchar_t (or equivalent) on Windows. This uses
- * only the Win32 functions and doesn't require the external Unicode UTF-8
- * conversion library. It will not work on Windows 95 without using Microsoft
- * Layer for Unicode in your application.
- */
-template <class SI_CHAR> class SI_ConvertW {
-  UINT m_uCodePage;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS,
+                           SI_CONVERTER>::PrepareForReaders(TIni &a_ini) {
+  a_ini.LoadLazySections();
+  a_ini.SetValueCache(false);
+}
 
-protected:
-  SI_ConvertW() {}
+#endif // SI_SUPPORT_THREADS
+
+#ifdef SI_SUPPORT_WATCH
 
+// ---------------------------------------------------------------------------
+//                                  FILE WATCHER
+// ---------------------------------------------------------------------------
+
+/** Reloads a file into a CSimpleIniSharedTempl object when it is changed.
+    The directory of the file is watched with inotify by a thread that
+    sleeps until something is written, so an idle watcher uses no CPU. The
+    file is reloaded the debounce time after the first write, so a burst of
+    writes within that time is loaded once. Writes that go on past it are
+    loaded by a further reload. Replacing the file by renaming another file
+    over it, as editors do, is seen as a write.
+
+    After each reload the callback is called on the watcher thread with the
+    previous and the new object, and with the sections and keys that were
+    added, removed or have different values. It isn't called if nothing
+    changed or if the file can't be loaded, and the shared object keeps its
+    current data in that case.
+
+    Requires SI_SUPPORT_WATCH to be defined before including SimpleIni.h.
+    It is only available on Linux.
+
+    <pre>
+    CSimpleIniSharedA config;
+    CSimpleIniWatcherA watcher(config);
+    watcher.SetCallback([](const CSimpleIniA &, const CSimpleIniA &,
+                           const CSimpleIniWatcherA::TChanges &changes) {
+      // changes[n].pSection, changes[n].pKey
+    });
+    watcher.Start("config.ini");
+    </pre>
+ */
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+class CSimpleIniWatcherTempl {
 public:
-  SI_ConvertW(bool a_bStoreIsUtf8) {
-    m_uCodePage = a_bStoreIsUtf8 ? CP_UTF8 : CP_ACP;
+  typedef CSimpleIniSharedTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER> TShared;
+  typedef typename TShared::TIni TIni;
+
+  /** A section or key that changed. The names point into the objects that
+        are passed to the callback, and are only valid during the call. */
+  struct Change {
+    const SI_CHAR *pSection;
+    const SI_CHAR *pKey; //!< NULL if the whole section was added or removed
+  };
+  typedef std::vector<Change> TChanges;
+
+  /** Called with the previous object, the new object and the changes */
+  typedef std::function<void(const TIni &a_old, const TIni &a_new,
+                             const TChanges &a_changes)>
+      TCallback;
+
+  /** The loaded file is published to a_shared, which must outlive the
+        watcher. */
+  explicit CSimpleIniWatcherTempl(TShared &a_shared)
+      : m_shared(a_shared), m_nDebounce(50), m_fdNotify(-1) {
+    m_fdStop[0] = m_fdStop[1] = -1;
   }
 
-  /* copy and assignment */
-  SI_ConvertW(const SI_ConvertW &rhs) { operator=(rhs); }
-  SI_ConvertW &operator=(const SI_ConvertW &rhs) {
-    m_uCodePage = rhs.m_uCodePage;
-    return *this;
+  /** Destructor. Stops the watcher thread. */
+  ~CSimpleIniWatcherTempl() { Stop(); }
+
+  /** Set the function to call after a reload. Set it before Start(). */
+  void SetCallback(const TCallback &a_fnCallback) {
+    m_fnCallback = a_fnCallback;
   }
 
-  /** Calculate the number of SI_CHAR required for converting the input
-     * from the storage format. The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
-     * @param a_uInputDataLen Length of storage format data in bytes. This
-     *                      must be the actual length of the data, including
-     *                      NULL byte if NULL terminated string is required.
-     * @return              Number of SI_CHAR required by the string when
-     *                      converted. If there are embedded NULL bytes in the
-     *                      input data, only the string up and not including
-     *                      the NULL byte will be converted.
-     * @return              -1 cast to size_t on a conversion error.
+  /** Milliseconds from the first write of the file until it is reloaded.
+        Writes within that time are loaded by the same reload. Set it before
+        Start(). */
+  void SetDebounce(unsigned a_nMilliseconds) { m_nDebounce = a_nMilliseconds; }
+  unsigned GetDebounce() const { return m_nDebounce; }
+
+  /** Load the file into the shared object and watch it for changes. The
+        watch is set up before the file is loaded so that no write is
+        missed.
+
+        @return SI_Error    See error definitions. SI_FAIL if already
+                            started, SI_FILE if the directory can't be
+                            watched (see errno).
      */
-  size_t SizeFromStore(const char *a_pInputData, size_t a_uInputDataLen) {
-    SI_ASSERT(a_uInputDataLen != (size_t)-1);
+  SI_Error Start(const char *a_pszFile);
 
-    int retval = MultiByteToWideChar(m_uCodePage, 0, a_pInputData,
-                                     (int)a_uInputDataLen, 0, 0);
-    return (size_t)(retval > 0 ? retval : -1);
+  /** Stop watching. The callback is not called after this returns. */
+  void Stop();
+
+  /** Is the watcher thread running */
+  bool IsRunning() const { return m_thread.joinable(); }
+
+  /** Find the sections and keys that differ between two objects. The
+        values found by CSimpleIniTempl::Diff() are reported once for each
+        key, so a key with several changed values is a single change. */
+  static void FindChanges(const TIni &a_old, const TIni &a_new,
+                          TChanges &a_changes);
+
+private:
+  // copying is not permitted
+  CSimpleIniWatcherTempl(const CSimpleIniWatcherTempl &); // disabled
+  CSimpleIniWatcherTempl &
+  operator=(const CSimpleIniWatcherTempl &); // disabled
+
+  /** The watcher thread */
+  void Run();
+
+  /** Read the pending events. Returns true if one of them is for the
+        watched file. */
+  bool ReadEvents();
+
+  /** Load the file again, publish it and call the callback */
+  void Reload();
+
+  /** Close the descriptors that are open */
+  void Close();
+
+  TShared &m_shared;
+  TCallback m_fnCallback;
+  unsigned m_nDebounce;
+
+  /** Path of the file and the name of the file within its directory */
+  std::string m_strPath;
+  std::string m_strName;
+
+  /** inotify instance and the pipe that wakes the thread to stop it */
+  int m_fdNotify;
+  int m_fdStop[2];
+
+  std::thread m_thread;
+};
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+SI_Error CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Start(
+    const char *a_pszFile) {
+  if (IsRunning()) {
+    return SI_FAIL;
+  }
+  m_strPath = a_pszFile;
+  const size_t uSlash = m_strPath.rfind('/');
+  const std::string strDir =
+      uSlash == std::string::npos ? "." : m_strPath.substr(0, uSlash + 1);
+  m_strName =
+      uSlash == std::string::npos ? m_strPath : m_strPath.substr(uSlash + 1);
+
+  m_fdNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_fdNotify < 0 || pipe2(m_fdStop, O_CLOEXEC) != 0 ||
+      inotify_add_watch(m_fdNotify, strDir.c_str(),
+                        IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO |
+                            IN_CREATE) < 0) {
+    const int nError = errno;
+    Close();
+    errno = nError;
+    return SI_FILE;
   }
 
-  /** Convert the input string from the storage format to SI_CHAR.
-     * The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  Data in storage format to be converted to SI_CHAR.
-     * @param a_uInputDataLen Length of storage format data in bytes. This
-     *                      must be the actual length of the data, including
-     *                      NULL byte if NULL terminated string is required.
-     * @param a_pOutputData Pointer to the output buffer to received the
-     *                      converted data.
-     * @param a_uOutputDataSize Size of the output buffer in SI_CHAR.
-     * @return              true if all of the input data was successfully
-     *                      converted.
-     */
-  bool ConvertFromStore(const char *a_pInputData, size_t a_uInputDataLen,
-                        SI_CHAR *a_pOutputData, size_t a_uOutputDataSize) {
-    int nSize =
-        MultiByteToWideChar(m_uCodePage, 0, a_pInputData, (int)a_uInputDataLen,
-                            (wchar_t *)a_pOutputData, (int)a_uOutputDataSize);
-    return (nSize > 0);
+  SI_Error rc = m_shared.LoadFile(a_pszFile);
+  if (rc < 0) {
+    Close();
+    return rc;
   }
+  m_thread = std::thread(&CSimpleIniWatcherTempl::Run, this);
+  return rc;
+}
 
-  /** Calculate the number of char required by the storage format of this
-     * data. The storage format is always UTF-8.
-     *
-     * @param a_pInputData  NULL terminated string to calculate the number of
-     *                      bytes required to be converted to storage format.
-     * @return              Number of bytes required by the string when
-     *                      converted to storage format. This size always
-     *                      includes space for the terminating NULL character.
-     * @return              -1 cast to size_t on a conversion error.
-     */
-  size_t SizeToStore(const SI_CHAR *a_pInputData) {
-    int retval = WideCharToMultiByte(
-        m_uCodePage, 0, (const wchar_t *)a_pInputData, -1, 0, 0, 0, 0);
-    return (size_t)(retval > 0 ? retval : -1);
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Stop() {
+  if (IsRunning()) {
+    const char cStop = 0;
+    while (write(m_fdStop[1], &cStop, 1) < 0 && errno == EINTR) {
+    }
+    m_thread.join();
   }
+  Close();
+}
 
-  /** Convert the input string to the storage format of this data.
-     * The storage format is always UTF-8 or MBCS.
-     *
-     * @param a_pInputData  NULL terminated source string to convert. All of
-     *                      the data will be converted including the
-     *                      terminating NULL character.
-     * @param a_pOutputData Pointer to the buffer to receive the converted
-     *                      string.
-     * @param a_pOutputDataSize Size of the output buffer in char.
-     * @return              true if all of the input data, including the
-     *                      terminating NULL character was successfully
-     *                      converted.
-     */
-  bool ConvertToStore(const SI_CHAR *a_pInputData, char *a_pOutputData,
-                      size_t a_uOutputDataSize) {
-    int retval =
-        WideCharToMultiByte(m_uCodePage, 0, (const wchar_t *)a_pInputData, -1,
-                            a_pOutputData, (int)a_uOutputDataSize, 0, 0);
-    return retval > 0;
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Close() {
+  int *fds[] = {&m_fdNotify, &m_fdStop[0], &m_fdStop[1]};
+  for (size_t n = 0; n < sizeof(fds) / sizeof(fds[0]); ++n) {
+    if (*fds[n] >= 0) {
+      close(*fds[n]);
+      *fds[n] = -1;
+    }
   }
-};
+}
 
-#endif // SI_CONVERT_WIN32
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Run() {
+  struct pollfd fds[2];
+  fds[0].fd = m_fdNotify;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_fdStop[0];
+  fds[1].events = POLLIN;
+
+  // the reload is due a fixed time after the first write of the file, so
+  // that further events, for this file or others, can't postpone it
+  typedef std::chrono::steady_clock Clock;
+  bool bPending = false;
+  Clock::time_point tDue;
+  for (;;) {
+    int nTimeout = -1;
+    if (bPending) {
+      // the remaining time in whole milliseconds, rounded up
+      const Clock::duration remaining = tDue - Clock::now();
+      const std::chrono::milliseconds ms(1);
+      nTimeout = remaining <= Clock::duration::zero()
+                     ? 0
+                     : static_cast<int>((remaining + ms - Clock::duration(1)) /
+                                        ms);
+    }
+    fds[0].revents = fds[1].revents = 0;
+    const int nReady = poll(fds, 2, nTimeout);
+    if (nReady < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (fds[1].revents) {
+      return;
+    }
+    if ((fds[0].revents & POLLIN) && ReadEvents() && !bPending) {
+      bPending = true;
+      tDue = Clock::now() + std::chrono::milliseconds(m_nDebounce);
+    }
+    if (bPending && Clock::now() >= tDue) {
+      bPending = false;
+      Reload();
+    }
+  }
+}
 
-// ---------------------------------------------------------------------------
-//                              SI_NO_CONVERSION
-// ---------------------------------------------------------------------------
-#ifdef SI_NO_CONVERSION
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+bool CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::ReadEvents() {
+  alignas(struct inotify_event) char buf[4096];
+  bool bChanged = false;
+  for (;;) {
+    const ssize_t nRead = read(m_fdNotify, buf, sizeof(buf));
+    if (nRead <= 0) {
+      return bChanged;
+    }
+    for (const char *p = buf; p < buf + nRead;) {
+      const struct inotify_event *pEvent =
+          reinterpret_cast<const struct inotify_event *>(p);
+      if (pEvent->len && m_strName == pEvent->name) {
+        bChanged = true;
+      }
+      p += sizeof(struct inotify_event) + pEvent->len;
+    }
+  }
+}
 
-#define SI_Case SI_GenericCase
-#define SI_NoCase SI_GenericNoCase
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::Reload() {
+  typename TShared::Snapshot oOld = m_shared.GetSnapshot();
+  if (m_shared.LoadFile(m_strPath.c_str()) < 0 || !m_fnCallback) {
+    return;
+  }
+  typename TShared::Snapshot oNew = m_shared.GetSnapshot();
 
-#endif // SI_NO_CONVERSION
+  // everything is new if nothing was published before
+  TChanges changes;
+  const TIni oEmpty;
+  const TIni &oldIni = oOld ? *oOld : oEmpty;
+  FindChanges(oldIni, *oNew, changes);
+  if (!changes.empty()) {
+    m_fnCallback(oldIni, *oNew, changes);
+  }
+}
+
+template <class SI_CHAR, class SI_STRLESS, class SI_CONVERTER>
+void CSimpleIniWatcherTempl<SI_CHAR, SI_STRLESS, SI_CONVERTER>::FindChanges(
+    const TIni &a_old, const TIni &a_new, TChanges &a_changes) {
+  a_changes.clear();
+  typename TIni::TDiff diff;
+  a_old.Diff(a_new, diff);
+
+  // the values of a key are reported one after the other, but each value
+  // has its own copy of the key name
+  const static SI_STRLESS isLess = SI_STRLESS();
+  typename TIni::TDiff::const_iterator i = diff.begin();
+  for (; i != diff.end(); ++i) {
+    if (!a_changes.empty() && i->pKey && a_changes.back().pKey &&
+        a_changes.back().pSection == i->pSection &&
+        !isLess(a_changes.back().pKey, i->pKey) &&
+        !isLess(i->pKey, a_changes.back().pKey)) {
+      continue;
+    }
+    Change change;
+    change.pSection = i->pSection;
+    change.pKey = i->pKey;
+    a_changes.push_back(change);
+  }
+}
+
+#endif // SI_SUPPORT_WATCH
 
 // ---------------------------------------------------------------------------
 //                                  TYPE DEFINITIONS
@@ -3659,12 +9450,34 @@ public:
 
 typedef CSimpleIniTempl<char, SI_NoCase<char>, SI_ConvertA<char>> CSimpleIniA;
 typedef CSimpleIniTempl<char, SI_Case<char>, SI_ConvertA<char>> CSimpleIniCaseA;
+typedef CSimpleIniFrozenTempl<char, SI_NoCase<char>, SI_ConvertA<char>>
+    CSimpleIniFrozenA;
+typedef CSimpleIniFrozenTempl<char, SI_Case<char>, SI_ConvertA<char>>
+    CSimpleIniFrozenCaseA;
+#ifdef SI_SUPPORT_THREADS
+typedef CSimpleIniSharedTempl<char, SI_NoCase<char>, SI_ConvertA<char>>
+    CSimpleIniSharedA;
+typedef CSimpleIniSharedTempl<char, SI_Case<char>, SI_ConvertA<char>>
+    CSimpleIniSharedCaseA;
+#endif // SI_SUPPORT_THREADS
+#ifdef SI_SUPPORT_WATCH
+typedef CSimpleIniWatcherTempl<char, SI_NoCase<char>, SI_ConvertA<char>>
+    CSimpleIniWatcherA;
+typedef CSimpleIniWatcherTempl<char, SI_Case<char>, SI_ConvertA<char>>
+    CSimpleIniWatcherCaseA;
+#endif // SI_SUPPORT_WATCH
 
 #if defined(SI_NO_CONVERSION)
 // if there is no wide char conversion then we don't need to define the
 // widechar "W" versions of CSimpleIni
 #define CSimpleIni CSimpleIniA
 #define CSimpleIniCase CSimpleIniCaseA
+#define CSimpleIniFrozen CSimpleIniFrozenA
+#define CSimpleIniFrozenCase CSimpleIniFrozenCaseA
+#define CSimpleIniShared CSimpleIniSharedA
+#define CSimpleIniSharedCase CSimpleIniSharedCaseA
+#define CSimpleIniWatcher CSimpleIniWatcherA
+#define CSimpleIniWatcherCase CSimpleIniWatcherCaseA
 #define SI_NEWLINE SI_NEWLINE_A
 #else
 #if defined(SI_CONVERT_ICU)
@@ -3672,20 +9485,68 @@ typedef CSimpleIniTempl<UChar, SI_NoCase<UChar>, SI_ConvertW<UChar>>
     CSimpleIniW;
 typedef CSimpleIniTempl<UChar, SI_Case<UChar>, SI_ConvertW<UChar>>
     CSimpleIniCaseW;
+typedef CSimpleIniFrozenTempl<UChar, SI_NoCase<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniFrozenW;
+typedef CSimpleIniFrozenTempl<UChar, SI_Case<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniFrozenCaseW;
+#ifdef SI_SUPPORT_THREADS
+typedef CSimpleIniSharedTempl<UChar, SI_NoCase<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniSharedW;
+typedef CSimpleIniSharedTempl<UChar, SI_Case<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniSharedCaseW;
+#endif // SI_SUPPORT_THREADS
+#ifdef SI_SUPPORT_WATCH
+typedef CSimpleIniWatcherTempl<UChar, SI_NoCase<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniWatcherW;
+typedef CSimpleIniWatcherTempl<UChar, SI_Case<UChar>, SI_ConvertW<UChar>>
+    CSimpleIniWatcherCaseW;
+#endif // SI_SUPPORT_WATCH
 #else
 typedef CSimpleIniTempl<wchar_t, SI_NoCase<wchar_t>, SI_ConvertW<wchar_t>>
     CSimpleIniW;
 typedef CSimpleIniTempl<wchar_t, SI_Case<wchar_t>, SI_ConvertW<wchar_t>>
     CSimpleIniCaseW;
+typedef CSimpleIniFrozenTempl<wchar_t, SI_NoCase<wchar_t>,
+                              SI_ConvertW<wchar_t>>
+    CSimpleIniFrozenW;
+typedef CSimpleIniFrozenTempl<wchar_t, SI_Case<wchar_t>, SI_ConvertW<wchar_t>>
+    CSimpleIniFrozenCaseW;
+#ifdef SI_SUPPORT_THREADS
+typedef CSimpleIniSharedTempl<wchar_t, SI_NoCase<wchar_t>,
+                              SI_ConvertW<wchar_t>>
+    CSimpleIniSharedW;
+typedef CSimpleIniSharedTempl<wchar_t, SI_Case<wchar_t>, SI_ConvertW<wchar_t>>
+    CSimpleIniSharedCaseW;
+#endif // SI_SUPPORT_THREADS
+#ifdef SI_SUPPORT_WATCH
+typedef CSimpleIniWatcherTempl<wchar_t, SI_NoCase<wchar_t>,
+                               SI_ConvertW<wchar_t>>
+    CSimpleIniWatcherW;
+typedef CSimpleIniWatcherTempl<wchar_t, SI_Case<wchar_t>,
+                               SI_ConvertW<wchar_t>>
+    CSimpleIniWatcherCaseW;
+#endif // SI_SUPPORT_WATCH
 #endif
 
 #ifdef _UNICODE
 #define CSimpleIni CSimpleIniW
 #define CSimpleIniCase CSimpleIniCaseW
+#define CSimpleIniFrozen CSimpleIniFrozenW
+#define CSimpleIniFrozenCase CSimpleIniFrozenCaseW
+#define CSimpleIniShared CSimpleIniSharedW
+#define CSimpleIniSharedCase CSimpleIniSharedCaseW
+#define CSimpleIniWatcher CSimpleIniWatcherW
+#define CSimpleIniWatcherCase CSimpleIniWatcherCaseW
 #define SI_NEWLINE SI_NEWLINE_W
 #else // !_UNICODE
 #define CSimpleIni CSimpleIniA
 #define CSimpleIniCase CSimpleIniCaseA
+#define CSimpleIniFrozen CSimpleIniFrozenA
+#define CSimpleIniFrozenCase CSimpleIniFrozenCaseA
+#define CSimpleIniShared CSimpleIniSharedA
+#define CSimpleIniSharedCase CSimpleIniSharedCaseA
+#define CSimpleIniWatcher CSimpleIniWatcherA
+#define CSimpleIniWatcherCase CSimpleIniWatcherCaseA
 #define SI_NEWLINE SI_NEWLINE_A
 #endif // _UNICODE
 #endif
@@ -0,0 +1,455 @@
+#include "../SimpleIni.h"
+#include "bench-corpus.h"
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Corpus shapes, each is about 4 MiB
+static CorpusOptions Shape(size_t a_uKeys, size_t a_uValueLen) {
+  CorpusOptions opt;
+  opt.uTargetBytes = 4 * 1024 * 1024;
+  opt.uKeysPerSection = a_uKeys;
+  opt.uValueLen = a_uValueLen;
+  return opt;
+}
+static CorpusOptions Flat() { return Shape(10000, 16); }
+static CorpusOptions ManySections() { return Shape(4, 16); }
+static CorpusOptions LongValues() { return Shape(10, 1024); }
+static CorpusOptions MultiKey() {
+  CorpusOptions opt = Shape(10, 16);
+  opt.uMultiKey = 8;
+  return opt;
+}
+static CorpusOptions MultiLine() {
+  CorpusOptions opt = Shape(10, 256);
+  opt.uMultiLinePercent = 50;
+  return opt;
+}
+static CorpusOptions Comments() {
+  CorpusOptions opt = Shape(10, 16);
+  opt.uCommentPercent = 100;
+  return opt;
+}
+static CorpusOptions Utf8() {
+  CorpusOptions opt = Shape(10, 64);
+  opt.bUtf8 = true;
+  return opt;
+}
+
+static void Load(CSimpleIniA &a_ini, const CorpusOptions &a_opt,
+                 const std::string &a_data) {
+  a_ini.SetUnicode(a_opt.bUtf8);
+  a_ini.SetMultiKey(a_opt.uMultiKey > 1);
+  a_ini.SetMultiLine(a_opt.uMultiLinePercent > 0);
+  if (a_ini.LoadData(a_data) < 0) {
+    abort();
+  }
+}
+
+static void SetBytes(benchmark::State &state, size_t a_uBytes) {
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(a_uBytes));
+}
+
+// names of all keys in a corpus in a shuffled order
+struct KeyName {
+  std::string section;
+  std::string key;
+};
+static std::vector<KeyName> Keys(const CSimpleIniA &a_ini) {
+  std::vector<KeyName> keys;
+  CSimpleIniA::TNamesDepend sections;
+  a_ini.GetAllSections(sections);
+  for (const auto &section : sections) {
+    CSimpleIniA::TNamesDepend names;
+    a_ini.GetAllKeys(section.pItem, names);
+    for (const auto &key : names) {
+      keys.push_back(KeyName{section.pItem, key.pItem});
+    }
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+  return keys;
+}
+
+static void BM_LoadData(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  for (auto _ : state) {
+    CSimpleIniA ini;
+    Load(ini, a_opt, data);
+    benchmark::DoNotOptimize(ini.IsEmpty());
+  }
+  SetBytes(state, data.size());
+}
+BENCHMARK_CAPTURE(BM_LoadData, flat, Flat())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, sections, ManySections())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, long_values, LongValues())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, multikey, MultiKey())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, multiline, MultiLine())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, comments, Comments())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadData, utf8, Utf8())->Unit(benchmark::kMillisecond);
+
+// one lookup for each iteration, the time is ns/op
+static void BM_GetValue(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  CSimpleIniA ini;
+  Load(ini, a_opt, data);
+  const std::vector<KeyName> keys = Keys(ini);
+  size_t n = 0;
+  for (auto _ : state) {
+    const KeyName &name = keys[n++ % keys.size()];
+    benchmark::DoNotOptimize(
+        ini.GetValue(name.section.c_str(), name.key.c_str()));
+  }
+}
+BENCHMARK_CAPTURE(BM_GetValue, flat, Flat());
+BENCHMARK_CAPTURE(BM_GetValue, sections, ManySections());
+
+// the same lookups through handles from ResolveKey()
+static void BM_GetValueHandle(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  CSimpleIniA ini;
+  Load(ini, a_opt, data);
+  std::vector<CSimpleIniA::TKeyHandle> handles;
+  for (const KeyName &name : Keys(ini)) {
+    handles.push_back(ini.ResolveKey(name.section.c_str(), name.key.c_str()));
+  }
+  size_t n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ini.GetValue(handles[n++ % handles.size()]));
+  }
+}
+BENCHMARK_CAPTURE(BM_GetValueHandle, sections, ManySections());
+
+static void BM_GetLongValue(benchmark::State &state, bool a_bValueCache) {
+  CSimpleIniA ini;
+  ini.SetValueCache(a_bValueCache);
+  std::vector<std::string> keys;
+  for (long n = 0; n < 10000; ++n) {
+    keys.push_back("key" + std::to_string(n));
+    ini.SetLongValue("section", keys.back().c_str(), n * 7919);
+  }
+  size_t n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ini.GetLongValue("section", keys[n++ % keys.size()].c_str()));
+  }
+}
+BENCHMARK_CAPTURE(BM_GetLongValue, parse, false);
+BENCHMARK_CAPTURE(BM_GetLongValue, cached, true);
+
+// the same values through the <charconv> accessors
+static void BM_GetInt64Value(benchmark::State &state) {
+  CSimpleIniA ini;
+  std::vector<std::string> keys;
+  for (long n = 0; n < 10000; ++n) {
+    keys.push_back("key" + std::to_string(n));
+    ini.SetInt64Value("section", keys.back().c_str(), n * 7919);
+  }
+  size_t n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        ini.GetInt64Value("section", keys[n++ % keys.size()].c_str()));
+  }
+}
+BENCHMARK(BM_GetInt64Value);
+
+// reading all keys of a section with GetValue() or one GetValues() call
+static void BM_GetSectionValues(benchmark::State &state, bool a_bBatch) {
+  CSimpleIniA ini;
+  std::vector<std::string> names;
+  for (long n = 0; n < 300; ++n) {
+    names.push_back("key" + std::to_string(n));
+    ini.SetLongValue("section", names.back().c_str(), n);
+  }
+  std::vector<const char *> keys, values(names.size());
+  for (const std::string &name : names) {
+    keys.push_back(name.c_str());
+  }
+  for (auto _ : state) {
+    if (a_bBatch) {
+      ini.GetValues("section", keys.data(), keys.size(), values.data());
+    } else {
+      for (size_t n = 0; n < keys.size(); ++n) {
+        values[n] = ini.GetValue("section", keys[n]);
+      }
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK_CAPTURE(BM_GetSectionValues, GetValue, false);
+BENCHMARK_CAPTURE(BM_GetSectionValues, GetValues, true);
+
+// SetDoubleValue() formats with "%f", SetFloatValue() with std::to_chars
+static void BM_SetDouble(benchmark::State &state, bool a_bFloat) {
+  CSimpleIniA ini;
+  double d = 0.1;
+  for (auto _ : state) {
+    d += 1.0 / 3.0;
+    if (a_bFloat) {
+      ini.SetFloatValue("section", "key", d);
+    } else {
+      ini.SetDoubleValue("section", "key", d);
+    }
+  }
+}
+BENCHMARK_CAPTURE(BM_SetDouble, double, false);
+BENCHMARK_CAPTURE(BM_SetDouble, float, true);
+
+// replace the value of an existing key
+static void BM_SetValue(benchmark::State &state) {
+  CorpusOptions opt = ManySections();
+  const std::string data = MakeCorpus(opt);
+  CSimpleIniA ini;
+  Load(ini, opt, data);
+  const std::vector<KeyName> keys = Keys(ini);
+  size_t n = 0;
+  for (auto _ : state) {
+    const KeyName &name = keys[n++ % keys.size()];
+    benchmark::DoNotOptimize(ini.SetValue(name.section.c_str(),
+                                          name.key.c_str(), "new value"));
+  }
+}
+BENCHMARK(BM_SetValue);
+
+// build a file of state.range(0) keys from nothing, ns/op is per key
+static void BM_SetValueInsert(benchmark::State &state) {
+  const size_t uKeys = static_cast<size_t>(state.range(0));
+  std::vector<std::string> keys;
+  for (size_t n = 0; n < uKeys; ++n) {
+    keys.push_back("key" + std::to_string(n));
+  }
+  for (auto _ : state) {
+    CSimpleIniA ini;
+    for (size_t n = 0; n < uKeys; ++n) {
+      ini.SetValue(n % 2 ? "odd" : "even", keys[n].c_str(), "value");
+    }
+    benchmark::DoNotOptimize(ini.IsEmpty());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+BENCHMARK(BM_SetValueInsert)->Arg(1000)->Arg(100000);
+
+// the same keys added in sorted order with SetValues()
+static void BM_SetValuesInsert(benchmark::State &state) {
+  const size_t uKeys = static_cast<size_t>(state.range(0));
+  std::vector<std::string> names;
+  for (size_t n = 0; n < uKeys; ++n) {
+    names.push_back("key" + std::to_string(n));
+  }
+  std::sort(names.begin(), names.end());
+  std::vector<const char *> keys, values(uKeys, "value");
+  for (const std::string &name : names) {
+    keys.push_back(name.c_str());
+  }
+  for (auto _ : state) {
+    CSimpleIniA ini;
+    ini.SetValues("section", keys.data(), values.data(), uKeys, true);
+    benchmark::DoNotOptimize(ini.IsEmpty());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          state.range(0));
+}
+BENCHMARK(BM_SetValuesInsert)->Arg(1000)->Arg(100000);
+
+// delete every key of a loaded file, ns/op is per key
+static void BM_Delete(benchmark::State &state) {
+  CorpusOptions opt = ManySections();
+  const std::string data = MakeCorpus(opt);
+  std::vector<KeyName> keys;
+  {
+    CSimpleIniA ini;
+    Load(ini, opt, data);
+    keys = Keys(ini);
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    CSimpleIniA ini;
+    Load(ini, opt, data);
+    state.ResumeTiming();
+    for (const KeyName &name : keys) {
+      ini.Delete(name.section.c_str(), name.key.c_str(), true);
+    }
+    benchmark::DoNotOptimize(ini.IsEmpty());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(keys.size()));
+}
+BENCHMARK(BM_Delete)->Unit(benchmark::kMillisecond);
+
+// deep copy of a loaded file, compare with BM_LoadData
+static void BM_Clone(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  CSimpleIniA ini;
+  Load(ini, a_opt, data);
+  CSimpleIniA copy;
+  for (auto _ : state) {
+    if (ini.Clone(copy) < 0) {
+      abort();
+    }
+  }
+  SetBytes(state, data.size());
+}
+BENCHMARK_CAPTURE(BM_Clone, sections, ManySections())
+    ->Unit(benchmark::kMillisecond);
+
+// compare a loaded file with a copy that has one changed value, either with
+// Diff() or with GetAllSections(), GetAllKeys() and GetAllValues()
+static void BM_Diff(benchmark::State &state, bool a_bGetAll) {
+  const CorpusOptions opt = ManySections();
+  const std::string data = MakeCorpus(opt);
+  CSimpleIniA ini;
+  Load(ini, opt, data);
+  CSimpleIniA copy;
+  if (ini.Clone(copy) < 0) {
+    abort();
+  }
+  const KeyName name = Keys(ini).back();
+  copy.SetValue(name.section.c_str(), name.key.c_str(), "changed");
+
+  CSimpleIniA::TDiff diff;
+  for (auto _ : state) {
+    size_t uChanged = 0;
+    if (!a_bGetAll) {
+      uChanged = ini.Diff(copy, diff);
+    } else {
+      CSimpleIniA::TNamesDepend sections, keys, values, otherValues;
+      ini.GetAllSections(sections);
+      for (const CSimpleIniA::Entry &section : sections) {
+        keys.clear();
+        ini.GetAllKeys(section.pItem, keys);
+        for (const CSimpleIniA::Entry &key : keys) {
+          ini.GetAllValues(section.pItem, key.pItem, values);
+          copy.GetAllValues(section.pItem, key.pItem, otherValues);
+          if (values.size() != otherValues.size() ||
+              strcmp(values.front().pItem, otherValues.front().pItem)) {
+            ++uChanged;
+          }
+        }
+      }
+    }
+    if (uChanged != 1) {
+      abort();
+    }
+  }
+  SetBytes(state, data.size());
+}
+BENCHMARK_CAPTURE(BM_Diff, Diff, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Diff, GetAll, true)->Unit(benchmark::kMillisecond);
+
+// visit every value in load order, either with ForEachInLoadOrder() or by
+// sorting the lists of GetAllSections() and GetAllKeys()
+static void BM_LoadOrder(benchmark::State &state, bool a_bGetAll) {
+  const CorpusOptions opt = ManySections();
+  const std::string data = MakeCorpus(opt);
+  CSimpleIniA ini;
+  Load(ini, opt, data);
+
+  for (auto _ : state) {
+    size_t uValues = 0;
+    if (!a_bGetAll) {
+      ini.ForEachInLoadOrder([&](const CSimpleIniA::Entry &,
+                                 const CSimpleIniA::Entry *a_pKey,
+                                 const char *) {
+        uValues += a_pKey != NULL;
+        return true;
+      });
+    } else {
+      CSimpleIniA::TNamesDepend sections, keys, values;
+      ini.GetAllSections(sections);
+      sections.sort(CSimpleIniA::Entry::LoadOrder());
+      for (const CSimpleIniA::Entry &section : sections) {
+        keys.clear();
+        ini.GetAllKeys(section.pItem, keys);
+        keys.sort(CSimpleIniA::Entry::LoadOrder());
+        for (const CSimpleIniA::Entry &key : keys) {
+          ini.GetAllValues(section.pItem, key.pItem, values);
+          uValues += values.size();
+        }
+      }
+    }
+    benchmark::DoNotOptimize(uValues);
+  }
+  SetBytes(state, data.size());
+}
+BENCHMARK_CAPTURE(BM_LoadOrder, ForEach, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_LoadOrder, GetAll, true)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveString(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  CSimpleIniA ini;
+  Load(ini, a_opt, data);
+  std::string output;
+  for (auto _ : state) {
+    output.clear();
+    if (ini.Save(output) < 0) {
+      abort();
+    }
+  }
+  SetBytes(state, output.size());
+}
+BENCHMARK_CAPTURE(BM_SaveString, sections, ManySections())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveString, multiline, MultiLine())
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveString, comments, Comments())
+    ->Unit(benchmark::kMillisecond);
+
+// save to a buffer of the caller, either a new string each time or a
+// buffer that was sized once
+static void BM_SaveBuffer(benchmark::State &state, bool a_bFixed) {
+  const CorpusOptions opt = ManySections();
+  const std::string data = MakeCorpus(opt);
+  CSimpleIniA ini;
+  Load(ini, opt, data);
+  size_t uLength = 0;
+  ini.Save(NULL, 0, uLength);
+  std::vector<char> buf(uLength);
+  for (auto _ : state) {
+    if (a_bFixed) {
+      if (ini.Save(buf.data(), buf.size(), uLength) < 0) {
+        abort();
+      }
+    } else {
+      std::string output;
+      if (ini.Save(output) < 0) {
+        abort();
+      }
+      benchmark::DoNotOptimize(output.data());
+    }
+  }
+  SetBytes(state, uLength);
+}
+BENCHMARK_CAPTURE(BM_SaveBuffer, string, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SaveBuffer, fixed, true)->Unit(benchmark::kMillisecond);
+
+static void BM_SaveFile(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  CSimpleIniA ini;
+  Load(ini, a_opt, data);
+  const char *pszFile = "bench-save.ini";
+  for (auto _ : state) {
+    if (ini.SaveFile(pszFile) < 0) {
+      abort();
+    }
+  }
+  std::string output;
+  ini.Save(output);
+  SetBytes(state, output.size());
+  remove(pszFile);
+}
+BENCHMARK_CAPTURE(BM_SaveFile, sections, ManySections())
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,62 @@
+// Load and save through each converter. This file is built once without a
+// converter for CSimpleIniA (SI_ConvertA), and once each with
+// SI_CONVERT_GENERIC and SI_CONVERT_ICU for CSimpleIniW.
+#include "../SimpleIni.h"
+#include "bench-corpus.h"
+#include <benchmark/benchmark.h>
+
+#include <stdlib.h>
+#include <string>
+
+#if defined(SI_CONVERT_GENERIC) || defined(SI_CONVERT_ICU)
+typedef CSimpleIniW BenchIni;
+#else
+typedef CSimpleIniA BenchIni;
+#endif
+
+static CorpusOptions Text(bool a_bUtf8) {
+  CorpusOptions opt;
+  opt.uTargetBytes = 4 * 1024 * 1024;
+  opt.uValueLen = 64;
+  opt.uCommentPercent = 20;
+  opt.bUtf8 = a_bUtf8;
+  return opt;
+}
+
+static void BM_ConvertLoad(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  for (auto _ : state) {
+    BenchIni ini(a_opt.bUtf8);
+    if (ini.LoadData(data) < 0) {
+      abort();
+    }
+    benchmark::DoNotOptimize(ini.IsEmpty());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+BENCHMARK_CAPTURE(BM_ConvertLoad, ascii, Text(false))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ConvertLoad, utf8, Text(true))
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_ConvertSave(benchmark::State &state, CorpusOptions a_opt) {
+  const std::string data = MakeCorpus(a_opt);
+  BenchIni ini(a_opt.bUtf8);
+  if (ini.LoadData(data) < 0) {
+    abort();
+  }
+  std::string output;
+  for (auto _ : state) {
+    output.clear();
+    if (ini.Save(output) < 0) {
+      abort();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(output.size()));
+}
+BENCHMARK_CAPTURE(BM_ConvertSave, ascii, Text(false))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ConvertSave, utf8, Text(true))
+    ->Unit(benchmark::kMillisecond);
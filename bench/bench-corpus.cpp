@@ -0,0 +1,72 @@
+// Write a generated INI file to use as a benchmark or test corpus.
+//
+//   bench-corpus [--size=BYTES] [--sections=N] [--keys=N] [--value=BYTES]
+//                [--multikey=N] [--multiline=PERCENT] [--comments=PERCENT]
+//                [--utf8] [--seed=N] [--out=FILE]
+//
+// The size may have a K or M suffix. Without --out the file is written to
+// stdout.
+
+#include "bench-corpus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool ParseNumber(const char *a_pArg, const char *a_pName,
+                        size_t &a_uValue) {
+  const size_t uName = strlen(a_pName);
+  if (strncmp(a_pArg, a_pName, uName) != 0 || a_pArg[uName] != '=') {
+    return false;
+  }
+  char *pEnd = NULL;
+  a_uValue = static_cast<size_t>(strtoull(a_pArg + uName + 1, &pEnd, 10));
+  if (*pEnd == 'K' || *pEnd == 'k') {
+    a_uValue *= 1024;
+  } else if (*pEnd == 'M' || *pEnd == 'm') {
+    a_uValue *= 1024 * 1024;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  CorpusOptions opt;
+  const char *pszOut = NULL;
+  for (int n = 1; n < argc; ++n) {
+    const char *pArg = argv[n];
+    size_t uValue = 0;
+    if (ParseNumber(pArg, "--size", opt.uTargetBytes) ||
+        ParseNumber(pArg, "--sections", opt.uSections) ||
+        ParseNumber(pArg, "--keys", opt.uKeysPerSection) ||
+        ParseNumber(pArg, "--value", opt.uValueLen) ||
+        ParseNumber(pArg, "--multikey", opt.uMultiKey)) {
+      continue;
+    }
+    if (ParseNumber(pArg, "--multiline", uValue)) {
+      opt.uMultiLinePercent = static_cast<unsigned>(uValue);
+    } else if (ParseNumber(pArg, "--comments", uValue)) {
+      opt.uCommentPercent = static_cast<unsigned>(uValue);
+    } else if (ParseNumber(pArg, "--seed", uValue)) {
+      opt.uSeed = static_cast<unsigned>(uValue);
+    } else if (strcmp(pArg, "--utf8") == 0) {
+      opt.bUtf8 = true;
+    } else if (strncmp(pArg, "--out=", 6) == 0) {
+      pszOut = pArg + 6;
+    } else {
+      fprintf(stderr, "bench-corpus: unknown option %s\n", pArg);
+      return 2;
+    }
+  }
+
+  const std::string data = MakeCorpus(opt);
+  FILE *fp = pszOut ? fopen(pszOut, "wb") : stdout;
+  if (!fp) {
+    perror(pszOut);
+    return 1;
+  }
+  const bool bOk = fwrite(data.data(), 1, data.size(), fp) == data.size();
+  if (pszOut) {
+    fclose(fp);
+  }
+  return bOk ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <cstring>
+#include <random>
+#include <string>
+
+// Shape of a generated INI file. The same options always generate the same
+// data so that results can be compared between runs.
+struct CorpusOptions {
+  size_t uTargetBytes = 0;         // add sections up to this size, if set
+  size_t uSections = 100;          // number of sections, if no target size
+  size_t uKeysPerSection = 10;     // distinct keys in every section
+  size_t uValueLen = 16;           // bytes in each value
+  size_t uMultiKey = 1;            // values for each key
+  unsigned uMultiLinePercent = 0;  // values written as <<< blocks
+  unsigned uCommentPercent = 0;    // keys that have a comment
+  bool bUtf8 = false;              // use non-ASCII text in the values
+  unsigned uSeed = 1;
+};
+
+// Append text of exactly a_uLen bytes, UTF-8 text never splits a character
+inline void AppendText(std::string &a_data, size_t a_uLen, bool a_bUtf8,
+                       size_t a_uStart) {
+  static const char *const chars[] = {"\xC3\xA9", "\xE6\x97\xA5", "a",
+                                      "\xCE\xA9", "\xF0\x9F\x98\x80", "z"};
+  const size_t uEnd = a_data.size() + a_uLen;
+  for (size_t n = a_uStart; a_data.size() < uEnd; ++n) {
+    if (!a_bUtf8) {
+      a_data += static_cast<char>('a' + n % 26);
+      continue;
+    }
+    const char *pChar = chars[n % 6];
+    const size_t uChar = strlen(pChar);
+    if (a_data.size() + uChar > uEnd) {
+      a_data.append(uEnd - a_data.size(), 'x');
+    } else {
+      a_data.append(pChar, uChar);
+    }
+  }
+}
+
+inline std::string MakeCorpus(const CorpusOptions &a_opt) {
+  std::mt19937 rng(a_opt.uSeed);
+  std::string data;
+  if (a_opt.uTargetBytes) {
+    data.reserve(a_opt.uTargetBytes + 4096);
+  }
+  for (size_t s = 0; a_opt.uTargetBytes ? data.size() < a_opt.uTargetBytes
+                                        : s < a_opt.uSections;
+       ++s) {
+    if (rng() % 100 < a_opt.uCommentPercent) {
+      data += "; section " + std::to_string(s) + "\n";
+    }
+    data += "[section" + std::to_string(s) + "]\n";
+    for (size_t k = 0; k < a_opt.uKeysPerSection; ++k) {
+      for (size_t m = 0; m < a_opt.uMultiKey; ++m) {
+        if (rng() % 100 < a_opt.uCommentPercent) {
+          data += "; comment for key" + std::to_string(k) + "\n";
+        }
+        data += "key" + std::to_string(k) + " = ";
+        if (rng() % 100 < a_opt.uMultiLinePercent) {
+          // split the value over lines of up to 64 bytes
+          data += "<<<END\n";
+          for (size_t uDone = 0; uDone < a_opt.uValueLen; uDone += 64) {
+            const size_t uLine = a_opt.uValueLen - uDone < 64
+                                     ? a_opt.uValueLen - uDone
+                                     : 64;
+            AppendText(data, uLine, a_opt.bUtf8, s + k + uDone);
+            data += "\n";
+          }
+          data += "END\n";
+        } else {
+          AppendText(data, a_opt.uValueLen, a_opt.bUtf8, s + k + m);
+          data += "\n";
+        }
+      }
+    }
+    data += "\n";
+  }
+  return data;
+}
+
+#endif // BENCH_CORPUS_H
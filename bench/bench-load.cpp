@@ -0,0 +1,36 @@
+#include "../SimpleIni.h"
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+// Generated data with long values so that the time is dominated by scanning
+// lines rather than by building the section and key maps.
+static std::string MakeData(size_t a_uSections, size_t a_uKeys,
+                            size_t a_uValueLen) {
+  std::string data;
+  data.reserve(a_uSections * a_uKeys * (a_uValueLen + 24));
+  for (size_t s = 0; s < a_uSections; ++s) {
+    data += "; comment for section " + std::to_string(s) + "\n";
+    data += "[section " + std::to_string(s) + "]\n";
+    for (size_t k = 0; k < a_uKeys; ++k) {
+      data += "key" + std::to_string(k) + " = ";
+      data.append(a_uValueLen, static_cast<char>('a' + (k % 26)));
+      data += "\n";
+    }
+    data += "\n";
+  }
+  return data;
+}
+
+static void BM_LoadData(benchmark::State &state) {
+  const std::string data =
+      MakeData(1000, 20, static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    CSimpleIniA ini;
+    SI_Error rc = ini.LoadData(data);
+    benchmark::DoNotOptimize(rc);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_LoadData)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
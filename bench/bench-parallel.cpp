@@ -0,0 +1,97 @@
+#define SI_SUPPORT_THREADS
+#include "../SimpleIni.h"
+#include <benchmark/benchmark.h>
+
+#include <shared_mutex>
+#include <string>
+
+// Many small sections, the shape of data that parallel loading targets.
+static const std::string &Data() {
+  static std::string data;
+  if (data.empty()) {
+    for (int s = 0; s < 200000; ++s) {
+      data += "; section " + std::to_string(s) + "\n";
+      data += "[section " + std::to_string(s) + "]\n";
+      for (int k = 0; k < 4; ++k) {
+        data += "key" + std::to_string(k) + " = value " + std::to_string(s) +
+                "." + std::to_string(k) + "\n";
+      }
+    }
+  }
+  return data;
+}
+
+static void BM_ParallelLoad(benchmark::State &state) {
+  const std::string &data = Data();
+  for (auto _ : state) {
+    CSimpleIniA ini;
+    ini.SetParallelLoad(static_cast<unsigned>(state.range(0)));
+    SI_Error rc = ini.LoadData(data);
+    benchmark::DoNotOptimize(rc);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_ParallelLoad)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Readers of data that thread 0 reloads every 10000 reads, one lookup for
+// each iteration. The shared object is compared with a shared_mutex.
+static const std::string &SmallData() {
+  static std::string data;
+  if (data.empty()) {
+    for (int s = 0; s < 100; ++s) {
+      data += "[section " + std::to_string(s) + "]\n";
+      for (int k = 0; k < 10; ++k) {
+        data += "key" + std::to_string(k) + " = value\n";
+      }
+    }
+  }
+  return data;
+}
+
+static CSimpleIniSharedA &SharedData() {
+  static CSimpleIniSharedA shared;
+  static SI_Error rc = shared.LoadData(SmallData());
+  (void)rc;
+  return shared;
+}
+
+static void BM_SharedRead(benchmark::State &state) {
+  CSimpleIniSharedA &shared = SharedData();
+  size_t n = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0 && ++n % 10000 == 0) {
+      shared.LoadData(SmallData());
+    }
+    CSimpleIniSharedA::Snapshot snapshot = shared.GetSnapshot();
+    benchmark::DoNotOptimize(snapshot->GetValue("section 50", "key5"));
+  }
+}
+BENCHMARK(BM_SharedRead)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_SharedMutexRead(benchmark::State &state) {
+  static CSimpleIniA ini;
+  static std::shared_timed_mutex lock;
+  static SI_Error rc = ini.LoadData(SmallData());
+  (void)rc;
+  size_t n = 0;
+  for (auto _ : state) {
+    if (state.thread_index() == 0 && ++n % 10000 == 0) {
+      CSimpleIniA reloaded;
+      reloaded.LoadData(SmallData());
+      std::unique_lock<std::shared_timed_mutex> writer(lock);
+      ini = std::move(reloaded);
+    }
+    std::shared_lock<std::shared_timed_mutex> reader(lock);
+    benchmark::DoNotOptimize(ini.GetValue("section 50", "key5"));
+  }
+}
+BENCHMARK(BM_SharedMutexRead)->ThreadRange(1, 16)->UseRealTime();
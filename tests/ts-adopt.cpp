@@ -0,0 +1,89 @@
+#define SI_CONVERT_GENERIC
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+TEST(AdoptData, StringParsedInPlace) {
+  // long enough that the string does not use a small string buffer, so it
+  // is moved without reallocation
+  std::string strData = "[section]\nkey = value\n; " + std::string(100, 'c');
+  const char *pBuffer = strData.c_str();
+  const size_t uLen = strData.size();
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(std::move(strData)), SI_OK);
+  const char *pValue = ini.GetValue("section", "key");
+  ASSERT_STREQ(pValue, "value");
+  ASSERT_GE(pValue, pBuffer);
+  ASSERT_LT(pValue, pBuffer + uLen);
+}
+
+TEST(AdoptData, StringWithSignature) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(std::string(SI_UTF8_SIGNATURE "[s]\nk = v\n")),
+            SI_OK);
+  ASSERT_TRUE(ini.IsUnicode());
+  ASSERT_STREQ(ini.GetValue("s", "k"), "v");
+}
+
+TEST(AdoptData, BufferParsedInPlace) {
+  const char szData[] = "[section]\nkey = value\n; comment\nother = 2";
+  const size_t uLen = sizeof(szData) - 1;
+  std::unique_ptr<char[]> pData(new char[uLen + 1]);
+  memcpy(pData.get(), szData, uLen);
+  pData[uLen] = 'x'; // overwritten with the terminator
+  const char *pBuffer = pData.get();
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(std::move(pData), uLen, uLen + 1), SI_OK);
+  ASSERT_EQ(pData, nullptr);
+  const char *pValue = ini.GetValue("section", "other");
+  ASSERT_STREQ(pValue, "2");
+  ASSERT_GE(pValue, pBuffer);
+  ASSERT_LT(pValue, pBuffer + uLen);
+}
+
+TEST(AdoptData, BufferWithoutRoomForTerminator) {
+  // the buffer is filled to the end, and released without being written
+  const char szData[] = "[section]\nkey = value";
+  const size_t uLen = sizeof(szData) - 1;
+  std::unique_ptr<char[]> pData(new char[uLen]);
+  memcpy(pData.get(), szData, uLen);
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(std::move(pData), uLen, uLen), SI_FAIL);
+  ASSERT_EQ(pData, nullptr);
+  ASSERT_EQ(ini.GetSectionSize("section"), -1);
+}
+
+TEST(AdoptData, MergeAndModify) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(std::string("[a]\nx = 1\n")), SI_OK);
+
+  std::unique_ptr<char[]> pData(new char[16]);
+  memcpy(pData.get(), "[a]\ny = 2\n", 10);
+  ASSERT_EQ(ini.LoadData(std::move(pData), 10, 16), SI_OK);
+
+  ASSERT_EQ(ini.SetValue("a", "x", "3"), SI_UPDATED);
+  ASSERT_TRUE(ini.Delete("a", "y"));
+  ASSERT_STREQ(ini.GetValue("a", "x"), "3");
+  ASSERT_EQ(ini.GetValue("a", "y"), nullptr);
+
+  ini.Reset();
+  ASSERT_EQ(ini.LoadData(std::string()), SI_OK);
+  ASSERT_EQ(ini.GetSectionSize("a"), -1);
+}
+
+TEST(AdoptData, ConvertingLoader) {
+  CSimpleIniW ini;
+  ASSERT_EQ(ini.LoadData(std::string("[s]\nkey = value\n")), SI_OK);
+  ASSERT_STREQ(ini.GetValue(L"s", L"key"), L"value");
+
+  std::unique_ptr<char[]> pData(new char[11]);
+  memcpy(pData.get(), "[t]\nk = v\n", 10);
+  ASSERT_EQ(ini.LoadData(std::move(pData), 10, 11), SI_OK);
+  ASSERT_STREQ(ini.GetValue(L"t", L"k"), L"v");
+}
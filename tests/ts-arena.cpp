@@ -0,0 +1,105 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+#include <string>
+
+TEST(StringArena, EmptyUntilStringsAreCopied) {
+  CSimpleIniA ini;
+  CSimpleIniA::StringStats stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 0u);
+  ASSERT_EQ(stats.uReservedBytes, 0u);
+
+  // strings loaded into an empty object stay in the loaded data
+  ASSERT_EQ(ini.LoadData("[section]\nkey = value\n"), SI_OK);
+  ASSERT_EQ(ini.GetStringStats().uStrings, 0u);
+
+  ASSERT_EQ(ini.SetValue("section", "other", "value"), SI_INSERTED);
+  stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 2u);
+  ASSERT_GT(stats.uUsedBytes, 0u);
+  ASSERT_GE(stats.uReservedBytes, stats.uUsedBytes + stats.uFreeBytes);
+
+  ini.Reset();
+  stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 0u);
+  ASSERT_EQ(stats.uUsedBytes, 0u);
+  ASSERT_EQ(stats.uFreeBytes, 0u);
+  ASSERT_EQ(stats.uReservedBytes, 0u);
+}
+
+TEST(StringArena, ReusesFreedStrings) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.SetValue("section", "key", "value0"), SI_INSERTED);
+  const CSimpleIniA::StringStats before = ini.GetStringStats();
+  for (int i = 0; i < 1000; ++i) {
+    const std::string value = "value" + std::to_string(i % 10);
+    ASSERT_EQ(ini.SetValue("section", "key", value.c_str()), SI_UPDATED);
+  }
+  const CSimpleIniA::StringStats after = ini.GetStringStats();
+  ASSERT_EQ(after.uStrings, before.uStrings);
+  ASSERT_EQ(after.uReservedBytes, before.uReservedBytes);
+  ASSERT_STREQ(ini.GetValue("section", "key"), "value9");
+}
+
+TEST(StringArena, LargeStringsAreReleased) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.SetValue("section", "key", "small"), SI_INSERTED);
+  const CSimpleIniA::StringStats before = ini.GetStringStats();
+
+  const std::string large(10000, 'x');
+  ASSERT_EQ(ini.SetValue("section", "key", large.c_str()), SI_UPDATED);
+  ASSERT_GE(ini.GetStringStats().uReservedBytes,
+            before.uReservedBytes + large.size());
+  ASSERT_EQ(ini.GetValue("section", "key"), large);
+
+  ASSERT_EQ(ini.SetValue("section", "key", "small"), SI_UPDATED);
+  ASSERT_EQ(ini.GetStringStats().uReservedBytes, before.uReservedBytes);
+}
+
+TEST(StringArena, DeletingEverythingReleasesMemory) {
+  CSimpleIniA ini;
+  for (int i = 0; i < 500; ++i) {
+    const std::string key = "key" + std::to_string(i);
+    ASSERT_GE(ini.SetValue("section", key.c_str(), "value", "; comment"), 0);
+  }
+  CSimpleIniA::StringStats stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 1501u);
+  ASSERT_GT(stats.uReservedBytes, 0u);
+
+  ASSERT_TRUE(ini.Delete("section", "key0"));
+  stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 1498u);
+  ASSERT_GT(stats.uFreeBytes, 0u);
+
+  ASSERT_TRUE(ini.Delete("section", NULL));
+  stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 0u);
+  ASSERT_EQ(stats.uReservedBytes, 0u);
+}
+
+TEST(StringArena, MatchesReferenceValues) {
+  std::mt19937 rng(7);
+  CSimpleIniA ini;
+  std::map<std::string, std::string> ref;
+  for (int n = 0; n < 5000; ++n) {
+    const std::string key = "key" + std::to_string(rng() % 50);
+    if (rng() % 4 == 0) {
+      ini.Delete("section", key.c_str());
+      ref.erase(key);
+      continue;
+    }
+    const std::string value(rng() % 400, static_cast<char>('a' + n % 26));
+    ASSERT_GE(ini.SetValue("section", key.c_str(), value.c_str()), 0);
+    ref[key] = value;
+  }
+
+  ASSERT_EQ(static_cast<size_t>(ini.GetSectionSize("section")), ref.size());
+  for (const auto &entry : ref) {
+    ASSERT_EQ(ini.GetValue("section", entry.first.c_str()), entry.second);
+  }
+  const CSimpleIniA::StringStats stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 1 + 2 * ref.size());
+  ASSERT_LE(stats.uUsedBytes + stats.uFreeBytes, stats.uReservedBytes);
+}
@@ -0,0 +1,99 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+static const char g_data[] = "[config]\n"
+                             "alpha = 1\n"
+                             "Beta = 2\n"
+                             "gamma = 3\n"
+                             "delta = 4\n"
+                             "multi = first\n"
+                             "multi = second\n"
+                             "\n"
+                             "[other]\n"
+                             "alpha = other\n";
+
+TEST(GetValues, FindsKeys) {
+  for (int nMode = 0; nMode < 3; ++nMode) {
+    CSimpleIniA ini(false, true);
+    ini.SetHashIndex(nMode == 1);
+    ini.SetLazyLoad(nMode == 2);
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+
+    const char *keys[] = {"gamma", "missing", "ALPHA", NULL,
+                          "multi", "beta",    "zzz"};
+    const size_t uKeys = sizeof(keys) / sizeof(keys[0]);
+    const char *values[uKeys];
+    CSimpleIniA::TNamesDepend missing;
+    ASSERT_EQ(ini.GetValues("config", keys, uKeys, values, &missing), 4u);
+    ASSERT_STREQ(values[0], "3");
+    ASSERT_EQ(values[1], nullptr);
+    ASSERT_STREQ(values[2], "1");
+    ASSERT_EQ(values[3], nullptr);
+    ASSERT_STREQ(values[4], "first");
+    ASSERT_STREQ(values[5], "2");
+    ASSERT_EQ(values[6], nullptr);
+
+    ASSERT_EQ(missing.size(), 2u);
+    ASSERT_STREQ(missing.front().pItem, "missing");
+    ASSERT_EQ(missing.front().nOrder, 1);
+    ASSERT_STREQ(missing.back().pItem, "zzz");
+    ASSERT_EQ(missing.back().nOrder, 6);
+  }
+}
+
+TEST(GetValues, SortedKeys) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  const char *keys[] = {"alpha", "beta", "delta", "epsilon", "gamma"};
+  const char *values[5];
+  ASSERT_EQ(ini.GetValues("config", keys, 5, values, NULL, true), 4u);
+  ASSERT_STREQ(values[0], "1");
+  ASSERT_STREQ(values[1], "2");
+  ASSERT_STREQ(values[2], "4");
+  ASSERT_EQ(values[3], nullptr);
+  ASSERT_STREQ(values[4], "3");
+}
+
+TEST(GetValues, MissingSection) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  const char *keys[] = {"alpha", "beta"};
+  const char *values[2] = {"x", "y"};
+  CSimpleIniA::TNamesDepend missing;
+  ASSERT_EQ(ini.GetValues("nothing", keys, 2, values, &missing), 0u);
+  ASSERT_EQ(values[0], nullptr);
+  ASSERT_EQ(values[1], nullptr);
+  ASSERT_EQ(missing.size(), 2u);
+  ASSERT_EQ(ini.GetValues(NULL, keys, 2, values), 0u);
+}
+
+TEST(GetValues, LargeSection) {
+  // few keys from a large section are looked up one by one
+  CSimpleIniA ini;
+  std::vector<std::string> names;
+  for (int n = 0; n < 1000; ++n) {
+    names.push_back("key" + std::to_string(n));
+    ini.SetLongValue("big", names.back().c_str(), n);
+  }
+  const char *keys[] = {"key999", "key5", "nokey"};
+  const char *values[3];
+  ASSERT_EQ(ini.GetValues("big", keys, 3, values), 2u);
+  ASSERT_STREQ(values[0], "999");
+  ASSERT_STREQ(values[1], "5");
+  ASSERT_EQ(values[2], nullptr);
+
+  // and many keys are found with a walk
+  std::vector<const char *> all;
+  for (size_t n = 0; n < names.size(); ++n) {
+    all.push_back(names[n].c_str());
+  }
+  std::vector<const char *> allValues(all.size());
+  ASSERT_EQ(ini.GetValues("big", all.data(), all.size(), allValues.data()),
+            all.size());
+  for (size_t n = 0; n < all.size(); ++n) {
+    ASSERT_EQ(std::to_string(n), allValues[n]);
+  }
+}
@@ -0,0 +1,100 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+TEST(SetValues, InsertsAndUpdates) {
+  for (int nMode = 0; nMode < 2; ++nMode) {
+    CSimpleIniA ini;
+    ini.SetHashIndex(nMode == 1);
+    ASSERT_EQ(ini.LoadData("[db]\nhost = old\n"), SI_OK);
+
+    const char *keys[] = {"port", "HOST", "user", "empty"};
+    const char *values[] = {"5432", "localhost", "admin", NULL};
+    ASSERT_EQ(ini.SetValues("db", keys, values, 4), SI_INSERTED);
+    ASSERT_EQ(ini.GetSectionSize("db"), 4);
+    ASSERT_STREQ(ini.GetValue("db", "host"), "localhost");
+    ASSERT_STREQ(ini.GetValue("db", "port"), "5432");
+    ASSERT_STREQ(ini.GetValue("db", "user"), "admin");
+    ASSERT_STREQ(ini.GetValue("db", "empty"), "");
+
+    // only updates
+    const char *updates[] = {"1", "2"};
+    ASSERT_EQ(ini.SetValues("db", keys, updates, 2), SI_UPDATED);
+    ASSERT_STREQ(ini.GetValue("db", "port"), "1");
+    ASSERT_STREQ(ini.GetValue("db", "host"), "2");
+
+    // a new section with no keys
+    ASSERT_EQ(ini.SetValues("new", keys, values, 0), SI_INSERTED);
+    ASSERT_TRUE(ini.SectionExists("new"));
+    ASSERT_EQ(ini.SetValues(NULL, keys, values, 1), SI_FAIL);
+  }
+}
+
+TEST(SetValues, NewKeysKeepLoadOrder) {
+  CSimpleIniA ini;
+  std::vector<std::string> names, data;
+  for (int n = 0; n < 500; ++n) {
+    names.push_back("key" + std::to_string(1000 + n));
+    data.push_back(std::to_string(n));
+  }
+  std::vector<const char *> keys, values;
+  for (size_t n = 0; n < names.size(); ++n) {
+    keys.push_back(names[n].c_str());
+    values.push_back(data[n].c_str());
+  }
+  ASSERT_EQ(ini.SetValues("s", keys.data(), values.data(), keys.size(), true),
+            SI_INSERTED);
+  ASSERT_EQ(ini.GetSectionSize("s"), 500);
+  ASSERT_STREQ(ini.GetValue("s", "key1499"), "499");
+
+  std::string out;
+  ASSERT_EQ(ini.Save(out), SI_OK);
+  ASSERT_NE(out.find("key1000 = 0\nkey1001 = 1\n"), std::string::npos);
+
+  // the copies are freed like any other
+  ASSERT_TRUE(ini.Delete("s", NULL));
+  ASSERT_EQ(ini.GetStringStats().uStrings, 0u);
+}
+
+TEST(SetValues, MultiKey) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[s]\nk = 1\n"), SI_OK);
+  const char *keys[] = {"k", "k", "j"};
+  const char *values[] = {"2", "3", "4"};
+  ASSERT_EQ(ini.SetValues("s", keys, values, 3), SI_INSERTED);
+  CSimpleIniA::TNamesDepend all;
+  ASSERT_TRUE(ini.GetAllValues("s", "k", all));
+  all.sort(CSimpleIniA::Entry::LoadOrder());
+  ASSERT_EQ(all.size(), 3u);
+  ASSERT_STREQ(all.front().pItem, "1");
+  ASSERT_STREQ(all.back().pItem, "3");
+  ASSERT_STREQ(ini.GetValue("s", "k"), "1");
+}
+
+TEST(SetValues, ReservesOneSlab) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.SetValue("s", "first", "value"), SI_INSERTED);
+
+  // the rest of the current slab is kept for later strings
+  std::vector<std::string> names;
+  for (int n = 0; n < 2000; ++n) {
+    names.push_back("key" + std::to_string(n));
+  }
+  std::vector<const char *> keys, values(names.size(), "value");
+  for (size_t n = 0; n < names.size(); ++n) {
+    keys.push_back(names[n].c_str());
+  }
+  ASSERT_EQ(ini.SetValues("s", keys.data(), values.data(), keys.size()),
+            SI_INSERTED);
+  CSimpleIniA::StringStats stats = ini.GetStringStats();
+  ASSERT_EQ(stats.uStrings, 3u + 2 * names.size());
+  ASSERT_GE(stats.uReservedBytes, stats.uUsedBytes + stats.uFreeBytes);
+
+  for (int n = 0; n < 100; ++n) {
+    ASSERT_EQ(ini.SetValue("t", names[n].c_str(), "x"), SI_INSERTED);
+  }
+  ini.Reset();
+  ASSERT_EQ(ini.GetStringStats().uReservedBytes, 0u);
+}
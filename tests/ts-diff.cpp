@@ -0,0 +1,92 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+// one line for each difference: type, section, key, value, other value
+template <class TIni>
+static std::string Describe(const TIni &a_ini, const TIni &a_other) {
+  typename TIni::TDiff diff;
+  const size_t uCount = a_ini.Diff(a_other, diff);
+  EXPECT_EQ(uCount, diff.size());
+  std::string result;
+  for (const typename TIni::DiffEntry &entry : diff) {
+    result += "+-~"[entry.nType];
+    result += std::string(" ") + entry.pSection;
+    result += std::string(" ") + (entry.pKey ? entry.pKey : "*");
+    result += std::string(" ") + (entry.pValue ? entry.pValue : "-");
+    result += std::string(" ") + (entry.pOther ? entry.pOther : "-");
+    result += "\n";
+  }
+  return result;
+}
+
+TEST(Diff, SameData) {
+  CSimpleIniA a, b;
+  ASSERT_EQ(a.LoadData("; comment\n[s]\nk = 1\n[t]\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[t]\n; other comment\n[s]\nk = 1\n"), SI_OK);
+  ASSERT_EQ(Describe(a, b), "");
+  ASSERT_EQ(Describe(a, a), "");
+
+  CSimpleIniA empty;
+  CSimpleIniA::TDiff diff;
+  ASSERT_EQ(empty.Diff(empty, diff), 0u);
+}
+
+TEST(Diff, SectionsAndKeys) {
+  CSimpleIniA a, b;
+  ASSERT_EQ(a.LoadData("[a]\nx = 1\ny = 2\n[b]\nz = 3\n[c]\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[a]\nx = 1\ny = 5\nv = 6\n[c]\n[d]\nu = 7\n"), SI_OK);
+  ASSERT_EQ(Describe(a, b), "+ a v - 6\n"
+                            "~ a y 2 5\n"
+                            "- b * - -\n"
+                            "+ d * - -\n");
+  ASSERT_EQ(Describe(b, a), "- a v 6 -\n"
+                            "~ a y 5 2\n"
+                            "+ b * - -\n"
+                            "- d * - -\n");
+}
+
+TEST(Diff, NamesUseStrLessValuesAreExact) {
+  CSimpleIniA a, b;
+  ASSERT_EQ(a.LoadData("[Section]\nKey = value\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[SECTION]\nkey = VALUE\n"), SI_OK);
+  ASSERT_EQ(Describe(a, b), "~ Section Key value VALUE\n");
+
+  CSimpleIniCaseA c, d;
+  ASSERT_EQ(c.LoadData("[Section]\nKey = value\n"), SI_OK);
+  ASSERT_EQ(d.LoadData("[SECTION]\nKey = value\n"), SI_OK);
+  ASSERT_EQ(Describe(c, d), "+ SECTION * - -\n"
+                            "- Section * - -\n");
+}
+
+TEST(Diff, MultiKeyValues) {
+  CSimpleIniA a(false, true), b(false, true);
+  ASSERT_EQ(a.LoadData("[s]\nk = 1\nk = 2\nm = 1\nn = 1\nn = 2\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[s]\nk = 1\nm = 1\nm = 2\nn = 2\nn = 1\n"), SI_OK);
+  ASSERT_EQ(Describe(a, b), "- s k 2 -\n"
+                            "+ s m - 2\n"
+                            "~ s n 1 2\n"
+                            "~ s n 2 1\n");
+}
+
+TEST(Diff, LazySections) {
+  CSimpleIniA a, b;
+  a.SetLazyLoad();
+  b.SetLazyLoad();
+  ASSERT_EQ(a.LoadData("[a]\nx = 1\n[b]\ny = 2\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[a]\nx = 1\n[b]\ny = 3\n"), SI_OK);
+  ASSERT_EQ(Describe(a, b), "~ b y 2 3\n");
+}
+
+TEST(Diff, AfterChanges) {
+  CSimpleIniA a;
+  ASSERT_EQ(a.LoadData("[s]\nk = 1\n"), SI_OK);
+  CSimpleIniA b;
+  ASSERT_EQ(a.Clone(b), SI_OK);
+  ASSERT_EQ(b.SetValue("s", "k", "2"), SI_UPDATED);
+  ASSERT_EQ(b.SetValue("s", "new", "3"), SI_INSERTED);
+  ASSERT_TRUE(b.Delete("s", "k"));
+  ASSERT_EQ(Describe(a, b), "- s k 1 -\n"
+                            "+ s new - 3\n");
+}
@@ -269,6 +269,37 @@ TEST_F(TestEdgeCases, TestEmptyVsNoEquals) {
   ASSERT_TRUE(val2 == nullptr || val2[0] == '\0');
 }
 
+// Test that a key without a value doesn't take the value before it
+TEST_F(TestEdgeCases, TestKeyOnlyAfterValue) {
+  ini.SetAllowKeyOnly(true);
+
+  std::string input = "[a]\n"
+                      "x = 1\n"
+                      "flag\n"
+                      "[b]\n"
+                      "y = 2\n"
+                      "; comment\n"
+                      "other\n";
+
+  SI_Error rc = ini.LoadData(input);
+  ASSERT_EQ(rc, SI_OK);
+
+  ASSERT_STREQ(ini.GetValue("a", "flag", "default"), "");
+  ASSERT_STREQ(ini.GetValue("b", "other", "default"), "");
+
+  std::string output;
+  ASSERT_EQ(ini.Save(output), SI_OK);
+  ASSERT_EQ(output, "[a]\n"
+                    "x = 1\n"
+                    "flag\n"
+                    "\n\n"
+                    "[b]\n"
+                    "y = 2\n"
+                    "\n"
+                    "; comment\n"
+                    "other\n");
+}
+
 // Test Unicode section/key/value names
 TEST_F(TestEdgeCases, TestUnicode) {
   const char tesuto[] = u8"テスト";
@@ -0,0 +1,80 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+TEST(Entry, StoredNamesHaveLengthAndHash) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData("[Section]\nKey = value\n"), SI_OK);
+  ASSERT_EQ(ini.SetValue("section", "other key", "x"), SI_INSERTED);
+
+  CSimpleIniA::TNamesDepend names;
+  ini.GetAllSections(names);
+  ASSERT_EQ(names.size(), 1u);
+  ASSERT_EQ(names.front().uLen, 7u);
+
+  ini.GetAllKeys("SECTION", names);
+  ASSERT_EQ(names.size(), 2u);
+  for (const auto &name : names) {
+    ASSERT_EQ(name.uLen, strlen(name.pItem));
+  }
+
+  // names that compare as equal have the same hash
+  CSimpleIniA::Entry a("KEY", NULL, 0), b("key", NULL, 0), c("kez", NULL, 0);
+  ASSERT_EQ(a.uHash, b.uHash);
+  ASSERT_TRUE(a.IsSameName(b));
+  ASSERT_FALSE(a.IsSameName(c));
+
+  CSimpleIniCaseA::Entry d("KEY", NULL, 0), e("key", NULL, 0);
+  ASSERT_FALSE(d.IsSameName(e));
+
+  // values are measured but not hashed
+  ini.GetAllValues("section", "key", names);
+  ASSERT_EQ(names.size(), 1u);
+  ASSERT_EQ(names.front().uLen, 5u);
+}
+
+TEST(Entry, MultiKeyGroupsByName) {
+  for (int nHash = 0; nHash < 2; ++nHash) {
+    CSimpleIniA ini(false, true);
+    ini.SetHashIndex(nHash == 1);
+    ASSERT_EQ(ini.LoadData("[s]\na = 1\nB = 2\nA = 3\nb = 4\nc = 5\n"), SI_OK);
+    ASSERT_EQ(ini.GetSectionSize("s"), 3);
+
+    CSimpleIniA::TNamesDepend names;
+    ASSERT_TRUE(ini.GetAllValues("s", "a", names));
+    ASSERT_EQ(names.size(), 2u);
+    bool bMultiple = false;
+    ASSERT_STREQ(ini.GetValue("s", "c", NULL, &bMultiple), "5");
+    ASSERT_FALSE(bMultiple);
+    ini.GetValue("s", "b", NULL, &bMultiple);
+    ASSERT_TRUE(bMultiple);
+
+    // replacing keeps the first entry's order, deleting removes all of them
+    ASSERT_EQ(ini.SetValue("s", "B", "6", NULL, true), SI_UPDATED);
+    ASSERT_TRUE(ini.GetAllValues("s", "b", names));
+    ASSERT_EQ(names.size(), 1u);
+    ASSERT_TRUE(ini.Delete("s", "A"));
+    ASSERT_FALSE(ini.KeyExists("s", "a"));
+    ASSERT_EQ(ini.GetSectionSize("s"), 2);
+
+    std::string output;
+    ASSERT_EQ(ini.Save(output), SI_OK);
+    ASSERT_EQ(output, "[s]\nB = 6\nc = 5\n");
+  }
+}
+
+TEST(Entry, SaveUsesStoredLength) {
+  CSimpleIniA ini;
+  ini.SetMultiLine(true);
+  std::string value(5000, 'v');
+  ASSERT_EQ(ini.SetValue("a long section name", "k", value.c_str()),
+            SI_INSERTED);
+  ASSERT_EQ(ini.SetValue("a long section name", "m", "line 1\nline 2"),
+            SI_INSERTED);
+
+  std::string output;
+  ASSERT_EQ(ini.Save(output), SI_OK);
+  ASSERT_EQ(output, "[a long section name]\nk = " + value +
+                        "\nm = <<<END_OF_TEXT\nline 1\nline 2\nEND_OF_TEXT\n");
+}
@@ -0,0 +1,177 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+static const char *g_names[] = {"",     "a",   "A",       "b",   "key",
+                                "KEY",  "num", "missing", "dbl", "flag",
+                                "multi"};
+
+static const char g_data[] = "; file comment\n"
+                             "\n"
+                             "key = no section\n"
+                             "\n"
+                             "; section a\n"
+                             "[a]\n"
+                             "; the key\n"
+                             "key = value a\n"
+                             "num = 0x20\n"
+                             "dbl = 2.5\n"
+                             "flag = on\n"
+                             "multi = 1\n"
+                             "multi = 2\n"
+                             "multi = 3\n"
+                             "\n"
+                             "[b]\n"
+                             "KEY = value b\n"
+                             "empty =\n"
+                             "\n"
+                             "[A]\n"
+                             "num = -7\n";
+
+template <class NAMES>
+static void ExpectNamesEqual(const NAMES &a_names, const NAMES &a_ref) {
+  ASSERT_EQ(a_names.size(), a_ref.size());
+  auto iRef = a_ref.begin();
+  for (const auto &name : a_names) {
+    ASSERT_STREQ(name.pItem, iRef->pItem);
+    ASSERT_EQ(name.pComment == NULL, iRef->pComment == NULL);
+    if (name.pComment) {
+      ASSERT_STREQ(name.pComment, iRef->pComment);
+    }
+    ASSERT_EQ(name.nOrder, iRef->nOrder);
+    ++iRef;
+  }
+}
+
+template <class INI, class FROZEN>
+static void CompareReads(const FROZEN &a_frozen, const INI &a_ini) {
+  typename INI::TNamesDepend names, ref;
+  a_frozen.GetAllSections(names);
+  a_ini.GetAllSections(ref);
+  ExpectNamesEqual(names, ref);
+
+  for (const char *pszSection : g_names) {
+    ASSERT_EQ(a_frozen.SectionExists(pszSection),
+              a_ini.SectionExists(pszSection));
+    ASSERT_EQ(a_frozen.GetSectionSize(pszSection),
+              a_ini.GetSectionSize(pszSection));
+    ASSERT_EQ(a_frozen.GetAllKeys(pszSection, names),
+              a_ini.GetAllKeys(pszSection, ref));
+    ExpectNamesEqual(names, ref);
+
+    for (const char *pszKey : g_names) {
+      ASSERT_EQ(a_frozen.KeyExists(pszSection, pszKey),
+                a_ini.KeyExists(pszSection, pszKey));
+      bool bMultiple = false, bRefMultiple = false;
+      const char *pszValue =
+          a_frozen.GetValue(pszSection, pszKey, "def", &bMultiple);
+      const char *pszRef = a_ini.GetValue(pszSection, pszKey, "def",
+                                          &bRefMultiple);
+      ASSERT_STREQ(pszValue, pszRef) << pszSection << "/" << pszKey;
+      ASSERT_EQ(bMultiple, bRefMultiple);
+      ASSERT_EQ(a_frozen.GetLongValue(pszSection, pszKey, 99),
+                a_ini.GetLongValue(pszSection, pszKey, 99));
+      ASSERT_EQ(a_frozen.GetDoubleValue(pszSection, pszKey, 9.5),
+                a_ini.GetDoubleValue(pszSection, pszKey, 9.5));
+      ASSERT_EQ(a_frozen.GetBoolValue(pszSection, pszKey, true),
+                a_ini.GetBoolValue(pszSection, pszKey, true));
+      ASSERT_EQ(a_frozen.GetAllValues(pszSection, pszKey, names),
+                a_ini.GetAllValues(pszSection, pszKey, ref));
+      ExpectNamesEqual(names, ref);
+    }
+  }
+}
+
+TEST(Frozen, MatchesSource) {
+  for (int nMode = 0; nMode < 2; ++nMode) {
+    CSimpleIniA ini;
+    ini.SetMultiKey(nMode == 1);
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+    ASSERT_EQ(ini.SetValue("b", "added", "new value", "; new"), SI_INSERTED);
+
+    CSimpleIniFrozenA frozen;
+    ASSERT_TRUE(frozen.IsEmpty());
+    ASSERT_EQ(frozen.Freeze(ini), SI_OK);
+    ASSERT_FALSE(frozen.IsEmpty());
+    ASSERT_EQ(frozen.IsMultiKey(), ini.IsMultiKey());
+    CompareReads(frozen, ini);
+  }
+}
+
+TEST(Frozen, CaseSensitive) {
+  CSimpleIniCaseA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CSimpleIniFrozenCaseA frozen;
+  ASSERT_EQ(frozen.Freeze(ini), SI_OK);
+  CompareReads(frozen, ini);
+  ASSERT_STREQ(frozen.GetValue("A", "num"), "-7");
+  ASSERT_STREQ(frozen.GetValue("a", "num"), "0x20");
+  ASSERT_EQ(frozen.GetValue("b", "key"), nullptr);
+}
+
+TEST(Frozen, IndependentOfSource) {
+  CSimpleIniFrozenA frozen;
+  {
+    CSimpleIniA ini;
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+    ASSERT_EQ(frozen.Freeze(ini), SI_OK);
+    ini.SetValue("a", "key", "changed");
+    ini.Delete("b", NULL);
+  }
+  ASSERT_STREQ(frozen.GetValue("a", "key"), "value a");
+  ASSERT_STREQ(frozen.GetValue("b", "key"), "value b");
+  ASSERT_EQ(frozen.GetLongValue("a", "num"), -7);
+  ASSERT_EQ(frozen.GetDoubleValue("a", "dbl"), 2.5);
+  ASSERT_TRUE(frozen.GetBoolValue("a", "flag"));
+
+  // freezing again replaces the contents
+  CSimpleIniA other;
+  ASSERT_EQ(other.LoadData("[x]\ny = z\n"), SI_OK);
+  ASSERT_EQ(frozen.Freeze(other), SI_OK);
+  ASSERT_FALSE(frozen.SectionExists("a"));
+  ASSERT_STREQ(frozen.GetValue("x", "y"), "z");
+
+  frozen.Reset();
+  ASSERT_TRUE(frozen.IsEmpty());
+  ASSERT_EQ(frozen.GetValue("x", "y"), nullptr);
+}
+
+TEST(Frozen, LazySource) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad();
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CSimpleIniFrozenA frozen;
+  ASSERT_EQ(frozen.Freeze(ini), SI_OK);
+  CompareReads(frozen, ini);
+
+  // the order of lazily parsed keys is different, but not the data
+  CSimpleIniA ref;
+  ASSERT_EQ(ref.LoadData(g_data), SI_OK);
+  CSimpleIniA::TNamesDepend keys;
+  ASSERT_TRUE(ref.GetAllKeys("a", keys));
+  for (const auto &key : keys) {
+    ASSERT_STREQ(frozen.GetValue("a", key.pItem), ref.GetValue("a", key.pItem));
+  }
+  ASSERT_EQ(frozen.GetSectionSize("a"), ref.GetSectionSize("a"));
+}
+
+TEST(Frozen, PoolsRepeatedStrings) {
+  CSimpleIniA ini;
+  std::string data;
+  for (int s = 0; s < 1000; ++s) {
+    data += "[section" + std::to_string(s) + "]\n";
+    for (int k = 0; k < 10; ++k) {
+      data += "key" + std::to_string(k) + " = value\n";
+    }
+  }
+  ASSERT_EQ(ini.LoadData(data), SI_OK);
+  CSimpleIniFrozenA frozen;
+  ASSERT_EQ(frozen.Freeze(ini), SI_OK);
+  ASSERT_EQ(frozen.GetSectionSize("section999"), 10);
+  ASSERT_STREQ(frozen.GetValue("section500", "key5"), "value");
+
+  // section names, ten key names and one value
+  const size_t uKeys = 1000 * 10;
+  ASSERT_LT(frozen.GetMemorySize(), uKeys * 64);
+}
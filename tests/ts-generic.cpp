@@ -2,6 +2,8 @@
 #include "../SimpleIni.h"
 #include "gtest/gtest.h"
 
+#include <string>
+
 // Test SI_CONVERT_GENERIC with char interface
 class TestGenericChar : public ::testing::Test {
 protected:
@@ -69,6 +71,21 @@ TEST_F(TestGenericChar, TestSectionUKeyUValU) {
   ASSERT_STREQ(result, tesutoni);
 }
 
+// Save() reserves the UTF-8 size of wide characters
+TEST(TestGenericSave, WideReservedOnce) {
+  CSimpleIniW ini(true);
+  for (int n = 0; n < 2000; ++n) {
+    const std::wstring key = L"key " + std::to_wstring(n);
+    ASSERT_GE(ini.SetValue(L"s\u00e9ction", key.c_str(),
+                           L"\u00e9\u4e2d\u00fc value"),
+              0);
+  }
+  std::string strOut;
+  ASSERT_EQ(ini.Save(strOut), SI_OK);
+  ASSERT_GE(strOut.capacity(), strOut.size());
+  ASSERT_LE(strOut.capacity(), strOut.size() + strOut.size() / 20 + 64);
+}
+
 #ifdef _WIN32
 // Test SI_CONVERT_GENERIC with wchar_t interface (Windows only)
 // On non-Windows platforms, wchar_t support with SI_CONVERT_GENERIC doesn't work the same way
@@ -0,0 +1,150 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char g_data[] = "[limits]\n"
+                             "max_inflight = 64\n"
+                             "timeout = 30\n"
+                             "\n"
+                             "[other]\n"
+                             "key = value\n";
+
+TEST(KeyHandle, ReadsCurrentValue) {
+  for (int nMode = 0; nMode < 2; ++nMode) {
+    CSimpleIniA ini;
+    ini.SetHashIndex(nMode == 1);
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+
+    CSimpleIniA::TKeyHandle hMax = ini.ResolveKey("limits", "max_inflight");
+    CSimpleIniA::TKeyHandle hNew = ini.ResolveKey("limits", "new_key");
+    ASSERT_NE(hMax, nullptr);
+    ASSERT_NE(hNew, nullptr);
+    ASSERT_STREQ(ini.GetValue(hMax), "64");
+    ASSERT_STREQ(ini.GetValue(hMax), "64");
+    ASSERT_FALSE(ini.KeyExists(hNew));
+    ASSERT_STREQ(ini.GetValue(hNew, "def"), "def");
+
+    // the same key gives the same handle
+    ASSERT_EQ(ini.ResolveKey("LIMITS", "Max_Inflight"), hMax);
+    ASSERT_EQ(ini.ResolveKey(NULL, "key"), nullptr);
+
+    // changes are seen through the handles
+    ASSERT_EQ(ini.SetValue("limits", "max_inflight", "128"), SI_UPDATED);
+    ASSERT_EQ(ini.SetValue("limits", "new_key", "x"), SI_INSERTED);
+    ASSERT_STREQ(ini.GetValue(hMax), "128");
+    ASSERT_STREQ(ini.GetValue(hNew), "x");
+
+    ASSERT_TRUE(ini.Delete("limits", "max_inflight"));
+    ASSERT_EQ(ini.GetValue(hMax), nullptr);
+    ASSERT_TRUE(ini.Delete("limits", NULL));
+    ASSERT_FALSE(ini.KeyExists(hNew));
+    ASSERT_EQ(ini.SetValue("limits", "max_inflight", "1"), SI_INSERTED);
+    ASSERT_STREQ(ini.GetValue(hMax), "1");
+  }
+}
+
+TEST(KeyHandle, ResetAndReload) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CSimpleIniA::TKeyHandle hKey = ini.ResolveKey("other", "key");
+  ASSERT_STREQ(ini.GetValue(hKey), "value");
+
+  ini.Reset();
+  ASSERT_EQ(ini.GetValue(hKey), nullptr);
+  ASSERT_EQ(ini.LoadData("[other]\nkey = reloaded\n"), SI_OK);
+  ASSERT_STREQ(ini.GetValue(hKey), "reloaded");
+
+  // loading more data into the same object
+  ASSERT_EQ(ini.LoadData("[other]\nkey = merged\n"), SI_OK);
+  ASSERT_STREQ(ini.GetValue(hKey), "merged");
+
+  // a lazily loaded section is parsed on the first read
+  CSimpleIniA lazy;
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(g_data), SI_OK);
+  CSimpleIniA::TKeyHandle hLazy = lazy.ResolveKey("limits", "timeout");
+  ASSERT_STREQ(lazy.GetValue(hLazy), "30");
+  ASSERT_STREQ(lazy.GetValue(hLazy), "30");
+}
+
+TEST(KeyHandle, MultiKey) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[s]\nk = 1\nk = 2\n"), SI_OK);
+  CSimpleIniA::TKeyHandle hKey =
+      ini.ResolveKey(std::string_view("s"), std::string_view("kx", 1));
+  ASSERT_STREQ(ini.GetValue(hKey), "1");
+  ASSERT_TRUE(ini.DeleteValue("s", "k", "1"));
+  ASSERT_STREQ(ini.GetValue(hKey), "2");
+}
+
+TEST(KeyHandle, NullHandle) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CSimpleIniA::TKeyHandle hNull = NULL;
+  ASSERT_STREQ(ini.GetValue(hNull, "def"), "def");
+  ASSERT_FALSE(ini.KeyExists(hNull));
+}
+
+TEST(KeyHandle, ManyKeys) {
+  CSimpleIniA ini;
+  ini.SetHashIndex(true);
+  std::vector<CSimpleIniA::TKeyHandle> handles;
+  for (int n = 0; n < 1000; ++n) {
+    const std::string key = "key" + std::to_string(n);
+    handles.push_back(ini.ResolveKey("s", key.c_str()));
+    if (n % 2 == 0) {
+      ASSERT_EQ(ini.SetValue("s", key.c_str(), key.c_str()), SI_INSERTED);
+    }
+  }
+  for (int n = 0; n < 1000; ++n) {
+    const std::string key = "key" + std::to_string(n);
+    ASSERT_EQ(ini.ResolveKey("S", key.c_str()), handles[n]);
+    if (n % 2 == 0) {
+      ASSERT_STREQ(ini.GetValue(handles[n]), key.c_str());
+    } else {
+      ASSERT_FALSE(ini.KeyExists(handles[n]));
+    }
+  }
+
+  // removing a section clears only the handles of its keys
+  CSimpleIniA::TKeyHandle hOther = ini.ResolveKey("t", "key0");
+  ASSERT_EQ(ini.SetValue("t", "key0", "t"), SI_INSERTED);
+  ASSERT_TRUE(ini.Delete("s", NULL));
+  ASSERT_FALSE(ini.KeyExists(handles[0]));
+  ASSERT_STREQ(ini.GetValue(hOther), "t");
+
+  // a copy has handles of its own
+  CSimpleIniA copy;
+  CSimpleIniA::TKeyHandle hCopy = copy.ResolveKey("t", "key0");
+  ASSERT_EQ(ini.Clone(copy), SI_OK);
+  ASSERT_STREQ(copy.GetValue(hCopy), "t");
+}
+
+TEST(KeyHandle, ConcurrentReaders) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CSimpleIniA::TKeyHandle hMax = ini.ResolveKey("limits", "max_inflight");
+  CSimpleIniA::TKeyHandle hKey = ini.ResolveKey("other", "key");
+
+  // reads through handles don't write, so readers don't race
+  std::vector<std::thread> readers;
+  int nFound[4] = {0, 0, 0, 0};
+  for (int n = 0; n < 4; ++n) {
+    readers.push_back(std::thread([&, n]() {
+      for (int i = 0; i < 10000; ++i) {
+        if (ini.KeyExists(hMax) && ini.GetValue(hKey)) {
+          ++nFound[n];
+        }
+      }
+    }));
+  }
+  for (size_t n = 0; n < readers.size(); ++n) {
+    readers[n].join();
+  }
+  for (int n = 0; n < 4; ++n) {
+    ASSERT_EQ(nFound[n], 10000);
+  }
+}
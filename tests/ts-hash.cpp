@@ -0,0 +1,147 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+
+static std::string SaveString(const CSimpleIniA &a_ini) {
+  std::string strOut;
+  EXPECT_EQ(a_ini.Save(strOut), SI_OK);
+  return strOut;
+}
+
+static const char *g_names[] = {"a",   "A",   "b",        "Key",
+                                "KEY", "key", "long name"};
+
+template <class INI>
+static void CompareLookups(const INI &a_ini, const INI &a_ref) {
+  for (const char *pszSection : g_names) {
+    ASSERT_EQ(a_ini.SectionExists(pszSection),
+              a_ref.SectionExists(pszSection));
+    ASSERT_EQ(a_ini.GetSectionSize(pszSection),
+              a_ref.GetSectionSize(pszSection));
+    for (const char *pszKey : g_names) {
+      bool bMultiple = false;
+      bool bRefMultiple = false;
+      const char *pszValue =
+          a_ini.GetValue(pszSection, pszKey, NULL, &bMultiple);
+      const char *pszRef =
+          a_ref.GetValue(pszSection, pszKey, NULL, &bRefMultiple);
+      ASSERT_EQ(pszValue == NULL, pszRef == NULL) << pszSection << pszKey;
+      if (pszValue) {
+        ASSERT_STREQ(pszValue, pszRef);
+      }
+      ASSERT_EQ(bMultiple, bRefMultiple);
+    }
+  }
+}
+
+TEST(HashIndex, MatchesOrderedLookups) {
+  std::mt19937 rng(42);
+  for (int nRun = 0; nRun < 20; ++nRun) {
+    CSimpleIniA ref(false, nRun % 2 == 0);
+    CSimpleIniA ini(false, nRun % 2 == 0);
+    ini.SetHashIndex();
+    ASSERT_TRUE(ini.IsHashIndex());
+
+    for (int nOp = 0; nOp < 300; ++nOp) {
+      const char *pszSection = g_names[rng() % 7];
+      const char *pszKey = g_names[rng() % 7];
+      const std::string strValue = std::to_string(rng() % 4);
+      switch (rng() % 6) {
+      case 0:
+      case 1:
+        ASSERT_EQ(ini.SetValue(pszSection, pszKey, strValue.c_str()),
+                  ref.SetValue(pszSection, pszKey, strValue.c_str()));
+        break;
+      case 2:
+        ASSERT_EQ(ini.SetValue(pszSection, pszKey, strValue.c_str(), NULL,
+                               true),
+                  ref.SetValue(pszSection, pszKey, strValue.c_str(), NULL,
+                               true));
+        break;
+      case 3: {
+        const bool bRemoveEmpty = rng() % 2 == 0;
+        ASSERT_EQ(ini.Delete(pszSection, pszKey, bRemoveEmpty),
+                  ref.Delete(pszSection, pszKey, bRemoveEmpty));
+        break;
+      }
+      case 4:
+        ASSERT_EQ(ini.DeleteValue(pszSection, pszKey, strValue.c_str()),
+                  ref.DeleteValue(pszSection, pszKey, strValue.c_str()));
+        break;
+      case 5:
+        if (rng() % 10 == 0) {
+          ASSERT_EQ(ini.Delete(pszSection, NULL), ref.Delete(pszSection, NULL));
+        }
+        break;
+      }
+      CompareLookups(ini, ref);
+    }
+    EXPECT_EQ(SaveString(ini), SaveString(ref));
+  }
+}
+
+TEST(HashIndex, CaseSensitive) {
+  CSimpleIniCaseA ini;
+  ini.SetHashIndex();
+  ASSERT_TRUE(ini.IsHashIndex());
+  ASSERT_EQ(ini.LoadData("[Sec]\nKey = 1\nkey = 2\n[sec]\nKey = 3\n"), SI_OK);
+  EXPECT_STREQ(ini.GetValue("Sec", "Key"), "1");
+  EXPECT_STREQ(ini.GetValue("Sec", "key"), "2");
+  EXPECT_STREQ(ini.GetValue("sec", "Key"), "3");
+  EXPECT_EQ(ini.GetValue("sec", "key"), nullptr);
+  EXPECT_EQ(ini.GetValue("SEC", "Key"), nullptr);
+}
+
+TEST(HashIndex, EnabledAfterLoading) {
+  const char *pszInput = "[a]\nx = 1\nx = 2\n[B]\ny = 3\n";
+  CSimpleIniA ref(false, true);
+  ASSERT_EQ(ref.LoadData(pszInput), SI_OK);
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData(pszInput), SI_OK);
+  ini.SetHashIndex();
+  CompareLookups(ini, ref);
+  EXPECT_STREQ(ini.GetValue("b", "Y"), "3");
+
+  ini.SetHashIndex(false);
+  EXPECT_FALSE(ini.IsHashIndex());
+  CompareLookups(ini, ref);
+}
+
+TEST(HashIndex, WithLazyLoad) {
+  const char *pszInput = "[a]\nx = 1\n[b]\ny = 2\n[a]\nz = 3\n";
+  CSimpleIniA ref;
+  ASSERT_EQ(ref.LoadData(pszInput), SI_OK);
+  CSimpleIniA ini;
+  ini.SetHashIndex();
+  ini.SetLazyLoad();
+  ASSERT_EQ(ini.LoadData(pszInput), SI_OK);
+  CompareLookups(ini, ref);
+  EXPECT_EQ(SaveString(ini), SaveString(ref));
+}
+
+TEST(HashIndex, ReloadAfterReset) {
+  CSimpleIniA ini;
+  ini.SetHashIndex();
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\n"), SI_OK);
+  ini.Reset();
+  EXPECT_EQ(ini.GetValue("a", "x"), nullptr);
+  EXPECT_TRUE(ini.IsHashIndex());
+  ASSERT_EQ(ini.LoadData("[a]\nx = 2\n"), SI_OK);
+  EXPECT_STREQ(ini.GetValue("A", "X"), "2");
+}
+
+struct ReverseLess {
+  bool operator()(const char *a_pLeft, const char *a_pRight) const {
+    return strcmp(a_pRight, a_pLeft) < 0;
+  }
+};
+
+TEST(HashIndex, IgnoredWithoutMatchingHash) {
+  CSimpleIniTempl<char, ReverseLess, SI_ConvertA<char>> ini;
+  ini.SetHashIndex();
+  EXPECT_FALSE(ini.IsHashIndex());
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\n"), SI_OK);
+  EXPECT_STREQ(ini.GetValue("a", "x"), "1");
+}
@@ -0,0 +1,175 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+static const char g_szInput[] =
+    "; file comment\n"
+    "\n"
+    "global = 1\n"
+    "; comment for one\n"
+    "\n"
+    "; continues after a blank line\n"
+    "[one]\r\n"
+    "key = value\r\n"
+    "multi = <<<END\r\n"
+    "[not a section]\r\n"
+    "END  \r\n"
+    "[still not a section]\r\n"
+    "END\r\n"
+    "; key comment\n"
+    "dup = a\n"
+    "invalid line\n"
+    "; dangling comment\n"
+    "also invalid\n"
+    "[ two ]\n"
+    "  spaced key  =  spaced value  \n"
+    "tag = <<<TAG  \n"
+    "[x]\n"
+    "TAG   \n"
+    "=empty key\n"
+    "[]\n"
+    "nameless = 2\n"
+    "[one]\n"
+    "dup = b\n"
+    "[empty]\n"
+    "[last]\n"
+    "tail = <<<EOF\n"
+    "unterminated multi-line value";
+
+static std::string SaveString(const CSimpleIniA &a_ini) {
+  std::string strOut;
+  EXPECT_EQ(a_ini.Save(strOut), SI_OK);
+  return strOut;
+}
+
+TEST(LazyLoad, SaveMatchesEagerLoad) {
+  CSimpleIniA eager(false, true, true);
+  ASSERT_EQ(eager.LoadData(g_szInput), SI_OK);
+
+  CSimpleIniA lazy(false, true, true);
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(g_szInput), SI_OK);
+  EXPECT_EQ(SaveString(lazy), SaveString(eager));
+}
+
+TEST(LazyLoad, ValuesMatchEagerLoad) {
+  CSimpleIniA eager(false, true, true);
+  ASSERT_EQ(eager.LoadData(g_szInput), SI_OK);
+
+  CSimpleIniA lazy(false, true, true);
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(g_szInput), SI_OK);
+
+  CSimpleIniA::TNamesDepend sections;
+  eager.GetAllSections(sections);
+  CSimpleIniA::TNamesDepend lazySections;
+  lazy.GetAllSections(lazySections);
+  ASSERT_EQ(lazySections.size(), sections.size());
+
+  // visit the sections in reverse so they are parsed in a different order
+  sections.sort(CSimpleIniA::Entry::LoadOrder());
+  sections.reverse();
+  for (const CSimpleIniA::Entry &section : sections) {
+    ASSERT_TRUE(lazy.SectionExists(section.pItem)) << section.pItem;
+    EXPECT_EQ(lazy.GetSectionSize(section.pItem),
+              eager.GetSectionSize(section.pItem));
+    CSimpleIniA::TNamesDepend keys;
+    eager.GetAllKeys(section.pItem, keys);
+    for (const CSimpleIniA::Entry &key : keys) {
+      CSimpleIniA::TNamesDepend values;
+      CSimpleIniA::TNamesDepend lazyValues;
+      eager.GetAllValues(section.pItem, key.pItem, values);
+      lazy.GetAllValues(section.pItem, key.pItem, lazyValues);
+      ASSERT_EQ(lazyValues.size(), values.size()) << key.pItem;
+      values.sort(CSimpleIniA::Entry::LoadOrder());
+      lazyValues.sort(CSimpleIniA::Entry::LoadOrder());
+      CSimpleIniA::TNamesDepend::const_iterator i = lazyValues.begin();
+      for (const CSimpleIniA::Entry &value : values) {
+        EXPECT_STREQ(i->pItem, value.pItem);
+        if (value.pComment) {
+          EXPECT_STREQ(i->pComment, value.pComment);
+        } else {
+          EXPECT_EQ(i->pComment, nullptr);
+        }
+        ++i;
+      }
+    }
+  }
+  EXPECT_EQ(SaveString(lazy), SaveString(eager));
+}
+
+TEST(LazyLoad, KeysAreParsedOnFirstUse) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad();
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\n[b]\ny = 2\n"), SI_OK);
+
+  // load order is assigned when the section is parsed
+  CSimpleIniA::TNamesDepend keysB;
+  ASSERT_TRUE(ini.GetAllKeys("b", keysB));
+  CSimpleIniA::TNamesDepend keysA;
+  ASSERT_TRUE(ini.GetAllKeys("a", keysA));
+  ASSERT_EQ(keysA.size(), 1u);
+  ASSERT_EQ(keysB.size(), 1u);
+  EXPECT_LT(keysB.front().nOrder, keysA.front().nOrder);
+  EXPECT_STREQ(ini.GetValue("a", "x"), "1");
+  EXPECT_STREQ(ini.GetValue("b", "y"), "2");
+}
+
+TEST(LazyLoad, ModifyBeforeAndAfterUse) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad();
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\ny = 2\n[b]\nz = 3\n[c]\nw = 4\n"),
+            SI_OK);
+
+  EXPECT_EQ(ini.SetValue("a", "x", "changed"), SI_UPDATED);
+  EXPECT_EQ(ini.SetValue("b", "new", "5"), SI_INSERTED);
+  EXPECT_TRUE(ini.Delete("c", NULL));
+  EXPECT_TRUE(ini.Delete("a", "y"));
+
+  EXPECT_EQ(SaveString(ini), "[a]\n"
+                             "x = changed\n"
+                             "\n"
+                             "\n"
+                             "[b]\n"
+                             "z = 3\n"
+                             "new = 5\n");
+}
+
+TEST(LazyLoad, LoadIntoLazyObject) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad();
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\n[b]\ny = 2\n"), SI_OK);
+  ASSERT_EQ(ini.LoadData("[a]\nx = 3\nz = 4\n[c]\nw = 5\n"), SI_OK);
+
+  CSimpleIniA eager;
+  ASSERT_EQ(eager.LoadData("[a]\nx = 1\n[b]\ny = 2\n"), SI_OK);
+  ASSERT_EQ(eager.LoadData("[a]\nx = 3\nz = 4\n[c]\nw = 5\n"), SI_OK);
+  EXPECT_EQ(SaveString(ini), SaveString(eager));
+}
+
+TEST(LazyLoad, UnterminatedSectionLineIsParsedEagerly) {
+  const char *pszInput = "[a]\nx = 1\n[broken\ny = 2\n[b]\nz = 3\n";
+  CSimpleIniA eager;
+  ASSERT_EQ(eager.LoadData(pszInput), SI_OK);
+
+  CSimpleIniA lazy;
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(pszInput), SI_OK);
+  EXPECT_EQ(SaveString(lazy), SaveString(eager));
+}
+
+TEST(LazyLoad, KeyOnly) {
+  const char *pszInput = "; c\nkey only\n[a]\nx = 1\n; c\nflag\n[b]\n";
+  CSimpleIniA eager;
+  eager.SetAllowKeyOnly();
+  ASSERT_EQ(eager.LoadData(pszInput), SI_OK);
+
+  CSimpleIniA lazy;
+  lazy.SetAllowKeyOnly();
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(pszInput), SI_OK);
+  EXPECT_EQ(SaveString(lazy), SaveString(eager));
+  EXPECT_STREQ(lazy.GetValue("a", "flag"), "");
+  EXPECT_STREQ(eager.GetValue("a", "flag"), "");
+}
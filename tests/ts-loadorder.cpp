@@ -0,0 +1,200 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+
+// Every value visited by ForEachInLoadOrder, one "section|key=value" line
+// each, "section|" for a section without keys.
+template <class TIni> static std::string Walk(const TIni &a_ini) {
+  std::string out;
+  a_ini.ForEachInLoadOrder([&](const typename TIni::Entry &a_section,
+                               const typename TIni::Entry *a_pKey,
+                               const char *a_pValue) {
+    out += a_section.pItem;
+    out += "|";
+    if (a_pKey) {
+      out += a_pKey->pItem;
+      out += "=";
+      out += a_pValue;
+    }
+    out += "\n";
+    return true;
+  });
+  return out;
+}
+
+// The same walk done with the sorted lists of the query functions
+template <class TIni> static std::string WalkSorted(const TIni &a_ini) {
+  std::string out;
+  typename TIni::TNamesDepend sections;
+  a_ini.GetAllSections(sections);
+  sections.sort(typename TIni::Entry::LoadOrder());
+  typename TIni::TNamesDepend::const_iterator iSection = sections.begin();
+  for (; iSection != sections.end(); ++iSection) {
+    if (!*iSection->pItem && iSection != sections.begin()) {
+      sections.push_front(*iSection);
+      sections.erase(iSection--);
+    }
+  }
+  for (iSection = sections.begin(); iSection != sections.end(); ++iSection) {
+    typename TIni::TNamesDepend keys;
+    a_ini.GetAllKeys(iSection->pItem, keys);
+    keys.sort(typename TIni::Entry::LoadOrder());
+    if (keys.empty()) {
+      out += std::string(iSection->pItem) + "|\n";
+    }
+    typename TIni::TNamesDepend::const_iterator iKey = keys.begin();
+    for (; iKey != keys.end(); ++iKey) {
+      typename TIni::TNamesDepend values;
+      a_ini.GetAllValues(iSection->pItem, iKey->pItem, values);
+      typename TIni::TNamesDepend::const_iterator iValue = values.begin();
+      for (; iValue != values.end(); ++iValue) {
+        out += std::string(iSection->pItem) + "|" + iKey->pItem + "=" +
+               iValue->pItem + "\n";
+      }
+    }
+  }
+  return out;
+}
+
+TEST(LoadOrder, VisitsInLoadOrder) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[z]\nb = 1\na = 2\nb = 3\n"
+                         "[empty]\n"
+                         "[a]\nkey = value\n"),
+            SI_OK);
+  ASSERT_EQ(ini.SetValue("", "global", "g"), SI_INSERTED);
+  ASSERT_EQ(Walk(ini), "|global=g\n"
+                       "z|b=1\n"
+                       "z|b=3\n"
+                       "z|a=2\n"
+                       "empty|\n"
+                       "a|key=value\n");
+}
+
+TEST(LoadOrder, VisitorCanStop) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\ny = 2\n[b]\nz = 3\n"), SI_OK);
+  int nVisited = 0;
+  ASSERT_FALSE(ini.ForEachInLoadOrder(
+      [&](const CSimpleIniA::Entry &, const CSimpleIniA::Entry *,
+          const char *) { return ++nVisited < 2; }));
+  ASSERT_EQ(nVisited, 2);
+
+  CSimpleIniA empty;
+  ASSERT_TRUE(empty.ForEachInLoadOrder(
+      [](const CSimpleIniA::Entry &, const CSimpleIniA::Entry *,
+         const char *) { return false; }));
+}
+
+TEST(LoadOrder, DeletedEntriesAreUnlinked) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\ny = 2\nx = 3\nz = 4\n"
+                         "[b]\nk = v\n[c]\nk = v\n"),
+            SI_OK);
+  ASSERT_TRUE(ini.DeleteValue("a", "x", "1"));
+  ASSERT_TRUE(ini.Delete("a", "z"));
+  ASSERT_TRUE(ini.Delete("b", NULL));
+  ASSERT_TRUE(ini.Delete("c", "k", true));
+  // a key is placed by the first of its values
+  ASSERT_EQ(Walk(ini), "a|y=2\n"
+                       "a|x=3\n");
+
+  ASSERT_EQ(ini.SetValue("b", "k", "new"), SI_INSERTED);
+  ASSERT_EQ(ini.SetValue("a", "x", "5"), SI_UPDATED);
+  ASSERT_EQ(Walk(ini), "a|y=2\n"
+                       "a|x=3\n"
+                       "a|x=5\n"
+                       "b|k=new\n");
+
+  std::string strOut;
+  ASSERT_EQ(ini.Save(strOut), SI_OK);
+  ASSERT_EQ(strOut, "[a]\n"
+                    "y = 2\n"
+                    "x = 3\n"
+                    "x = 5\n"
+                    "\n\n"
+                    "[b]\n"
+                    "k = new\n");
+}
+
+TEST(LoadOrder, ReplacedValuesKeepTheirPlace) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\ny = 2\nx = 3\n"), SI_OK);
+  ASSERT_EQ(ini.SetValue("a", "x", "4", NULL, true), SI_UPDATED);
+  ASSERT_EQ(Walk(ini), "a|x=4\n"
+                       "a|y=2\n");
+  ASSERT_EQ(ini.SetValue("a", "y", "5"), SI_UPDATED);
+  ASSERT_EQ(Walk(ini), "a|x=4\n"
+                       "a|y=2\n"
+                       "a|y=5\n");
+  ASSERT_EQ(ini.SetValue("a", "y", "6", NULL, true), SI_UPDATED);
+  ASSERT_EQ(Walk(ini), "a|x=4\n"
+                       "a|y=6\n");
+}
+
+TEST(LoadOrder, CloneKeepsOrder) {
+  CSimpleIniA ini(false, true);
+  ASSERT_EQ(ini.LoadData("[z]\nb = 1\na = 2\nb = 3\n[a]\nk = v\n"), SI_OK);
+  ASSERT_TRUE(ini.Delete("z", "a"));
+  ASSERT_EQ(ini.SetValue("z", "a", "4"), SI_INSERTED);
+
+  CSimpleIniA copy;
+  ASSERT_EQ(ini.Clone(copy), SI_OK);
+  ASSERT_EQ(Walk(copy), Walk(ini));
+  ASSERT_EQ(copy.SetValue("z", "c", "5"), SI_INSERTED);
+  ASSERT_EQ(Walk(copy), "z|b=1\n"
+                        "z|b=3\n"
+                        "z|a=4\n"
+                        "z|c=5\n"
+                        "a|k=v\n");
+}
+
+TEST(LoadOrder, LazySectionsAreLoadedFirst) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad(true);
+  ASSERT_EQ(ini.LoadData("[b]\nx = 1\n[a]\ny = 2\n[b]\nz = 3\n"), SI_OK);
+  ASSERT_EQ(Walk(ini), "b|x=1\n"
+                       "b|z=3\n"
+                       "a|y=2\n");
+}
+
+TEST(LoadOrder, MatchesSortedQueries) {
+  std::mt19937 rng(11);
+  for (int nMode = 0; nMode < 2; ++nMode) {
+    CSimpleIniA ini(false, nMode != 0);
+    for (int n = 0; n < 4000; ++n) {
+      const std::string section = "s" + std::to_string(rng() % 8);
+      const std::string key = "k" + std::to_string(rng() % 30);
+      const std::string value = std::to_string(rng() % 4);
+      switch (rng() % 6) {
+      case 0:
+        ini.DeleteValue(section.c_str(), key.c_str(), value.c_str(), true);
+        break;
+      case 1:
+        ini.SetValue(section.c_str(), key.c_str(), value.c_str(), NULL, true);
+        break;
+      case 2:
+        if (rng() % 20 == 0) {
+          ini.Delete(section.c_str(), NULL);
+        }
+        break;
+      default:
+        ini.SetValue(section.c_str(), key.c_str(), value.c_str());
+        break;
+      }
+      if (n % 500 == 0) {
+        ASSERT_EQ(Walk(ini), WalkSorted(ini)) << "after " << n;
+      }
+    }
+    ASSERT_EQ(Walk(ini), WalkSorted(ini));
+
+    CSimpleIniA copy;
+    ASSERT_EQ(ini.Clone(copy), SI_OK);
+    std::string strExpected, strActual;
+    ASSERT_EQ(ini.Save(strExpected), SI_OK);
+    ASSERT_EQ(copy.Save(strActual), SI_OK);
+    ASSERT_EQ(strActual, strExpected);
+  }
+}
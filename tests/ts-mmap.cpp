@@ -0,0 +1,105 @@
+#define SI_CONVERT_GENERIC
+#define SI_SUPPORT_MMAP
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+static void WriteFile(const char *a_pszFile, const std::string &a_strData) {
+  FILE *fp = fopen(a_pszFile, "wb");
+  ASSERT_NE(fp, nullptr);
+  ASSERT_EQ(fwrite(a_strData.data(), 1, a_strData.size(), fp),
+            a_strData.size());
+  fclose(fp);
+}
+
+static std::string SaveString(const CSimpleIniA &a_ini) {
+  std::string strOut;
+  EXPECT_EQ(a_ini.Save(strOut), SI_OK);
+  return strOut;
+}
+
+TEST(MappedLoad, MatchesLoadFile) {
+  CSimpleIniA read, mapped;
+  ASSERT_EQ(read.LoadFile("example.ini"), SI_OK);
+  ASSERT_EQ(mapped.LoadFileMapped("example.ini"), SI_OK);
+  ASSERT_EQ(SaveString(mapped), SaveString(read));
+}
+
+TEST(MappedLoad, Utf8Signature) {
+  WriteFile("mmap-bom.ini", SI_UTF8_SIGNATURE "[s]\nkey = value\n");
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadFileMapped("mmap-bom.ini"), SI_OK);
+  ASSERT_TRUE(ini.IsUnicode());
+  ASSERT_STREQ(ini.GetValue("s", "key"), "value");
+  remove("mmap-bom.ini");
+}
+
+TEST(MappedLoad, ModifyAfterLoad) {
+  WriteFile("mmap-modify.ini", "; file comment\n\n[s]\na = 1\nb = 2\n");
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadFileMapped("mmap-modify.ini"), SI_OK);
+  ASSERT_EQ(ini.SetValue("s", "a", "changed"), SI_UPDATED);
+  ASSERT_EQ(ini.SetValue("t", "c", "3"), SI_INSERTED);
+  ASSERT_TRUE(ini.Delete("s", "b"));
+  ASSERT_STREQ(ini.GetValue("s", "a"), "changed");
+  ASSERT_STREQ(ini.GetValue("t", "c"), "3");
+
+  // the file itself is mapped copy-on-write and must be unchanged
+  CSimpleIniA check;
+  ASSERT_EQ(check.LoadFile("mmap-modify.ini"), SI_OK);
+  ASSERT_STREQ(check.GetValue("s", "a"), "1");
+  ASSERT_STREQ(check.GetValue("s", "b"), "2");
+
+  ini.Reset();
+  ASSERT_EQ(ini.LoadFileMapped("mmap-modify.ini"), SI_OK);
+  ASSERT_STREQ(ini.GetValue("s", "a"), "1");
+  remove("mmap-modify.ini");
+}
+
+TEST(MappedLoad, MergeIntoExistingData) {
+  WriteFile("mmap-merge.ini", "[s]\nb = 2\n");
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData("[s]\na = 1\n"), SI_OK);
+  ASSERT_EQ(ini.LoadFileMapped("mmap-merge.ini"), SI_OK);
+  remove("mmap-merge.ini");
+  ASSERT_STREQ(ini.GetValue("s", "a"), "1");
+  ASSERT_STREQ(ini.GetValue("s", "b"), "2");
+}
+
+TEST(MappedLoad, PageSizedFileFallsBackToRead) {
+  // a file that fills whole pages has no zero byte after it in the mapping
+  std::string strData = "[s]\nkey = value\n";
+  strData.resize(65536, '#');
+  strData[strData.size() - 1] = '\n';
+  WriteFile("mmap-page.ini", strData);
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadFileMapped("mmap-page.ini"), SI_OK);
+  remove("mmap-page.ini");
+  ASSERT_STREQ(ini.GetValue("s", "key"), "value");
+}
+
+TEST(MappedLoad, EmptyAndMissingFiles) {
+  WriteFile("mmap-empty.ini", "");
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadFileMapped("mmap-empty.ini"), SI_OK);
+  remove("mmap-empty.ini");
+  CSimpleIniA::TNamesDepend sections;
+  ini.GetAllSections(sections);
+  ASSERT_TRUE(sections.empty());
+  ASSERT_EQ(ini.LoadFileMapped("mmap-does-not-exist.ini"), SI_FILE);
+}
+
+TEST(MappedLoad, ConvertingLoader) {
+  WriteFile("mmap-wide.ini", "[s]\nkey = value\n");
+
+  CSimpleIniW ini;
+  ASSERT_EQ(ini.LoadFileMapped("mmap-wide.ini"), SI_OK);
+  remove("mmap-wide.ini");
+  ASSERT_STREQ(ini.GetValue(L"s", L"key"), L"value");
+}
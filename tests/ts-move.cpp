@@ -0,0 +1,106 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char g_data[] = "; file comment\n"
+                             "\n"
+                             "[db]\n"
+                             "host = localhost\n"
+                             "empty =\n"
+                             "\n"
+                             "; section comment\n"
+                             "[cache]\n"
+                             "size = 64\n";
+
+static CSimpleIniA MakeConfig() {
+  CSimpleIniA ini(false, true);
+  ini.SetSpaces(false);
+  EXPECT_EQ(ini.LoadData(g_data), SI_OK);
+  EXPECT_EQ(ini.SetValue("db", "user", "admin"), SI_INSERTED);
+  return ini;
+}
+
+TEST(Move, ConstructAndAssign) {
+  CSimpleIniA ini = MakeConfig();
+  ASSERT_TRUE(ini.IsMultiKey());
+  ASSERT_FALSE(ini.UsingSpaces());
+  ASSERT_STREQ(ini.GetValue("db", "host"), "localhost");
+  ASSERT_STREQ(ini.GetValue("db", "user"), "admin");
+  ASSERT_STREQ(ini.GetValue("db", "empty"), "");
+
+  const char *pHost = ini.GetValue("db", "host");
+  CSimpleIniA::TKeyHandle hSize = ini.ResolveKey("cache", "size");
+  CSimpleIniA moved(std::move(ini));
+  ASSERT_TRUE(ini.IsEmpty());
+  ASSERT_FALSE(ini.IsMultiKey());
+  ASSERT_EQ(moved.GetValue("db", "host"), pHost);
+  ASSERT_STREQ(moved.GetValue(hSize), "64");
+
+  CSimpleIniA other;
+  ASSERT_EQ(other.LoadData("[x]\ny = z\n"), SI_OK);
+  other = std::move(moved);
+  ASSERT_TRUE(moved.IsEmpty());
+  ASSERT_FALSE(other.SectionExists("x"));
+  ASSERT_STREQ(other.GetValue(hSize), "64");
+  ASSERT_EQ(other.SetValue("db", "host", "remote", NULL, true), SI_UPDATED);
+  ASSERT_STREQ(other.GetValue("db", "host"), "remote");
+
+  // the moved from object can be used again
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  ASSERT_STREQ(ini.GetValue("db", "host"), "localhost");
+}
+
+TEST(Move, SwapAndVector) {
+  CSimpleIniA a, b;
+  a.SetHashIndex();
+  ASSERT_EQ(a.LoadData("[a]\nk = 1\n"), SI_OK);
+  ASSERT_EQ(b.LoadData("[b]\nk = 2\n"), SI_OK);
+  a.Swap(b);
+  ASSERT_STREQ(a.GetValue("b", "k"), "2");
+  ASSERT_STREQ(b.GetValue("a", "k"), "1");
+  ASSERT_TRUE(b.IsHashIndex());
+  ASSERT_EQ(b.SetValue("a", "j", "3"), SI_INSERTED);
+  ASSERT_STREQ(b.GetValue("a", "j"), "3");
+
+  std::vector<CSimpleIniA> configs;
+  for (int n = 0; n < 20; ++n) {
+    configs.push_back(MakeConfig());
+  }
+  for (size_t n = 0; n < configs.size(); ++n) {
+    ASSERT_STREQ(configs[n].GetValue("cache", "size"), "64");
+  }
+}
+
+TEST(Move, Clone) {
+  for (int nMode = 0; nMode < 3; ++nMode) {
+    CSimpleIniA ini(false, true);
+    ini.SetHashIndex(nMode == 1);
+    ini.SetLazyLoad(nMode == 2);
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+    ASSERT_EQ(ini.SetValue("db", "user", "admin", "; the user"), SI_INSERTED);
+    ASSERT_EQ(ini.SetValue("db", "user", "guest"), SI_UPDATED);
+
+    CSimpleIniA copy;
+    ASSERT_EQ(copy.LoadData("[x]\ny = z\n"), SI_OK);
+    ASSERT_EQ(ini.Clone(copy), SI_OK);
+    ASSERT_TRUE(copy.IsMultiKey());
+    ASSERT_EQ(copy.IsHashIndex(), nMode == 1);
+    ASSERT_EQ(copy.IsLazyLoad(), nMode == 2);
+
+    std::string original, copied;
+    ASSERT_EQ(ini.Save(original), SI_OK);
+    ini.Reset();
+    ASSERT_EQ(copy.Save(copied), SI_OK);
+    ASSERT_EQ(original, copied);
+    ASSERT_FALSE(copy.SectionExists("x"));
+    ASSERT_STREQ(copy.GetValue("cache", "size"), "64");
+
+    // the copy owns its strings
+    ASSERT_TRUE(copy.Delete("db", "user"));
+    ASSERT_EQ(copy.SetValue("db", "host", "remote", NULL, true), SI_UPDATED);
+    ASSERT_STREQ(copy.GetValue("db", "host"), "remote");
+  }
+}
@@ -305,3 +305,98 @@ TEST_F(TestNumeric, TestNumericRoundtrip) {
   ASSERT_NEAR(ini2.GetDoubleValue("test", "double1", 0.0), 3.14159, 0.00001);
   ASSERT_NEAR(ini2.GetDoubleValue("test", "double2", 0.0), -2.71828, 0.00001);
 }
+
+// Test the 64-bit integer accessors
+TEST_F(TestNumeric, TestInt64Value) {
+  std::string input = "[numbers]\n"
+                      "big = 9223372036854775807\n"
+                      "small = -9223372036854775808\n"
+                      "over = 9223372036854775808\n"
+                      "hex = 0x7fffffffffffffff\n"
+                      "neghex = -0x10\n"
+                      "plus = +12\n"
+                      "umax = 18446744073709551615\n"
+                      "uover = 18446744073709551616\n"
+                      "bad = 12abc\n";
+
+  SI_Error rc = ini.LoadData(input);
+  ASSERT_EQ(rc, SI_OK);
+
+  ASSERT_EQ(ini.GetInt64Value("numbers", "big"), INT64_MAX);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "small"), INT64_MIN);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "over", -1), -1);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "hex"), INT64_MAX);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "neghex"), -16);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "plus"), 12);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "bad", -1), -1);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "missing", -2), -2);
+
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "umax"), UINT64_MAX);
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "uover", 1), 1u);
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "neghex", 1), 1u);
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "hex"), (uint64_t)INT64_MAX);
+}
+
+// Test that the 64-bit integer setters read back
+TEST_F(TestNumeric, TestSetInt64Value) {
+  ASSERT_EQ(ini.SetInt64Value("numbers", "min", INT64_MIN), SI_INSERTED);
+  ASSERT_EQ(ini.SetInt64Value("numbers", "hex", -255, NULL, true),
+            SI_INSERTED);
+  ASSERT_EQ(ini.SetUInt64Value("numbers", "umax", UINT64_MAX), SI_INSERTED);
+  ASSERT_EQ(ini.SetUInt64Value("numbers", "uhex", 0xABCu, NULL, true),
+            SI_INSERTED);
+
+  ASSERT_STREQ(ini.GetValue("numbers", "min"), "-9223372036854775808");
+  ASSERT_STREQ(ini.GetValue("numbers", "hex"), "-0xff");
+  ASSERT_STREQ(ini.GetValue("numbers", "umax"), "18446744073709551615");
+  ASSERT_STREQ(ini.GetValue("numbers", "uhex"), "0xabc");
+
+  ASSERT_EQ(ini.GetInt64Value("numbers", "min"), INT64_MIN);
+  ASSERT_EQ(ini.GetInt64Value("numbers", "hex"), -255);
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "umax"), UINT64_MAX);
+  ASSERT_EQ(ini.GetUInt64Value("numbers", "uhex"), 0xABCu);
+}
+
+// Test the floating point accessors
+TEST_F(TestNumeric, TestFloatValue) {
+  std::string input = "[numbers]\n"
+                      "pi = 3.141592653589793\n"
+                      "exp = -1.5e-300\n"
+                      "plus = +2.5\n"
+                      "bad = 1.5x\n"
+                      "comma = 1,5\n"
+                      "min = 5e-324\n"
+                      "subnormal = -1e-310\n"
+                      "underflow = 1e-400\n"
+                      "overflow = 1e400\n";
+
+  SI_Error rc = ini.LoadData(input);
+  ASSERT_EQ(rc, SI_OK);
+
+  ASSERT_EQ(ini.GetFloatValue("numbers", "pi"), 3.141592653589793);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "exp"), -1.5e-300);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "plus"), 2.5);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "bad", -1.0), -1.0);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "comma", -1.0), -1.0);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "missing", -2.0), -2.0);
+
+  // subnormals are read, smaller values round to zero
+  ASSERT_EQ(ini.GetFloatValue("numbers", "min"), 5e-324);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "subnormal"), -1e-310);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "underflow", -1.0), 0.0);
+  ASSERT_EQ(ini.GetFloatValue("numbers", "overflow", -1.0), -1.0);
+}
+
+// Test that SetFloatValue writes the shortest text that reads back
+TEST_F(TestNumeric, TestSetFloatValue) {
+  const double values[] = {0.1, 1.0 / 3.0, -2.5, 1e300, 5e-324, 0.0};
+  for (size_t n = 0; n < sizeof(values) / sizeof(values[0]); ++n) {
+    ASSERT_GE(ini.SetFloatValue("numbers", "value", values[n]), 0);
+    ASSERT_EQ(ini.GetFloatValue("numbers", "value", 99.0), values[n]);
+  }
+
+  ini.SetFloatValue("numbers", "tenth", 0.1);
+  ASSERT_STREQ(ini.GetValue("numbers", "tenth"), "0.1");
+  ini.SetFloatValue("numbers", "half", -0.5);
+  ASSERT_STREQ(ini.GetValue("numbers", "half"), "-0.5");
+}
@@ -0,0 +1,113 @@
+#define SI_SUPPORT_THREADS
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+// Data large enough to be split into many parts. The text between sections
+// varies so that split points fall on each kind of line.
+static std::string MakeData(const char *a_pszNewLine, int a_nSections) {
+  const std::string nl = a_pszNewLine;
+  std::string data = "; file comment" + nl + nl + "global = 1" + nl;
+  for (int n = 0; n < a_nSections; ++n) {
+    const std::string num = std::to_string(n);
+    switch (n % 7) {
+    case 0:
+      data += "; comment for section " + num + nl + nl + "; more" + nl;
+      break;
+    case 1:
+      data += "; dangling comment" + nl + "invalid line" + nl;
+      break;
+    case 2:
+      data += "key = <<<END" + nl + "[not a section " + num + "]" + nl +
+              "; not a comment" + nl + "END" + nl;
+      break;
+    case 3:
+      data += "[unterminated" + nl + "orphan = " + num + nl;
+      break;
+    default:
+      break;
+    }
+    data += "[section " + std::to_string(n % (a_nSections * 5 / 6)) + "]" + nl;
+    data += "; key comment" + nl + "a = " + num + nl + "b = value " + num +
+            nl + "a = again" + nl;
+    if (n % 11 == 0) {
+      data += "long = <<<TAG" + nl;
+      for (int line = 0; line < 40; ++line) {
+        data += "[inside " + std::to_string(line) + "]" + nl;
+      }
+      data += "TAG" + nl;
+    }
+  }
+  return data;
+}
+
+static std::string LoadAndSave(const std::string &a_strData,
+                               unsigned a_nThreads, bool a_bMultiKey,
+                               bool a_bMultiLine) {
+  CSimpleIniA ini(false, a_bMultiKey, a_bMultiLine);
+  ini.SetParallelLoad(a_nThreads);
+  EXPECT_EQ(ini.GetParallelLoad(), a_nThreads);
+  EXPECT_EQ(ini.LoadData(a_strData), SI_OK);
+  std::string strOut;
+  EXPECT_EQ(ini.Save(strOut), SI_OK);
+  return strOut;
+}
+
+TEST(ParallelLoad, MatchesSequentialLoad) {
+  const std::string strData = MakeData("\n", 3000);
+  for (int nMode = 0; nMode < 4; ++nMode) {
+    const bool bMultiKey = (nMode & 1) != 0;
+    const bool bMultiLine = (nMode & 2) != 0;
+    const std::string strExpected =
+        LoadAndSave(strData, 1, bMultiKey, bMultiLine);
+    for (unsigned nThreads : {2u, 3u, 16u}) {
+      ASSERT_EQ(LoadAndSave(strData, nThreads, bMultiKey, bMultiLine),
+                strExpected)
+          << nThreads << " threads, mode " << nMode;
+    }
+  }
+}
+
+TEST(ParallelLoad, WindowsLineEndings) {
+  const std::string strData = MakeData("\r\n", 3000);
+  const std::string strExpected = LoadAndSave(strData, 1, true, true);
+  ASSERT_EQ(LoadAndSave(strData, 5, true, true), strExpected);
+}
+
+TEST(ParallelLoad, MultiLineValueAcrossSplitPoint) {
+  // one multi-line value that covers most of the data, so every split
+  // point falls inside it
+  std::string strData = "[first]\nvalue = <<<END\n";
+  for (int n = 0; n < 20000; ++n) {
+    strData += "[line " + std::to_string(n) + "]\n";
+  }
+  strData += "END\n[last]\nkey = 1\n";
+
+  const std::string strExpected = LoadAndSave(strData, 1, false, true);
+  ASSERT_EQ(LoadAndSave(strData, 8, false, true), strExpected);
+
+  CSimpleIniA ini(false, false, true);
+  ini.SetParallelLoad(8);
+  ASSERT_EQ(ini.LoadData(strData), SI_OK);
+  ASSERT_STREQ(ini.GetValue("last", "key"), "1");
+  ASSERT_EQ(ini.GetSectionSize("line 5"), -1);
+}
+
+TEST(ParallelLoad, MergeIntoExistingData) {
+  const std::string strData = MakeData("\n", 1200);
+
+  CSimpleIniA expected;
+  ASSERT_EQ(expected.LoadData("[section 1]\nfirst = 1\n"), SI_OK);
+  ASSERT_EQ(expected.LoadData(strData), SI_OK);
+
+  CSimpleIniA ini;
+  ini.SetParallelLoad(4);
+  ASSERT_EQ(ini.LoadData("[section 1]\nfirst = 1\n"), SI_OK);
+  ASSERT_EQ(ini.LoadData(strData), SI_OK);
+
+  std::string strExpected, strActual;
+  ASSERT_EQ(expected.Save(strExpected), SI_OK);
+  ASSERT_EQ(ini.Save(strActual), SI_OK);
+  ASSERT_EQ(strActual, strExpected);
+}
@@ -17,8 +17,6 @@
 // ---------------------------------------------------------------------------
 #if defined(__linux__) && defined(__GLIBC__)
 
-static std::atomic<bool> g_fail_small_allocs{false};
-static std::atomic<size_t> g_small_alloc_threshold{256};
 static std::atomic<bool> g_fail_after_n_allocs{false};
 static std::atomic<int> g_alloc_budget{0};
 
@@ -31,9 +29,6 @@ extern "C" void *__wrap_malloc(size_t size) {
       return nullptr;
     }
   }
-  if (g_fail_small_allocs && size < g_small_alloc_threshold.load()) {
-    return nullptr;
-  }
   return __real_malloc(size);
 }
 
@@ -45,6 +40,18 @@ void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
   return __wrap_malloc(size);
 }
 
+// the allocations of the standard containers only fail when asked to
+static std::atomic<bool> g_fail_containers{false};
+
+void *operator new(std::size_t size) {
+  void *p = g_fail_containers.load() ? __wrap_malloc(size ? size : 1)
+                                     : __real_malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
 static size_t CurrentHeapBytes() {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -250,9 +257,12 @@ TEST(LoadDataRegression, DoesNotLeakParseBufferOnAddEntryFailure) {
 
   const size_t heap_before = CurrentHeapBytes();
 
-  g_fail_small_allocs = true;
+  // the parse buffer and the first slab of copied strings are allocated,
+  // the strings fail when the next slab is needed
+  g_fail_after_n_allocs = true;
+  g_alloc_budget = 2;
   const SI_Error rc = ini.LoadData(second);
-  g_fail_small_allocs = false;
+  g_fail_after_n_allocs = false;
 
   ASSERT_EQ(rc, SI_NOMEM);
 
@@ -279,7 +289,7 @@ TEST(LoadDataRegression, DoesNotPartiallyMergeOnAddEntryFailure) {
   }
 
   g_fail_after_n_allocs = true;
-  g_alloc_budget = 20;
+  g_alloc_budget = 2;
   const SI_Error rc = ini.LoadData(second);
   g_fail_after_n_allocs = false;
 
@@ -322,3 +332,42 @@ TEST(SetValueRegression, RejectsOversizedValue) {
   ASSERT_EQ(rc, SI_NOMEM);
   ASSERT_FALSE(ini.KeyExists("section", "key"));
 }
+
+// Clone must report SI_NOMEM and leave an empty copy whichever allocation
+// fails, including those of the containers.
+#if defined(__linux__) && defined(__GLIBC__)
+TEST(CloneRegression, ReportsNoMemory) {
+  CSimpleIniA ini(false, true);
+  ini.SetHashIndex(true);
+  ASSERT_EQ(ini.LoadData("; file comment\n\n[a]\nx = 1\nx = 2\n[b]\ny = 3\n"),
+            SI_OK);
+  ASSERT_EQ(ini.SetValue("c", "z", "copied", "; comment"), SI_INSERTED);
+  std::string strExpected;
+  ASSERT_EQ(ini.Save(strExpected), SI_OK);
+
+  for (int nBudget = 0;; ++nBudget) {
+    ASSERT_LT(nBudget, 1000);
+    CSimpleIniA copy;
+    g_fail_containers = true;
+    g_fail_after_n_allocs = true;
+    g_alloc_budget = nBudget;
+    const SI_Error rc = ini.Clone(copy);
+    g_fail_after_n_allocs = false;
+    g_fail_containers = false;
+
+    std::string strActual;
+    ASSERT_EQ(copy.Save(strActual), SI_OK);
+    if (rc == SI_OK) {
+      ASSERT_EQ(strActual, strExpected);
+      ASSERT_GT(nBudget, 5);
+      break;
+    }
+    ASSERT_EQ(rc, SI_NOMEM);
+    ASSERT_EQ(strActual, "");
+  }
+}
+#else
+TEST(CloneRegression, ReportsNoMemory) {
+  GTEST_SKIP() << "malloc interposer requires Linux glibc";
+}
+#endif
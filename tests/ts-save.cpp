@@ -0,0 +1,259 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// A writer written before Write(const char *, size_t) was added
+class TextWriter : public CSimpleIniA::OutputWriter {
+public:
+  std::string m_text;
+  size_t m_uCalls = 0;
+  void Write(const char *a_pBuf) {
+    m_text += a_pBuf;
+    ++m_uCalls;
+  }
+};
+
+// A writer that records the size of every block
+class BlockWriter : public CSimpleIniA::OutputWriter {
+public:
+  std::string m_text;
+  std::vector<size_t> m_blocks;
+  void Write(const char *) { ADD_FAILURE() << "not called with a length"; }
+  void Write(const char *a_pBuf, size_t a_uLen) {
+    m_text.append(a_pBuf, a_uLen);
+    m_blocks.push_back(a_uLen);
+  }
+};
+
+// A writer that fails
+class ThrowingWriter : public CSimpleIniA::OutputWriter {
+public:
+  size_t m_uCalls = 0;
+  void Write(const char *) { Write("", 0); }
+  void Write(const char *, size_t) {
+    ++m_uCalls;
+    throw std::runtime_error("write failed");
+  }
+};
+
+static void MakeLarge(CSimpleIniA &a_ini) {
+  ASSERT_EQ(a_ini.LoadData("; file comment\n\n[first]\nkey = value\n"), SI_OK);
+  for (int n = 0; n < 10000; ++n) {
+    const std::string section = "section " + std::to_string(n % 40);
+    const std::string key = "key " + std::to_string(n);
+    ASSERT_GE(a_ini.SetValue(section.c_str(), key.c_str(), "some value",
+                             n % 10 ? NULL : "; comment"),
+              0);
+  }
+}
+
+TEST(Save, WriterWithoutLength) {
+  CSimpleIniA ini(false, false, true);
+  MakeLarge(ini);
+  const std::string longValue(1000, 'x');
+  ASSERT_EQ(ini.SetValue("long", "value", longValue.c_str()), SI_INSERTED);
+  ASSERT_EQ(ini.SetValue("long", "multi", "line 1\nline 2"), SI_INSERTED);
+
+  std::string strExpected;
+  ASSERT_EQ(ini.Save(strExpected), SI_OK);
+  TextWriter writer;
+  ASSERT_EQ(ini.Save(writer), SI_OK);
+  ASSERT_EQ(writer.m_text, strExpected);
+  ASSERT_NE(writer.m_text.find(longValue), std::string::npos);
+
+  // the output is passed on in blocks, not one string at a time
+  ASSERT_LT(writer.m_uCalls, strExpected.size() / 255 + 10);
+}
+
+TEST(Save, WrittenInBlocks) {
+  CSimpleIniA ini;
+  MakeLarge(ini);
+  std::string strExpected;
+  ASSERT_EQ(ini.Save(strExpected), SI_OK);
+  ASSERT_GT(strExpected.size(), 2u * SI_SAVE_BUFFER_SIZE);
+
+  BlockWriter writer;
+  ASSERT_EQ(ini.Save(writer), SI_OK);
+  ASSERT_EQ(writer.m_text, strExpected);
+  // every block but the last is full, up to the length of one string
+  ASSERT_GT(writer.m_blocks.size(), 2u);
+  for (size_t n = 0; n < writer.m_blocks.size(); ++n) {
+    ASSERT_LE(writer.m_blocks[n], static_cast<size_t>(SI_SAVE_BUFFER_SIZE));
+    if (n + 1 < writer.m_blocks.size()) {
+      ASSERT_GT(writer.m_blocks[n], SI_SAVE_BUFFER_SIZE - 20u);
+    }
+  }
+}
+
+TEST(Save, LargerThanBuffer) {
+  CSimpleIniA ini;
+  const std::string value(3 * SI_SAVE_BUFFER_SIZE, 'v');
+  ASSERT_EQ(ini.SetValue("section", "before", "1"), SI_INSERTED);
+  ASSERT_EQ(ini.SetValue("section", "key", value.c_str()), SI_INSERTED);
+  ASSERT_EQ(ini.SetValue("section", "after", "2"), SI_INSERTED);
+
+  BlockWriter writer;
+  ASSERT_EQ(ini.Save(writer), SI_OK);
+  ASSERT_EQ(writer.m_text, "[section]\nbefore = 1\nkey = " + value +
+                               "\nafter = 2\n");
+  ASSERT_EQ(writer.m_blocks.size(), 3u);
+  ASSERT_EQ(writer.m_blocks[1], value.size());
+}
+
+TEST(Save, WriterThrows) {
+  CSimpleIniA ini;
+  MakeLarge(ini);
+  ThrowingWriter writer;
+  ASSERT_THROW(ini.Save(writer), std::runtime_error);
+  // the block is not written again while the exception unwinds
+  ASSERT_EQ(writer.m_uCalls, 1u);
+
+  CSimpleIniA small;
+  ASSERT_EQ(small.SetValue("section", "key", "value"), SI_INSERTED);
+  ThrowingWriter last;
+  ASSERT_THROW(small.Save(last), std::runtime_error);
+  ASSERT_EQ(last.m_uCalls, 1u);
+}
+
+TEST(Save, EmptyData) {
+  CSimpleIniA ini;
+  BlockWriter writer;
+  ASSERT_EQ(ini.Save(writer), SI_OK);
+  ASSERT_TRUE(writer.m_blocks.empty());
+}
+
+TEST(Save, FileMatchesString) {
+  CSimpleIniA ini(true);
+  MakeLarge(ini);
+  std::string strExpected;
+  ASSERT_EQ(ini.Save(strExpected, true), SI_OK);
+
+  const char *pszFile = "test-save.ini";
+  ASSERT_EQ(ini.SaveFile(pszFile, true), SI_OK);
+  FILE *fp = fopen(pszFile, "rb");
+  ASSERT_TRUE(fp != NULL);
+  std::string strActual;
+  char buf[4096];
+  size_t uRead;
+  while ((uRead = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    strActual.append(buf, uRead);
+  }
+  fclose(fp);
+  remove(pszFile);
+  ASSERT_EQ(strActual, strExpected);
+}
+
+TEST(Save, StringIsAppended) {
+  CSimpleIniA ini;
+  MakeLarge(ini);
+  TextWriter writer;
+  ASSERT_EQ(ini.Save(writer), SI_OK);
+
+  std::string strOut = "prefix\n";
+  ASSERT_EQ(ini.Save(strOut), SI_OK);
+  ASSERT_EQ(strOut, "prefix\n" + writer.m_text);
+}
+
+// The string is reserved from the size kept for the entries, so it should
+// not need to grow, or be reserved much larger than the output
+template <class TIni> static void ExpectReserved(const TIni &a_ini) {
+  std::string strOut;
+  ASSERT_EQ(a_ini.Save(strOut), SI_OK);
+  ASSERT_GE(strOut.capacity(), strOut.size());
+  ASSERT_LE(strOut.capacity(), strOut.size() + strOut.size() / 20 + 64);
+}
+
+TEST(Save, ReservedOnce) {
+  CSimpleIniA ini(true, true, true);
+  MakeLarge(ini);
+  ExpectReserved(ini);
+
+  // multi-line values and comments
+  for (int n = 0; n < 2000; ++n) {
+    const std::string key = "text " + std::to_string(n);
+    ASSERT_GE(ini.SetValue("text", key.c_str(), "line 1\nline 2\nline 3",
+                           "; comment\n; more"),
+              0);
+  }
+  ExpectReserved(ini);
+
+  // most of the loaded data is deleted
+  CSimpleIniA loaded;
+  std::string strData;
+  ASSERT_EQ(ini.Save(strData), SI_OK);
+  ASSERT_EQ(loaded.LoadData(strData), SI_OK);
+  for (int n = 1; n < 40; ++n) {
+    const std::string section = "section " + std::to_string(n);
+    ASSERT_TRUE(loaded.Delete(section.c_str(), NULL));
+  }
+  ASSERT_TRUE(loaded.Delete("text", NULL));
+  ExpectReserved(loaded);
+}
+
+TEST(Save, ReservedOnceForPaddedValues) {
+  // written as multi-line text
+  CSimpleIniA multi(false, false, true);
+  for (int n = 0; n < 2000; ++n) {
+    const std::string key = "key " + std::to_string(n);
+    ASSERT_EQ(multi.SetValue("section", key.c_str(), " v"), SI_INSERTED);
+  }
+  ExpectReserved(multi);
+
+  // written in quotes
+  CSimpleIniA quoted;
+  quoted.SetQuotes(true);
+  for (int n = 0; n < 2000; ++n) {
+    const std::string key = "key " + std::to_string(n);
+    ASSERT_EQ(quoted.SetValue("section", key.c_str(), " v "), SI_INSERTED);
+  }
+  ExpectReserved(quoted);
+
+  // the form follows the settings at the time of the save
+  multi.SetQuotes(true);
+  ExpectReserved(multi);
+  quoted.SetMultiLine(true);
+  ExpectReserved(quoted);
+  quoted.SetQuotes(false);
+  ExpectReserved(quoted);
+  for (int n = 0; n < 2000; n += 2) {
+    const std::string key = "key " + std::to_string(n);
+    ASSERT_EQ(quoted.SetValue("section", key.c_str(), "v"), SI_UPDATED);
+  }
+  ExpectReserved(quoted);
+}
+
+TEST(Save, CallerBuffer) {
+  CSimpleIniA ini(true);
+  MakeLarge(ini);
+  std::string strExpected;
+  ASSERT_EQ(ini.Save(strExpected, true), SI_OK);
+
+  // the length is found without a buffer
+  size_t uLength = 0;
+  ASSERT_EQ(ini.Save(NULL, 0, uLength, true), SI_FAIL);
+  ASSERT_EQ(uLength, strExpected.size());
+
+  std::vector<char> buf(uLength + 1, '#');
+  ASSERT_EQ(ini.Save(buf.data(), uLength, uLength, true), SI_OK);
+  ASSERT_EQ(uLength, strExpected.size());
+  ASSERT_EQ(std::string(buf.data(), uLength), strExpected);
+  ASSERT_EQ(buf[uLength], '#');
+
+  // what fits is written when the buffer is too small
+  std::fill(buf.begin(), buf.end(), '#');
+  ASSERT_EQ(ini.Save(buf.data(), 1000, uLength, true), SI_FAIL);
+  ASSERT_EQ(uLength, strExpected.size());
+  ASSERT_EQ(std::string(buf.data(), 1000), strExpected.substr(0, 1000));
+  ASSERT_EQ(buf[1000], '#');
+}
+
+TEST(Save, CallerBufferEmptyData) {
+  CSimpleIniA ini;
+  size_t uLength = 1;
+  ASSERT_EQ(ini.Save(NULL, 0, uLength), SI_OK);
+  ASSERT_EQ(uLength, 0u);
+}
@@ -0,0 +1,67 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+// Lines longer than the SIMD block size exercise the vectorized scanner,
+// the delimiters are placed on both sides of the 16 and 32 byte boundaries.
+
+TEST(Scanner, DelimiterAtEveryOffset) {
+  for (size_t uPad = 0; uPad < 80; ++uPad) {
+    const std::string key(uPad + 1, 'k');
+    const std::string value(uPad + 3, 'v');
+    const std::string section(uPad + 2, 's');
+    const std::string input = "[" + section + "]\n" + key + "=" + value +
+                              "\n" + key + "2 = " + value + "\r\n";
+
+    CSimpleIniA ini;
+    ASSERT_EQ(ini.LoadData(input), SI_OK);
+    ASSERT_STREQ(ini.GetValue(section.c_str(), key.c_str()), value.c_str());
+    ASSERT_STREQ(ini.GetValue(section.c_str(), (key + "2").c_str()),
+                 value.c_str());
+  }
+}
+
+TEST(Scanner, ValueWithoutTrailingNewline) {
+  for (size_t uLen = 1; uLen < 70; ++uLen) {
+    const std::string value(uLen, 'x');
+    CSimpleIniA ini;
+    ASSERT_EQ(ini.LoadData("[s]\nkey = " + value), SI_OK);
+    ASSERT_STREQ(ini.GetValue("s", "key"), value.c_str());
+  }
+}
+
+TEST(Scanner, SecondDelimiterIsData) {
+  std::string input = "[section] trailing ] text = ignored\n"
+                      "key = a=b=c]d [e] " +
+                      std::string(40, '=') + "\n";
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(input), SI_OK);
+  ASSERT_EQ(ini.GetSectionSize("section"), 1);
+  std::string expected = "a=b=c]d [e] " + std::string(40, '=');
+  ASSERT_STREQ(ini.GetValue("section", "key"), expected.c_str());
+}
+
+TEST(Scanner, EmbeddedNulEndsData) {
+  std::string input = "[s]\nkey = " + std::string(40, 'a');
+  input += '\0';
+  input += "bbbb\nother = value\n";
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(input), SI_OK);
+  ASSERT_STREQ(ini.GetValue("s", "key"), std::string(40, 'a').c_str());
+  ASSERT_EQ(ini.GetValue("s", "other"), nullptr);
+}
+
+TEST(Scanner, LongMultiLineValue) {
+  const std::string line(100, 'm');
+  std::string input = "[s]\nkey = <<<END\r\n" + line + "\r\n" + line +
+                      "\r\nEND\r\nnext = value\r\n";
+
+  CSimpleIniA ini;
+  ini.SetMultiLine();
+  ASSERT_EQ(ini.LoadData(input), SI_OK);
+  ASSERT_STREQ(ini.GetValue("s", "key"), (line + "\n" + line).c_str());
+  ASSERT_STREQ(ini.GetValue("s", "next"), "value");
+}
@@ -0,0 +1,119 @@
+#define SI_SUPPORT_THREADS
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string MakeData(int a_nVersion) {
+  const std::string num = std::to_string(a_nVersion);
+  std::string data;
+  for (int n = 0; n < 20; ++n) {
+    data += "[section " + std::to_string(n) + "]\nversion = " + num +
+            "\ncheck = " + num + "\n";
+  }
+  return data;
+}
+
+TEST(Shared, EmptyUntilPublished) {
+  CSimpleIniSharedA shared;
+  CSimpleIniSharedA::Snapshot snapshot = shared.GetSnapshot();
+  ASSERT_FALSE(snapshot);
+  ASSERT_EQ(snapshot.Get(), nullptr);
+  ASSERT_EQ(shared.Collect(), 0u);
+}
+
+TEST(Shared, SnapshotKeepsItsVersion) {
+  CSimpleIniSharedA shared;
+  ASSERT_EQ(shared.LoadData(MakeData(1)), SI_OK);
+  CSimpleIniSharedA::Snapshot first = shared.GetSnapshot();
+  ASSERT_TRUE(first);
+  ASSERT_STREQ(first->GetValue("section 3", "version"), "1");
+
+  ASSERT_EQ(shared.LoadData(MakeData(2)), SI_OK);
+  CSimpleIniSharedA::Snapshot second = shared.GetSnapshot();
+  ASSERT_STREQ(first->GetValue("section 3", "version"), "1");
+  ASSERT_STREQ(second->GetValue("section 3", "version"), "2");
+
+  // the first version is kept until its snapshot is released
+  ASSERT_EQ(shared.Collect(), 1u);
+  first.Release();
+  ASSERT_FALSE(first);
+  ASSERT_EQ(shared.Collect(), 0u);
+  ASSERT_STREQ((*second).GetValue("section 3", "version"), "2");
+}
+
+TEST(Shared, SnapshotsMove) {
+  CSimpleIniSharedA shared;
+  ASSERT_EQ(shared.LoadData(MakeData(1)), SI_OK);
+  CSimpleIniSharedA::Snapshot a = shared.GetSnapshot();
+  CSimpleIniSharedA::Snapshot b(std::move(a));
+  ASSERT_FALSE(a);
+  ASSERT_TRUE(b);
+
+  ASSERT_EQ(shared.LoadData(MakeData(2)), SI_OK);
+  a = shared.GetSnapshot();
+  ASSERT_EQ(shared.Collect(), 1u);
+  b = std::move(a);
+  ASSERT_EQ(shared.Collect(), 0u);
+  ASSERT_STREQ(b->GetValue("section 0", "version"), "2");
+}
+
+TEST(Shared, FailedLoadKeepsCurrent) {
+  CSimpleIniSharedA shared;
+  ASSERT_EQ(shared.LoadData(MakeData(1)), SI_OK);
+  ASSERT_LT(shared.LoadFile("does-not-exist.ini"), 0);
+  ASSERT_STREQ(shared.GetSnapshot()->GetValue("section 0", "version"), "1");
+}
+
+TEST(Shared, PublishPreparesForReaders) {
+  CSimpleIniA ini;
+  ini.SetLazyLoad();
+  ini.SetValueCache();
+  ASSERT_EQ(ini.LoadData(MakeData(5)), SI_OK);
+
+  CSimpleIniSharedA shared;
+  ASSERT_EQ(shared.Publish(std::move(ini)), SI_OK);
+  ASSERT_TRUE(ini.IsEmpty());
+
+  CSimpleIniSharedA::Snapshot snapshot = shared.GetSnapshot();
+  ASSERT_FALSE(snapshot->IsValueCache());
+  ASSERT_EQ(snapshot->GetSectionSize("section 19"), 2);
+  ASSERT_EQ(snapshot->GetLongValue("section 19", "check"), 5);
+}
+
+TEST(Shared, ReadersDuringPublish) {
+  CSimpleIniSharedA shared;
+  ASSERT_EQ(shared.LoadData(MakeData(0)), SI_OK);
+
+  std::atomic<bool> bDone(false);
+  std::atomic<int> nErrors(0);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 8; ++t) {
+    readers.emplace_back([&]() {
+      long nLast = 0;
+      while (!bDone.load()) {
+        CSimpleIniSharedA::Snapshot snapshot = shared.GetSnapshot();
+        const long nVersion = snapshot->GetLongValue("section 7", "version");
+        // every value comes from the same version, which never goes back
+        if (nVersion < nLast ||
+            snapshot->GetLongValue("section 19", "check") != nVersion) {
+          ++nErrors;
+        }
+        nLast = nVersion;
+      }
+    });
+  }
+  for (int n = 1; n <= 300; ++n) {
+    ASSERT_EQ(shared.LoadData(MakeData(n)), SI_OK);
+  }
+  bDone = true;
+  for (size_t t = 0; t < readers.size(); ++t) {
+    readers[t].join();
+  }
+  ASSERT_EQ(nErrors.load(), 0);
+  ASSERT_EQ(shared.Collect(), 0u);
+  ASSERT_EQ(shared.GetSnapshot()->GetLongValue("section 7", "version"), 300);
+}
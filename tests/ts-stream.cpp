@@ -0,0 +1,147 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+static const char g_szInput[] =
+    "; file comment line 1\n"
+    "; file comment line 2\n"
+    "\n"
+    "global = 1\n"
+    "; section comment\n"
+    "\n"
+    "; continues after a blank line\n"
+    "[section one]\r\n"
+    "key = value\r\n"
+    "multi = <<<END\n"
+    "line 1\n"
+    "\n"
+    "line 3\n"
+    "END\n"
+    "; key comment\n"
+    "dup = a\n"
+    "dup = b\n"
+    "invalid line\n"
+    "[ section two ]\n"
+    "  spaced key  =  spaced value  \n"
+    "tail = <<<TAG\n"
+    "unterminated multi-line value";
+
+static std::string SaveString(const CSimpleIniA &a_ini) {
+  std::string strOut;
+  EXPECT_EQ(a_ini.Save(strOut), SI_OK);
+  return strOut;
+}
+
+static SI_Error LoadChunked(CSimpleIniA &a_ini, const std::string &a_strData,
+                            size_t a_uChunk) {
+  SI_Error rc = a_ini.BeginLoad();
+  if (rc < 0) {
+    return rc;
+  }
+  for (size_t uPos = 0; uPos < a_strData.size(); uPos += a_uChunk) {
+    rc = a_ini.Feed(a_strData.data() + uPos,
+                    std::min(a_uChunk, a_strData.size() - uPos));
+    if (rc < 0) {
+      return rc;
+    }
+  }
+  return a_ini.EndLoad();
+}
+
+TEST(StreamLoad, EveryChunkSizeMatchesLoadData) {
+  const std::string strData = g_szInput;
+  CSimpleIniA expected(false, true, true);
+  ASSERT_EQ(expected.LoadData(strData), SI_OK);
+  const std::string strExpected = SaveString(expected);
+
+  for (size_t uChunk = 1; uChunk <= strData.size(); ++uChunk) {
+    CSimpleIniA ini(false, true, true);
+    ASSERT_EQ(LoadChunked(ini, strData, uChunk), SI_OK) << uChunk;
+    ASSERT_EQ(SaveString(ini), strExpected) << uChunk;
+  }
+}
+
+TEST(StreamLoad, EverySplitPointMatchesLoadData) {
+  const std::string strData = g_szInput;
+  CSimpleIniA expected(false, true, true);
+  ASSERT_EQ(expected.LoadData(strData), SI_OK);
+  const std::string strExpected = SaveString(expected);
+
+  for (size_t uSplit = 0; uSplit <= strData.size(); ++uSplit) {
+    CSimpleIniA ini(false, true, true);
+    ASSERT_EQ(ini.BeginLoad(), SI_OK);
+    ASSERT_EQ(ini.Feed(strData.data(), uSplit), SI_OK);
+    ASSERT_EQ(ini.Feed(strData.data() + uSplit, strData.size() - uSplit),
+              SI_OK);
+    ASSERT_EQ(ini.EndLoad(), SI_OK);
+    ASSERT_EQ(SaveString(ini), strExpected) << uSplit;
+  }
+}
+
+TEST(StreamLoad, EntriesAvailableBeforeEndLoad) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.BeginLoad(), SI_OK);
+  ASSERT_TRUE(ini.IsLoading());
+  ASSERT_EQ(ini.Feed("[s]\na = 1\nb = 2\nc = ", 20), SI_OK);
+  ASSERT_STREQ(ini.GetValue("s", "a"), "1");
+  ASSERT_EQ(ini.GetValue("s", "c"), nullptr);
+  ASSERT_EQ(ini.Feed("3\n", 2), SI_OK);
+  ASSERT_EQ(ini.EndLoad(), SI_OK);
+  ASSERT_FALSE(ini.IsLoading());
+  ASSERT_STREQ(ini.GetValue("s", "b"), "2");
+  ASSERT_STREQ(ini.GetValue("s", "c"), "3");
+}
+
+TEST(StreamLoad, SignatureSplitAcrossChunks) {
+  const std::string strData = SI_UTF8_SIGNATURE "[s]\nkey = value\n";
+  CSimpleIniA ini;
+  ASSERT_EQ(LoadChunked(ini, strData, 1), SI_OK);
+  ASSERT_TRUE(ini.IsUnicode());
+  ASSERT_STREQ(ini.GetValue("s", "key"), "value");
+}
+
+TEST(StreamLoad, MergeIntoExistingData) {
+  const char szFirst[] = "; comment\n\n[a]\nx = 1\n";
+  const char szSecond[] = "; second\n\n[a]\n; key\ny = 2\n[b]\nz = 3\n";
+
+  CSimpleIniA expected;
+  ASSERT_EQ(expected.LoadData(szFirst), SI_OK);
+  ASSERT_EQ(expected.LoadData(szSecond), SI_OK);
+
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(szFirst), SI_OK);
+  ASSERT_EQ(LoadChunked(ini, szSecond, 3), SI_OK);
+  ASSERT_STREQ(ini.GetValue("a", "y"), "2");
+  ASSERT_STREQ(ini.GetValue("b", "z"), "3");
+  ASSERT_EQ(SaveString(ini), SaveString(expected));
+}
+
+TEST(StreamLoad, ErrorCancelsLoad) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData("[a]\nx = 1\n"), SI_OK);
+
+  ASSERT_EQ(ini.BeginLoad(), SI_OK);
+  ASSERT_EQ(ini.BeginLoad(), SI_FAIL);
+  ASSERT_EQ(ini.Feed("[a]\ny = 2\n[b]\nz = 3\nw = 4\n", 26), SI_OK);
+  ASSERT_STREQ(ini.GetValue("b", "z"), "3");
+  ASSERT_EQ(ini.Feed("bad\0data\n", 9), SI_FAIL);
+  ASSERT_FALSE(ini.IsLoading());
+  ASSERT_EQ(ini.Feed("v = 5\n", 6), SI_FAIL);
+  ASSERT_EQ(ini.EndLoad(), SI_FAIL);
+
+  ASSERT_STREQ(ini.GetValue("a", "x"), "1");
+  ASSERT_EQ(ini.GetValue("a", "y"), nullptr);
+  ASSERT_FALSE(ini.SectionExists("b"));
+}
+
+TEST(StreamLoad, CancelOnEmptyResets) {
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.BeginLoad(), SI_OK);
+  ASSERT_EQ(ini.Feed("; comment\n\n[a]\nx = 1\ny = 2\n", 26), SI_OK);
+  ini.CancelLoad();
+  ASSERT_FALSE(ini.IsLoading());
+  ASSERT_TRUE(ini.IsEmpty());
+  ASSERT_EQ(LoadChunked(ini, "[c]\nk = v\n", 4), SI_OK);
+  ASSERT_STREQ(ini.GetValue("c", "k"), "v");
+}
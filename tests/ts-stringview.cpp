@@ -0,0 +1,136 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <string_view>
+
+static const char g_data[] = "[section]\n"
+                             "key = value\n"
+                             "num = 42\n"
+                             "dbl = 1.5\n"
+                             "flag = yes\n"
+                             "multi = 1\n"
+                             "multi = 2\n"
+                             "\n"
+                             "[Other]\n"
+                             "key = other\n";
+
+// names taken from a larger buffer, none of them are NUL terminated
+struct Names {
+  std::string buffer = "sectionkeynummultiOtherdblflagmissing";
+  std::string_view section = std::string_view(buffer).substr(0, 7);
+  std::string_view key = std::string_view(buffer).substr(7, 3);
+  std::string_view num = std::string_view(buffer).substr(10, 3);
+  std::string_view multi = std::string_view(buffer).substr(13, 5);
+  std::string_view other = std::string_view(buffer).substr(18, 5);
+  std::string_view dbl = std::string_view(buffer).substr(23, 3);
+  std::string_view flag = std::string_view(buffer).substr(26, 4);
+  std::string_view missing = std::string_view(buffer).substr(30, 7);
+};
+
+template <class INI> static void CheckLookups(INI &ini) {
+  const Names n;
+  ASSERT_TRUE(ini.SectionExists(n.section));
+  ASSERT_TRUE(ini.SectionExists(n.other));
+  ASSERT_FALSE(ini.SectionExists(n.missing));
+  ASSERT_FALSE(ini.SectionExists(n.section.substr(0, 6)));
+  ASSERT_TRUE(ini.KeyExists(n.section, n.key));
+  ASSERT_FALSE(ini.KeyExists(n.section, n.key.substr(0, 2)));
+  ASSERT_FALSE(ini.KeyExists(n.missing, n.key));
+
+  ASSERT_STREQ(ini.GetValue(n.section, n.key), "value");
+  ASSERT_STREQ(ini.GetValue(n.other, n.key), "other");
+  ASSERT_STREQ(ini.GetValue(n.section, n.missing, "def"), "def");
+  ASSERT_EQ(ini.GetValueView(n.section, n.key), "value");
+  ASSERT_EQ(ini.GetValueView(n.section, n.missing, "def"), "def");
+  ASSERT_EQ(ini.GetLongValue(n.section, n.num), 42);
+  ASSERT_EQ(ini.GetDoubleValue(n.section, n.dbl), 1.5);
+  ASSERT_TRUE(ini.GetBoolValue(n.section, n.flag));
+  ASSERT_EQ(ini.GetLongValue(n.section, n.missing, 7), 7);
+
+  bool bMultiple = false;
+  ASSERT_EQ(ini.GetValueView(n.section, n.multi, {}, &bMultiple),
+            ini.IsMultiKey() ? "1" : "2");
+  ASSERT_EQ(bMultiple, ini.IsMultiKey());
+
+  typename INI::TNamesDepend names;
+  ASSERT_TRUE(ini.GetAllValues(n.section, n.multi, names));
+  ASSERT_EQ(names.size(), ini.IsMultiKey() ? 2u : 1u);
+  ASSERT_TRUE(ini.GetAllKeys(n.section, names));
+  ASSERT_EQ(names.size(), 5u);
+  ASSERT_EQ(ini.GetSectionSize(n.section), 5);
+  ASSERT_EQ(ini.GetSectionSize(n.missing), -1);
+  ASSERT_NE(ini.GetSection(n.other), nullptr);
+}
+
+TEST(StringView, Lookups) {
+  for (int nMode = 0; nMode < 4; ++nMode) {
+    CSimpleIniA ini(false, (nMode & 1) != 0);
+    ini.SetHashIndex((nMode & 2) != 0);
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+    CheckLookups(ini);
+  }
+
+  CSimpleIniA lazy(false, true);
+  lazy.SetLazyLoad();
+  ASSERT_EQ(lazy.LoadData(g_data), SI_OK);
+  CheckLookups(lazy);
+
+  // case insensitive names compare by length too
+  CSimpleIniA ini;
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  ASSERT_STREQ(ini.GetValue(std::string_view("SECTIONX", 7), "KEY"), "value");
+  CSimpleIniCaseA caseIni;
+  ASSERT_EQ(caseIni.LoadData(g_data), SI_OK);
+  ASSERT_EQ(caseIni.GetValue(std::string_view("SECTIONX", 7), "key"), nullptr);
+  ASSERT_STREQ(caseIni.GetValue(std::string("Other"), "key"), "other");
+}
+
+// a comparison with no length aware version, names are copied first
+struct PlainLess {
+  bool operator()(const char *a_pLeft, const char *a_pRight) const {
+    return strcmp(a_pLeft, a_pRight) < 0;
+  }
+};
+
+TEST(StringView, CopiedNames) {
+  CSimpleIniTempl<char, PlainLess, SI_ConvertA<char>> ini(false, true);
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  CheckLookups(ini);
+
+  // longer than the buffer on the stack
+  const std::string longKey(500, 'k');
+  ASSERT_EQ(ini.SetValue(std::string_view("section"), longKey, "long"),
+            SI_INSERTED);
+  ASSERT_STREQ(ini.GetValue(std::string_view("section"), longKey), "long");
+}
+
+TEST(StringView, Modify) {
+  CSimpleIniA ini;
+  const std::string buffer = "abc=def";
+  const std::string_view view(buffer);
+  ASSERT_EQ(ini.SetValue(view.substr(0, 1), view.substr(1, 2), view.substr(4)),
+            SI_INSERTED);
+  ASSERT_STREQ(ini.GetValue("a", "bc"), "def");
+  ASSERT_EQ(ini.SetLongValue(view.substr(0, 1), view.substr(4, 1), 12),
+            SI_INSERTED);
+  ASSERT_EQ(ini.SetBoolValue(view.substr(0, 1), view.substr(5, 1), true),
+            SI_INSERTED);
+  ASSERT_EQ(ini.SetDoubleValue(view.substr(0, 1), view.substr(6, 1), 0.5),
+            SI_INSERTED);
+  ASSERT_EQ(ini.GetLongValue("a", "d"), 12);
+  ASSERT_TRUE(ini.GetBoolValue("a", "e"));
+  ASSERT_EQ(ini.GetDoubleValue("a", "f"), 0.5);
+
+  ASSERT_FALSE(ini.DeleteValue(view.substr(0, 1), view.substr(1, 2), "xyz"));
+  ASSERT_TRUE(ini.DeleteValue(view.substr(0, 1), view.substr(1, 2),
+                              view.substr(4)));
+  ASSERT_FALSE(ini.KeyExists("a", "bc"));
+  ASSERT_TRUE(ini.Delete(view.substr(0, 1), view.substr(4, 1)));
+  ASSERT_FALSE(ini.KeyExists("a", "d"));
+  ASSERT_TRUE(ini.KeyExists("a", "e"));
+
+  // NUL terminated names still use the pointer overloads
+  ASSERT_TRUE(ini.Delete("a", NULL));
+  ASSERT_TRUE(ini.IsEmpty());
+}
@@ -0,0 +1,109 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+static const char g_data[] = "[limits]\n"
+                             "max_inflight = 64\n"
+                             "ratio = 0.25\n"
+                             "enabled = yes\n"
+                             "bad = 12abc\n";
+
+TEST(ValueCache, ReadsCachedValues) {
+  CSimpleIniA ini;
+  ini.SetValueCache();
+  ASSERT_TRUE(ini.IsValueCache());
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+
+  for (int n = 0; n < 2; ++n) {
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 64);
+    ASSERT_EQ(ini.GetDoubleValue("limits", "ratio"), 0.25);
+    ASSERT_TRUE(ini.GetBoolValue("limits", "enabled"));
+    ASSERT_EQ(ini.GetLongValue("limits", "bad", -1), -1);
+    ASSERT_EQ(ini.GetLongValue("limits", "missing", -2), -2);
+  }
+
+  // a value read as another type is converted again
+  ASSERT_EQ(ini.GetDoubleValue("limits", "max_inflight"), 64.0);
+  ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 64);
+  ASSERT_EQ(ini.GetLongValue("limits", "ratio", -1), -1);
+  ASSERT_EQ(ini.GetDoubleValue("limits", "ratio"), 0.25);
+}
+
+TEST(ValueCache, ChangesInvalidate) {
+  for (int nMode = 0; nMode < 2; ++nMode) {
+    CSimpleIniA ini(false, nMode == 1);
+    ini.SetValueCache();
+    ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 64);
+
+    ASSERT_EQ(ini.SetLongValue("limits", "max_inflight", 128, NULL, false,
+                               true),
+              SI_UPDATED);
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 128);
+    ASSERT_EQ(ini.SetValue("limits", "max_inflight", "256", NULL, true),
+              SI_UPDATED);
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 256);
+
+    ASSERT_TRUE(ini.GetBoolValue("limits", "enabled"));
+    ASSERT_EQ(ini.SetBoolValue("limits", "enabled", false, NULL, true),
+              SI_UPDATED);
+    ASSERT_FALSE(ini.GetBoolValue("limits", "enabled", true));
+
+    ASSERT_TRUE(ini.Delete("limits", "max_inflight"));
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight", -1), -1);
+    ASSERT_EQ(ini.SetLongValue("limits", "max_inflight", 7), SI_INSERTED);
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 7);
+
+    ini.Reset();
+    ASSERT_EQ(ini.GetLongValue("limits", "max_inflight", -1), -1);
+  }
+}
+
+TEST(ValueCache, MultiKey) {
+  CSimpleIniA ini(false, true);
+  ini.SetValueCache();
+  ASSERT_EQ(ini.LoadData("[s]\nk = 1\nk = 2\n"), SI_OK);
+  bool bHasMultiple = false;
+  ASSERT_EQ(ini.GetLongValue("s", "k", 0, &bHasMultiple), 1);
+  ASSERT_TRUE(bHasMultiple);
+  ASSERT_EQ(ini.GetLongValue("s", "k", 0, &bHasMultiple), 1);
+  ASSERT_TRUE(bHasMultiple);
+  ASSERT_TRUE(ini.DeleteValue("s", "k", "1"));
+  ASSERT_EQ(ini.GetLongValue("s", "k", 0, &bHasMultiple), 2);
+  ASSERT_FALSE(bHasMultiple);
+}
+
+TEST(ValueCache, Disabled) {
+  CSimpleIniA ini;
+  ASSERT_FALSE(ini.IsValueCache());
+  ASSERT_EQ(ini.LoadData(g_data), SI_OK);
+  ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 64);
+  ini.SetValueCache();
+  ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 64);
+  ini.SetValueCache(false);
+  ASSERT_EQ(ini.SetValue("limits", "max_inflight", "5"), SI_UPDATED);
+  ini.SetValueCache();
+  ASSERT_EQ(ini.GetLongValue("limits", "max_inflight"), 5);
+}
+
+TEST(ValueCache, ErasedEntriesAreForgotten) {
+  CSimpleIniA ini;
+  ini.SetValueCache();
+  // the map nodes of erased keys are likely reused for the new keys
+  for (int nRound = 0; nRound < 20; ++nRound) {
+    for (long n = 0; n < 100; ++n) {
+      const std::string key = "key" + std::to_string(n);
+      ASSERT_EQ(ini.SetLongValue("s", key.c_str(), n * nRound), SI_INSERTED);
+      ASSERT_EQ(ini.GetLongValue("s", key.c_str()), n * nRound);
+    }
+    if (nRound % 2) {
+      ASSERT_TRUE(ini.Delete("s", NULL));
+    } else {
+      for (long n = 0; n < 100; ++n) {
+        const std::string key = "key" + std::to_string(n);
+        ASSERT_TRUE(ini.Delete("s", key.c_str()));
+      }
+    }
+  }
+}
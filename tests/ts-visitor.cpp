@@ -0,0 +1,105 @@
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+class RecordingVisitor : public CSimpleIniA::Visitor {
+public:
+  RecordingVisitor() : m_nStopAfter(-1) {}
+
+  bool OnComment(const char *a_pComment) override {
+    m_strLog += "C(" + std::string(a_pComment) + ")\n";
+    return Next();
+  }
+  bool OnSection(const char *a_pSection) override {
+    m_strLog += "S(" + std::string(a_pSection) + ")\n";
+    return Next();
+  }
+  bool OnKey(const char *a_pSection, const char *a_pKey,
+             const char *a_pValue) override {
+    m_strLog += "K(" + std::string(a_pSection) + "|" + a_pKey + "|" +
+                a_pValue + ")\n";
+    return Next();
+  }
+
+  std::string m_strLog;
+  int m_nStopAfter;
+
+private:
+  bool Next() { return m_nStopAfter < 0 || --m_nStopAfter > 0; }
+};
+
+static const char g_szInput[] =
+    "; file comment\n"
+    "\n"
+    "global = 1\n"
+    "; section comment\n"
+    "[one]\r\n"
+    "key = \"quoted\"\r\n"
+    "multi = <<<END\n"
+    "line 1\n"
+    "line 2\n"
+    "END\n"
+    "[two]\n"
+    "flag\n"
+    "key = second\n"
+    "[one]\n"
+    "key = again\n"
+    "; trailing comment\n";
+
+TEST(Visitor, ReportsEntriesInFileOrder) {
+  CSimpleIniA ini;
+  ini.SetMultiLine();
+  ini.SetQuotes();
+  ini.SetAllowKeyOnly();
+  RecordingVisitor visitor;
+  ASSERT_EQ(ini.Parse(g_szInput, visitor), SI_OK);
+  EXPECT_EQ(visitor.m_strLog, "C(; file comment)\n"
+                              "K(|global|1)\n"
+                              "C(; section comment)\n"
+                              "S(one)\n"
+                              "K(one|key|quoted)\n"
+                              "K(one|multi|line 1\nline 2)\n"
+                              "S(two)\n"
+                              "K(two|flag|)\n"
+                              "K(two|key|second)\n"
+                              "S(one)\n"
+                              "K(one|key|again)\n"
+                              "C(; trailing comment)\n");
+  EXPECT_TRUE(ini.IsEmpty());
+}
+
+TEST(Visitor, UsesCurrentSettings) {
+  CSimpleIniA ini;
+  RecordingVisitor visitor;
+  ASSERT_EQ(ini.Parse("[s]\nflag\nkey = \"quoted\"\nm = <<<END\n", visitor),
+            SI_OK);
+  EXPECT_EQ(visitor.m_strLog, "S(s)\n"
+                              "K(s|key|\"quoted\")\n"
+                              "K(s|m|<<<END)\n");
+}
+
+TEST(Visitor, StopsWhenCallbackReturnsFalse) {
+  CSimpleIniA ini;
+  RecordingVisitor visitor;
+  visitor.m_nStopAfter = 2;
+  ASSERT_EQ(ini.Parse("[a]\nx = 1\ny = 2\n; end\n", visitor), SI_OK);
+  EXPECT_EQ(visitor.m_strLog, "S(a)\n"
+                              "K(a|x|1)\n");
+}
+
+TEST(Visitor, Utf8SignatureDoesNotChangeSettings) {
+  CSimpleIniA ini;
+  RecordingVisitor visitor;
+  ASSERT_EQ(ini.Parse("\xEF\xBB\xBF[s]\nk = v\n", visitor), SI_OK);
+  EXPECT_EQ(visitor.m_strLog, "S(s)\nK(s|k|v)\n");
+  EXPECT_FALSE(ini.IsUnicode());
+}
+
+TEST(Visitor, EmptyData) {
+  CSimpleIniA ini;
+  RecordingVisitor visitor;
+  EXPECT_EQ(ini.Parse("", visitor), SI_OK);
+  EXPECT_EQ(ini.Parse(NULL, 0, visitor), SI_OK);
+  EXPECT_EQ(visitor.m_strLog, "");
+}
@@ -0,0 +1,200 @@
+#define SI_SUPPORT_WATCH
+#include "../SimpleIni.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+
+// Records the changes reported by the watcher
+class WatchTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    char szDir[] = "watch-XXXXXX";
+    ASSERT_NE(mkdtemp(szDir), nullptr);
+    m_strDir = szDir;
+    m_strFile = m_strDir + "/config.ini";
+    m_nReloads = 0;
+    m_uChanges = 0;
+  }
+
+  void TearDown() override {
+    unlink(m_strFile.c_str());
+    unlink((m_strFile + ".new").c_str());
+    unlink((m_strDir + "/other.ini").c_str());
+    rmdir(m_strDir.c_str());
+  }
+
+  void Write(const std::string &a_strPath, const std::string &a_strData) {
+    FILE *fp = fopen(a_strPath.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fwrite(a_strData.data(), 1, a_strData.size(), fp);
+    fclose(fp);
+  }
+
+  void Watch(CSimpleIniWatcherA &a_watcher) {
+    a_watcher.SetDebounce(20);
+    a_watcher.SetCallback([this](
+                              const CSimpleIniA &, const CSimpleIniA &,
+                              const CSimpleIniWatcherA::TChanges &a_changes) {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_changes.clear();
+      for (const CSimpleIniWatcherA::Change &change : a_changes) {
+        m_changes.insert(std::string(change.pSection) + "/" +
+                         (change.pKey ? change.pKey : "*"));
+      }
+      m_uChanges = a_changes.size();
+      ++m_nReloads;
+      m_changed.notify_all();
+    });
+  }
+
+  // wait for the given number of reloads, return the last changes
+  std::set<std::string> WaitFor(int a_nReloads) {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_changed.wait_for(lock, std::chrono::seconds(10),
+                       [&]() { return m_nReloads >= a_nReloads; });
+    EXPECT_EQ(m_nReloads, a_nReloads);
+    return m_changes;
+  }
+
+  std::string m_strDir;
+  std::string m_strFile;
+  std::mutex m_lock;
+  std::condition_variable m_changed;
+  std::set<std::string> m_changes;
+  int m_nReloads;
+  size_t m_uChanges;
+};
+
+TEST_F(WatchTest, ReportsChangedKeys) {
+  Write(m_strFile, "[a]\nx = 1\ny = 2\n[b]\nz = 3\n[c]\nw = 4\n");
+  CSimpleIniSharedA shared;
+  CSimpleIniWatcherA watcher(shared);
+  Watch(watcher);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_OK);
+  ASSERT_TRUE(watcher.IsRunning());
+  ASSERT_STREQ(shared.GetSnapshot()->GetValue("a", "x"), "1");
+
+  Write(m_strFile, "[a]\nx = 1\ny = 5\nv = 6\n[c]\nw = 4\n[d]\nu = 7\n");
+  const std::set<std::string> expected = {"a/y", "a/v", "b/*", "d/*"};
+  ASSERT_EQ(WaitFor(1), expected);
+  ASSERT_STREQ(shared.GetSnapshot()->GetValue("a", "y"), "5");
+
+  watcher.Stop();
+  ASSERT_FALSE(watcher.IsRunning());
+}
+
+TEST_F(WatchTest, MultiKeyReportedOnce) {
+  Write(m_strFile, "[a]\nx = 1\nx = 2\ny = 1\n");
+  CSimpleIniSharedA shared(false, true);
+  CSimpleIniWatcherA watcher(shared);
+  Watch(watcher);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_OK);
+
+  // every value of x differs, but x is one change
+  Write(m_strFile, "[a]\nx = 3\nx = 4\nx = 5\ny = 1\n");
+  const std::set<std::string> expected = {"a/x"};
+  ASSERT_EQ(WaitFor(1), expected);
+  std::lock_guard<std::mutex> lock(m_lock);
+  ASSERT_EQ(m_uChanges, 1u);
+}
+
+TEST_F(WatchTest, RenamedOverFile) {
+  Write(m_strFile, "[a]\nx = 1\n");
+  CSimpleIniSharedA shared;
+  CSimpleIniWatcherA watcher(shared);
+  Watch(watcher);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_OK);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_FAIL);
+
+  Write(m_strFile + ".new", "[a]\nx = 2\n");
+  ASSERT_EQ(rename((m_strFile + ".new").c_str(), m_strFile.c_str()), 0);
+  const std::set<std::string> expected = {"a/x"};
+  ASSERT_EQ(WaitFor(1), expected);
+  ASSERT_STREQ(shared.GetSnapshot()->GetValue("a", "x"), "2");
+}
+
+TEST_F(WatchTest, UnchangedDataIsNotReported) {
+  Write(m_strFile, "[a]\nx = 1\n");
+  CSimpleIniSharedA shared;
+  CSimpleIniWatcherA watcher(shared);
+  Watch(watcher);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_OK);
+
+  // a reload that finds no change doesn't call the callback
+  Write(m_strFile, "; only a comment\n[a]\nx = 1\n");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  Write(m_strFile, "[a]\nx = 3\n");
+  const std::set<std::string> expected = {"a/x"};
+  ASSERT_EQ(WaitFor(1), expected);
+}
+
+TEST_F(WatchTest, OtherWritesDontPostponeReload) {
+  Write(m_strFile, "[a]\nx = 1\n");
+  CSimpleIniSharedA shared;
+  CSimpleIniWatcherA watcher(shared);
+  Watch(watcher);
+  watcher.SetDebounce(200);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_OK);
+
+  // another file in the directory is written more often than the debounce
+  // time, until the change is reported or a time limit passes
+  std::atomic<bool> bStop(false);
+  std::thread noise([&]() {
+    const std::chrono::steady_clock::time_point tEnd =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!bStop && std::chrono::steady_clock::now() < tEnd) {
+      Write(m_strDir + "/other.ini", "[b]\ny = 1\n");
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  Write(m_strFile, "[a]\nx = 2\n");
+  std::set<std::string> changes;
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_changed.wait_for(lock, std::chrono::seconds(2),
+                       [&]() { return m_nReloads >= 1; });
+    changes = m_changes;
+  }
+  bStop = true;
+  noise.join();
+  const std::set<std::string> expected = {"a/x"};
+  ASSERT_EQ(changes, expected);
+}
+
+TEST_F(WatchTest, MissingFile) {
+  CSimpleIniSharedA shared;
+  CSimpleIniWatcherA watcher(shared);
+  ASSERT_EQ(watcher.Start(m_strFile.c_str()), SI_FILE);
+  ASSERT_FALSE(watcher.IsRunning());
+  ASSERT_FALSE(shared.GetSnapshot());
+}
+
+TEST(Watch, FindChangesMultiKey) {
+  CSimpleIniA before(false, true), after(false, true);
+  ASSERT_EQ(before.LoadData("[s]\nk = 1\nk = 2\nm = 1\nn = 1\n"), SI_OK);
+  ASSERT_EQ(after.LoadData("[s]\nk = 1\nm = 1\nm = 2\nn = 1\n"), SI_OK);
+  CSimpleIniWatcherA::TChanges changes;
+  CSimpleIniWatcherA::FindChanges(before, after, changes);
+  ASSERT_EQ(changes.size(), 2u);
+  ASSERT_STREQ(changes[0].pKey, "k");
+  ASSERT_STREQ(changes[1].pKey, "m");
+
+  // a key whose values all changed, and a section that is only in one
+  CSimpleIniA added(false, true);
+  ASSERT_EQ(added.LoadData("[s]\nk = 3\nk = 4\nm = 1\nn = 1\n[t]\nk = 1\n"),
+            SI_OK);
+  CSimpleIniWatcherA::FindChanges(before, added, changes);
+  ASSERT_EQ(changes.size(), 2u);
+  ASSERT_STREQ(changes[0].pKey, "k");
+  ASSERT_STREQ(changes[1].pSection, "t");
+  ASSERT_EQ(changes[1].pKey, nullptr);
+}